@@ -1,41 +1,118 @@
-#include "mws_ivp_solver.h"
-#include "mws_ls_solver.h"
-#include "mws_nls_solver.h"
-
-#include "my_euler.c"    /*Զ㷨ͷļ*/
-
-void MwsRegisterUserAlgorithm1(void* mdl_data)
-{
-	/* Register user defined LS and NLS algorithm. Ի㷨*/
-}
-
-void MwsRegisterUserAlgorithm2(void* sim_data)
-{
-	/* Register user defined IVP algorithm.㷨 */
-    MwsIVPSolverProp ivp_prop;
-    MwsIVPSolverFcns ivp_fcns;
-
-    ivp_prop.m_name = "myeuler";                        /*ƣִСд֤Ψһ*/
-    ivp_prop.m_desc = "MYEULER";                        /*㷨*/
-    ivp_prop.m_fixedStep = moTrue;                      /*ǷΪmoTruemoFalse*/
-    ivp_prop.m_ivpType = MWS_IVP_ODE;                   /*㷨ͣODEΪMWS_IVP_ODEDAEΪMWS_IVP_DAE*/
-    ivp_fcns.m_createPtr = &myEulerCreate;              /*㷨ָ*/
-    ivp_fcns.m_createPBPtr = &myEulerProblemCreate;     /*ָ*/
-    ivp_fcns.m_destroyPBPtr = &myEulerProblemDestroy;   /*ָ*/
-    ivp_fcns.m_destroyPtr = &myEulerDestroy;            /*㷨ָ*/
-    ivp_fcns.m_initPtr = &myEulerInit;                  /*ʼָ*/
-    ivp_fcns.m_interpolatePtr = &myEulerInterpolate;    /*ֵ*/
-    ivp_fcns.m_solvePtr = &myEulerSolve;                /*⺯ָ*/
-    isimRegisterIVPSolver(sim_data, &ivp_prop, &ivp_fcns);
-}
-
-void MwsUnregisterUserAlgorithm1(void* mdl_data)
-{
-	/* Unregister user defined LS and NLS algorithm. */
-}
-
-void MwsUnregisterUserAlgorithm2(void* sim_data)
-{
-	/* Unregister user defined IVP algorithm. */
-    isimUnregisterIVPSolver(sim_data, "myeuler");
-}
\ No newline at end of file
+/* -std=c99/c11 等严格模式下 <time.h> 不声明 clock_gettime，须在包含任何系统头文件前打开POSIX接口（各算法文件整体包含于此） */
+#if !defined(_WIN32) && defined(__STRICT_ANSI__) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 199309L
+#endif
+
+#include "mws_ivp_solver.h"
+#include "mws_ls_solver.h"
+#include "mws_nls_solver.h"
+
+/*
+ * 自定义算法插件：全部算法在同一个插件中，按下面的注册表注册
+ * my_RK45.c、my_euler.c 的级计算在 my_rk_engine.cpp 中，须一并编译
+ */
+#include "my_ivp_trace.c"   /* 定义 MY_IVP_TRACE 时跟踪各回调与试算步耗时，否则为空 */
+#include "my_euler.c"
+#include "my_symplectic.c"
+#include "my_RK45.c"
+#include "my_dop853.c"
+#include "my_bs23.c"
+#include "my_multirate.c"
+#include "my_abm.c"
+#include "my_gbs.c"
+#include "my_pirk.c"
+#include "my_exprb.c"
+#include "my_parareal.c"    /* 须在 my_euler.c、my_RK45.c 之后 */
+#include "my_auto.c"        /* 须在各候选算法之后 */
+
+/* 注册表的一行；新增算法只需加一行 */
+typedef struct
+{
+    MwsString m_name;           /* 名称，不区分大小写，保证唯一 */
+    MwsString m_desc;           /* 算法描述 */
+    MwsBoolean m_fixedStep;     /* 是否为定步长 */
+    MwsIVPSolverFcns m_fcns;    /* 创建、创建问题、初始化、求解、插值、销毁问题、销毁 */
+} MyIVPRegistryEntry;
+
+static const MyIVPRegistryEntry s_myIVPRegistry[] =
+{
+    /* 实时定步长：显式欧拉、Heun、RK4 */
+    { "myeuler", "MYEULER", moTrue, { &myEulerCreate, &myEulerProblemCreate, &myEulerInit, &myEulerSolve,
+        &myEulerInterpolate, &myEulerProblemDestroy, &myEulerDestroy } },
+    /* 辛积分算法，状态排列为[位置;速度]，三者只有创建函数不同 */
+    { "myVerlet", "MYVERLET", moTrue, { &myVerletCreate, &mySymplecticProblemCreate, &mySymplecticInit,
+        &mySymplecticSolve, &mySymplecticInterpolate, &mySymplecticProblemDestroy, &mySymplecticDestroy } },
+    { "myYoshida4", "MYYOSHIDA4", moTrue, { &myYoshida4Create, &mySymplecticProblemCreate, &mySymplecticInit,
+        &mySymplecticSolve, &mySymplecticInterpolate, &mySymplecticProblemDestroy, &mySymplecticDestroy } },
+    { "myBlanesMoan", "MYBLANESMOAN", moTrue, { &myBlanesMoanCreate, &mySymplecticProblemCreate, &mySymplecticInit,
+        &mySymplecticSolve, &mySymplecticInterpolate, &mySymplecticProblemDestroy, &mySymplecticDestroy } },
+    /* Runge-Kutta 4(5)，Butcher表可选 */
+    { "myRK45", "MYRK45", moFalse, { &myRK45Create, &myRK45ProblemCreate, &myRK45Init, &myRK45Solve,
+        &myRK45Interpolate, &myRK45ProblemDestroy, &myRK45Destroy } },
+    /* 8阶变步长，适合1e-10~1e-12的严格容差 */
+    { "myDOP853", "MYDOP853", moFalse, { &myDop853Create, &myDop853ProblemCreate, &myDop853Init, &myDop853Solve,
+        &myDop853Interpolate, &myDop853ProblemDestroy, &myDop853Destroy } },
+    /* 3(2)阶变步长，适合1e-3左右的宽松容差和交互式仿真 */
+    { "myBS23", "MYBS23", moFalse, { &myBs23Create, &myBs23ProblemCreate, &myBs23Init, &myBs23Solve,
+        &myBs23Interpolate, &myBs23ProblemDestroy, &myBs23Destroy } },
+    /* 多速率：慢变量宏步、快变量微步 */
+    { "myMultirate", "MYMULTIRATE", moFalse, { &myMultirateCreate, &myMultirateProblemCreate, &myMultirateInit,
+        &myMultirateSolve, &myMultirateInterpolate, &myMultirateProblemDestroy, &myMultirateDestroy } },
+    /* 变步长变阶Adams PECE，适合右端函数代价高的非刚性问题 */
+    { "myABM", "MYABM", moFalse, { &myAbmCreate, &myAbmProblemCreate, &myAbmInit, &myAbmSolve,
+        &myAbmInterpolate, &myAbmProblemDestroy, &myAbmDestroy } },
+    /* Gragg-Bulirsch-Stoer外推，子步序列可并行 */
+    { "myGBS", "MYGBS", moFalse, { &myGbsCreate, &myGbsProblemCreate, &myGbsInit, &myGbsSolve,
+        &myGbsInterpolate, &myGbsProblemDestroy, &myGbsDestroy } },
+    /* 并行迭代RK（Gauss 6阶），各级右端函数可并行 */
+    { "myPIRK", "MYPIRK", moFalse, { &myPirkCreate, &myPirkProblemCreate, &myPirkInit, &myPirkSolve,
+        &myPirkInterpolate, &myPirkProblemDestroy, &myPirkDestroy } },
+    /* 指数Rosenbrock（Krylov计算φ函数），适合线性部分刚性的半线性问题，如扩散-反应方程的空间离散 */
+    { "myEXPRB", "MYEXPRB", moFalse, { &myExprbCreate, &myExprbProblemCreate, &myExprbInit, &myExprbSolve,
+        &myExprbInterpolate, &myExprbProblemDestroy, &myExprbDestroy } },
+    /* 时间并行：myEuler粗传播、myRK45细传播，需定义终止时间 */
+    { "myParareal", "MYPARAREAL", moFalse, { &myPararealCreate, &myPararealProblemCreate, &myPararealInit,
+        &myPararealSolve, &myPararealInterpolate, &myPararealProblemDestroy, &myPararealDestroy } },
+    /* 按规模、容许误差与刚性探测自动选择上面的算法之一 */
+    { "myAuto", "MYAUTO", moFalse, { &myAutoCreate, &myAutoProblemCreate, &myAutoInit, &myAutoSolve,
+        &myAutoInterpolate, &myAutoProblemDestroy, &myAutoDestroy } },
+};
+
+#define MY_IVP_REGISTRY_SIZE    (sizeof(s_myIVPRegistry) / sizeof(s_myIVPRegistry[0]))
+
+void MwsRegisterUserAlgorithm1(void* mdl_data)
+{
+	/* Register user defined LS and NLS algorithm. 线性或非线性算法*/
+}
+
+void MwsRegisterUserAlgorithm2(void* sim_data)
+{
+	/* Register user defined IVP algorithm.积分算法 */
+    MwsIVPSolverProp ivp_prop;
+    MoSize i;
+
+    for (i = 0; i < MY_IVP_REGISTRY_SIZE; ++i)
+    {
+        ivp_prop.m_name = s_myIVPRegistry[i].m_name;
+        ivp_prop.m_desc = s_myIVPRegistry[i].m_desc;
+        ivp_prop.m_fixedStep = s_myIVPRegistry[i].m_fixedStep;
+        ivp_prop.m_ivpType = MWS_IVP_ODE;               /*积分算法类型，均为ODE*/
+        isimRegisterIVPSolver(sim_data, &ivp_prop, &s_myIVPRegistry[i].m_fcns);
+    }
+}
+
+void MwsUnregisterUserAlgorithm1(void* mdl_data)
+{
+	/* Unregister user defined LS and NLS algorithm. */
+}
+
+void MwsUnregisterUserAlgorithm2(void* sim_data)
+{
+	/* Unregister user defined IVP algorithm. */
+    MoSize i;
+
+    for (i = 0; i < MY_IVP_REGISTRY_SIZE; ++i)
+    {
+        isimUnregisterIVPSolver(sim_data, s_myIVPRegistry[i].m_name);
+    }
+}
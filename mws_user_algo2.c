@@ -1,41 +0,0 @@
-#include "mws_ivp_solver.h"
-#include "mws_ls_solver.h"
-#include "mws_nls_solver.h"
-
-#include "my_RK45.c"    /*Զ㷨ͷļ*/
-
-void MwsRegisterUserAlgorithm1(void* mdl_data)
-{
-	/* Register user defined LS and NLS algorithm. Ի㷨*/
-}
-
-void MwsRegisterUserAlgorithm2(void* sim_data)
-{
-	/* Register user defined IVP algorithm.㷨 */
-    MwsIVPSolverProp ivp_prop;
-    MwsIVPSolverFcns ivp_fcns;
-
-    ivp_prop.m_name = "myRK45";                        /*ƣִСд֤Ψһ*/
-    ivp_prop.m_desc = "MYRK45";                        /*㷨*/
-    ivp_prop.m_fixedStep = moFalse;                      /*ǷΪmoTruemoFalse*/
-    ivp_prop.m_ivpType = MWS_IVP_ODE;                   /*㷨ͣODEΪMWS_IVP_ODEDAEΪMWS_IVP_DAE*/
-    ivp_fcns.m_createPtr = &myRK45Create;              /*㷨ָ*/
-    ivp_fcns.m_createPBPtr = &myRK45ProblemCreate;     /*ָ*/
-    ivp_fcns.m_destroyPBPtr = &myRK45ProblemDestroy;   /*ָ*/
-    ivp_fcns.m_destroyPtr = &myRK45Destroy;            /*㷨ָ*/
-    ivp_fcns.m_initPtr = &myRK45Init;                  /*ʼָ*/
-    ivp_fcns.m_interpolatePtr = &myRK45Interpolate;    /*ֵ*/
-    ivp_fcns.m_solvePtr = &myRK45Solve;                /*⺯ָ*/
-    isimRegisterIVPSolver(sim_data, &ivp_prop, &ivp_fcns);
-}
-
-void MwsUnregisterUserAlgorithm1(void* mdl_data)
-{
-	/* Unregister user defined LS and NLS algorithm. */
-}
-
-void MwsUnregisterUserAlgorithm2(void* sim_data)
-{
-	/* Unregister user defined IVP algorithm. */
-    isimUnregisterIVPSolver(sim_data, "myRK45");
-}
\ No newline at end of file
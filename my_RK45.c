@@ -1,471 +1,2099 @@
-/***************************************************************************
-///
-/// Copyright (c) 2020, ͬԪϢ޹˾
-/// All rights reserved.
-///
-/// @file           my_RK45.c
-/// @brief          ʽŷ㷨ʾ
-///
-/// @version        v1.0
-/// @author         
-/// @date           2020/07/07
-///
-***************************************************************************/
-
-#include "mo_types.h"
-#include "mws_ivp_solver.h"
-
-#include <memory.h>
-#include <math.h>
-
-#ifdef __cplusplus
-extern "C" {
-#endif
-
-    /* 㷨 */
-    typedef struct
-    {
-        MwsIVPUtilFcns	m_utils;
-        void* m_userData;
-
-    } MyRK45;
-
-    /* ݣڴͷź */
-    typedef struct
-    {
-        MoReal* m_preY;
-        MoReal* m_curY;
-
-        MoReal* m_preYp;
-        MoReal* m_curYp;
-
-        MoReal* k1;
-        MoReal* k2;
-        MoReal* k3;
-        MoReal* k4;
-        MoReal* k5;
-        MoReal* k6;
-
-        MoReal* k2y;
-        MoReal* k3y;
-        MoReal* k4y;
-        MoReal* k5y;
-        MoReal* k6y;
-
-        MoReal m_curTime;
-        MoReal m_initialStep;
-        MoReal m_h;
-        
-        MoReal* m_D;
-        MoReal m_Q;
-    } MyRK45ProblemData;
-
-    /*  */
-    typedef struct
-    {
-        MoSize          m_nStates;
-
-        MwsIVPOptions	m_opt;
-        MwsIVPCallback  m_callback;
-        void* m_userData;
-
-        MyRK45ProblemData* m_data;
-        MyRK45* m_solverWork;
-
-    } MyRK45Problem;
-
-    void myRK45ProblemDestroy(MwsIVPSolverObj solver, MwsIVPObj ivp);
-    void myRK45Destroy(MwsIVPSolverObj solver);
-
-    /// <summary>
-    /// 㷨
-    /// </summary>
-    /// <param name="util_fcns">ߺṩûã</param>
-    /// <param name="user_data">ûݣڲݣݸߺutil_fcnsԶ㷨ݣ</param>
-    /// <returns></returns>
-    MwsIVPSolverObj myRK45Create(MwsIVPUtilFcns* util_fcns, void* user_data)
-    {
-        MyRK45* sw = (MyRK45*)util_fcns->m_allocMemory(user_data, 1, sizeof(MyRK45));
-
-        if (sw)
-        {
-            memset(sw, 0, sizeof(*sw));
-            sw->m_utils = *util_fcns;
-            sw->m_userData = user_data;
-        }
-
-        return sw;
-    }
-
-    /// <summary>
-    /// 
-    /// </summary>
-    /// <param name="solver">㷨</param>
-    /// <param name="n">ģ״̬==΢ַ̽</param>
-    /// <param name="call_back">ص</param>
-    /// <param name="opt">ѡ</param>
-    /// <param name="ivp_user_data">û(ڲݣݸصcall_back㷨)</param>
-    /// <returns></returns>
-    MwsIVPObj myRK45ProblemCreate(MwsIVPSolverObj solver, MwsSize n, MwsIVPCallback* call_back, MwsIVPOptions* opt, void* ivp_user_data)
-    {
-        MyRK45* sw = (MyRK45*)solver;
-        MyRK45Problem* spw = (MyRK45Problem*)sw->m_utils.m_allocMemory(sw->m_userData, 1, sizeof(MyRK45Problem));
-
-        if (spw)
-        {
-            MyRK45ProblemData* ds = (MyRK45ProblemData*)sw->m_utils.m_allocDataMemory(sw->m_userData, 1, sizeof(MyRK45ProblemData));
-
-            if (ds == mwsNullPtr)
-            {
-                sw->m_utils.m_freeMemory(sw->m_userData, spw);
-                return mwsNullPtr;
-            }
-
-            memset(spw, 0, sizeof(*spw));
-            memset(ds, 0, sizeof(*ds));
-
-            spw->m_callback = *call_back;
-            spw->m_userData = ivp_user_data;
-            spw->m_opt = *opt;
-            spw->m_nStates = n;
-            spw->m_data = ds;
-            spw->m_solverWork = sw;
-
-            spw->m_data->m_curTime = 0;
-            spw->m_data->m_initialStep = spw->m_opt.m_stopTime/1000;          //Ĭϳʼֲdefault
-            //spw->m_data->m_Q = 0;
-            spw->m_data->m_h = 0;
-
-            spw->m_opt.m_maxStepSize = spw->m_opt.m_stopTime;
-            
-            if (spw->m_nStates > 0)
-            {
-                spw->m_data->m_preY = (MoReal*)sw->m_utils.m_allocDataMemory(sw->m_userData, 1, n * sizeof(MoReal));  //(MoReal *)ǿת
-                spw->m_data->m_curY = (MoReal*)sw->m_utils.m_allocDataMemory(sw->m_userData, 1, n * sizeof(MoReal));
-
-                spw->m_data->m_preYp = (MoReal*)sw->m_utils.m_allocDataMemory(sw->m_userData, 1, n * sizeof(MoReal));
-                spw->m_data->m_curYp = (MoReal*)sw->m_utils.m_allocDataMemory(sw->m_userData, 1, n * sizeof(MoReal));
-
-                spw->m_data->k1 = (MoReal*)sw->m_utils.m_allocDataMemory(sw->m_userData, 1, n * sizeof(MoReal));
-                spw->m_data->k2 = (MoReal*)sw->m_utils.m_allocDataMemory(sw->m_userData, 1, n * sizeof(MoReal));
-                spw->m_data->k3 = (MoReal*)sw->m_utils.m_allocDataMemory(sw->m_userData, 1, n * sizeof(MoReal));
-                spw->m_data->k4 = (MoReal*)sw->m_utils.m_allocDataMemory(sw->m_userData, 1, n * sizeof(MoReal));
-                spw->m_data->k5 = (MoReal*)sw->m_utils.m_allocDataMemory(sw->m_userData, 1, n * sizeof(MoReal));
-                spw->m_data->k6 = (MoReal*)sw->m_utils.m_allocDataMemory(sw->m_userData, 1, n * sizeof(MoReal));
-
-                spw->m_data->k2y = (MoReal*)sw->m_utils.m_allocDataMemory(sw->m_userData, 1, n * sizeof(MoReal));
-                spw->m_data->k3y = (MoReal*)sw->m_utils.m_allocDataMemory(sw->m_userData, 1, n * sizeof(MoReal));
-                spw->m_data->k4y = (MoReal*)sw->m_utils.m_allocDataMemory(sw->m_userData, 1, n * sizeof(MoReal));
-                spw->m_data->k5y = (MoReal*)sw->m_utils.m_allocDataMemory(sw->m_userData, 1, n * sizeof(MoReal));
-                spw->m_data->k6y = (MoReal*)sw->m_utils.m_allocDataMemory(sw->m_userData, 1, n * sizeof(MoReal));
-                spw->m_data->m_D = (MoReal*)sw->m_utils.m_allocDataMemory(sw->m_userData, 1, n * sizeof(MoReal));
-                if (!spw->m_data->m_preY || !spw->m_data->m_curY)
-                {
-                    myRK45ProblemDestroy(sw, spw);
-                    spw = MWnullptr;
-                }
-                else
-                {
-                    MoSize index;
-                    for (index = 0; index < n; ++index)
-                    {
-                        spw->m_data->m_preY[index] = 0;
-                        spw->m_data->m_curY[index] = 0;
-
-                        spw->m_data->m_preYp[index] = 0;
-                        spw->m_data->m_curYp[index] = 0;
-
-                        spw->m_data->m_D[index] = 0;
-
-                        spw->m_data->k1[index] = 0;
-                        spw->m_data->k2[index] = 0;
-                        spw->m_data->k3[index] = 0;
-                        spw->m_data->k4[index] = 0;
-                        spw->m_data->k5[index] = 0;
-                        spw->m_data->k6[index] = 0;
-
-                        spw->m_data->k2y[index] = 0;
-                        spw->m_data->k3y[index] = 0;
-                        spw->m_data->k4y[index] = 0;
-                        spw->m_data->k5y[index] = 0;
-                        spw->m_data->k5y[index] = 0;
-
-                    }
-                }
-            }
-        }
-
-        return spw;   //أ(Զ㷨ڲݣ)Ϊӿںĵڶ±ߵivp
-    }
-
-    /// <summary>
-    /// ʼ
-    /// </summary>
-    /// <param name="solver">㷨</param>
-    /// <param name="ivp"></param>
-    /// <param name="t0">ʼʱ</param>
-    /// <param name="y0">yĳʼֵضΪգ</param>
-    /// <param name="yp0">yĳʼֵDAE</param>
-    /// <param name="is_reinit">Ƿ³ʼ</param>
-    /// <param name="reserve">ݲʹ</param>
-    /// <returns></returns>
-    MwsInteger myRK45Init(MwsIVPSolverObj solver, MwsIVPObj ivp, MwsReal t0, const MwsReal* y0,
-        const MwsReal* yp0, MwsBoolean is_reinit, void* reserve)
-    {
-        /* nothing to do */
-        return MWS_IVP_SUCCESS;  //״̬ȡMwsIVPStatusֵ
-    }
-
-    /// <summary>
-    /// 
-    /// </summary>
-    /// 룺
-    /// <param name="solver">㷨</param>
-    /// <param name="ivp"></param>
-    /// <param name="step_size">ʼֲ</param>
-    /// <param name="t">ǰʱ</param>
-    /// <param name="tout">ʱ</param>
-    /// 
-    /// <param name="tret">ʵʴﵽʱ</param>
-    /// <param name="yret">yĽֵ</param>
-    /// <param name="ypret">yĽֵDAE</param>
-    /// <param name="reserve">ݲʹ</param>
-    /// <returns></returns>
-    MwsInteger myRK45Solve(MwsIVPSolverObj solver, MwsIVPObj ivp, MwsReal step_size, MwsReal t,
-        MwsReal tout, MwsReal* tret, MwsReal* yret, MwsReal* ypret, MwsReal reserve)
-    {
-        MyRK45* sw = (MyRK45*)solver;
-        MyRK45Problem* spw = (MyRK45Problem*)ivp;
-
-        MoSize index = 0;
-        MoSize nState = spw->m_nStates;
-
-        spw->m_data->m_curTime = t;
-        spw->m_data->m_initialStep = step_size;             //ʼֲ
-
-        MoReal* D = spw->m_data->m_D;                       //D=w(i+1)-y(i+1)
-        MoReal h = spw->m_data->m_h;
-        if (h==0)
-        {
-            h = spw->m_data->m_initialStep;
-        }
-        else
-        {
-            h = reserve;
-        }
-
-        MoReal* preY = spw->m_data->m_preY;                 //ϸy
-        MoReal* curY = spw->m_data->m_curY;                //ǰy
-        MoReal* preYp = spw->m_data->m_preYp;               //ϸy'
-        MoReal* curYp = spw->m_data->m_curYp;               //ǰy
-
-        MoReal* K1 = spw->m_data->k1;
-        MoReal* K2 = spw->m_data->k2;
-        MoReal* K3 = spw->m_data->k3;
-        MoReal* K4 = spw->m_data->k4;
-        MoReal* K5 = spw->m_data->k5;
-        MoReal* K6 = spw->m_data->k6;
-
-        MoReal* K2y = spw->m_data->k2y;
-        MoReal* K3y = spw->m_data->k3y;
-        MoReal* K4y = spw->m_data->k4y;
-        MoReal* K5y = spw->m_data->k5y;
-        MoReal* K6y = spw->m_data->k6y;
-        
-        MoBoolean Flag = moTrue;
-        
-            for (index = 0; index < nState; ++index)
-            {
-                preY[index] = yret[index];
-                preYp[index] = ypret[index];
-
-                //ʽ
-
-                K1[index] = preYp[index];
-                K2y[index] = preY[index] + 1 / 4 * K1[index];
-                spw->m_callback.m_rshFunction(spw->m_userData, spw->m_data->m_curTime + h / 4,
-                    K2y, K2);
-                K3y[index] = preY[index] + 3 / 32 * K1[index] + 9 / 32 * K2[index];
-                spw->m_callback.m_rshFunction(spw->m_userData, spw->m_data->m_curTime + h * 3 / 8,
-                    K3y, K3);
-                K4y[index] = preY[index] + 1932 / 2197 * K1[index] - 7200 / 2197 * K2[index] + 7296 / 2197 * K3[index];
-                spw->m_callback.m_rshFunction(spw->m_userData, spw->m_data->m_curTime + h * 12 / 13,
-                    K4y, K4);
-                K5y[index] = preY[index] + 439 / 216 * K1[index] - 8 * K2[index] + 3680 / 513 * K3[index]
-                    - 845 / 4104 * K4[index];
-                spw->m_callback.m_rshFunction(spw->m_userData, spw->m_data->m_curTime + h,
-                    K5y, K5);
-                K6y[index] = preY[index] - 8 / 27 * K1[index] + 2 * K2[index] - 3544 / 2565 * K3[index]
-                    + 1859 / 4104 * K4[index] - 11 / 40 * K5[index];
-                spw->m_callback.m_rshFunction(spw->m_userData, spw->m_data->m_curTime + h / 2,
-                    K6y, K6);
-
-                D[index] = K1[index] / 360 - 128 / 4275 * K3[index] - 2197 / 75240 * K4[index]
-                    + K5[index] / 50 + 2 / 55 * K6[index];
-            }
-
-            MoReal sum = 0;
-            MoReal normD = 0;
-            for (index = 0; index < nState; ++index)
-            {
-                sum = sum + fabs(D[index]) * fabs(D[index]);
-            }
-            normD = sqrtl(sum);              //Ķ
-            MoReal R = normD / h;
-
-            /*normDΪʲôô󡣡ֻɴ0.1ʱſ*/
-            if (normD < spw->m_opt.m_absoluteTolerance[0])            //㾫
-            {
-                *tret += h;
-                for (index = 0; index < nState; ++index)
-                {
-                    //improved RK45
-                    yret[index] = preY[index] + 25 / 216 * K1[index] + 1408 / 2565 * K3[index]
-                        + 2197 / 4104 * K4[index] - 1 / 5 * K5[index] + D[index];
-
-                    curY[index] = yret[index];
-
-                    spw->m_callback.m_rshFunction(spw->m_userData, spw->m_data->m_curTime + spw->m_data->m_initialStep, curY, preYp);
-
-                    ypret[index] = preYp[index];
-                    curYp[index] = ypret[index];
-
-                }
-
-                Flag = moFalse;
-            }
-
-            MoReal Q = pow(spw->m_opt.m_absoluteTolerance[0] / R, 1 / 4);
-            if (Q <= 0.2)
-            {
-                h = 0.2 * h;
-            }
-            else if (Q >= 4)
-            {
-                h = 4 * h;
-            }
-            else
-            {
-                h = h * Q;
-            }
-
-            if (h > spw->m_opt.m_maxStepSize)      //趨󲽳h=hmax
-            {
-                h = spw->m_opt.m_maxStepSize;
-            }
-
-            if (spw->m_data->m_curTime >= spw->m_opt.m_stopTime)       //ǰʱ趨ֹͣʱ
-            {
-                *tret = tout;
-                Flag = moFalse;
-
-                // return MWS_IVP_TSTOP_RETURN;        //ֹʱ
-            }
-            else if (spw->m_data->m_curTime + h > spw->m_opt.m_stopTime)     //ti+qh>L,߽磬h=L-ti
-            {
-                h = spw->m_opt.m_stopTime - spw->m_data->m_curTime;
-            }
-            if (h < 0)
-            {
-                Flag = moFalse;
-
-                return MWS_IVP_FAIL;
-            }
-            reserve = h;
-       /* µǰʱ */
-             if (Flag)      //flag=trueʱ򣬲
-             {
-                 *tret = spw->m_data->m_curTime;
-             }
-                        //ʱһⲿѭ
-       return MWS_IVP_SUCCESS;  //״̬ȡMwsIVPStatusֵ
-    }
-
-    /// <summary>
-    /// ɲֵynߣ
-    /// </summary>
-    /// 룺
-    /// <param name="solver">㷨</param>
-    /// <param name="ivp"></param>
-    /// <param name="tout">ʱ</param>
-    /// 
-    /// <param name="yret">yĽֵ</param>
-    /// <param name="reserve"></param>
-    /// <returns></returns>
-    MwsInteger myRK45Interpolate(MwsIVPSolverObj solver, MwsIVPObj ivp, MwsReal tout, MwsReal* yret, void* reserve)
-    {
-        /* Բֵ */
-        MyRK45* sw = (MyRK45*)solver;
-        MyRK45Problem* spw = (MyRK45Problem*)ivp;
-
-        MoSize nStates = spw->m_nStates;
-        MoSize index;
-
-        for (index = 0; index < nStates; ++index)
-        {
-            /* Բֵ:
-                        f(x2)-f(x1)
-                L(x) = ------------ * (x - x1) + f(x1)
-                           x2-x1
-            */
-            yret[index] = (spw->m_data->m_curY[index] - spw->m_data->m_preY[index]) * (
-                tout - spw->m_data->m_curTime + spw->m_data->m_initialStep) / spw->m_data->m_initialStep + spw->m_data->m_preY[index];
-        }
-
-        return MWS_IVP_SUCCESS;
-    }
-
-    /// <summary>
-    /// 
-    /// </summary>
-    /// <param name="solver"></param>
-    /// <param name="ivp"></param>
-    void myRK45ProblemDestroy(MwsIVPSolverObj solver, MwsIVPObj ivp)
-    {
-        MyRK45* sw = (MyRK45*)solver;
-        MyRK45Problem* spw = (MyRK45Problem*)ivp;
-
-        if (spw)
-        {
-            if (spw->m_data->m_preY)
-            {
-                (*sw->m_utils.m_freeDataMemory)(sw->m_userData, spw->m_data->m_preY);
-            }
-
-            if (spw->m_data->m_curY)
-            {
-                (*sw->m_utils.m_freeDataMemory)(sw->m_userData, spw->m_data->m_curY);
-            }
-
-            if (spw->m_data)
-            {
-                (*sw->m_utils.m_freeDataMemory)(sw->m_userData, spw->m_data);
-            }
-
-            (*sw->m_utils.m_freeMemory)(sw->m_userData, spw);
-        }
-    }
-
-    /// <summary>
-    /// ٻ㷨
-    /// </summary>
-    /// <param name="solver"></param>
-    void myRK45Destroy(MwsIVPSolverObj solver)
-    {
-        MyRK45* sw = (MyRK45*)solver;
-
-        if (sw)
-        {
-            (*sw->m_utils.m_freeMemory)(sw->m_userData, sw);
-        }
-    }
-
-#ifdef __cplusplus
-}
-#endif
-
-
-/***************************************************************************
-//   end of file
-***************************************************************************/
-
+/***************************************************************************
+///
+/// Copyright (c) 2020, 苏州同元软控信息技术有限公司
+/// All rights reserved.
+///
+/// @file           my_RK45.c
+/// @brief          Runge-Kutta 4(5) 变步长积分算法，级计算由 my_rk_engine 按Butcher表生成，三次Hermite稠密输出
+///
+/// @version        v1.0
+/// @author         田显钊
+/// @date           2020/07/07
+///
+***************************************************************************/
+
+#include "mo_types.h"
+#include "mws_ivp_solver.h"
+#include "my_ivp_common.h"
+#include "my_ivp_trace.h"
+#include "my_rk_engine.h"
+
+#include <memory.h>
+#include <math.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MY_RK45_F32_MIN_TOL     1e-5    /* 单精度模式下相对容许误差的下限，约为float机器精度的100倍 */
+#define MY_RK45_POOL_SIZE       8       /* 算法对象缓存的已销毁问题对象数上限 */
+
+    struct MyRK45Problem;
+
+    /* 算法对象 */
+    typedef struct
+    {
+        MwsIVPUtilFcns	m_utils;
+        void* m_userData;
+
+        /* 已销毁问题对象池：连同工作区保留，按状态数复用，参数扫描反复创建销毁问题时不再分配内存 */
+        struct MyRK45Problem* m_pool[MY_RK45_POOL_SIZE];
+        MoInteger m_poolCount;
+
+    } MyRK45;
+
+    /* 状态快照（协同仿真回退用），创建问题时预分配 */
+    typedef struct
+    {
+        MoReal* m_y;            /* preY|curY|preYp|curYp 的副本，长度4n */
+        MoReal m_curTime;
+        MoReal m_initialStep;
+        MoReal m_h;
+        MoReal m_Q;
+        MoBoolean m_valid;      /* 是否已保存过快照 */
+        MoInteger m_np;         /* 保存时的灵敏度参数个数，灵敏度副本在 m_snapS 中 */
+        MoSize m_adjSteps;      /* 保存时伴随记录的步数 */
+    } MyRK45Snapshot;
+
+    /*
+     * 伴随灵敏度（myRK45SetAdjoint）：正向积分时记录每步步长，并按固定间隔在 m_ck 中保存步起点的状态；
+     * 检查点占满正向配额（容量的一半）时隔一个丢弃一个、间隔加倍，正向过程占用的检查点数始终有界。
+     * 反向时逐段从检查点重算，段内用其余检查点按二项式（revolve）策略安排重算
+     */
+    typedef struct
+    {
+        MoBoolean m_enabled;
+        MoInteger m_np;
+        MoReal* m_params;       /* 模型参数，未提供导数回调时临时扰动以求差商（可为空） */
+        MyIVPParamJacPtr m_dfdp;
+        MyIVPParamVjpPtr m_vjp;
+
+        MoReal* m_h;            /* 各步步长，m_nSteps步，容量m_hCap，按倍增扩展 */
+        MoSize m_nSteps;
+        MoSize m_hCap;
+
+        MoInteger m_slots;      /* 检查点容量，由内存预算决定 */
+        MoInteger m_count;      /* 正向保存的检查点数 */
+        MoSize m_stride;        /* 正向检查点间隔（步数） */
+        MoSize* m_ckStep;       /* 各检查点的步号，长度m_slots */
+        MoReal* m_ckT;          /* 各检查点的时间，长度m_slots */
+
+        /* m_ck(m_slots*n)|m_yA|m_yB|m_lambda|m_f0|m_yPert|m_fPert(各n)|m_adjWork((MY_RK_MAX_STAGES+2)*n)
+           依次位于同一块内存，由m_ck持有 */
+        MoReal* m_ck;
+        MoReal* m_yA;
+        MoReal* m_yB;
+        MoReal* m_lambda;
+        MoReal* m_f0;
+        MoReal* m_yPert;
+        MoReal* m_fPert;
+        MoReal* m_adjWork;
+
+        MoReal* m_grad;         /* 反向过程中累加的参数梯度 */
+        MoSize m_recomputed;    /* 最近一次反向过程重算的正向步数 */
+    } MyRK45Adjoint;
+
+    /* 求解问题的数据，用数据内存分配和释放函数 */
+    typedef struct
+    {
+        /* m_preY、m_curY、m_preYp、m_curYp 依次位于同一块连续内存中（由m_preY持有），
+           保存/恢复快照只需一次memcpy */
+        MoReal* m_preY;
+        MoReal* m_curY;
+
+        MoReal* m_preYp;
+        MoReal* m_curYp;
+
+        /* 引擎工作区（各级k_i与级间y）及误差向量，同一块内存，长度(MY_RK_MAX_STAGES+2)*n */
+        MoReal* m_work;
+        MoReal* m_err;
+
+        MoInteger m_method;     /* MyRKMethod的值，默认 MY_RK_FEHLBERG45 */
+        MyIVPController m_ctl;  /* 步长控制器参数，默认 MY_IVP_CONTROLLER_DEFAULT */
+        MoBoolean m_ypValid;    /* m_curYp 是否为 f(m_curTime, m_curY) */
+
+        MoReal m_curTime;
+        MoReal m_initialStep;   /* 上一步的步长，插值用 */
+        MoReal m_h;             /* 下一步的建议步长，<=0时由求解时传入或自动选择 */
+        MoReal m_Q;             /* 上一步的步长倍数 */
+
+        /* 单精度模式（myRK45SetSinglePrecision）：float区依次为 y|f|y1|err|comp|comp1|引擎工作区，
+           长度(MY_RK_MAX_STAGES+7)*n，由m_yF持有；插值历史、快照与返回值仍为双精度 */
+        float* m_yF;
+        float* m_fF;
+        float* m_y1F;
+        float* m_errF;
+        float* m_compF;         /* 补偿求和的舍入误差 */
+        float* m_comp1F;
+        float* m_workF;
+        MoReal* m_shim;         /* 右端函数的双精度转换区，长度2n */
+        MyRKRhsF32 m_rhsF32;
+        MoBoolean m_f32;
+        MoBoolean m_compensated;
+        MoBoolean m_f32Valid;   /* m_yF、m_fF、m_compF 是否对应 m_curTime 的状态 */
+
+        /* 前向灵敏度（myRK45SetSensitivity）：np个参数，ns=n*np；m_preS|m_curS|m_preSp|m_curSp|快照副本(4ns)|
+           引擎灵敏度工作区((MY_RK_MAX_STAGES+1)*ns+n)|扰动用的y、f(2n) 依次位于同一块内存，由m_preS持有 */
+        MoInteger m_np;
+        MoInteger m_sensCap;    /* 已分配的参数个数 */
+        MoReal* m_params;       /* 模型参数，按参数差商时临时扰动（可为空） */
+        MyIVPParamJacPtr m_dfdp;
+        MoBoolean m_sensJac;    /* J*s 用 m_jacFunction 计算，否则用方向差商 */
+        MoBoolean m_sensValid;  /* m_curSp 是否对应 (m_curTime, m_curS) */
+        MoReal* m_preS;
+        MoReal* m_curS;
+        MoReal* m_preSp;
+        MoReal* m_curSp;
+        MoReal* m_snapS;
+        MoReal* m_sensWork;
+        MoReal* m_yPert;
+        MoReal* m_fPert;
+        MoReal* m_jac;          /* 稠密Jacobian，n*n按列存储，灵敏度与伴随共用 */
+
+        MyRK45Adjoint m_adj;
+
+        /* 试算步中右端函数失败时的重试策略（myRK45SetRhsRetry）与累计重试次数 */
+        MoInteger m_retryMax;
+        MoReal m_retryShrink;
+        MoSize m_retries;
+
+        /* 轨迹历史（myRK45SetHistory）：最近m_histCap个已接受步的 preY|curY|preYp|curYp（每步4n）按环形存放，
+           其后依次是各步起点时间m_histT、步长m_histH，同一块内存由m_histY持有；m_histHead为最老一步的位置。
+           m_histAlloc为已分配内存可容纳的步数，m_histCap为启用的容量（0表示不记录），对象池复用时只保留前者 */
+        MoReal* m_histY;
+        MoReal* m_histT;
+        MoReal* m_histH;
+        MoSize m_histAlloc;
+        MoSize m_histCap;
+        MoSize m_histHead;
+        MoSize m_histCount;
+
+        MyRK45Snapshot m_snap;
+    } MyRK45ProblemData;
+
+    /* 求解问题对象 */
+    typedef struct MyRK45Problem
+    {
+        MoSize          m_nStates;
+
+        MwsIVPOptions	m_opt;
+        MwsIVPCallback  m_callback;
+        void* m_userData;
+        MY_IVP_TRACE_MEMBER(m_trace)
+
+        MyRK45ProblemData* m_data;
+        MyRK45* m_solverWork;
+
+    } MyRK45Problem;
+
+    void myRK45ProblemDestroy(MwsIVPSolverObj solver, MwsIVPObj ivp);
+    void myRK45Destroy(MwsIVPSolverObj solver);
+    static MwsInteger myRK45AdjRecord(MyRK45Problem* spw, MoReal t, MoReal h);
+    MwsInteger myRK45SetController(MwsIVPSolverObj solver, MwsIVPObj ivp, const MyIVPController* ctl);
+
+    /* 释放问题对象及其全部工作区 */
+    static void myRK45ProblemFree(MyRK45* sw, MyRK45Problem* spw)
+    {
+        MyRK45ProblemData* ds = spw->m_data;
+
+        if (ds)
+        {
+            if (ds->m_preY)     /* m_curY、m_preYp、m_curYp 与之同一块内存 */
+            {
+                (*sw->m_utils.m_freeDataMemory)(sw->m_userData, ds->m_preY);
+            }
+
+            if (ds->m_snap.m_y)
+            {
+                (*sw->m_utils.m_freeDataMemory)(sw->m_userData, ds->m_snap.m_y);
+            }
+
+            if (ds->m_work)     /* m_err 与之同一块内存 */
+            {
+                (*sw->m_utils.m_freeDataMemory)(sw->m_userData, ds->m_work);
+            }
+
+            if (ds->m_yF)       /* 单精度模式的各向量与之同一块内存 */
+            {
+                (*sw->m_utils.m_freeDataMemory)(sw->m_userData, ds->m_yF);
+            }
+
+            if (ds->m_shim)
+            {
+                (*sw->m_utils.m_freeDataMemory)(sw->m_userData, ds->m_shim);
+            }
+
+            if (ds->m_preS)     /* 灵敏度的各向量与之同一块内存 */
+            {
+                (*sw->m_utils.m_freeDataMemory)(sw->m_userData, ds->m_preS);
+            }
+
+            if (ds->m_jac)
+            {
+                (*sw->m_utils.m_freeDataMemory)(sw->m_userData, ds->m_jac);
+            }
+
+            if (ds->m_adj.m_h)
+            {
+                (*sw->m_utils.m_freeDataMemory)(sw->m_userData, ds->m_adj.m_h);
+            }
+
+            if (ds->m_histY)    /* 历史的时间与步长与之同一块内存 */
+            {
+                (*sw->m_utils.m_freeDataMemory)(sw->m_userData, ds->m_histY);
+            }
+
+            if (ds->m_adj.m_ck)     /* 伴随的各向量与之同一块内存 */
+            {
+                (*sw->m_utils.m_freeDataMemory)(sw->m_userData, ds->m_adj.m_ck);
+            }
+
+            if (ds->m_adj.m_ckStep)
+            {
+                (*sw->m_utils.m_freeDataMemory)(sw->m_userData, ds->m_adj.m_ckStep);
+            }
+
+            if (ds->m_adj.m_ckT)
+            {
+                (*sw->m_utils.m_freeDataMemory)(sw->m_userData, ds->m_adj.m_ckT);
+            }
+
+            (*sw->m_utils.m_freeDataMemory)(sw->m_userData, ds);
+        }
+
+        (*sw->m_utils.m_freeMemory)(sw->m_userData, spw);
+    }
+
+    /* 从对象池取出状态数为n的问题对象，并把除工作区外的数据恢复为新建时的值；没有时返回空 */
+    static MyRK45Problem* myRK45PoolTake(MyRK45* sw, MoSize n)
+    {
+        MyRK45Problem* spw;
+        MyRK45ProblemData* ds;
+        MyRK45ProblemData kept;
+        MoInteger index;
+
+        for (index = 0; index < sw->m_poolCount; ++index)
+        {
+            if (sw->m_pool[index]->m_nStates == n)
+            {
+                break;
+            }
+        }
+        if (index == sw->m_poolCount)
+        {
+            return mwsNullPtr;
+        }
+        spw = sw->m_pool[index];
+        sw->m_pool[index] = sw->m_pool[--sw->m_poolCount];
+
+        ds = spw->m_data;
+        kept = *ds;
+        memset(ds, 0, sizeof(*ds));
+        ds->m_preY = kept.m_preY;
+        ds->m_curY = kept.m_curY;
+        ds->m_preYp = kept.m_preYp;
+        ds->m_curYp = kept.m_curYp;
+        ds->m_work = kept.m_work;
+        ds->m_err = kept.m_err;
+        ds->m_yF = kept.m_yF;
+        ds->m_fF = kept.m_fF;
+        ds->m_y1F = kept.m_y1F;
+        ds->m_errF = kept.m_errF;
+        ds->m_compF = kept.m_compF;
+        ds->m_comp1F = kept.m_comp1F;
+        ds->m_workF = kept.m_workF;
+        ds->m_shim = kept.m_shim;
+        ds->m_snap.m_y = kept.m_snap.m_y;
+        ds->m_sensCap = kept.m_sensCap;
+        ds->m_preS = kept.m_preS;
+        ds->m_curS = kept.m_curS;
+        ds->m_preSp = kept.m_preSp;
+        ds->m_curSp = kept.m_curSp;
+        ds->m_snapS = kept.m_snapS;
+        ds->m_sensWork = kept.m_sensWork;
+        ds->m_yPert = kept.m_yPert;
+        ds->m_fPert = kept.m_fPert;
+        ds->m_jac = kept.m_jac;
+        ds->m_adj.m_h = kept.m_adj.m_h;
+        ds->m_adj.m_hCap = kept.m_adj.m_hCap;
+        ds->m_adj.m_slots = kept.m_adj.m_slots;
+        ds->m_adj.m_ckStep = kept.m_adj.m_ckStep;
+        ds->m_adj.m_ckT = kept.m_adj.m_ckT;
+        ds->m_adj.m_ck = kept.m_adj.m_ck;
+        ds->m_adj.m_yA = kept.m_adj.m_yA;
+        ds->m_adj.m_yB = kept.m_adj.m_yB;
+        ds->m_adj.m_lambda = kept.m_adj.m_lambda;
+        ds->m_adj.m_f0 = kept.m_adj.m_f0;
+        ds->m_adj.m_yPert = kept.m_adj.m_yPert;
+        ds->m_adj.m_fPert = kept.m_adj.m_fPert;
+        ds->m_adj.m_adjWork = kept.m_adj.m_adjWork;
+        ds->m_histY = kept.m_histY;
+        ds->m_histT = kept.m_histT;
+        ds->m_histH = kept.m_histH;
+        ds->m_histAlloc = kept.m_histAlloc;
+        if (n > 0)
+        {
+            memset(ds->m_preY, 0, 4 * n * sizeof(MoReal));
+        }
+
+        return spw;
+    }
+
+    /// <summary>
+    /// 创建算法
+    /// </summary>
+    /// <param name="util_fcns">工具函数（由求解器提供，用户调用）</param>
+    /// <param name="user_data">用户数据（求解器内部数据，传递给工具函数util_fcns，自定义算法无需关心其内容）</param>
+    /// <returns></returns>
+    MwsIVPSolverObj myRK45Create(MwsIVPUtilFcns* util_fcns, void* user_data)
+    {
+        MyRK45* sw = (MyRK45*)util_fcns->m_allocMemory(user_data, 1, sizeof(MyRK45));
+
+        if (sw)
+        {
+            memset(sw, 0, sizeof(*sw));
+            sw->m_utils = *util_fcns;
+            sw->m_userData = user_data;
+        }
+
+        return sw;
+    }
+
+    /// <summary>
+    /// 创建问题：对象池中有同规模的问题对象时直接复用，不分配内存
+    /// </summary>
+    /// <param name="solver">积分算法对象</param>
+    /// <param name="n">问题规模，即状态变量数量==微分方程阶数</param>
+    /// <param name="call_back">回调函数</param>
+    /// <param name="opt">积分器选项</param>
+    /// <param name="ivp_user_data">用户数据(求解器内部数据，传递给回调函数call_back，算法不需关心)</param>
+    /// <returns></returns>
+    MwsIVPObj myRK45ProblemCreate(MwsIVPSolverObj solver, MwsSize n, MwsIVPCallback* call_back, MwsIVPOptions* opt, void* ivp_user_data)
+    {
+        MyRK45* sw = (MyRK45*)solver;
+        MyRK45Problem* spw = myRK45PoolTake(sw, n);
+
+        if (spw)
+        {
+            spw->m_callback = *call_back;
+            spw->m_userData = ivp_user_data;
+            MY_IVP_TRACE_INTERPOSE(&spw->m_trace, &spw->m_callback, &spw->m_userData);
+            spw->m_opt = *opt;
+            spw->m_data->m_method = MY_RK_FEHLBERG45;
+            spw->m_data->m_retryMax = MY_IVP_RHS_RETRIES;
+            spw->m_data->m_retryShrink = MY_IVP_RHS_SHRINK;
+            myRK45SetController(sw, spw, mwsNullPtr);
+            return spw;
+        }
+
+        spw = (MyRK45Problem*)sw->m_utils.m_allocMemory(sw->m_userData, 1, sizeof(MyRK45Problem));
+        if (spw)
+        {
+            MyRK45ProblemData* ds = (MyRK45ProblemData*)sw->m_utils.m_allocDataMemory(sw->m_userData, 1, sizeof(MyRK45ProblemData));
+
+            if (ds == mwsNullPtr)
+            {
+                sw->m_utils.m_freeMemory(sw->m_userData, spw);
+                return mwsNullPtr;
+            }
+
+            memset(spw, 0, sizeof(*spw));
+            memset(ds, 0, sizeof(*ds));
+
+            spw->m_callback = *call_back;
+            spw->m_userData = ivp_user_data;
+            MY_IVP_TRACE_INTERPOSE(&spw->m_trace, &spw->m_callback, &spw->m_userData);
+            spw->m_opt = *opt;
+            spw->m_nStates = n;
+            spw->m_data = ds;
+            spw->m_solverWork = sw;
+
+            spw->m_data->m_curTime = 0;
+            spw->m_data->m_initialStep = 0;
+            spw->m_data->m_h = 0;
+            spw->m_data->m_method = MY_RK_FEHLBERG45;
+            spw->m_data->m_retryMax = MY_IVP_RHS_RETRIES;
+            spw->m_data->m_retryShrink = MY_IVP_RHS_SHRINK;
+            myRK45SetController(sw, spw, mwsNullPtr);
+
+            if (spw->m_nStates > 0)
+            {
+                spw->m_data->m_preY = (MoReal*)sw->m_utils.m_allocDataMemory(sw->m_userData, 4, n * sizeof(MoReal));  //(MoReal *)强制转换
+                spw->m_data->m_snap.m_y = (MoReal*)sw->m_utils.m_allocDataMemory(sw->m_userData, 4, n * sizeof(MoReal));
+                if (spw->m_data->m_preY)
+                {
+                    spw->m_data->m_curY = spw->m_data->m_preY + n;
+                    spw->m_data->m_preYp = spw->m_data->m_preY + 2 * n;
+                    spw->m_data->m_curYp = spw->m_data->m_preY + 3 * n;
+                }
+
+                spw->m_data->m_work = (MoReal*)sw->m_utils.m_allocDataMemory(sw->m_userData, MY_RK_MAX_STAGES + 2, n * sizeof(MoReal));
+                if (spw->m_data->m_work)
+                {
+                    spw->m_data->m_err = spw->m_data->m_work + (MY_RK_MAX_STAGES + 1) * n;
+                }
+                if (!spw->m_data->m_preY || !spw->m_data->m_snap.m_y || !spw->m_data->m_work)
+                {
+                    myRK45ProblemFree(sw, spw);
+                    spw = MWnullptr;
+                }
+                else
+                {
+                    MoSize index;
+                    for (index = 0; index < n; ++index)
+                    {
+                        spw->m_data->m_preY[index] = 0;
+                        spw->m_data->m_curY[index] = 0;
+
+                        spw->m_data->m_preYp[index] = 0;
+                        spw->m_data->m_curYp[index] = 0;
+                    }
+                }
+            }
+        }
+
+        return spw;   //返回：问题对象(自定义算法内部数据，求解器不关心其内容)，作为其它接口函数的第二个参数，即下边的ivp
+    }
+
+    /// <summary>
+    /// 初始化
+    /// </summary>
+    /// <param name="solver">积分算法对象</param>
+    /// <param name="ivp">问题对象</param>
+    /// <param name="t0">起始时间</param>
+    /// <param name="y0">y的初始值（必定不为空）</param>
+    /// <param name="yp0">y’的初始值（DAE）</param>
+    /// <param name="is_reinit">是否重新初始化（重启）</param>
+    /// <param name="reserve">保留参数，暂不使用</param>
+    /// <returns></returns>
+    MwsInteger myRK45Init(MwsIVPSolverObj solver, MwsIVPObj ivp, MwsReal t0, const MwsReal* y0,
+        const MwsReal* yp0, MwsBoolean is_reinit, void* reserve)
+    {
+        MyRK45Problem* spw = (MyRK45Problem*)ivp;
+        MyRK45ProblemData* ds = spw->m_data;
+        MoSize nState = spw->m_nStates;
+        MoSize index;
+        MoReal oldNorm = 0;
+        MoReal newNorm = 0;
+
+        if (nState == 0 || y0 == mwsNullPtr)
+        {
+            ds->m_curTime = t0;
+            return MWS_IVP_SUCCESS;
+        }
+
+        /* 重新初始化（离散事件后）：只有插值历史失效，步长与控制器记忆保留 */
+        if (is_reinit)
+        {
+            for (index = 0; index < nState; ++index)
+            {
+                oldNorm += ds->m_curYp[index] * ds->m_curYp[index];
+            }
+        }
+
+        /* 新状态直接写入已有缓冲区，不重新分配 */
+        memcpy(ds->m_curY, y0, nState * sizeof(MoReal));
+        memcpy(ds->m_preY, y0, nState * sizeof(MoReal));
+        ds->m_curTime = t0;
+
+        if (spw->m_callback.m_rshFunction(spw->m_userData, t0, ds->m_curY, ds->m_curYp) != MWS_IVP_SUCCESS)
+        {
+            return MWS_IVP_RHSFN_FAIL;
+        }
+        memcpy(ds->m_preYp, ds->m_curYp, nState * sizeof(MoReal));
+        ds->m_ypValid = moTrue;
+        ds->m_f32Valid = moFalse;
+        ds->m_sensValid = moFalse;
+        ds->m_initialStep = 0;      /* 插值历史失效 */
+
+        /* 伴随记录只覆盖最近一次初始化之后的连续轨迹 */
+        ds->m_adj.m_nSteps = 0;
+        ds->m_adj.m_count = 0;
+        ds->m_adj.m_stride = 1;
+
+        /* 初始化后轨迹不再连续，历史清空 */
+        ds->m_histHead = 0;
+        ds->m_histCount = 0;
+
+        if (is_reinit && ds->m_h > 0)
+        {
+            /* y'跳变越大步长缩得越多：h *= |y'旧|/|y'新|，限制在[0.1, 1]倍之间 */
+            for (index = 0; index < nState; ++index)
+            {
+                newNorm += ds->m_curYp[index] * ds->m_curYp[index];
+            }
+            if (newNorm > oldNorm)
+            {
+                MoReal ratio = sqrt(oldNorm / newNorm);
+                ds->m_h *= (ratio < 0.1) ? 0.1 : ratio;
+            }
+        }
+        else if (!is_reinit)
+        {
+            /* 首次初始化：清空步长历史，首步使用求解时传入的初始步长；旧快照作废 */
+            ds->m_h = 0;
+            ds->m_Q = 0;
+            ds->m_snap.m_valid = moFalse;
+        }
+
+        return MWS_IVP_SUCCESS;  //返回状态，取MwsIVPStatus的值
+    }
+
+    /*
+     * 灵敏度方程右端 ks_j = J*s_j + df/dp_j（j=0..np-1），sens_data 为问题对象
+     *  J*s_j：m_sensJac 时用解析Jacobian，否则用方向差商 (f(y+eps*s_j) - f(y))/eps；
+     *  df/dp_j：有 m_dfdp 时调用它，否则有 m_params 时扰动参数求差商（与上面的差商合并为一次右端函数计算），
+     *  两者都没有时为0（只求对初值的灵敏度）
+     */
+    static MwsInteger myRK45SensRhs(void* sens_data, MoReal t, const MoReal* y, const MoReal* f, const MoReal* s,
+        MoReal* ks)
+    {
+        MyRK45Problem* spw = (MyRK45Problem*)sens_data;
+        MyRK45ProblemData* ds = spw->m_data;
+        MoSize n = spw->m_nStates;
+        MoReal sqrtEps = sqrt(2.2e-16);
+        MoReal normY = 1;
+        MoSize index, col;
+        MoInteger j;
+
+        if (ds->m_sensJac && spw->m_callback.m_jacFunction(spw->m_userData, t, y, mwsNullPtr, 0, ds->m_jac) != MWS_IVP_SUCCESS)
+        {
+            return MWS_IVP_RHSFN_FAIL;
+        }
+        for (index = 0; index < n; ++index)
+        {
+            normY = fabs(y[index]) > normY ? fabs(y[index]) : normY;
+        }
+
+        for (j = 0; j < ds->m_np; ++j)
+        {
+            const MoReal* sj = s + j * n;
+            MoReal* kj = ks + j * n;
+            MoBoolean perturbY = !ds->m_sensJac;
+            MoBoolean perturbP = ds->m_params && !ds->m_dfdp;
+            MoReal normS = 0;
+            MoReal eps = HUGE_VAL;
+
+            memset(kj, 0, n * sizeof(MoReal));
+            if (ds->m_sensJac)
+            {
+                for (col = 0; col < n; ++col)
+                {
+                    for (index = 0; index < n; ++index)
+                    {
+                        kj[index] += ds->m_jac[col * n + index] * sj[col];
+                    }
+                }
+            }
+
+            for (index = 0; index < n; ++index)
+            {
+                normS = fabs(sj[index]) > normS ? fabs(sj[index]) : normS;
+            }
+            if (perturbY && normS == 0)
+            {
+                perturbY = moFalse;     /* J*0 = 0 */
+            }
+            if (perturbY)
+            {
+                eps = sqrtEps * normY / normS;
+            }
+            if (perturbP)
+            {
+                MoReal pj = fabs(ds->m_params[j]) > 1 ? fabs(ds->m_params[j]) : 1;
+                eps = sqrtEps * pj < eps ? sqrtEps * pj : eps;
+            }
+
+            if (perturbY || perturbP)
+            {
+                MoReal pj = perturbP ? ds->m_params[j] : 0;
+                MwsInteger status;
+
+                for (index = 0; index < n; ++index)
+                {
+                    ds->m_yPert[index] = perturbY ? y[index] + eps * sj[index] : y[index];
+                }
+                if (perturbP)
+                {
+                    ds->m_params[j] = pj + eps;
+                }
+                status = spw->m_callback.m_rshFunction(spw->m_userData, t, ds->m_yPert, ds->m_fPert);
+                if (perturbP)
+                {
+                    ds->m_params[j] = pj;
+                }
+                if (status != MWS_IVP_SUCCESS)
+                {
+                    return MWS_IVP_RHSFN_FAIL;
+                }
+                for (index = 0; index < n; ++index)
+                {
+                    kj[index] += (ds->m_fPert[index] - f[index]) / eps;
+                }
+            }
+
+            if (ds->m_dfdp)
+            {
+                if (ds->m_dfdp(MY_IVP_TRACE_USER_DATA(&spw->m_callback, spw->m_userData), t, y, j, ds->m_fPert) != MWS_IVP_SUCCESS)
+                {
+                    return MWS_IVP_RHSFN_FAIL;
+                }
+                for (index = 0; index < n; ++index)
+                {
+                    kj[index] += ds->m_fPert[index];
+                }
+            }
+        }
+
+        return MWS_IVP_SUCCESS;
+    }
+
+    /*
+     * 灵敏度随刚被接受的状态步 [t, t+h] 推进：复用 m_work 中的状态各级，首级沿用上一步末点的导数（FSAL），
+     * 须在 m_curTime 更新之前调用
+     */
+    static MwsInteger myRK45SensStep(MyRK45Problem* spw, MoReal t, MoReal h)
+    {
+        MyRK45ProblemData* ds = spw->m_data;
+        const MyRKEngineInfo* info = myRKEngineGetInfo(ds->m_method);
+        MoSize n = spw->m_nStates;
+        MoSize ns = n * ds->m_np;
+        MwsInteger status;
+
+        memcpy(ds->m_preS, ds->m_curS, ns * sizeof(MoReal));
+        if (ds->m_sensValid && t == ds->m_curTime)
+        {
+            memcpy(ds->m_preSp, ds->m_curSp, ns * sizeof(MoReal));
+        }
+        else if (myRK45SensRhs(spw, t, ds->m_preY, ds->m_preYp, ds->m_preS, ds->m_preSp) != MWS_IVP_SUCCESS)
+        {
+            return MWS_IVP_RHSFN_FAIL;
+        }
+        ds->m_sensValid = moFalse;
+
+        status = myRKEngineSensStep(ds->m_method, &myRK45SensRhs, spw, n, ns, t, h, ds->m_preY, ds->m_work,
+            ds->m_preS, ds->m_preSp, ds->m_curS, ds->m_sensWork);
+        if (status != MWS_IVP_SUCCESS)
+        {
+            memcpy(ds->m_curS, ds->m_preS, ns * sizeof(MoReal));
+            return status;
+        }
+
+        if (info->m_fsal)
+        {
+            memcpy(ds->m_curSp, ds->m_sensWork + (info->m_stages - 1) * ns, ns * sizeof(MoReal));
+        }
+        else if (myRK45SensRhs(spw, t + h, ds->m_curY, ds->m_curYp, ds->m_curS, ds->m_curSp) != MWS_IVP_SUCCESS)
+        {
+            memcpy(ds->m_curS, ds->m_preS, ns * sizeof(MoReal));
+            return MWS_IVP_RHSFN_FAIL;
+        }
+        ds->m_sensValid = moTrue;
+
+        return MWS_IVP_SUCCESS;
+    }
+
+    /*
+     * 记录刚被接受的步 [t, t+h]：步号为间隔整数倍时把步起点状态存为检查点（正向配额满时先隔一丢一），
+     * 再追加步长
+     */
+    static MwsInteger myRK45AdjRecord(MyRK45Problem* spw, MoReal t, MoReal h)
+    {
+        MyRK45* sw = spw->m_solverWork;
+        MyRK45Adjoint* adj = &spw->m_data->m_adj;
+        MoSize n = spw->m_nStates;
+        MoInteger quota = adj->m_slots / 2;
+        MoInteger index, kept;
+
+        if (adj->m_nSteps % adj->m_stride == 0 && adj->m_count == quota)
+        {
+            for (index = 0, kept = 0; index < adj->m_count; index += 2, ++kept)
+            {
+                memcpy(adj->m_ck + kept * n, adj->m_ck + index * n, n * sizeof(MoReal));
+                adj->m_ckStep[kept] = adj->m_ckStep[index];
+                adj->m_ckT[kept] = adj->m_ckT[index];
+            }
+            adj->m_count = kept;
+            adj->m_stride *= 2;
+        }
+        if (adj->m_nSteps % adj->m_stride == 0)
+        {
+            memcpy(adj->m_ck + adj->m_count * n, spw->m_data->m_preY, n * sizeof(MoReal));
+            adj->m_ckStep[adj->m_count] = adj->m_nSteps;
+            adj->m_ckT[adj->m_count] = t;
+            ++adj->m_count;
+        }
+
+        if (adj->m_nSteps == adj->m_hCap)
+        {
+            MoSize cap = adj->m_hCap > 0 ? 2 * adj->m_hCap : 256;
+            MoReal* hLog = (MoReal*)sw->m_utils.m_allocDataMemory(sw->m_userData, cap, sizeof(MoReal));
+            if (!hLog)
+            {
+                return MWS_IVP_MEM_FAIL;
+            }
+            if (adj->m_h)
+            {
+                memcpy(hLog, adj->m_h, adj->m_nSteps * sizeof(MoReal));
+                sw->m_utils.m_freeDataMemory(sw->m_userData, adj->m_h);
+            }
+            adj->m_h = hLog;
+            adj->m_hCap = cap;
+        }
+        adj->m_h[adj->m_nSteps++] = h;
+
+        return MWS_IVP_SUCCESS;
+    }
+
+    /*
+     * 伴随级函数 nu = J^T*kappa，并把 (df/dp)^T*kappa 累加到 m_adj.m_grad；adj_data 为问题对象
+     *  J：有 m_jacFunction 时调用它，否则逐列差商（n次右端函数）；
+     *  df/dp：依次取 m_vjp、m_dfdp（每个参数一次）、扰动 m_params 求差商，都没有时不累加
+     */
+    static MwsInteger myRK45AdjRhs(void* adj_data, MoReal t, const MoReal* y, const MoReal* f, const MoReal* kappa,
+        MoReal* nu)
+    {
+        MyRK45Problem* spw = (MyRK45Problem*)adj_data;
+        MyRK45ProblemData* ds = spw->m_data;
+        MyRK45Adjoint* adj = &ds->m_adj;
+        MoSize n = spw->m_nStates;
+        MoReal sqrtEps = sqrt(2.2e-16);
+        MoSize index, col;
+        MoInteger j;
+
+        if (spw->m_callback.m_jacFunction)
+        {
+            if (spw->m_callback.m_jacFunction(spw->m_userData, t, y, mwsNullPtr, 0, ds->m_jac) != MWS_IVP_SUCCESS)
+            {
+                return MWS_IVP_RHSFN_FAIL;
+            }
+        }
+        else
+        {
+            memcpy(adj->m_yPert, y, n * sizeof(MoReal));
+            for (col = 0; col < n; ++col)
+            {
+                MoReal eps = sqrtEps * (fabs(y[col]) > 1 ? fabs(y[col]) : 1);
+                adj->m_yPert[col] = y[col] + eps;
+                if (spw->m_callback.m_rshFunction(spw->m_userData, t, adj->m_yPert, adj->m_fPert) != MWS_IVP_SUCCESS)
+                {
+                    return MWS_IVP_RHSFN_FAIL;
+                }
+                adj->m_yPert[col] = y[col];
+                for (index = 0; index < n; ++index)
+                {
+                    ds->m_jac[col * n + index] = (adj->m_fPert[index] - f[index]) / eps;
+                }
+            }
+        }
+        for (col = 0; col < n; ++col)
+        {
+            MoReal sum = 0;
+            for (index = 0; index < n; ++index)
+            {
+                sum += ds->m_jac[col * n + index] * kappa[index];
+            }
+            nu[col] = sum;
+        }
+
+        if (adj->m_np == 0 || !adj->m_grad)
+        {
+            return MWS_IVP_SUCCESS;
+        }
+        if (adj->m_vjp)
+        {
+            return adj->m_vjp(MY_IVP_TRACE_USER_DATA(&spw->m_callback, spw->m_userData), t, y, kappa, adj->m_grad) == MWS_IVP_SUCCESS
+                ? MWS_IVP_SUCCESS : MWS_IVP_RHSFN_FAIL;
+        }
+        for (j = 0; j < adj->m_np && (adj->m_dfdp || adj->m_params); ++j)
+        {
+            MoReal sum = 0;
+            MoReal eps = 0;
+            MwsInteger status;
+
+            if (adj->m_dfdp)
+            {
+                status = adj->m_dfdp(MY_IVP_TRACE_USER_DATA(&spw->m_callback, spw->m_userData), t, y, j, adj->m_fPert);
+            }
+            else
+            {
+                MoReal pj = adj->m_params[j];
+                eps = sqrtEps * (fabs(pj) > 1 ? fabs(pj) : 1);
+                adj->m_params[j] = pj + eps;
+                status = spw->m_callback.m_rshFunction(spw->m_userData, t, y, adj->m_fPert);
+                adj->m_params[j] = pj;
+            }
+            if (status != MWS_IVP_SUCCESS)
+            {
+                return MWS_IVP_RHSFN_FAIL;
+            }
+            for (index = 0; index < n; ++index)
+            {
+                sum += (eps > 0 ? (adj->m_fPert[index] - f[index]) / eps : adj->m_fPert[index]) * kappa[index];
+            }
+            adj->m_grad[j] += sum;
+        }
+
+        return MWS_IVP_SUCCESS;
+    }
+
+    /* 从 (t,y) 按记录的步长重算第step步起的m步，结果写入yOut（可与y相同），时间写入tOut */
+    static MwsInteger myRK45AdjAdvance(MyRK45Problem* spw, MoSize step, MoSize m, MoReal t, const MoReal* y,
+        MoReal* yOut, MoReal* tOut)
+    {
+        MyRK45ProblemData* ds = spw->m_data;
+        MyRK45Adjoint* adj = &ds->m_adj;
+        MoSize n = spw->m_nStates;
+        MoSize index;
+        MwsInteger status;
+
+        if (yOut != y)
+        {
+            memcpy(yOut, y, n * sizeof(MoReal));
+        }
+        for (index = 0; index < m; ++index)
+        {
+            MoReal h = adj->m_h[step + index];
+            if (spw->m_callback.m_rshFunction(spw->m_userData, t, yOut, adj->m_f0) != MWS_IVP_SUCCESS)
+            {
+                return MWS_IVP_RHSFN_FAIL;
+            }
+            status = myRKEngineStep(ds->m_method, &spw->m_callback, spw->m_userData, n, t, h, yOut, adj->m_f0,
+                adj->m_yA, mwsNullPtr, ds->m_work);
+            if (status != MWS_IVP_SUCCESS)
+            {
+                return status;
+            }
+            memcpy(yOut, adj->m_yA, n * sizeof(MoReal));
+            t += h;
+            ++adj->m_recomputed;
+        }
+        *tOut = t;
+        return MWS_IVP_SUCCESS;
+    }
+
+    /* 第step步的伴随：由步起点 (t,y) 重算各级，再把 m_lambda 从步终点反推到步起点 */
+    static MwsInteger myRK45AdjStep(MyRK45Problem* spw, MoSize step, MoReal t, const MoReal* y)
+    {
+        MyRK45ProblemData* ds = spw->m_data;
+        MyRK45Adjoint* adj = &ds->m_adj;
+        MoSize n = spw->m_nStates;
+        MoReal h = adj->m_h[step];
+        MwsInteger status;
+
+        if (spw->m_callback.m_rshFunction(spw->m_userData, t, y, adj->m_f0) != MWS_IVP_SUCCESS)
+        {
+            return MWS_IVP_RHSFN_FAIL;
+        }
+        status = myRKEngineStep(ds->m_method, &spw->m_callback, spw->m_userData, n, t, h, y, adj->m_f0, adj->m_yA,
+            mwsNullPtr, ds->m_work);
+        if (status != MWS_IVP_SUCCESS)
+        {
+            return status;
+        }
+        ++adj->m_recomputed;
+
+        memcpy(adj->m_yB, adj->m_lambda, n * sizeof(MoReal));
+        return myRKEngineAdjointStep(ds->m_method, &myRK45AdjRhs, spw, n, t, h, y, ds->m_work, adj->m_yB,
+            adj->m_lambda, adj->m_adjWork);
+    }
+
+    /* 二项式系数 C(c+r, c)，即c个空闲检查点、每步至多重算r次时能反推的最大步数（溢出前截断） */
+    static MoReal myRK45AdjBeta(MoInteger c, MoInteger r)
+    {
+        MoReal beta = 1;
+        MoInteger index;
+
+        for (index = 1; index <= c && beta < 1e15; ++index)
+        {
+            beta = beta * (r + index) / index;
+        }
+        return beta;
+    }
+
+    /*
+     * 反推 [a, b) 各步，步a起点的状态在检查点slot中、时间为t；free个空闲检查点从base开始。
+     * 取最小的r使 C(free+r, free) >= b-a，先前进到 a+m（m = max(1, (b-a) - C(free-1+r, free-1))）
+     * 存为新检查点，右段用 free-1 个检查点反推，左段再用 free 个检查点反推——两段的步数都不超过各自的容量
+     */
+    static MwsInteger myRK45AdjReverse(MyRK45Problem* spw, MoSize a, MoSize b, MoReal t, MoInteger slot,
+        MoInteger base, MoInteger free)
+    {
+        MyRK45Adjoint* adj = &spw->m_data->m_adj;
+        MoSize n = spw->m_nStates;
+        const MoReal* y = adj->m_ck + slot * n;
+        MoSize l = b - a;
+        MoSize m, step;
+        MoInteger r = 1;
+        MoReal tm;
+        MwsInteger status;
+
+        if (l == 1)
+        {
+            return myRK45AdjStep(spw, a, t, y);
+        }
+        if (free == 0)
+        {
+            /* 没有空闲检查点：每步都从段起点重算 */
+            for (step = b; step-- > a;)
+            {
+                status = myRK45AdjAdvance(spw, a, step - a, t, y, adj->m_ck + base * n, &tm);
+                if (status == MWS_IVP_SUCCESS)
+                {
+                    status = myRK45AdjStep(spw, step, tm, adj->m_ck + base * n);
+                }
+                if (status != MWS_IVP_SUCCESS)
+                {
+                    return status;
+                }
+            }
+            return MWS_IVP_SUCCESS;
+        }
+
+        while (myRK45AdjBeta(free, r) < (MoReal)l)
+        {
+            ++r;
+        }
+        m = (MoReal)l > myRK45AdjBeta(free - 1, r) ? l - (MoSize)myRK45AdjBeta(free - 1, r) : 1;
+
+        status = myRK45AdjAdvance(spw, a, m, t, y, adj->m_ck + base * n, &tm);
+        if (status == MWS_IVP_SUCCESS)
+        {
+            status = myRK45AdjReverse(spw, a + m, b, tm, base, base + 1, free - 1);
+        }
+        if (status == MWS_IVP_SUCCESS)
+        {
+            status = myRK45AdjReverse(spw, a, a + m, t, slot, base, free);
+        }
+        return status;
+    }
+
+    /* 把刚接受的步 [t, t+h] 追加到轨迹历史，满时覆盖最老的一步 */
+    static void myRK45HistPush(MyRK45ProblemData* ds, MoSize n, MoReal t, MoReal h)
+    {
+        MoSize slot;
+
+        if (ds->m_histCap == 0)
+        {
+            return;
+        }
+        if (ds->m_histCount < ds->m_histCap)
+        {
+            slot = (ds->m_histHead + ds->m_histCount++) % ds->m_histCap;
+        }
+        else
+        {
+            slot = ds->m_histHead;
+            ds->m_histHead = (ds->m_histHead + 1) % ds->m_histCap;
+        }
+        memcpy(ds->m_histY + slot * 4 * n, ds->m_preY, 4 * n * sizeof(MoReal));
+        ds->m_histT[slot] = t;
+        ds->m_histH[slot] = h;
+    }
+
+    /* 二分查找起点不晚于tout的最后一步，返回其在历史中的序号（0为最老）；tout早于窗口时返回0 */
+    static MoSize myRK45HistFind(const MyRK45ProblemData* ds, MoReal tout)
+    {
+        MoSize lo = 0;
+        MoSize hi = ds->m_histCount;
+
+        while (hi - lo > 1)
+        {
+            MoSize mid = lo + (hi - lo) / 2;
+            if (ds->m_histT[(ds->m_histHead + mid) % ds->m_histCap] <= tout)
+            {
+                lo = mid;
+            }
+            else
+            {
+                hi = mid;
+            }
+        }
+        return lo;
+    }
+
+    /*
+     * 在轨迹历史上插值m个时刻：落在同一步内的相邻时刻合并成一次批量Hermite求值。
+     * 晚于最新一步的时刻沿最新一步外推（与无历史时相同）；早于窗口的沿最老一步外推并返回MWS_IVP_WARNING
+     */
+    static MwsInteger myRK45HistInterpolate(const MyRK45ProblemData* ds, MoSize n, MoSize m, const MoReal* tout,
+        MoReal* yret)
+    {
+        MwsInteger status = MWS_IVP_SUCCESS;
+        MoSize j = 0;
+
+        while (j < m)
+        {
+            MoSize k = myRK45HistFind(ds, tout[j]);
+            MoSize slot = (ds->m_histHead + k) % ds->m_histCap;
+            MoReal t0 = ds->m_histT[slot];
+            MoReal h = ds->m_histH[slot];
+            const MoReal* y = ds->m_histY + slot * 4 * n;
+            MoSize run = 1;
+
+            if (tout[j] < t0)
+            {
+                status = MWS_IVP_WARNING;
+            }
+            while (j + run < m && tout[j + run] >= t0 && (k + 1 == ds->m_histCount || tout[j + run] <= t0 + h))
+            {
+                ++run;
+            }
+            myIVPHermiteBatch(n, run, tout + j, t0, h, y, y + n, y + 2 * n, y + 3 * n, yret + j * n);
+            j += run;
+        }
+        return status;
+    }
+
+    /*
+     * 试算步中右端函数失败（如查表越界、负数开方）时缩小步长重试：可以重试时缩小*h并返回moTrue；
+     * 其它错误或重试次数用完时返回moFalse，由调用方返回原状态
+     */
+    static MoBoolean myRK45RetryStep(MyRK45ProblemData* ds, MwsInteger status, MoInteger* retries, MoReal* h)
+    {
+        if (status != MWS_IVP_RHSFN_FAIL || *retries >= ds->m_retryMax)
+        {
+            return moFalse;
+        }
+        ++*retries;
+        ++ds->m_retries;
+        *h *= ds->m_retryShrink;
+        return moTrue;
+    }
+
+    /* 单精度求解：状态与各级为float，时间、步长控制、插值历史与返回值为double */
+    static MwsInteger myRK45SolveF32(MyRK45Problem* spw, MwsReal step_size, MwsReal t, MwsReal* tret,
+        MwsReal* yret, MwsReal* ypret)
+    {
+        MyRK45ProblemData* ds = spw->m_data;
+        const MyRKEngineInfo* info = myRKEngineGetInfo(ds->m_method);
+
+        MoSize nState = spw->m_nStates;
+        MoSize index;
+
+        MoReal rtol = myIVPRelTol(&spw->m_opt);
+        MoReal atol = myIVPAbsTol(&spw->m_opt);
+        MoReal h = ds->m_h;
+        MoReal errNorm = 0;
+        MoReal factor;
+        MoBoolean rejected = moFalse;
+        MoInteger retries = 0;
+        float* fEnd = mwsNullPtr;
+        MwsInteger status;
+
+        if (rtol < MY_RK45_F32_MIN_TOL)
+        {
+            rtol = MY_RK45_F32_MIN_TOL;     /* 低于舍入误差的容许误差会让步长一直缩小到失败 */
+        }
+
+        /* 接着上一步的单精度状态（连同补偿量）继续；重新初始化或外部改过y时从yret重新载入 */
+        for (index = 0; index < nState && ds->m_f32Valid; ++index)
+        {
+            if (yret[index] != (MoReal)ds->m_yF[index])
+            {
+                ds->m_f32Valid = moFalse;
+            }
+        }
+        if (!ds->m_f32Valid || t != ds->m_curTime)
+        {
+            for (index = 0; index < nState; ++index)
+            {
+                ds->m_yF[index] = (float)yret[index];
+            }
+            memset(ds->m_compF, 0, nState * sizeof(float));
+            if (nState > 0 && myRKRhsF32Eval(&ds->m_rhsF32, nState, t, ds->m_yF, ds->m_fF) != MWS_IVP_SUCCESS)
+            {
+                return MWS_IVP_RHSFN_FAIL;
+            }
+        }
+        ds->m_f32Valid = moFalse;
+        ds->m_ypValid = moFalse;
+
+        for (index = 0; index < nState; ++index)
+        {
+            ds->m_preY[index] = ds->m_yF[index];
+            ds->m_preYp[index] = ds->m_fF[index];
+        }
+
+        if (h <= 0)
+        {
+            h = step_size;
+            if (h <= 0 && myIVPInitialStep(&spw->m_callback, spw->m_userData, nState, t, ds->m_preY, ds->m_preYp,
+                rtol, atol, info->m_errOrder, myIVPMaxStep(&spw->m_opt), ds->m_work, ds->m_work + nState, &h) != MWS_IVP_SUCCESS)
+            {
+                return MWS_IVP_RHSFN_FAIL;
+            }
+        }
+
+        for (;;)
+        {
+            MY_IVP_TRACE_BEGIN(attempt)
+
+            h = myIVPClampStep(&spw->m_opt, t, h);
+            if (h < myIVPMinStep(t))
+            {
+                return MWS_IVP_FAIL;    /* 步长过小 */
+            }
+
+            status = myRKEngineStepF32(ds->m_method, &ds->m_rhsF32, nState, t, h, ds->m_yF, ds->m_fF, ds->m_y1F,
+                ds->m_errF, ds->m_compensated ? ds->m_compF : mwsNullPtr, ds->m_comp1F, ds->m_workF);
+            if (status == MWS_IVP_SUCCESS)
+            {
+                for (index = 0; index < nState; ++index)
+                {
+                    ds->m_curY[index] = ds->m_y1F[index];
+                    ds->m_err[index] = ds->m_errF[index];
+                }
+                errNorm = myIVPErrorNorm(nState, ds->m_err, ds->m_preY, ds->m_curY, rtol, atol);
+                if (errNorm > 1)
+                {
+                    h *= myIVPStepFactorCtl(&ds->m_ctl, errNorm, info->m_errOrder);
+                    rejected = moTrue;
+                    MY_IVP_TRACE_END(MY_IVP_TRACE_REJECT, attempt);
+                    continue;
+                }
+
+                /* 末点导数：FSAL方法即最后一级，否则补算到引擎工作区的末段，失败时第1级m_fF仍可用于重试 */
+                fEnd = ds->m_workF + (info->m_fsal ? info->m_stages - 1 : info->m_stages) * nState;
+                if (!info->m_fsal && nState > 0
+                    && myRKRhsF32Eval(&ds->m_rhsF32, nState, t + h, ds->m_y1F, fEnd) != MWS_IVP_SUCCESS)
+                {
+                    status = MWS_IVP_RHSFN_FAIL;
+                }
+                if (status == MWS_IVP_SUCCESS)
+                {
+                    MY_IVP_TRACE_END(MY_IVP_TRACE_STEP, attempt);
+                    break;
+                }
+            }
+            MY_IVP_TRACE_END(MY_IVP_TRACE_REJECT, attempt);
+            if (!myRK45RetryStep(ds, status, &retries, &h))
+            {
+                return status;
+            }
+            rejected = moTrue;
+        }
+
+        memcpy(ds->m_fF, fEnd, nState * sizeof(float));
+        memcpy(ds->m_yF, ds->m_y1F, nState * sizeof(float));
+        if (ds->m_compensated)
+        {
+            memcpy(ds->m_compF, ds->m_comp1F, nState * sizeof(float));
+        }
+        for (index = 0; index < nState; ++index)
+        {
+            ds->m_curYp[index] = ds->m_fF[index];
+        }
+
+        ds->m_curTime = t + h;
+        ds->m_initialStep = h;
+        ds->m_f32Valid = moTrue;
+        myRK45HistPush(ds, nState, t, h);
+
+        factor = myIVPStepFactorCtl(&ds->m_ctl, errNorm, info->m_errOrder);
+        if (rejected && factor > 1)
+        {
+            factor = 1;
+        }
+        ds->m_Q = factor;
+        ds->m_h = h * factor;
+
+        memcpy(yret, ds->m_curY, nState * sizeof(MoReal));
+        if (ypret)
+        {
+            memcpy(ypret, ds->m_curYp, nState * sizeof(MoReal));
+        }
+        *tret = ds->m_curTime;
+
+        return MWS_IVP_SUCCESS;
+    }
+
+    /// <summary>
+    /// 求解：每次调用前进一个被接受的步，级计算由 myRKEngineStep 完成
+    /// </summary>
+    /// 输入：
+    /// <param name="solver">积分算法对象</param>
+    /// <param name="ivp">问题对象</param>
+    /// <param name="step_size">初始积分步长（仅首步使用，<=0时自动选择）</param>
+    /// <param name="t">当前时间</param>
+    /// <param name="tout">期望输出时间</param>
+    /// 输出：
+    /// <param name="tret">求解实际达到的时间</param>
+    /// <param name="yret">y的结果值（输入为当前y）</param>
+    /// <param name="ypret">y’的结果值（可为空）</param>
+    /// <param name="reserve">保留参数，暂不使用</param>
+    /// <returns></returns>
+    MwsInteger myRK45Solve(MwsIVPSolverObj solver, MwsIVPObj ivp, MwsReal step_size, MwsReal t,
+        MwsReal tout, MwsReal* tret, MwsReal* yret, MwsReal* ypret, void* reserve)
+    {
+        MyRK45Problem* spw = (MyRK45Problem*)ivp;
+        MyRK45ProblemData* ds = spw->m_data;
+        const MyRKEngineInfo* info = myRKEngineGetInfo(ds->m_method);
+
+        MoSize nState = spw->m_nStates;
+
+        MoReal* preY = ds->m_preY;                  //上个y
+        MoReal* curY = ds->m_curY;                  //当前y
+        MoReal* preYp = ds->m_preYp;                //上个y'，即第1级
+        MoReal* curYp = ds->m_curYp;                //当前y'
+        MoReal* work = ds->m_work;
+
+        MoReal rtol = myIVPRelTol(&spw->m_opt);
+        MoReal atol = myIVPAbsTol(&spw->m_opt);
+        MoReal h = ds->m_h;
+        MoReal errNorm = 0;
+        MoReal factor;
+        MoBoolean rejected = moFalse;
+        MoInteger retries = 0;
+        MwsInteger status;
+
+        if (spw->m_opt.m_stopTimeDefined && t >= spw->m_opt.m_stopTime)
+        {
+            *tret = t;
+            return MWS_IVP_TSTOP_RETURN;
+        }
+        if (ds->m_f32)
+        {
+            return myRK45SolveF32(spw, step_size, t, tret, yret, ypret);
+        }
+
+        /* 当前状态（上一步的y1即本步的y0），第1级沿用上一步末点的 f(t+h,y1) */
+        memcpy(preY, yret, nState * sizeof(MoReal));
+        if (ds->m_ypValid && t == ds->m_curTime)
+        {
+            memcpy(preYp, curYp, nState * sizeof(MoReal));
+        }
+        else if (nState > 0 && spw->m_callback.m_rshFunction(spw->m_userData, t, preY, preYp) != MWS_IVP_SUCCESS)
+        {
+            return MWS_IVP_RHSFN_FAIL;
+        }
+        ds->m_ypValid = moFalse;
+
+        if (h <= 0)
+        {
+            h = step_size;
+            if (h <= 0 && myIVPInitialStep(&spw->m_callback, spw->m_userData, nState, t, preY, preYp, rtol, atol,
+                info->m_errOrder, myIVPMaxStep(&spw->m_opt), work, work + nState, &h) != MWS_IVP_SUCCESS)
+            {
+                return MWS_IVP_RHSFN_FAIL;
+            }
+        }
+
+        for (;;)
+        {
+            MY_IVP_TRACE_BEGIN(attempt)
+
+            h = myIVPClampStep(&spw->m_opt, t, h);
+            if (h < myIVPMinStep(t))
+            {
+                return MWS_IVP_FAIL;    /* 步长过小 */
+            }
+
+            status = myRKEngineStep(ds->m_method, &spw->m_callback, spw->m_userData, nState, t, h,
+                preY, preYp, curY, ds->m_err, work);
+            if (status == MWS_IVP_SUCCESS)
+            {
+                errNorm = myIVPErrorNorm(nState, ds->m_err, preY, curY, rtol, atol);
+                if (errNorm > 1)
+                {
+                    h *= myIVPStepFactorCtl(&ds->m_ctl, errNorm, info->m_errOrder);
+                    rejected = moTrue;
+                    MY_IVP_TRACE_END(MY_IVP_TRACE_REJECT, attempt);
+                    continue;
+                }
+
+                /* 末点导数：FSAL方法即最后一级，否则补算一次（它失败时同样缩小步长重试） */
+                if (info->m_fsal)
+                {
+                    memcpy(curYp, work + (info->m_stages - 1) * nState, nState * sizeof(MoReal));
+                }
+                else if (nState > 0
+                    && spw->m_callback.m_rshFunction(spw->m_userData, t + h, curY, curYp) != MWS_IVP_SUCCESS)
+                {
+                    status = MWS_IVP_RHSFN_FAIL;
+                }
+                if (status == MWS_IVP_SUCCESS)
+                {
+                    MY_IVP_TRACE_END(MY_IVP_TRACE_STEP, attempt);
+                    break;
+                }
+            }
+            MY_IVP_TRACE_END(MY_IVP_TRACE_REJECT, attempt);
+            if (!myRK45RetryStep(ds, status, &retries, &h))
+            {
+                return status;
+            }
+            rejected = moTrue;
+        }
+
+        if (ds->m_np > 0)
+        {
+            status = myRK45SensStep(spw, t, h);
+            if (status != MWS_IVP_SUCCESS)
+            {
+                return status;
+            }
+        }
+        if (ds->m_adj.m_enabled)
+        {
+            status = myRK45AdjRecord(spw, t, h);
+            if (status != MWS_IVP_SUCCESS)
+            {
+                return status;
+            }
+        }
+
+        ds->m_curTime = t + h;
+        ds->m_initialStep = h;
+        ds->m_ypValid = moTrue;
+        myRK45HistPush(ds, nState, t, h);
+
+        /* 刚被拒绝过的步不再放大步长 */
+        factor = myIVPStepFactorCtl(&ds->m_ctl, errNorm, info->m_errOrder);
+        if (rejected && factor > 1)
+        {
+            factor = 1;
+        }
+        ds->m_Q = factor;
+        ds->m_h = h * factor;
+
+        memcpy(yret, curY, nState * sizeof(MoReal));
+        if (ypret)
+        {
+            memcpy(ypret, curYp, nState * sizeof(MoReal));
+        }
+        *tret = ds->m_curTime;
+
+        return MWS_IVP_SUCCESS;  //返回状态，取MwsIVPStatus的值
+    }
+
+    /// <summary>
+    /// 插值：用步两端的 y 与 y' 做三次Hermite插值，不需要额外的右端函数计算。
+    /// 启用轨迹历史（myRK45SetHistory）后，早于当前步的时刻在历史中所在的步上插值
+    /// </summary>
+    /// 输入：
+    /// <param name="solver">积分算法对象</param>
+    /// <param name="ivp">问题对象</param>
+    /// <param name="tout">期望的输出时间</param>
+    /// 输出：
+    /// <param name="yret">y的结果值</param>
+    /// <param name="reserve"></param>
+    /// <returns>tout早于历史窗口时返回MWS_IVP_WARNING（结果为外推值）</returns>
+    MwsInteger myRK45Interpolate(MwsIVPSolverObj solver, MwsIVPObj ivp, MwsReal tout, MwsReal* yret, void* reserve)
+    {
+        MyRK45Problem* spw = (MyRK45Problem*)ivp;
+        MyRK45ProblemData* ds = spw->m_data;
+        MoReal h = ds->m_initialStep;
+
+        if (ds->m_histCount > 0 && tout < ds->m_curTime - h)
+        {
+            return myRK45HistInterpolate(ds, spw->m_nStates, 1, &tout, yret);
+        }
+        if (h == 0)
+        {
+            memcpy(yret, ds->m_curY, spw->m_nStates * sizeof(MoReal));
+            return MWS_IVP_SUCCESS;
+        }
+
+        myIVPHermite(spw->m_nStates, (tout - ds->m_curTime + h) / h, h, ds->m_preY, ds->m_curY,
+            ds->m_preYp, ds->m_curYp, yret);
+
+        return MWS_IVP_SUCCESS;
+    }
+
+    /// <summary>
+    /// 批量插值：一次求m个输出时刻的值（同一步内的高频输出），结果与逐个调用 myRK45Interpolate 在舍入误差内一致，
+    /// 但各状态的Hermite多项式系数只求一次，数据只扫描一遍；启用轨迹历史时时刻可跨越历史中的多步
+    /// </summary>
+    /// 输入：
+    /// <param name="solver">积分算法对象</param>
+    /// <param name="ivp">问题对象</param>
+    /// <param name="m">输出时刻个数</param>
+    /// <param name="tout">输出时刻，长度m</param>
+    /// 输出：
+    /// <param name="yret">结果矩阵，m*n按行存储，第j行为tout[j]时刻的y</param>
+    /// <returns>有时刻早于历史窗口时返回MWS_IVP_WARNING</returns>
+    MwsInteger myRK45InterpolateBatch(MwsIVPSolverObj solver, MwsIVPObj ivp, MoSize m, const MwsReal* tout,
+        MwsReal* yret)
+    {
+        MyRK45Problem* spw = (MyRK45Problem*)ivp;
+        MyRK45ProblemData* ds = spw->m_data;
+        MoSize n = spw->m_nStates;
+        MoReal h = ds->m_initialStep;
+        MoSize j;
+
+        if (m > 0 && (!tout || !yret))
+        {
+            return MWS_IVP_INVALID_INPUT;
+        }
+        if (ds->m_histCount > 0)
+        {
+            return myRK45HistInterpolate(ds, n, m, tout, yret);
+        }
+        if (h == 0)
+        {
+            for (j = 0; j < m; ++j)
+            {
+                memcpy(yret + j * n, ds->m_curY, n * sizeof(MoReal));
+            }
+            return MWS_IVP_SUCCESS;
+        }
+
+        myIVPHermiteBatch(n, m, tout, ds->m_curTime - h, h, ds->m_preY, ds->m_curY, ds->m_preYp, ds->m_curYp, yret);
+
+        return MWS_IVP_SUCCESS;
+    }
+
+    /// <summary>
+    /// 保存状态快照（协同仿真主算法回退用），只拷贝到预分配的快照区，不分配内存
+    /// </summary>
+    /// <param name="solver">积分算法对象</param>
+    /// <param name="ivp">问题对象</param>
+    /// <returns></returns>
+    MwsInteger myRK45SaveState(MwsIVPSolverObj solver, MwsIVPObj ivp)
+    {
+        MyRK45Problem* spw = (MyRK45Problem*)ivp;
+        MyRK45ProblemData* ds = spw->m_data;
+
+        if (spw->m_nStates > 0)
+        {
+            memcpy(ds->m_snap.m_y, ds->m_preY, 4 * spw->m_nStates * sizeof(MoReal));
+        }
+        ds->m_snap.m_curTime = ds->m_curTime;
+        ds->m_snap.m_initialStep = ds->m_initialStep;
+        ds->m_snap.m_h = ds->m_h;
+        ds->m_snap.m_Q = ds->m_Q;
+        ds->m_snap.m_np = ds->m_np;
+        ds->m_snap.m_adjSteps = ds->m_adj.m_nSteps;
+        if (ds->m_np > 0)
+        {
+            memcpy(ds->m_snapS, ds->m_preS, 4 * spw->m_nStates * ds->m_np * sizeof(MoReal));
+        }
+        ds->m_snap.m_valid = moTrue;
+
+        return MWS_IVP_SUCCESS;
+    }
+
+    /// <summary>
+    /// 恢复到最近一次保存的快照，步长历史一并恢复
+    /// </summary>
+    /// 输入：
+    /// <param name="solver">积分算法对象</param>
+    /// <param name="ivp">问题对象</param>
+    /// 输出：
+    /// <param name="tret">快照时刻（可为空）</param>
+    /// <param name="yret">快照时刻y的值（可为空）</param>
+    /// <param name="ypret">快照时刻y'的值（可为空）</param>
+    /// <returns>未保存过快照时返回MWS_IVP_INVALID_INPUT</returns>
+    MwsInteger myRK45RestoreState(MwsIVPSolverObj solver, MwsIVPObj ivp, MwsReal* tret, MwsReal* yret, MwsReal* ypret)
+    {
+        MyRK45Problem* spw = (MyRK45Problem*)ivp;
+        MyRK45ProblemData* ds = spw->m_data;
+        MoSize nState = spw->m_nStates;
+
+        if (!ds->m_snap.m_valid)
+        {
+            return MWS_IVP_INVALID_INPUT;
+        }
+
+        if (nState > 0)
+        {
+            memcpy(ds->m_preY, ds->m_snap.m_y, 4 * nState * sizeof(MoReal));
+        }
+        ds->m_curTime = ds->m_snap.m_curTime;
+        ds->m_initialStep = ds->m_snap.m_initialStep;
+        ds->m_h = ds->m_snap.m_h;
+        ds->m_Q = ds->m_snap.m_Q;
+        ds->m_ypValid = moTrue;
+        ds->m_sensValid = moFalse;
+        if (ds->m_np > 0 && ds->m_snap.m_np == ds->m_np)
+        {
+            memcpy(ds->m_preS, ds->m_snapS, 4 * nState * ds->m_np * sizeof(MoReal));
+            ds->m_sensValid = moTrue;
+        }
+        ds->m_f32Valid = moFalse;
+
+        /* 历史中快照之后的步作废 */
+        while (ds->m_histCount > 0
+            && ds->m_histT[(ds->m_histHead + ds->m_histCount - 1) % ds->m_histCap] >= ds->m_curTime)
+        {
+            --ds->m_histCount;
+        }
+
+        /* 伴随记录截到快照时刻；快照早于本次记录时从快照时刻重新记录 */
+        if (ds->m_snap.m_adjSteps <= ds->m_adj.m_nSteps)
+        {
+            ds->m_adj.m_nSteps = ds->m_snap.m_adjSteps;
+            while (ds->m_adj.m_count > 0 && ds->m_adj.m_ckStep[ds->m_adj.m_count - 1] >= ds->m_adj.m_nSteps)
+            {
+                --ds->m_adj.m_count;
+            }
+        }
+        else
+        {
+            ds->m_adj.m_nSteps = 0;
+            ds->m_adj.m_count = 0;
+            ds->m_adj.m_stride = 1;
+        }
+
+        if (tret)
+        {
+            *tret = ds->m_curTime;
+        }
+        if (yret && nState > 0)
+        {
+            memcpy(yret, ds->m_curY, nState * sizeof(MoReal));
+        }
+        if (ypret && nState > 0)
+        {
+            memcpy(ypret, ds->m_curYp, nState * sizeof(MoReal));
+        }
+
+        return MWS_IVP_SUCCESS;
+    }
+
+    /// <summary>
+    /// 选择Butcher表（见 my_rk_engine.h 中的 MyRKMethod），默认 MY_RK_FEHLBERG45；
+    /// 切换后步长历史清空，下一步重新选择初始步长
+    /// </summary>
+    /// <param name="solver">积分算法对象</param>
+    /// <param name="ivp">问题对象</param>
+    /// <param name="method">MyRKMethod的值</param>
+    /// <returns>方法不存在或是定步长方法时返回MWS_IVP_INVALID_INPUT</returns>
+    MwsInteger myRK45SetMethod(MwsIVPSolverObj solver, MwsIVPObj ivp, MoInteger method)
+    {
+        MyRK45Problem* spw = (MyRK45Problem*)ivp;
+        const MyRKEngineInfo* info = myRKEngineGetInfo(method);
+
+        if (info == mwsNullPtr || info->m_errOrder == 0)
+        {
+            return MWS_IVP_INVALID_INPUT;
+        }
+        spw->m_data->m_method = method;
+        spw->m_data->m_h = 0;
+
+        return MWS_IVP_SUCCESS;
+    }
+
+    /// <summary>
+    /// 设置步长控制器参数（安全因子与单步缩放倍数上下限），不影响已有的步长历史
+    /// </summary>
+    /// <param name="solver">积分算法对象</param>
+    /// <param name="ivp">问题对象</param>
+    /// <param name="ctl">控制器参数，为空时恢复默认值</param>
+    /// <returns>参数无效时返回MWS_IVP_INVALID_INPUT</returns>
+    MwsInteger myRK45SetController(MwsIVPSolverObj solver, MwsIVPObj ivp, const MyIVPController* ctl)
+    {
+        static const MyIVPController defaultCtl = MY_IVP_CONTROLLER_DEFAULT;
+        MyRK45Problem* spw = (MyRK45Problem*)ivp;
+
+        if (ctl == mwsNullPtr)
+        {
+            ctl = &defaultCtl;
+        }
+        if (!myIVPControllerValid(ctl))
+        {
+            return MWS_IVP_INVALID_INPUT;
+        }
+        spw->m_data->m_ctl = *ctl;
+
+        return MWS_IVP_SUCCESS;
+    }
+
+    /// <summary>
+    /// 单精度模式：状态、各级与误差以float存储和计算，时间与步长控制仍为double，适合容许误差1e-4左右的
+    /// 大批量集合仿真与硬件在环。相对容许误差低于 MY_RK45_F32_MIN_TOL 时按该值计算
+    /// </summary>
+    /// <param name="solver">积分算法对象</param>
+    /// <param name="ivp">问题对象</param>
+    /// <param name="enable">是否启用单精度</param>
+    /// <param name="compensated">状态更新是否采用Kahan补偿求和（长时间积分时减小舍入误差的累积）</param>
+    /// <param name="native_rhs">单精度右端函数（可为空，为空时经双精度转换调用原回调）</param>
+    /// <returns></returns>
+    MwsInteger myRK45SetSinglePrecision(MwsIVPSolverObj solver, MwsIVPObj ivp, MoBoolean enable,
+        MoBoolean compensated, MyRKRhsF32Ptr native_rhs)
+    {
+        MyRK45* sw = (MyRK45*)solver;
+        MyRK45Problem* spw = (MyRK45Problem*)ivp;
+        MyRK45ProblemData* ds = spw->m_data;
+        MoSize n = spw->m_nStates;
+
+        if (enable && ds->m_np > 0)
+        {
+            return MWS_IVP_INVALID_INPUT;   /* 灵敏度只支持双精度 */
+        }
+        if (enable && n > 0 && ds->m_yF == mwsNullPtr)
+        {
+            ds->m_yF = (float*)sw->m_utils.m_allocDataMemory(sw->m_userData, MY_RK_MAX_STAGES + 7, n * sizeof(float));
+            ds->m_shim = (MoReal*)sw->m_utils.m_allocDataMemory(sw->m_userData, 2, n * sizeof(MoReal));
+            if (!ds->m_yF || !ds->m_shim)
+            {
+                if (ds->m_yF)
+                {
+                    sw->m_utils.m_freeDataMemory(sw->m_userData, ds->m_yF);
+                    ds->m_yF = mwsNullPtr;
+                }
+                if (ds->m_shim)
+                {
+                    sw->m_utils.m_freeDataMemory(sw->m_userData, ds->m_shim);
+                    ds->m_shim = mwsNullPtr;
+                }
+                return MWS_IVP_MEM_FAIL;
+            }
+            ds->m_fF = ds->m_yF + n;
+            ds->m_y1F = ds->m_yF + 2 * n;
+            ds->m_errF = ds->m_yF + 3 * n;
+            ds->m_compF = ds->m_yF + 4 * n;
+            ds->m_comp1F = ds->m_yF + 5 * n;
+            ds->m_workF = ds->m_yF + 6 * n;
+        }
+
+        ds->m_rhsF32.m_native = native_rhs;
+        ds->m_rhsF32.m_callback = &spw->m_callback;
+        ds->m_rhsF32.m_userData = native_rhs ? MY_IVP_TRACE_USER_DATA(&spw->m_callback, spw->m_userData)
+            : spw->m_userData;
+        ds->m_rhsF32.m_shim = ds->m_shim;
+        ds->m_f32 = enable;
+        ds->m_compensated = compensated;
+        ds->m_f32Valid = moFalse;
+        ds->m_ypValid = moFalse;
+
+        return MWS_IVP_SUCCESS;
+    }
+
+    /// <summary>
+    /// 前向灵敏度：与状态一起积分 s_j = dy/dp_j 满足的 s_j' = J*s_j + df/dp_j（交错法：状态步先按原误差控制接受，
+    /// 灵敏度再沿用同一步长与Butcher表推进，状态各级不重算，灵敏度不参与误差控制）。
+    /// 须在 Init 之后调用；再次调用会重置灵敏度，np为0时关闭。单精度模式下不可用
+    /// </summary>
+    /// <param name="solver">积分算法对象</param>
+    /// <param name="ivp">问题对象</param>
+    /// <param name="np">参数个数</param>
+    /// <param name="params">模型参数（可为空）：模型回调经user_data读取的同一数组，未提供dfdp时临时扰动以求差商</param>
+    /// <param name="dfdp">df/dp_j 回调（可为空）</param>
+    /// <param name="use_jac">J*s 是否用 m_jacFunction（稠密，按列存储）计算；回调未提供Jacobian时忽略，改用方向差商</param>
+    /// <param name="s0">初始灵敏度，n*np，第j段为 dy0/dp_j（可为空，为空时全为0）</param>
+    /// <returns></returns>
+    MwsInteger myRK45SetSensitivity(MwsIVPSolverObj solver, MwsIVPObj ivp, MoInteger np, MoReal* params,
+        MyIVPParamJacPtr dfdp, MoBoolean use_jac, const MoReal* s0)
+    {
+        MyRK45* sw = (MyRK45*)solver;
+        MyRK45Problem* spw = (MyRK45Problem*)ivp;
+        MyRK45ProblemData* ds = spw->m_data;
+        MoSize n = spw->m_nStates;
+        MoSize ns;
+
+        if (np < 0 || (np > 0 && ds->m_f32))
+        {
+            return MWS_IVP_INVALID_INPUT;
+        }
+        ds->m_np = 0;
+        ds->m_sensValid = moFalse;
+        ds->m_snap.m_np = 0;
+        if (np == 0 || n == 0)
+        {
+            return MWS_IVP_SUCCESS;
+        }
+        ns = n * np;
+
+        if (np > ds->m_sensCap)
+        {
+            if (ds->m_preS)
+            {
+                sw->m_utils.m_freeDataMemory(sw->m_userData, ds->m_preS);
+            }
+            ds->m_sensCap = 0;
+            ds->m_preS = (MoReal*)sw->m_utils.m_allocDataMemory(sw->m_userData, (MY_RK_MAX_STAGES + 9) * ns + 3 * n,
+                sizeof(MoReal));
+            if (!ds->m_preS)
+            {
+                return MWS_IVP_MEM_FAIL;
+            }
+            ds->m_sensCap = np;
+        }
+        ds->m_curS = ds->m_preS + ns;
+        ds->m_preSp = ds->m_preS + 2 * ns;
+        ds->m_curSp = ds->m_preS + 3 * ns;
+        ds->m_snapS = ds->m_preS + 4 * ns;
+        ds->m_sensWork = ds->m_preS + 8 * ns;
+        ds->m_yPert = ds->m_sensWork + (MY_RK_MAX_STAGES + 1) * ns + n;
+        ds->m_fPert = ds->m_yPert + n;
+
+        ds->m_sensJac = use_jac && spw->m_callback.m_jacFunction;
+        if (ds->m_sensJac && !ds->m_jac)
+        {
+            ds->m_jac = (MoReal*)sw->m_utils.m_allocDataMemory(sw->m_userData, n * n, sizeof(MoReal));
+            if (!ds->m_jac)
+            {
+                return MWS_IVP_MEM_FAIL;
+            }
+        }
+
+        if (s0)
+        {
+            memcpy(ds->m_curS, s0, ns * sizeof(MoReal));
+        }
+        else
+        {
+            memset(ds->m_curS, 0, ns * sizeof(MoReal));
+        }
+        memcpy(ds->m_preS, ds->m_curS, ns * sizeof(MoReal));
+        ds->m_params = params;
+        ds->m_dfdp = dfdp;
+        ds->m_np = np;
+
+        return MWS_IVP_SUCCESS;
+    }
+
+    /// <summary>
+    /// 取灵敏度：用最近一步两端的 s 与 s' 做三次Hermite插值（与 myRK45Interpolate 相同），尚未积分时返回当前值
+    /// </summary>
+    /// 输入：
+    /// <param name="solver">积分算法对象</param>
+    /// <param name="ivp">问题对象</param>
+    /// <param name="tout">期望的输出时间</param>
+    /// 输出：
+    /// <param name="s">灵敏度，n*np，第j段为 dy/dp_j</param>
+    /// <returns>未启用灵敏度时返回MWS_IVP_INVALID_INPUT</returns>
+    MwsInteger myRK45GetSensitivity(MwsIVPSolverObj solver, MwsIVPObj ivp, MwsReal tout, MoReal* s)
+    {
+        MyRK45Problem* spw = (MyRK45Problem*)ivp;
+        MyRK45ProblemData* ds = spw->m_data;
+        MoSize ns = spw->m_nStates * ds->m_np;
+        MoReal h = ds->m_initialStep;
+
+        if (ds->m_np == 0)
+        {
+            return MWS_IVP_INVALID_INPUT;
+        }
+        if (h == 0 || !ds->m_sensValid)
+        {
+            memcpy(s, ds->m_curS, ns * sizeof(MoReal));
+            return MWS_IVP_SUCCESS;
+        }
+
+        myIVPHermite(ns, (tout - ds->m_curTime + h) / h, h, ds->m_preS, ds->m_curS, ds->m_preSp, ds->m_curSp, s);
+
+        return MWS_IVP_SUCCESS;
+    }
+
+    /// <summary>
+    /// 右端函数失败的重试策略：试算步的某一级或末点导数返回MWS_IVP_RHSFN_FAIL时（如试算状态超出查表范围、负数开方），
+    /// 丢弃该步、步长乘以shrink后重试，至多max_retries次，之后才返回错误；步起点处的右端函数失败不重试。
+    /// 默认 MY_IVP_RHS_RETRIES 次、MY_IVP_RHS_SHRINK 倍，max_retries为0时恢复为立即返回错误
+    /// </summary>
+    /// <param name="solver">积分算法对象</param>
+    /// <param name="ivp">问题对象</param>
+    /// <param name="max_retries">每步最多重试次数</param>
+    /// <param name="shrink">每次重试的步长缩小倍数，(0,1)</param>
+    /// <returns></returns>
+    MwsInteger myRK45SetRhsRetry(MwsIVPSolverObj solver, MwsIVPObj ivp, MoInteger max_retries, MoReal shrink)
+    {
+        MyRK45Problem* spw = (MyRK45Problem*)ivp;
+
+        if (max_retries < 0 || !(shrink > 0 && shrink < 1))
+        {
+            return MWS_IVP_INVALID_INPUT;
+        }
+        spw->m_data->m_retryMax = max_retries;
+        spw->m_data->m_retryShrink = shrink;
+
+        return MWS_IVP_SUCCESS;
+    }
+
+    /// <summary>
+    /// 创建问题以来因右端函数失败而缩小步长重试的累计次数
+    /// </summary>
+    /// <param name="solver">积分算法对象</param>
+    /// <param name="ivp">问题对象</param>
+    /// <returns></returns>
+    MoSize myRK45GetRhsRetries(MwsIVPSolverObj solver, MwsIVPObj ivp)
+    {
+        return ((MyRK45Problem*)ivp)->m_data->m_retries;
+    }
+
+    /// <summary>
+    /// 轨迹历史：保留最近steps个已接受步的插值数据（每步4n+2个实数），myRK45Interpolate 与 myRK45InterpolateBatch
+    /// 可在整个历史窗口内插值，无需重新积分。调用时清空已有历史，steps为0时关闭并释放内存
+    /// </summary>
+    /// <param name="solver">积分算法对象</param>
+    /// <param name="ivp">问题对象</param>
+    /// <param name="steps">保留的步数</param>
+    /// <returns></returns>
+    MwsInteger myRK45SetHistory(MwsIVPSolverObj solver, MwsIVPObj ivp, MoSize steps)
+    {
+        MyRK45* sw = (MyRK45*)solver;
+        MyRK45Problem* spw = (MyRK45Problem*)ivp;
+        MyRK45ProblemData* ds = spw->m_data;
+        MoSize n = spw->m_nStates;
+
+        ds->m_histHead = 0;
+        ds->m_histCount = 0;
+        if (steps != 0 && steps == ds->m_histAlloc)
+        {
+            ds->m_histCap = steps;
+            return MWS_IVP_SUCCESS;
+        }
+
+        if (ds->m_histY)
+        {
+            sw->m_utils.m_freeDataMemory(sw->m_userData, ds->m_histY);
+        }
+        ds->m_histY = mwsNullPtr;
+        ds->m_histT = mwsNullPtr;
+        ds->m_histH = mwsNullPtr;
+        ds->m_histAlloc = 0;
+        ds->m_histCap = 0;
+        if (steps == 0)
+        {
+            return MWS_IVP_SUCCESS;
+        }
+
+        ds->m_histY = (MoReal*)sw->m_utils.m_allocDataMemory(sw->m_userData, steps * (4 * n + 2), sizeof(MoReal));
+        if (!ds->m_histY)
+        {
+            return MWS_IVP_MEM_FAIL;
+        }
+        ds->m_histT = ds->m_histY + steps * 4 * n;
+        ds->m_histH = ds->m_histT + steps;
+        ds->m_histAlloc = steps;
+        ds->m_histCap = steps;
+
+        return MWS_IVP_SUCCESS;
+    }
+
+    /// <summary>
+    /// 取轨迹历史覆盖的时间区间（如时滞项据此判断所需的过去时刻是否仍可插值）
+    /// </summary>
+    /// 输入：
+    /// <param name="solver">积分算法对象</param>
+    /// <param name="ivp">问题对象</param>
+    /// 输出：
+    /// <param name="tStart">最老一步的起点</param>
+    /// <param name="tEnd">最新一步的终点，即当前时刻</param>
+    /// <returns>未启用历史或尚无已接受的步时返回MWS_IVP_INVALID_INPUT</returns>
+    MwsInteger myRK45GetHistoryWindow(MwsIVPSolverObj solver, MwsIVPObj ivp, MoReal* tStart, MoReal* tEnd)
+    {
+        MyRK45Problem* spw = (MyRK45Problem*)ivp;
+        MyRK45ProblemData* ds = spw->m_data;
+
+        if (ds->m_histCount == 0)
+        {
+            return MWS_IVP_INVALID_INPUT;
+        }
+        *tStart = ds->m_histT[ds->m_histHead];
+        *tEnd = ds->m_curTime;
+
+        return MWS_IVP_SUCCESS;
+    }
+
+    /// <summary>
+    /// 伴随灵敏度：正向积分时记录步长和检查点，之后由 myRK45AdjointSolve 一次反向求出终点标量 g(y(T)) 对初值与参数的梯度，
+    /// 代价与参数个数基本无关（提供vjp时）。检查点所占内存不超过budget_bytes（每个n*8字节，至少2个），
+    /// 检查点越少反向时重算的步数越多；步长记录另占每步8字节。
+    /// 须在 Init 之后、Solve 之前调用；记录从调用（或再次 Init）时的状态开始，budget_bytes为0时关闭。单精度模式下不可用
+    /// </summary>
+    /// <param name="solver">积分算法对象</param>
+    /// <param name="ivp">问题对象</param>
+    /// <param name="budget_bytes">检查点内存预算（字节）</param>
+    /// <param name="np">参数个数（可为0，只求对初值的梯度）</param>
+    /// <param name="params">模型参数（可为空）：模型回调经user_data读取的同一数组，未提供导数回调时临时扰动以求差商</param>
+    /// <param name="dfdp">df/dp_j 回调（可为空），每级每个参数调用一次</param>
+    /// <param name="vjp">(df/dp)^T*w 回调（可为空），优先于dfdp，每级调用一次</param>
+    /// <returns>预算不足两个检查点时返回MWS_IVP_INVALID_INPUT</returns>
+    MwsInteger myRK45SetAdjoint(MwsIVPSolverObj solver, MwsIVPObj ivp, MoSize budget_bytes, MoInteger np,
+        MoReal* params, MyIVPParamJacPtr dfdp, MyIVPParamVjpPtr vjp)
+    {
+        MyRK45* sw = (MyRK45*)solver;
+        MyRK45Problem* spw = (MyRK45Problem*)ivp;
+        MyRK45ProblemData* ds = spw->m_data;
+        MyRK45Adjoint* adj = &ds->m_adj;
+        MoSize n = spw->m_nStates;
+        MoInteger slots;
+
+        adj->m_enabled = moFalse;
+        adj->m_nSteps = 0;
+        adj->m_count = 0;
+        adj->m_stride = 1;
+        if (budget_bytes == 0)
+        {
+            return MWS_IVP_SUCCESS;
+        }
+        if (np < 0 || n == 0 || ds->m_f32 || budget_bytes / (n * sizeof(MoReal)) < 2)
+        {
+            return MWS_IVP_INVALID_INPUT;
+        }
+        slots = (MoInteger)(budget_bytes / (n * sizeof(MoReal)));
+
+        if (slots != adj->m_slots)
+        {
+            if (adj->m_ck)
+            {
+                sw->m_utils.m_freeDataMemory(sw->m_userData, adj->m_ck);
+                sw->m_utils.m_freeDataMemory(sw->m_userData, adj->m_ckStep);
+                sw->m_utils.m_freeDataMemory(sw->m_userData, adj->m_ckT);
+            }
+            adj->m_slots = 0;
+            adj->m_ck = (MoReal*)sw->m_utils.m_allocDataMemory(sw->m_userData, (slots + MY_RK_MAX_STAGES + 8) * n,
+                sizeof(MoReal));
+            adj->m_ckStep = (MoSize*)sw->m_utils.m_allocDataMemory(sw->m_userData, slots, sizeof(MoSize));
+            adj->m_ckT = (MoReal*)sw->m_utils.m_allocDataMemory(sw->m_userData, slots, sizeof(MoReal));
+            if (!adj->m_ck || !adj->m_ckStep || !adj->m_ckT)
+            {
+                if (adj->m_ck)
+                {
+                    sw->m_utils.m_freeDataMemory(sw->m_userData, adj->m_ck);
+                }
+                if (adj->m_ckStep)
+                {
+                    sw->m_utils.m_freeDataMemory(sw->m_userData, adj->m_ckStep);
+                }
+                if (adj->m_ckT)
+                {
+                    sw->m_utils.m_freeDataMemory(sw->m_userData, adj->m_ckT);
+                }
+                adj->m_ck = mwsNullPtr;
+                adj->m_ckStep = mwsNullPtr;
+                adj->m_ckT = mwsNullPtr;
+                return MWS_IVP_MEM_FAIL;
+            }
+            adj->m_slots = slots;
+            adj->m_yA = adj->m_ck + slots * n;
+            adj->m_yB = adj->m_yA + n;
+            adj->m_lambda = adj->m_yB + n;
+            adj->m_f0 = adj->m_lambda + n;
+            adj->m_yPert = adj->m_f0 + n;
+            adj->m_fPert = adj->m_yPert + n;
+            adj->m_adjWork = adj->m_fPert + n;
+        }
+        if (!ds->m_jac)
+        {
+            ds->m_jac = (MoReal*)sw->m_utils.m_allocDataMemory(sw->m_userData, n * n, sizeof(MoReal));
+            if (!ds->m_jac)
+            {
+                return MWS_IVP_MEM_FAIL;
+            }
+        }
+
+        adj->m_np = np;
+        adj->m_params = params;
+        adj->m_dfdp = dfdp;
+        adj->m_vjp = vjp;
+        adj->m_enabled = moTrue;
+        ds->m_snap.m_adjSteps = 0;
+
+        return MWS_IVP_SUCCESS;
+    }
+
+    /// <summary>
+    /// 反向求伴随：lambda(T) = dg/dy(T) 从当前时刻沿记录的各步反推到记录起点，同时累加 dg/dp。
+    /// 采用离散伴随（RK格式本身的转置），与正向求得的数值解一致；各段从检查点重算正向各级，
+    /// 段内按二项式检查点策略安排重算。记录保持不变，可对不同的 lambda(T) 多次调用
+    /// </summary>
+    /// 输入：
+    /// <param name="solver">积分算法对象</param>
+    /// <param name="ivp">问题对象</param>
+    /// <param name="lambdaT">终点伴随 dg/dy(T)，长度n</param>
+    /// 输出：
+    /// <param name="lambda0">记录起点的伴随 dg/dy(t0)，长度n（可为空）</param>
+    /// <param name="grad">dg/dp，长度np（可为空）</param>
+    /// <param name="recomputed">反向过程重算的正向步数（可为空）</param>
+    /// <returns>未启用伴随时返回MWS_IVP_INVALID_INPUT</returns>
+    MwsInteger myRK45AdjointSolve(MwsIVPSolverObj solver, MwsIVPObj ivp, const MoReal* lambdaT, MoReal* lambda0,
+        MoReal* grad, MoSize* recomputed)
+    {
+        MyRK45Problem* spw = (MyRK45Problem*)ivp;
+        MyRK45ProblemData* ds = spw->m_data;
+        MyRK45Adjoint* adj = &ds->m_adj;
+        MoSize n = spw->m_nStates;
+        MoInteger seg;
+        MwsInteger status = MWS_IVP_SUCCESS;
+
+        if (!adj->m_enabled)
+        {
+            return MWS_IVP_INVALID_INPUT;
+        }
+        if (grad && adj->m_np > 0)
+        {
+            memset(grad, 0, adj->m_np * sizeof(MoReal));
+        }
+        adj->m_grad = grad;     /* 为空时不计算参数导数 */
+        adj->m_recomputed = 0;
+        memcpy(adj->m_lambda, lambdaT, n * sizeof(MoReal));
+
+        /*
+         * 从最后一段起逐段反推。正向检查点（0..m_count-1）只读，保证记录可反复使用；
+         * 正向至多占容量的一半，其后的检查点供段内重算（末个作暂存区）
+         */
+        for (seg = adj->m_count - 1; seg >= 0 && status == MWS_IVP_SUCCESS; --seg)
+        {
+            MoSize a = adj->m_ckStep[seg];
+            MoSize b = seg + 1 < adj->m_count ? adj->m_ckStep[seg + 1] : adj->m_nSteps;
+            if (b > a)
+            {
+                status = myRK45AdjReverse(spw, a, b, adj->m_ckT[seg], seg, adj->m_count,
+                    adj->m_slots - adj->m_count - 1);
+            }
+        }
+
+        if (status == MWS_IVP_SUCCESS && lambda0)
+        {
+            memcpy(lambda0, adj->m_lambda, n * sizeof(MoReal));
+        }
+        if (recomputed)
+        {
+            *recomputed = adj->m_recomputed;
+        }
+        return status;
+    }
+
+    /// <summary>
+    /// 销毁问题：对象池未满时连同工作区放回池中，供下次创建同规模的问题复用
+    /// </summary>
+    /// <param name="solver"></param>
+    /// <param name="ivp"></param>
+    void myRK45ProblemDestroy(MwsIVPSolverObj solver, MwsIVPObj ivp)
+    {
+        MyRK45* sw = (MyRK45*)solver;
+        MyRK45Problem* spw = (MyRK45Problem*)ivp;
+
+        if (spw)
+        {
+            if (sw->m_poolCount < MY_RK45_POOL_SIZE)
+            {
+                sw->m_pool[sw->m_poolCount++] = spw;
+            }
+            else
+            {
+                myRK45ProblemFree(sw, spw);
+            }
+        }
+    }
+
+    /// <summary>
+    /// 销毁积分算法
+    /// </summary>
+    /// <param name="solver"></param>
+    void myRK45Destroy(MwsIVPSolverObj solver)
+    {
+        MyRK45* sw = (MyRK45*)solver;
+
+        if (sw)
+        {
+            while (sw->m_poolCount > 0)
+            {
+                myRK45ProblemFree(sw, sw->m_pool[--sw->m_poolCount]);
+            }
+            (*sw->m_utils.m_freeMemory)(sw->m_userData, sw);
+        }
+    }
+
+#ifdef __cplusplus
+}
+#endif
+
+
+/***************************************************************************
+//   end of file
+***************************************************************************/
+
@@ -0,0 +1,569 @@
+/***************************************************************************
+///
+/// Copyright (c) 2020, 苏州同元软控信息技术有限公司
+/// All rights reserved.
+///
+/// @file           my_abm.c
+/// @brief          变步长变阶Adams-Bashforth-Moulton（PECE，1~12阶）积分算法
+///
+/// @version        v1.0
+/// @author         田显钊
+/// @date           2020/07/07
+///
+***************************************************************************/
+
+#include "mo_types.h"
+#include "mws_ivp_solver.h"
+#include "my_ivp_common.h"
+#include "my_ivp_trace.h"
+
+#include <memory.h>
+#include <math.h>
+
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+/*
+ * 算法（思路同Shampine-Gordon的DE/STEP，系数按变步长直接计算）：
+ *  记 x_0=t_n, x_1=t_{n-1}, ...，D_j = f[x_0,...,x_j] 为f的差商（最新的点在前），
+ *  W_j = ∫_{t_n}^{t_n+H} ∏_{i<j}(s - x_i) ds，则
+ *    P: yp = y_n + Σ_{j<k} W_j*D_j                 （k阶Adams-Bashforth）
+ *    E: fp = f(t_n+H, yp)
+ *    C: y_{n+1} = yp + W_k*f[t_{n+1},x_0,...,x_{k-1}] （k+1阶Adams-Moulton）
+ *    E: f_{n+1} = f(t_{n+1}, y_{n+1})
+ *  每步只需2次右端函数计算；校正项即为k阶预估公式的局部误差估计。
+ *  阶数按相邻阶误差估计的大小升降；差商表本身就是f的插值多项式，积分后即稠密输出。
+ */
+#define MY_ABM_MAX_ORDER    12
+#define MY_ABM_MAX_GROWTH   2.0     /* 单步最大放大倍数（Adams方法对步长剧变敏感） */
+#define MY_ABM_MIN_SHRINK   0.1     /* 单步最大缩小倍数 */
+
+/* 算法对象 */
+typedef struct
+{
+    MwsIVPUtilFcns	m_utils;
+    void*           m_userData;
+
+} MyAbm;
+
+/* 求解问题的数据，用数据内存分配和释放函数 */
+typedef struct
+{
+    /* 以下向量均位于同一块连续内存中（由m_preY持有） */
+    MoReal *m_preY;         /* 上一步y */
+    MoReal *m_curY;         /* 当前y */
+    MoReal *m_yp;           /* 预估值 */
+    MoReal *m_fp;           /* 预估值处的导数 */
+    MoReal *m_diff;         /* 差商表，(MY_ABM_MAX_ORDER+2)个长度为n的向量，第j个为 D_j */
+    MoReal *m_diffNew;      /* 新差商表（接受后与m_diff交换） */
+
+    MoReal m_tHist[MY_ABM_MAX_ORDER + 2];   /* 节点 x_0=t_n, x_1=t_{n-1}, ... */
+    MoInteger m_nHist;      /* 差商表中有效点数 */
+    MoInteger m_order;      /* 当前阶数k */
+    MoInteger m_nAtOrder;   /* 当前阶数下已走的步数，满k+1步才允许升阶 */
+    MoInteger m_nFail;      /* 本步连续失败次数 */
+
+    MoReal m_curTime;
+    MoReal m_preTime;
+    MoReal m_h;             /* 下一步建议步长，0表示尚未开始积分 */
+    MoBoolean m_ypValid;    /* 差商表是否对应 (m_curTime, m_curY) */
+} MyAbmProblemData;
+
+/* 求解问题对象 */
+typedef struct
+{
+    MoSize          m_nStates;
+
+    MwsIVPOptions	m_opt;
+    MwsIVPCallback  m_callback;
+    void*			m_userData;
+    MY_IVP_TRACE_MEMBER(m_trace)
+
+    MyAbmProblemData* m_data;
+    MyAbm* m_solverWork;
+
+} MyAbmProblem;
+
+void myAbmProblemDestroy(MwsIVPSolverObj solver, MwsIVPObj ivp);
+void myAbmDestroy(MwsIVPSolverObj solver);
+
+/*
+ * 积分权重：W_j = H^(j+1) * ∫_0^x ∏_{i<j}(u - u_i) du，j=0..k，u_i = (tHist[i]-tHist[0])/H
+ * x=1 为向前一步（预估/校正），x∈[-1,0] 用于步内插值
+ */
+static void myAbmWeights(const MoReal* tHist, MoInteger k, MoReal H, MoReal x, MoReal* W)
+{
+    MoReal poly[MY_ABM_MAX_ORDER + 2];
+    MoReal Hp = H;
+    MoInteger j, m;
+
+    poly[0] = 1;
+    for (j = 0; j <= k; ++j)
+    {
+        MoReal sum = 0;
+        MoReal xp = x;
+
+        for (m = 0; m <= j; ++m)
+        {
+            sum += poly[m] * xp / (m + 1);
+            xp *= x;
+        }
+        W[j] = Hp * sum;
+        Hp *= H;
+
+        if (j < k)
+        {
+            /* poly *= (u - u_j) */
+            MoReal uj = (tHist[j] - tHist[0]) / H;
+            poly[j + 1] = poly[j];
+            for (m = j; m > 0; --m)
+            {
+                poly[m] = poly[m - 1] - uj * poly[m];
+            }
+            poly[0] = -uj * poly[0];
+        }
+    }
+}
+
+/* 以新点(tNew, fNew)为首重建差商表：dst_0 = fNew，dst_j = (dst_{j-1} - src_{j-1})/(tNew - x_{j-1}) */
+static void myAbmDiffs(MoSize n, const MoReal* tHist, MoInteger nHist, MoReal tNew, const MoReal* fNew,
+    const MoReal* src, MoReal* dst)
+{
+    MoInteger j;
+    MoSize index;
+
+    memcpy(dst, fNew, n * sizeof(MoReal));
+    for (j = 1; j <= nHist && j <= MY_ABM_MAX_ORDER + 1; ++j)
+    {
+        MoReal dt = tNew - tHist[j - 1];
+        for (index = 0; index < n; ++index)
+        {
+            dst[j * n + index] = (dst[(j - 1) * n + index] - src[(j - 1) * n + index]) / dt;
+        }
+    }
+}
+
+/* 加权均方根范数：||W*D||，权重按y的大小 */
+static MoReal myAbmTermNorm(MoSize n, MoReal W, const MoReal* D, const MoReal* y, MoReal rtol, MoReal atol)
+{
+    MoReal sum = 0;
+    MoSize index;
+
+    if (n == 0)
+    {
+        return 0;
+    }
+    for (index = 0; index < n; ++index)
+    {
+        MoReal e = W * D[index] / (atol + rtol * fabs(y[index]));
+        sum += e * e;
+    }
+    return sqrt(sum / n);
+}
+
+/// <summary>
+/// 创建算法
+/// </summary>
+/// <param name="util_fcns">工具函数（由求解器提供，用户调用）</param>
+/// <param name="user_data">用户数据（求解器内部数据，传递给工具函数util_fcns，自定义算法无需关心其内容）</param>
+/// <returns></returns>
+MwsIVPSolverObj myAbmCreate(MwsIVPUtilFcns* util_fcns, void* user_data)
+{
+    MyAbm* sw = (MyAbm*)util_fcns->m_allocMemory(user_data, 1, sizeof(MyAbm));
+
+    if (sw)
+    {
+        memset(sw, 0, sizeof(*sw));
+        sw->m_utils = *util_fcns;
+        sw->m_userData = user_data;
+    }
+
+    return sw;
+}
+
+/// <summary>
+/// 创建问题
+/// </summary>
+/// <param name="solver">积分算法对象</param>
+/// <param name="n">问题规模，即状态变量个数==微分方程阶数</param>
+/// <param name="call_back">回调函数</param>
+/// <param name="opt">求解器选项</param>
+/// <param name="ivp_user_data">用户数据(求解器内部数据，传递给回调函数call_back，算法无需关心)</param>
+/// <returns></returns>
+MwsIVPObj myAbmProblemCreate(MwsIVPSolverObj solver, MwsSize n, MwsIVPCallback* call_back, MwsIVPOptions* opt, void* ivp_user_data)
+{
+    MyAbm* sw = (MyAbm*)solver;
+    MyAbmProblem* spw = (MyAbmProblem*)sw->m_utils.m_allocMemory(sw->m_userData, 1, sizeof(MyAbmProblem));
+
+    if (spw)
+    {
+        MyAbmProblemData* ds = (MyAbmProblemData*)sw->m_utils.m_allocDataMemory(sw->m_userData, 1, sizeof(MyAbmProblemData));
+        MoSize nVec = 4 + 2 * (MY_ABM_MAX_ORDER + 2);
+
+        if (ds == mwsNullPtr)
+        {
+            sw->m_utils.m_freeMemory(sw->m_userData, spw);
+            return mwsNullPtr;
+        }
+
+        memset(spw, 0, sizeof(*spw));
+        memset(ds, 0, sizeof(*ds));
+
+        spw->m_callback = *call_back;
+        spw->m_userData = ivp_user_data;
+        MY_IVP_TRACE_INTERPOSE(&spw->m_trace, &spw->m_callback, &spw->m_userData);
+        spw->m_opt = *opt;
+        spw->m_nStates = n;
+        spw->m_data = ds;
+        spw->m_solverWork = sw;
+
+        ds->m_order = 1;
+
+        if (spw->m_nStates > 0)
+        {
+            ds->m_preY = (MoReal*)sw->m_utils.m_allocDataMemory(sw->m_userData, nVec, n * sizeof(MoReal));
+
+            if (!ds->m_preY)
+            {
+                myAbmProblemDestroy(sw, spw);
+                spw = MWnullptr;
+            }
+            else
+            {
+                ds->m_curY = ds->m_preY + n;
+                ds->m_yp = ds->m_preY + 2 * n;
+                ds->m_fp = ds->m_preY + 3 * n;
+                ds->m_diff = ds->m_preY + 4 * n;
+                ds->m_diffNew = ds->m_diff + (MY_ABM_MAX_ORDER + 2) * n;
+
+                memset(ds->m_preY, 0, nVec * n * sizeof(MoReal));
+            }
+        }
+    }
+
+    return spw;
+}
+
+/// <summary>
+/// 初始化：差商表只保留初始点，从1阶重新起步
+/// </summary>
+/// <param name="solver">积分算法对象</param>
+/// <param name="ivp">问题对象</param>
+/// <param name="t0">初始时间</param>
+/// <param name="y0">y的初始值（特定不为空）</param>
+/// <param name="yp0">y’的初始值（DAE）</param>
+/// <param name="is_reinit">是否重新初始化（保留）：多步法的历史全部失效，同样从1阶起步</param>
+/// <param name="reserve">保留参数，暂不使用</param>
+/// <returns></returns>
+MwsInteger myAbmInit(MwsIVPSolverObj solver, MwsIVPObj ivp, MwsReal t0, const MwsReal* y0,
+    const MwsReal* yp0, MwsBoolean is_reinit, void* reserve)
+{
+    MyAbmProblem* spw = (MyAbmProblem*)ivp;
+    MyAbmProblemData* ds = spw->m_data;
+    MoSize nState = spw->m_nStates;
+
+    ds->m_curTime = t0;
+    ds->m_preTime = t0;
+    ds->m_tHist[0] = t0;
+    ds->m_nHist = 1;
+    ds->m_order = 1;
+    ds->m_nAtOrder = 0;
+    ds->m_nFail = 0;
+    ds->m_h = 0;
+    ds->m_ypValid = moFalse;
+
+    if (nState == 0 || y0 == mwsNullPtr)
+    {
+        return MWS_IVP_SUCCESS;
+    }
+
+    memcpy(ds->m_curY, y0, nState * sizeof(MoReal));
+    memcpy(ds->m_preY, y0, nState * sizeof(MoReal));
+    if (spw->m_callback.m_rshFunction(spw->m_userData, t0, ds->m_curY, ds->m_diff) != MWS_IVP_SUCCESS)
+    {
+        return MWS_IVP_RHSFN_FAIL;
+    }
+    ds->m_ypValid = moTrue;
+
+    return MWS_IVP_SUCCESS;
+}
+
+/// <summary>
+/// 求解：每次调用前进一个被接受的积分步
+/// </summary>
+/// 输入：
+/// <param name="solver">积分算法对象</param>
+/// <param name="ivp">问题对象</param>
+/// <param name="step_size">初始积分步长（仅首步使用，<=0时自动选择）</param>
+/// <param name="t">当前时间</param>
+/// <param name="tout">输出结果时间</param>
+/// 输出：
+/// <param name="tret">结果实际达到的时间</param>
+/// <param name="yret">y的结果值（输入为当前y，与上一步结果不一致时按重新初始化处理）</param>
+/// <param name="ypret">y’的结果值（可为空）</param>
+/// <param name="reserve">保留参数，暂不使用</param>
+/// <returns></returns>
+MwsInteger myAbmSolve(MwsIVPSolverObj solver, MwsIVPObj ivp, MwsReal step_size, MwsReal t,
+    MwsReal tout, MwsReal* tret, MwsReal* yret, MwsReal* ypret, void* reserve)
+{
+    MyAbmProblem* spw = (MyAbmProblem*)ivp;
+    MyAbmProblemData* ds = spw->m_data;
+
+    MoSize n = spw->m_nStates;
+    MoSize index;
+    MoInteger j, k;
+    MoReal W[MY_ABM_MAX_ORDER + 2];
+    MoReal rtol = myIVPRelTol(&spw->m_opt);
+    MoReal atol = myIVPAbsTol(&spw->m_opt);
+    MoReal H = ds->m_h;
+    MoReal errK, errKm1, errKp1, factor;
+    MoReal* tmp;
+
+    if (spw->m_opt.m_stopTimeDefined && t >= spw->m_opt.m_stopTime)
+    {
+        *tret = t;
+        return MWS_IVP_TSTOP_RETURN;
+    }
+
+    /* 外部改动了状态或时间：历史失效，从当前点重新起步 */
+    if (!ds->m_ypValid || t != ds->m_curTime || (n > 0 && memcmp(yret, ds->m_curY, n * sizeof(MoReal)) != 0))
+    {
+        MwsInteger status = myAbmInit(solver, ivp, t, yret, mwsNullPtr, moFalse, mwsNullPtr);
+        if (status != MWS_IVP_SUCCESS)
+        {
+            return status;
+        }
+        H = 0;
+    }
+
+    if (H <= 0)
+    {
+        H = step_size;
+        if (H <= 0 && myIVPInitialStep(&spw->m_callback, spw->m_userData, n, t, ds->m_curY, ds->m_diff, rtol, atol, 1,
+            myIVPMaxStep(&spw->m_opt), ds->m_yp, ds->m_fp, &H) != MWS_IVP_SUCCESS)
+        {
+            return MWS_IVP_RHSFN_FAIL;
+        }
+    }
+
+    ds->m_nFail = 0;
+    for (;;)
+    {
+        MY_IVP_TRACE_BEGIN(attempt)
+
+        k = ds->m_order;
+        H = myIVPClampStep(&spw->m_opt, t, H);
+        if (H < myIVPMinStep(t))
+        {
+            return MWS_IVP_FAIL;    /* 步长过小 */
+        }
+
+        /* P：k阶预估 */
+        myAbmWeights(ds->m_tHist, k, H, 1.0, W);
+        for (index = 0; index < n; ++index)
+        {
+            MoReal sum = 0;
+            for (j = 0; j < k; ++j)
+            {
+                sum += W[j] * ds->m_diff[j * n + index];
+            }
+            ds->m_yp[index] = ds->m_curY[index] + sum;
+        }
+
+        /* E：预估点导数，并以其为首构造新差商 */
+        if (n > 0 && spw->m_callback.m_rshFunction(spw->m_userData, t + H, ds->m_yp, ds->m_fp) != MWS_IVP_SUCCESS)
+        {
+            return MWS_IVP_RHSFN_FAIL;
+        }
+        myAbmDiffs(n, ds->m_tHist, k, t + H, ds->m_fp, ds->m_diff, ds->m_diffNew);
+
+        /* 校正项 W_k*f[t_{n+1},x_0..x_{k-1}] 即局部误差估计 */
+        errK = myAbmTermNorm(n, W[k], ds->m_diffNew + k * n, ds->m_curY, rtol, atol);
+        if (!(errK <= HUGE_VAL))
+        {
+            errK = HUGE_VAL;    /* nan按失败处理 */
+        }
+        if (errK <= 1)
+        {
+            MY_IVP_TRACE_END(MY_IVP_TRACE_STEP, attempt);
+            break;
+        }
+
+        /* 失败：缩小步长，连续失败时降阶，三次以上退到1阶 */
+        ++ds->m_nFail;
+        factor = MY_IVP_SAFETY * pow(errK, -1.0 / (k + 1));
+        H *= factor < MY_ABM_MIN_SHRINK ? MY_ABM_MIN_SHRINK : (factor > 0.5 ? 0.5 : factor);
+        if (ds->m_nFail >= 3)
+        {
+            ds->m_order = 1;
+        }
+        else if (ds->m_nFail >= 2 && ds->m_order > 1)
+        {
+            --ds->m_order;
+        }
+        ds->m_nAtOrder = 0;
+        MY_IVP_TRACE_END(MY_IVP_TRACE_REJECT, attempt);
+    }
+
+    /* C：k+1阶校正 */
+    memcpy(ds->m_preY, ds->m_curY, n * sizeof(MoReal));
+    for (index = 0; index < n; ++index)
+    {
+        ds->m_curY[index] = ds->m_yp[index] + W[k] * ds->m_diffNew[k * n + index];
+    }
+
+    /* E：校正值导数，重建差商表并推进历史节点 */
+    if (n > 0 && spw->m_callback.m_rshFunction(spw->m_userData, t + H, ds->m_curY, ds->m_fp) != MWS_IVP_SUCCESS)
+    {
+        return MWS_IVP_RHSFN_FAIL;
+    }
+    myAbmDiffs(n, ds->m_tHist, ds->m_nHist, t + H, ds->m_fp, ds->m_diff, ds->m_diffNew);
+    tmp = ds->m_diff;
+    ds->m_diff = ds->m_diffNew;
+    ds->m_diffNew = tmp;
+    for (j = (ds->m_nHist < MY_ABM_MAX_ORDER + 1 ? ds->m_nHist : MY_ABM_MAX_ORDER + 1); j > 0; --j)
+    {
+        ds->m_tHist[j] = ds->m_tHist[j - 1];
+    }
+    ds->m_tHist[0] = t + H;
+    if (ds->m_nHist < MY_ABM_MAX_ORDER + 2)
+    {
+        ++ds->m_nHist;
+    }
+    ++ds->m_nAtOrder;
+
+    /* 选阶：比较k-1、k、k+1阶的误差项 W_q*f[t_{n+1},...,t_{n+1-q}] */
+    errK = myAbmTermNorm(n, W[k], ds->m_diff + k * n, ds->m_curY, rtol, atol);
+    errKm1 = k > 1 ? myAbmTermNorm(n, W[k - 1], ds->m_diff + (k - 1) * n, ds->m_curY, rtol, atol) : HUGE_VAL;
+    errKp1 = HUGE_VAL;
+    if (k < MY_ABM_MAX_ORDER && k + 1 < ds->m_nHist && ds->m_nAtOrder > k)
+    {
+        myAbmWeights(ds->m_tHist + 1, k + 1, H, 1.0, W);
+        errKp1 = myAbmTermNorm(n, W[k + 1], ds->m_diff + (k + 1) * n, ds->m_curY, rtol, atol);
+    }
+    if (errKm1 <= errK)
+    {
+        --ds->m_order;
+        ds->m_nAtOrder = 0;
+        errK = errKm1;
+    }
+    else if (errKp1 < errK)
+    {
+        ++ds->m_order;
+        ds->m_nAtOrder = 0;
+        errK = errKp1;
+    }
+
+    factor = errK > 0 ? MY_IVP_SAFETY * pow(errK, -1.0 / (ds->m_order + 1)) : MY_ABM_MAX_GROWTH;
+    if (ds->m_nFail > 0 && factor > 1)
+    {
+        factor = 1;     /* 刚失败过的步不放大 */
+    }
+    factor = factor > MY_ABM_MAX_GROWTH ? MY_ABM_MAX_GROWTH : (factor < MY_ABM_MIN_SHRINK ? MY_ABM_MIN_SHRINK : factor);
+
+    ds->m_preTime = t;
+    ds->m_curTime = t + H;
+    ds->m_h = H * factor;
+    ds->m_ypValid = moTrue;
+
+    memcpy(yret, ds->m_curY, n * sizeof(MoReal));
+    if (ypret)
+    {
+        memcpy(ypret, ds->m_diff, n * sizeof(MoReal));
+    }
+    *tret = ds->m_curTime;
+
+    return MWS_IVP_SUCCESS;
+}
+
+/// <summary>
+/// 插值：对差商表表示的f插值多项式积分，y(t) = y_{n+1} + ∫_{t_{n+1}}^{t} p(s) ds
+/// </summary>
+/// 输入：
+/// <param name="solver">积分算法对象</param>
+/// <param name="ivp">问题对象</param>
+/// <param name="tout">输出结果的时间</param>
+/// 输出：
+/// <param name="yret">y的结果值</param>
+/// <param name="reserve"></param>
+/// <returns></returns>
+MwsInteger myAbmInterpolate(MwsIVPSolverObj solver, MwsIVPObj ivp, MwsReal tout, MwsReal* yret, void* reserve)
+{
+    MyAbmProblem* spw = (MyAbmProblem*)ivp;
+    MyAbmProblemData* ds = spw->m_data;
+    MoSize n = spw->m_nStates;
+    MoSize index;
+    MoInteger j;
+    MoInteger k = ds->m_order < ds->m_nHist - 1 ? ds->m_order : ds->m_nHist - 1;
+    MoReal W[MY_ABM_MAX_ORDER + 2];
+    MoReal H = ds->m_curTime - ds->m_preTime;
+
+    if (H == 0 || k < 1)
+    {
+        memcpy(yret, ds->m_curY, n * sizeof(MoReal));
+        return MWS_IVP_SUCCESS;
+    }
+
+    myAbmWeights(ds->m_tHist, k, H, (tout - ds->m_curTime) / H, W);
+    for (index = 0; index < n; ++index)
+    {
+        MoReal sum = 0;
+        for (j = 0; j <= k; ++j)
+        {
+            sum += W[j] * ds->m_diff[j * n + index];
+        }
+        yret[index] = ds->m_curY[index] + sum;
+    }
+
+    return MWS_IVP_SUCCESS;
+}
+
+/// <summary>
+/// 销毁问题
+/// </summary>
+/// <param name="solver"></param>
+/// <param name="ivp"></param>
+void myAbmProblemDestroy(MwsIVPSolverObj solver, MwsIVPObj ivp)
+{
+    MyAbm* sw = (MyAbm*)solver;
+    MyAbmProblem* spw = (MyAbmProblem*)ivp;
+
+    if (spw)
+    {
+        if (spw->m_data->m_preY)
+        {
+            (*sw->m_utils.m_freeDataMemory)(sw->m_userData, spw->m_data->m_preY);
+        }
+
+        if (spw->m_data)
+        {
+            (*sw->m_utils.m_freeDataMemory)(sw->m_userData, spw->m_data);
+        }
+
+        (*sw->m_utils.m_freeMemory)(sw->m_userData, spw);
+    }
+}
+
+/// <summary>
+/// 销毁积分算法
+/// </summary>
+/// <param name="solver"></param>
+void myAbmDestroy(MwsIVPSolverObj solver)
+{
+    MyAbm* sw = (MyAbm*)solver;
+
+    if (sw)
+    {
+        (*sw->m_utils.m_freeMemory)(sw->m_userData, sw);
+    }
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+
+/***************************************************************************
+//   end of file
+***************************************************************************/
@@ -0,0 +1,1041 @@
+/***************************************************************************
+///
+/// Copyright (c) 2020, 苏州同元软控信息技术有限公司
+/// All rights reserved.
+///
+/// @file           my_auto.c
+/// @brief          自动选择积分算法：按规模、容许误差与刚性探测结果转交给预计最快的算法
+///
+/// @version        v1.0
+/// @author         田显钊
+/// @date           2020/07/07
+///
+***************************************************************************/
+
+/* -std=c99/c11 等严格模式下 <time.h> 不声明 clock_gettime，须在包含任何系统头文件前打开POSIX接口 */
+#if !defined(_WIN32) && defined(__STRICT_ANSI__) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 199309L
+#endif
+
+#include "mo_types.h"
+#include "mws_ivp_solver.h"
+#include "my_ivp_common.h"
+#include "my_ivp_trace.h"
+
+#include <memory.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <limits.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+/*
+ * 选择规则（首次初始化时在 (t0,y0) 处探测一次，重新初始化沿用已选的算法）：
+ *  1. 刚性探测：先用 myBS23 从 (t0,y0) 试积分 MY_AUTO_PROBE_STEPS 步（越过初始的快速过渡段），
+ *     再在到达点用幂迭代估计Jacobian的谱半径rho（有 m_jacFunction 时用解析Jacobian，否则用右端函数差商
+ *     计算 J*v）。myBS23 的实轴稳定区间约为2.5，试积分末步的 h*rho 接近它说明步长受稳定性而非精度限制；
+ *     h*rho > MY_AUTO_STIFF_HRHO 且整个区间内 rho*(tEnd-t0) 足够大时判为刚性。
+ *  2. 非刚性：相对容许误差 >= 1e-4 用 myBS23；< 1e-8 用 myDOP853；
+ *     其余规模 n >= MY_AUTO_LARGE_N 时用 myABM（每步约2次右端函数，右端函数代价随n增长时最省），
+ *     否则用 myRK45（Dormand-Prince 5(4)）。
+ *  3. 刚性：选 myEXPRB（指数Rosenbrock，线性部分由φ函数精确积分，步长不受 h*rho 限制），并通过日志提示；
+ *     它只在刚性主要来自线性（或可线性化的）部分时高效，非线性强刚性问题仍需隐式算法。
+ * 各候选算法由下表引用，本文件须在这些算法的源文件之后包含。
+ *
+ * 自动调优（myAutoSetTuning）：同一模型反复运行时，首次初始化改为实测——在 (t0,y0) 起的一段短区间上
+ * 用各候选算法及若干组步长控制器参数（见 s_myAutoTuneGrid）试积分，与收紧100倍容许误差的 myDOP853
+ * 参考解比较，误差范数不超过 MY_AUTO_TUNE_ERR_LIMIT 的配置中取耗时最短者（参考解本身耗时过短、计时
+ * 不可靠时改比右端函数次数）。结果按模型指纹（n、回调函数地址或调用方给的模型标识、积分器选项）
+ * 追加到缓存文件，之后再遇到同一指纹直接采用缓存的配置，不再试积分。刚性问题不调优，按规则3选择并缓存。
+ */
+#define MY_AUTO_PROBE_STEPS     20      /* 试积分步数 */
+#define MY_AUTO_PROBE_ITERS     12      /* 幂迭代次数 */
+#define MY_AUTO_STIFF_HRHO      1.5
+#define MY_AUTO_STIFF_SPAN      1000.0  /* rho*(tEnd-t0) 低于此值时即使刚性，显式方法的步数也可接受 */
+#define MY_AUTO_LARGE_N         500
+#define MY_AUTO_JAC_MAX_N       200     /* 超过此规模不分配稠密Jacobian，改用差商 */
+#define MY_AUTO_TUNE_STEPS      200     /* 调优区间长度：试积分末步步长的倍数 */
+#define MY_AUTO_TUNE_ERR_LIMIT  10.0    /* 调优区间末点相对参考解的误差范数上限 */
+#define MY_AUTO_TUNE_REF_TOL    0.01    /* 参考解的容许误差倍数 */
+#define MY_AUTO_TUNE_MIN_NS     200000  /* 参考解耗时低于此值（ns）时按右端函数次数比较 */
+#define MY_AUTO_PATH_MAX        260
+
+/* 候选算法，下标即 MyAutoChoice */
+typedef enum
+{
+    MY_AUTO_BS23 = 0,
+    MY_AUTO_RK45,
+    MY_AUTO_DOP853,
+    MY_AUTO_ABM,
+    MY_AUTO_EXPRB,          /* 只用于刚性问题，不参与非刚性调优 */
+    MY_AUTO_CHOICE_COUNT
+} MyAutoChoice;
+
+/* 设置步长控制器参数，与 myRK45SetController 等同型 */
+typedef MwsInteger (*MyAutoSetControllerPtr)(MwsIVPSolverObj solver, MwsIVPObj ivp, const MyIVPController* ctl);
+
+typedef struct
+{
+    MwsString m_name;
+    MwsIVPSolverFcns m_fcns;
+    MyAutoSetControllerPtr m_setController;     /* 为空表示控制器不可调，只用默认参数 */
+} MyAutoCandidate;
+
+static const MyAutoCandidate s_myAutoCandidates[MY_AUTO_CHOICE_COUNT] =
+{
+    { "myBS23", { &myBs23Create, &myBs23ProblemCreate, &myBs23Init, &myBs23Solve, &myBs23Interpolate,
+        &myBs23ProblemDestroy, &myBs23Destroy }, &myBs23SetController },
+    { "myRK45", { &myRK45Create, &myRK45ProblemCreate, &myRK45Init, &myRK45Solve, &myRK45Interpolate,
+        &myRK45ProblemDestroy, &myRK45Destroy }, &myRK45SetController },
+    { "myDOP853", { &myDop853Create, &myDop853ProblemCreate, &myDop853Init, &myDop853Solve, &myDop853Interpolate,
+        &myDop853ProblemDestroy, &myDop853Destroy }, &myDop853SetController },
+    { "myABM", { &myAbmCreate, &myAbmProblemCreate, &myAbmInit, &myAbmSolve, &myAbmInterpolate,
+        &myAbmProblemDestroy, &myAbmDestroy }, mwsNullPtr },
+    { "myEXPRB", { &myExprbCreate, &myExprbProblemCreate, &myExprbInit, &myExprbSolve, &myExprbInterpolate,
+        &myExprbProblemDestroy, &myExprbDestroy }, &myExprbSetController },
+};
+
+/* 调优时搜索的控制器参数，第1组为默认值 */
+static const MyIVPController s_myAutoTuneGrid[] =
+{
+    MY_IVP_CONTROLLER_DEFAULT,
+    { 0.8, MY_IVP_MIN_FACTOR, MY_IVP_MAX_FACTOR },
+    { 0.95, MY_IVP_MIN_FACTOR, MY_IVP_MAX_FACTOR },
+    { 0.9, MY_IVP_MIN_FACTOR, 5.0 },
+    { 0.9, MY_IVP_MIN_FACTOR, 2.0 },
+    { 0.8, 0.1, 5.0 },
+};
+
+#define MY_AUTO_TUNE_GRID_SIZE  (sizeof(s_myAutoTuneGrid) / sizeof(s_myAutoTuneGrid[0]))
+
+/* 刚性探测结果 */
+typedef struct
+{
+    MoReal m_rho;           /* 谱半径估计 */
+    MoReal m_h;             /* 试积分末步的步长 */
+    MoBoolean m_stiff;
+} MyAutoProbe;
+
+/* 算法对象 */
+typedef struct
+{
+    MwsIVPUtilFcns	m_utils;
+    void*           m_userData;
+
+} MyAuto;
+
+/* 求解问题的数据，用数据内存分配和释放函数 */
+typedef struct
+{
+    MoInteger m_choice;             /* 已选的候选算法，-1表示尚未选择 */
+    MwsIVPSolverObj m_innerSolver;
+    MwsIVPObj m_innerIvp;
+    MyAutoProbe m_probe;
+    MyIVPController m_ctl;          /* 已选算法使用的控制器参数 */
+
+    MoBoolean m_tune;               /* 是否自动调优 */
+    MoBoolean m_cached;             /* 本次的配置是否取自缓存 */
+    unsigned long long m_fingerprint;
+    char m_cachePath[MY_AUTO_PATH_MAX];
+
+    MoReal *m_work;                 /* 探测用 f0|y|f|v|试积分的y，长度5n */
+} MyAutoProblemData;
+
+/* 调优试积分时包装右端函数，统计调用次数 */
+typedef struct
+{
+    const MwsIVPCallback* m_callback;
+    void* m_userData;
+    long m_count;
+    long m_limit;                   /* 超过时返回失败，中止明显更慢的配置 */
+} MyAutoCounter;
+
+/* 求解问题对象 */
+typedef struct
+{
+    MoSize          m_nStates;
+
+    MwsIVPOptions	m_opt;
+    MwsIVPCallback  m_callback;
+    void*			m_userData;
+    MY_IVP_TRACE_MEMBER(m_trace)
+
+    MyAutoProblemData* m_data;
+    MyAuto* m_solverWork;
+
+} MyAutoProblem;
+
+void myAutoProblemDestroy(MwsIVPSolverObj solver, MwsIVPObj ivp);
+void myAutoDestroy(MwsIVPSolverObj solver);
+MwsInteger myAutoSetTuning(MwsIVPSolverObj solver, MwsIVPObj ivp, MwsString cache_path, MwsString model_key);
+
+/* 释放已选算法的问题对象与算法对象 */
+static void myAutoFreeInner(MyAutoProblemData* ds)
+{
+    if (ds->m_choice >= 0)
+    {
+        const MwsIVPSolverFcns* fcns = &s_myAutoCandidates[ds->m_choice].m_fcns;
+        if (ds->m_innerIvp)
+        {
+            fcns->m_destroyPBPtr(ds->m_innerSolver, ds->m_innerIvp);
+        }
+        if (ds->m_innerSolver)
+        {
+            fcns->m_destroyPtr(ds->m_innerSolver);
+        }
+    }
+    ds->m_choice = -1;
+    ds->m_innerSolver = mwsNullPtr;
+    ds->m_innerIvp = mwsNullPtr;
+}
+
+/* 向量2范数 */
+static MoReal myAutoNorm(MoSize n, const MoReal* v)
+{
+    MoReal sum = 0;
+    MoSize index;
+
+    for (index = 0; index < n; ++index)
+    {
+        sum += v[index] * v[index];
+    }
+    return sqrt(sum);
+}
+
+/*
+ * 幂迭代估计 (t0,y0) 处Jacobian的谱半径
+ * @return 状态，取MwsIVPStatus的值
+ */
+static MwsInteger myAutoSpectralRadius(MyAuto* sw, MyAutoProblem* spw, MoReal t0, const MoReal* y0, MoReal* rho)
+{
+    MyAutoProblemData* ds = spw->m_data;
+    MoSize n = spw->m_nStates;
+    MoReal* f0 = ds->m_work;
+    MoReal* y = ds->m_work + n;
+    MoReal* f = ds->m_work + 2 * n;
+    MoReal* v = ds->m_work + 3 * n;
+    MoReal* jac = mwsNullPtr;
+    MoReal normY = myAutoNorm(n, y0);
+    MoSize index, col;
+    MoInteger iter;
+
+    *rho = 0;
+
+    if (spw->m_callback.m_rshFunction(spw->m_userData, t0, y0, f0) != MWS_IVP_SUCCESS)
+    {
+        return MWS_IVP_RHSFN_FAIL;
+    }
+
+    /* 有解析Jacobian且规模不大时取稠密矩阵（按列或按行存储都不影响谱半径） */
+    if (spw->m_callback.m_jacFunction && n <= MY_AUTO_JAC_MAX_N)
+    {
+        jac = (MoReal*)sw->m_utils.m_allocDataMemory(sw->m_userData, n * n, sizeof(MoReal));
+        if (jac && spw->m_callback.m_jacFunction(spw->m_userData, t0, y0, mwsNullPtr, 0, jac) != MWS_IVP_SUCCESS)
+        {
+            sw->m_utils.m_freeDataMemory(sw->m_userData, jac);
+            jac = mwsNullPtr;
+        }
+    }
+
+    /* 起始向量取各分量不同的值，避免恰好与主特征向量正交 */
+    for (index = 0; index < n; ++index)
+    {
+        v[index] = 1.0 + (MoReal)index / n;
+    }
+
+    for (iter = 0; iter < MY_AUTO_PROBE_ITERS; ++iter)
+    {
+        MoReal normV = myAutoNorm(n, v);
+        MoReal normJv;
+
+        if (normV == 0)
+        {
+            break;
+        }
+        for (index = 0; index < n; ++index)
+        {
+            v[index] /= normV;
+        }
+
+        if (jac)
+        {
+            for (index = 0; index < n; ++index)
+            {
+                f[index] = 0;
+            }
+            for (col = 0; col < n; ++col)
+            {
+                for (index = 0; index < n; ++index)
+                {
+                    f[index] += jac[col * n + index] * v[col];
+                }
+            }
+        }
+        else
+        {
+            MoReal eps = sqrt(2.2e-16) * (1 + normY);
+            for (index = 0; index < n; ++index)
+            {
+                y[index] = y0[index] + eps * v[index];
+            }
+            if (spw->m_callback.m_rshFunction(spw->m_userData, t0, y, f) != MWS_IVP_SUCCESS)
+            {
+                return MWS_IVP_RHSFN_FAIL;
+            }
+            for (index = 0; index < n; ++index)
+            {
+                f[index] = (f[index] - f0[index]) / eps;
+            }
+        }
+
+        normJv = myAutoNorm(n, f);
+        if (!(normJv <= HUGE_VAL))
+        {
+            break;
+        }
+        *rho = normJv;
+        memcpy(v, f, n * sizeof(MoReal));
+    }
+
+    if (jac)
+    {
+        sw->m_utils.m_freeDataMemory(sw->m_userData, jac);
+    }
+    return MWS_IVP_SUCCESS;
+}
+
+/*
+ * 用 myBS23 从 (t0,y0) 试积分至多 MY_AUTO_PROBE_STEPS 步，到达点写入 yProbe
+ * @return 状态，取MwsIVPStatus的值
+ */
+static MwsInteger myAutoProbeRun(MyAuto* sw, MyAutoProblem* spw, MoReal t0, const MoReal* y0, MoReal* yProbe,
+    MoReal* tProbe, MoReal* hProbe)
+{
+    const MwsIVPSolverFcns* fcns = &s_myAutoCandidates[MY_AUTO_BS23].m_fcns;
+    MwsIVPSolverObj solver = fcns->m_createPtr(&sw->m_utils, sw->m_userData);
+    MwsIVPObj ivp = solver ? fcns->m_createPBPtr(solver, spw->m_nStates, &spw->m_callback, &spw->m_opt,
+        spw->m_userData) : mwsNullPtr;
+    MoReal t = t0, tret = t0;
+    MoInteger step;
+    MwsInteger status = MWS_IVP_MEM_FAIL;
+
+    *tProbe = t0;
+    *hProbe = 0;
+    memcpy(yProbe, y0, spw->m_nStates * sizeof(MoReal));
+
+    if (ivp)
+    {
+        status = fcns->m_initPtr(solver, ivp, t0, y0, mwsNullPtr, moFalse, mwsNullPtr);
+        for (step = 0; step < MY_AUTO_PROBE_STEPS && status == MWS_IVP_SUCCESS; ++step)
+        {
+            status = fcns->m_solvePtr(solver, ivp, 0, t, t, &tret, yProbe, mwsNullPtr, mwsNullPtr);
+            if (status == MWS_IVP_SUCCESS)
+            {
+                *hProbe = tret - t;
+                *tProbe = tret;
+                t = tret;
+            }
+        }
+        if (status == MWS_IVP_TSTOP_RETURN)
+        {
+            status = MWS_IVP_SUCCESS;   /* 区间比试积分还短 */
+        }
+        fcns->m_destroyPBPtr(solver, ivp);
+    }
+    if (solver)
+    {
+        fcns->m_destroyPtr(solver);
+    }
+    return status;
+}
+
+/*
+ * 刚性探测并按选择规则决定候选算法
+ * @return 状态，取MwsIVPStatus的值
+ */
+static MwsInteger myAutoSelect(MyAuto* sw, MyAutoProblem* spw, MoReal t0, const MoReal* y0, MoInteger* choice)
+{
+    MyAutoProblemData* ds = spw->m_data;
+    MyAutoProbe* probe = &ds->m_probe;
+    MoSize n = spw->m_nStates;
+    MoReal rtol = myIVPRelTol(&spw->m_opt);
+    MoReal tProbe;
+    MoReal span = spw->m_opt.m_stopTimeDefined ? spw->m_opt.m_stopTime - t0 : HUGE_VAL;
+    MwsInteger status;
+
+    memset(probe, 0, sizeof(*probe));
+
+    if (n > 0)
+    {
+        status = myAutoProbeRun(sw, spw, t0, y0, ds->m_work + 4 * n, &tProbe, &probe->m_h);
+        if (status == MWS_IVP_SUCCESS)
+        {
+            status = myAutoSpectralRadius(sw, spw, tProbe, ds->m_work + 4 * n, &probe->m_rho);
+        }
+        if (status != MWS_IVP_SUCCESS)
+        {
+            return status;
+        }
+        probe->m_stiff = probe->m_h * probe->m_rho > MY_AUTO_STIFF_HRHO && probe->m_rho * span > MY_AUTO_STIFF_SPAN;
+    }
+
+    if (probe->m_stiff)
+    {
+        *choice = MY_AUTO_EXPRB;
+        if (sw->m_utils.m_logger)
+        {
+            char msg[160];
+            sprintf(msg, "stiff problem detected (rho %.3g, h*rho %.3g), using %s",
+                probe->m_rho, probe->m_h * probe->m_rho, s_myAutoCandidates[*choice].m_name);
+            sw->m_utils.m_logger(sw->m_userData, MWS_IVP_WARNING, "myAutoInit", msg);
+        }
+    }
+    else if (rtol >= 1e-4)
+    {
+        *choice = MY_AUTO_BS23;
+    }
+    else if (rtol < 1e-8)
+    {
+        *choice = MY_AUTO_DOP853;
+    }
+    else if (n >= MY_AUTO_LARGE_N)
+    {
+        *choice = MY_AUTO_ABM;
+    }
+    else
+    {
+        *choice = MY_AUTO_RK45;
+    }
+
+    return MWS_IVP_SUCCESS;
+}
+
+/* 单调时钟(ns) */
+static unsigned long long myAutoNowNs(void)
+{
+#ifdef _WIN32
+    static LARGE_INTEGER freq;
+    LARGE_INTEGER cnt;
+    if (freq.QuadPart == 0)
+    {
+        QueryPerformanceFrequency(&freq);
+    }
+    QueryPerformanceCounter(&cnt);
+    return (unsigned long long)((double)cnt.QuadPart * 1e9 / (double)freq.QuadPart);
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long)ts.tv_sec * 1000000000ULL + (unsigned long long)ts.tv_nsec;
+#endif
+}
+
+/* 计数的右端函数，user_data 为 MyAutoCounter */
+static MwsInteger myAutoCountRhs(void* user_data, MwsReal t, const MwsReal* y, MwsReal* yp)
+{
+    MyAutoCounter* counter = (MyAutoCounter*)user_data;
+
+    if (++counter->m_count > counter->m_limit)
+    {
+        return MWS_IVP_RHSFN_FAIL;
+    }
+    return counter->m_callback->m_rshFunction(counter->m_userData, t, y, yp);
+}
+
+/* FNV-1a 散列 */
+static unsigned long long myAutoHash(unsigned long long hash, const void* data, MoSize size)
+{
+    const unsigned char* bytes = (const unsigned char*)data;
+    MoSize index;
+
+    for (index = 0; index < size; ++index)
+    {
+        hash = (hash ^ bytes[index]) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+/*
+ * 模型指纹：n、模型标识（为空时取回调函数地址）与积分器选项
+ * 回调函数地址只在同一进程、或模型库每次加载到相同地址时稳定，跨进程复用缓存时应给出模型标识
+ */
+static unsigned long long myAutoFingerprint(const MyAutoProblem* spw, MwsString model_key)
+{
+    const MwsIVPOptions* opt = &spw->m_opt;
+    unsigned long long hash = 14695981039346656037ULL;
+    MoReal rtol = myIVPRelTol(opt);
+    MoReal atol = myIVPAbsTol(opt);
+    MoReal hmax = myIVPMaxStep(opt);
+    MoReal tStop = opt->m_stopTimeDefined ? opt->m_stopTime : HUGE_VAL;
+
+    hash = myAutoHash(hash, &spw->m_nStates, sizeof(spw->m_nStates));
+    if (model_key)
+    {
+        hash = myAutoHash(hash, model_key, strlen(model_key));
+    }
+    else
+    {
+        const MwsIVPCallback* cb = MY_IVP_TRACE_CALLBACK(&spw->m_callback, spw->m_userData);   /* 跟踪包装前的模型回调 */
+
+        hash = myAutoHash(hash, &cb->m_rshFunction, sizeof(cb->m_rshFunction));
+        hash = myAutoHash(hash, &cb->m_jacFunction, sizeof(cb->m_jacFunction));
+    }
+    hash = myAutoHash(hash, &rtol, sizeof(rtol));
+    hash = myAutoHash(hash, &atol, sizeof(atol));
+    hash = myAutoHash(hash, &hmax, sizeof(hmax));
+    hash = myAutoHash(hash, &tStop, sizeof(tStop));
+    return hash;
+}
+
+/*
+ * 在缓存文件中查找指纹，同一指纹有多条记录时以最后一条为准
+ * 每行格式：指纹(16位十六进制) 算法名 安全因子 最小倍数 最大倍数 右端函数次数 耗时(ns)，#开头为注释
+ * @return 是否找到
+ */
+static MoBoolean myAutoCacheLookup(const MyAutoProblemData* ds, MoInteger* choice, MyIVPController* ctl)
+{
+    FILE* file = fopen(ds->m_cachePath, "r");
+    char line[256];
+    MoBoolean found = moFalse;
+
+    if (!file)
+    {
+        return moFalse;
+    }
+    while (fgets(line, sizeof(line), file))
+    {
+        unsigned long long fingerprint;
+        char name[64];
+        MyIVPController c;
+        MoInteger index;
+
+        if (line[0] == '#' || sscanf(line, "%llx %63s %lf %lf %lf", &fingerprint, name, &c.m_safety,
+            &c.m_minFactor, &c.m_maxFactor) != 5 || fingerprint != ds->m_fingerprint || !myIVPControllerValid(&c))
+        {
+            continue;
+        }
+        for (index = 0; index < MY_AUTO_CHOICE_COUNT; ++index)
+        {
+            if (strcmp(name, s_myAutoCandidates[index].m_name) == 0)
+            {
+                *choice = index;
+                *ctl = c;
+                found = moTrue;
+            }
+        }
+    }
+    fclose(file);
+    return found;
+}
+
+/* 追加一条缓存记录，文件不可写时只影响下次是否重新调优 */
+static void myAutoCacheStore(MyAuto* sw, const MyAutoProblemData* ds, MoInteger choice, const MyIVPController* ctl,
+    long rhs, unsigned long long ns)
+{
+    FILE* file = fopen(ds->m_cachePath, "a");
+
+    if (!file)
+    {
+        if (sw->m_utils.m_logger)
+        {
+            sw->m_utils.m_logger(sw->m_userData, MWS_IVP_WARNING, "myAutoInit", "cannot write tuning cache");
+        }
+        return;
+    }
+    fprintf(file, "%016llx %s %.17g %.17g %.17g %ld %llu\n", ds->m_fingerprint, s_myAutoCandidates[choice].m_name,
+        ctl->m_safety, ctl->m_minFactor, ctl->m_maxFactor, rhs, ns);
+    fclose(file);
+}
+
+/*
+ * 用候选算法与控制器参数从 (t0,y0) 积分到 tEnd，末点写入 yEnd
+ * @param[in] tol_scale  容许误差倍数（参考解用）
+ * @return 状态，取MwsIVPStatus的值；右端函数次数超过 limit 时返回 MWS_IVP_RHSFN_FAIL
+ */
+static MwsInteger myAutoTrial(MyAuto* sw, MyAutoProblem* spw, MoInteger choice, const MyIVPController* ctl,
+    MoReal tol_scale, MoReal t0, const MoReal* y0, MoReal tEnd, MoReal* yEnd, long limit, long* rhs,
+    unsigned long long* ns)
+{
+    const MyAutoCandidate* cand = &s_myAutoCandidates[choice];
+    MyAutoCounter counter = { &spw->m_callback, spw->m_userData, 0, limit };
+    MwsIVPCallback callback = { &myAutoCountRhs, mwsNullPtr, mwsNullPtr, mwsNullPtr };
+    MwsIVPOptions opt = spw->m_opt;
+    MoReal rtol = myIVPRelTol(&spw->m_opt) * tol_scale;
+    MoReal atol = myIVPAbsTol(&spw->m_opt) * tol_scale;
+    MoReal t = t0, tret = t0;
+    unsigned long long start = myAutoNowNs();
+    MwsIVPSolverObj solver;
+    MwsIVPObj ivp = mwsNullPtr;
+    MwsInteger status = MWS_IVP_MEM_FAIL;
+
+    opt.m_stopTimeDefined = moTrue;
+    opt.m_stopTime = tEnd;
+    opt.m_toleranceDefined = moTrue;
+    opt.m_relativeTolerance = &rtol;
+    opt.m_absoluteTolerance = &atol;
+    memcpy(yEnd, y0, spw->m_nStates * sizeof(MoReal));
+
+    solver = cand->m_fcns.m_createPtr(&sw->m_utils, sw->m_userData);
+    if (solver)
+    {
+        ivp = cand->m_fcns.m_createPBPtr(solver, spw->m_nStates, &callback, &opt, &counter);
+    }
+    if (ivp)
+    {
+        if (cand->m_setController)
+        {
+            cand->m_setController(solver, ivp, ctl);
+        }
+        if (choice == MY_AUTO_RK45)
+        {
+            myRK45SetMethod(solver, ivp, MY_RK_DORMAND_PRINCE54);
+        }
+        status = cand->m_fcns.m_initPtr(solver, ivp, t0, y0, mwsNullPtr, moFalse, mwsNullPtr);
+        while (status == MWS_IVP_SUCCESS)
+        {
+            status = cand->m_fcns.m_solvePtr(solver, ivp, 0, t, tEnd, &tret, yEnd, mwsNullPtr, mwsNullPtr);
+            t = tret;
+        }
+        if (status == MWS_IVP_TSTOP_RETURN)
+        {
+            status = MWS_IVP_SUCCESS;
+        }
+        cand->m_fcns.m_destroyPBPtr(solver, ivp);
+    }
+    if (solver)
+    {
+        cand->m_fcns.m_destroyPtr(solver);
+    }
+
+    *rhs = counter.m_count;
+    *ns = myAutoNowNs() - start;
+    return status;
+}
+
+/* 调优失败时告警，沿用规则选择的算法与默认参数，不写缓存（下次初始化重新调优） */
+static void myAutoTuneWarn(MyAuto* sw, const char* reason, MoInteger choice)
+{
+    if (sw->m_utils.m_logger)
+    {
+        char msg[160];
+        sprintf(msg, "tuning failed (%s), using %s", reason, s_myAutoCandidates[choice].m_name);
+        sw->m_utils.m_logger(sw->m_userData, MWS_IVP_WARNING, "myAutoInit", msg);
+    }
+}
+
+/*
+ * 自动调优：先查缓存；未命中时刚性探测，非刚性再逐个试积分候选配置，结果写入缓存；
+ * 试积分失败时退回规则选择
+ * @return 状态，取MwsIVPStatus的值
+ */
+static MwsInteger myAutoTune(MyAuto* sw, MyAutoProblem* spw, MoReal t0, const MoReal* y0, MoInteger* choice)
+{
+    MyAutoProblemData* ds = spw->m_data;
+    MoSize n = spw->m_nStates;
+    MoReal* yRef = ds->m_work;
+    MoReal* yEnd = ds->m_work + n;
+    MoReal tEnd;
+    MoReal rtol = myIVPRelTol(&spw->m_opt);
+    MoReal atol = myIVPAbsTol(&spw->m_opt);
+    MoBoolean byRhs;
+    MoInteger cand, index;
+    MoSize i;
+    MyIVPController bestCtl = s_myAutoTuneGrid[0];
+    long rhs, refRhs, bestRhs = -1;
+    unsigned long long ns, refNs, bestNs = 0;
+    MwsInteger status;
+
+    if (myAutoCacheLookup(ds, choice, &ds->m_ctl))
+    {
+        ds->m_cached = moTrue;
+        return MWS_IVP_SUCCESS;
+    }
+
+    status = myAutoSelect(sw, spw, t0, y0, choice);
+    if (status != MWS_IVP_SUCCESS || n == 0 || ds->m_probe.m_stiff || ds->m_probe.m_h <= 0)
+    {
+        if (status == MWS_IVP_SUCCESS)
+        {
+            myAutoCacheStore(sw, ds, *choice, &ds->m_ctl, 0, 0);
+        }
+        return status;
+    }
+
+    /* 调优区间：试积分末步步长的 MY_AUTO_TUNE_STEPS 倍，不超过终止时间 */
+    tEnd = t0 + MY_AUTO_TUNE_STEPS * ds->m_probe.m_h;
+    if (spw->m_opt.m_stopTimeDefined && tEnd > spw->m_opt.m_stopTime)
+    {
+        tEnd = spw->m_opt.m_stopTime;
+    }
+
+    status = myAutoTrial(sw, spw, MY_AUTO_DOP853, &s_myAutoTuneGrid[0], MY_AUTO_TUNE_REF_TOL, t0, y0, tEnd, yRef,
+        LONG_MAX, &refRhs, &refNs);
+    if (status != MWS_IVP_SUCCESS)
+    {
+        myAutoTuneWarn(sw, "reference solution", *choice);
+        return MWS_IVP_SUCCESS;
+    }
+    byRhs = refNs < MY_AUTO_TUNE_MIN_NS;
+
+    for (cand = 0; cand < MY_AUTO_EXPRB; ++cand)
+    {
+        MoInteger gridSize = s_myAutoCandidates[cand].m_setController ? (MoInteger)MY_AUTO_TUNE_GRID_SIZE : 1;
+
+        for (index = 0; index < gridSize; ++index)
+        {
+            /* 参考解以100倍精度算得，比它多用一倍以上右端函数的配置不可能最快 */
+            status = myAutoTrial(sw, spw, cand, &s_myAutoTuneGrid[index], 1.0, t0, y0, tEnd, yEnd,
+                bestRhs >= 0 && byRhs ? bestRhs : 2 * refRhs, &rhs, &ns);
+            if (status != MWS_IVP_SUCCESS)
+            {
+                continue;
+            }
+            for (i = 0; i < n; ++i)
+            {
+                yEnd[i] -= yRef[i];
+            }
+            if (!(myIVPErrorNorm(n, yEnd, yRef, yRef, rtol, atol) <= MY_AUTO_TUNE_ERR_LIMIT))
+            {
+                continue;
+            }
+            if (bestRhs < 0 || (byRhs ? rhs < bestRhs : ns < bestNs))
+            {
+                *choice = cand;
+                bestCtl = s_myAutoTuneGrid[index];
+                bestRhs = rhs;
+                bestNs = ns;
+            }
+        }
+    }
+
+    if (bestRhs < 0)
+    {
+        myAutoTuneWarn(sw, "no candidate met the tolerance", *choice);
+        return MWS_IVP_SUCCESS;
+    }
+
+    ds->m_ctl = bestCtl;
+    myAutoCacheStore(sw, ds, *choice, &ds->m_ctl, bestRhs, bestNs);
+    return MWS_IVP_SUCCESS;
+}
+
+/// <summary>
+/// 创建算法
+/// </summary>
+/// <param name="util_fcns">工具函数（由求解器提供，用户调用）</param>
+/// <param name="user_data">用户数据（求解器内部数据，传递给工具函数util_fcns，自定义算法无需关心其内容）</param>
+/// <returns></returns>
+MwsIVPSolverObj myAutoCreate(MwsIVPUtilFcns* util_fcns, void* user_data)
+{
+    MyAuto* sw = (MyAuto*)util_fcns->m_allocMemory(user_data, 1, sizeof(MyAuto));
+
+    if (sw)
+    {
+        memset(sw, 0, sizeof(*sw));
+        sw->m_utils = *util_fcns;
+        sw->m_userData = user_data;
+    }
+
+    return sw;
+}
+
+/// <summary>
+/// 创建问题：只保存参数，候选算法在初始化时选定后再创建
+/// </summary>
+/// <param name="solver">积分算法对象</param>
+/// <param name="n">问题规模，即状态变量数量==微分方程阶数</param>
+/// <param name="call_back">回调函数</param>
+/// <param name="opt">积分器选项</param>
+/// <param name="ivp_user_data">用户数据(求解器内部数据，传递给回调函数call_back，算法不需关心)</param>
+/// <returns></returns>
+MwsIVPObj myAutoProblemCreate(MwsIVPSolverObj solver, MwsSize n, MwsIVPCallback* call_back, MwsIVPOptions* opt, void* ivp_user_data)
+{
+    MyAuto* sw = (MyAuto*)solver;
+    MyAutoProblem* spw = (MyAutoProblem*)sw->m_utils.m_allocMemory(sw->m_userData, 1, sizeof(MyAutoProblem));
+
+    if (spw)
+    {
+        MyAutoProblemData* ds = (MyAutoProblemData*)sw->m_utils.m_allocDataMemory(sw->m_userData, 1, sizeof(MyAutoProblemData));
+
+        if (ds == mwsNullPtr)
+        {
+            sw->m_utils.m_freeMemory(sw->m_userData, spw);
+            return mwsNullPtr;
+        }
+
+        memset(spw, 0, sizeof(*spw));
+        memset(ds, 0, sizeof(*ds));
+
+        spw->m_callback = *call_back;
+        spw->m_userData = ivp_user_data;
+        MY_IVP_TRACE_INTERPOSE(&spw->m_trace, &spw->m_callback, &spw->m_userData);
+        spw->m_opt = *opt;
+        spw->m_nStates = n;
+        spw->m_data = ds;
+        spw->m_solverWork = sw;
+
+        ds->m_choice = -1;
+        myAutoSetTuning(sw, spw, mwsNullPtr, mwsNullPtr);
+        {
+            static const MyIVPController defaultCtl = MY_IVP_CONTROLLER_DEFAULT;
+            ds->m_ctl = defaultCtl;
+        }
+
+        if (n > 0)
+        {
+            ds->m_work = (MoReal *)sw->m_utils.m_allocDataMemory(sw->m_userData, 5, n * sizeof(MoReal));
+            if (!ds->m_work)
+            {
+                myAutoProblemDestroy(sw, spw);
+                spw = MWnullptr;
+            }
+        }
+    }
+
+    return spw;
+}
+
+/// <summary>
+/// 初始化：首次初始化时探测并选定算法（与上次所选不同时重建），重新初始化直接转交已选算法
+/// </summary>
+/// <param name="solver">积分算法对象</param>
+/// <param name="ivp">问题对象</param>
+/// <param name="t0">起始时间</param>
+/// <param name="y0">y的初始值（必定不为空）</param>
+/// <param name="yp0">y’的初始值（DAE）</param>
+/// <param name="is_reinit">是否重新初始化（重启）</param>
+/// <param name="reserve">保留参数，暂不使用</param>
+/// <returns></returns>
+MwsInteger myAutoInit(MwsIVPSolverObj solver, MwsIVPObj ivp, MwsReal t0, const MwsReal* y0,
+    const MwsReal* yp0, MwsBoolean is_reinit, void* reserve)
+{
+    MyAuto* sw = (MyAuto*)solver;
+    MyAutoProblem* spw = (MyAutoProblem*)ivp;
+    MyAutoProblemData* ds = spw->m_data;
+    const MwsIVPSolverFcns* fcns;
+    MoInteger choice = ds->m_choice;
+    MoBoolean selected = !is_reinit || choice < 0;
+    MwsInteger status;
+
+    if (selected)
+    {
+        static const MyIVPController defaultCtl = MY_IVP_CONTROLLER_DEFAULT;
+
+        ds->m_ctl = defaultCtl;
+        ds->m_cached = moFalse;
+        status = ds->m_tune ? myAutoTune(sw, spw, t0, y0, &choice) : myAutoSelect(sw, spw, t0, y0, &choice);
+        if (status != MWS_IVP_SUCCESS)
+        {
+            return status;
+        }
+    }
+
+    if (choice != ds->m_choice)
+    {
+        myAutoFreeInner(ds);
+        fcns = &s_myAutoCandidates[choice].m_fcns;
+        ds->m_innerSolver = fcns->m_createPtr(&sw->m_utils, sw->m_userData);
+        if (ds->m_innerSolver)
+        {
+            ds->m_choice = choice;
+            ds->m_innerIvp = fcns->m_createPBPtr(ds->m_innerSolver, spw->m_nStates, &spw->m_callback, &spw->m_opt,
+                spw->m_userData);
+        }
+        if (!ds->m_innerIvp)
+        {
+            myAutoFreeInner(ds);
+            return MWS_IVP_MEM_FAIL;
+        }
+        if (choice == MY_AUTO_RK45)
+        {
+            myRK45SetMethod(ds->m_innerSolver, ds->m_innerIvp, MY_RK_DORMAND_PRINCE54);
+        }
+    }
+
+    if (selected && s_myAutoCandidates[choice].m_setController)
+    {
+        s_myAutoCandidates[choice].m_setController(ds->m_innerSolver, ds->m_innerIvp, &ds->m_ctl);
+    }
+
+    fcns = &s_myAutoCandidates[ds->m_choice].m_fcns;
+    return fcns->m_initPtr(ds->m_innerSolver, ds->m_innerIvp, t0, y0, yp0, is_reinit, reserve);
+}
+
+/// <summary>
+/// 求解：转交已选算法
+/// </summary>
+/// 输入：
+/// <param name="solver">积分算法对象</param>
+/// <param name="ivp">问题对象</param>
+/// <param name="step_size">初始积分步长</param>
+/// <param name="t">当前时间</param>
+/// <param name="tout">输出结果时间</param>
+/// 输出：
+/// <param name="tret">结果实际达到的时间</param>
+/// <param name="yret">y的结果值（输入为当前y）</param>
+/// <param name="ypret">y’的结果值（可为空）</param>
+/// <param name="reserve">保留参数，暂不使用</param>
+/// <returns></returns>
+MwsInteger myAutoSolve(MwsIVPSolverObj solver, MwsIVPObj ivp, MwsReal step_size, MwsReal t,
+    MwsReal tout, MwsReal* tret, MwsReal* yret, MwsReal* ypret, void* reserve)
+{
+    MyAutoProblemData* ds = ((MyAutoProblem*)ivp)->m_data;
+
+    if (ds->m_choice < 0)
+    {
+        return MWS_IVP_INVALID_INPUT;   /* 未初始化 */
+    }
+    return s_myAutoCandidates[ds->m_choice].m_fcns.m_solvePtr(ds->m_innerSolver, ds->m_innerIvp, step_size, t,
+        tout, tret, yret, ypret, reserve);
+}
+
+/// <summary>
+/// 插值：转交已选算法
+/// </summary>
+/// 输入：
+/// <param name="solver">积分算法对象</param>
+/// <param name="ivp">问题对象</param>
+/// <param name="tout">输出结果的时间</param>
+/// 输出：
+/// <param name="yret">y的结果值</param>
+/// <param name="reserve"></param>
+/// <returns></returns>
+MwsInteger myAutoInterpolate(MwsIVPSolverObj solver, MwsIVPObj ivp, MwsReal tout, MwsReal* yret, void* reserve)
+{
+    MyAutoProblemData* ds = ((MyAutoProblem*)ivp)->m_data;
+
+    if (ds->m_choice < 0)
+    {
+        return MWS_IVP_INVALID_INPUT;
+    }
+    return s_myAutoCandidates[ds->m_choice].m_fcns.m_interpolatePtr(ds->m_innerSolver, ds->m_innerIvp, tout,
+        yret, reserve);
+}
+
+/// <summary>
+/// 查询选择结果
+/// </summary>
+/// <param name="solver">积分算法对象</param>
+/// <param name="ivp">问题对象</param>
+/// <param name="rho">探测到的谱半径（可为空）</param>
+/// <param name="stiff">是否判为刚性（可为空）</param>
+/// <returns>已选算法的名称，尚未初始化时为空</returns>
+MwsString myAutoGetChoice(MwsIVPSolverObj solver, MwsIVPObj ivp, MoReal* rho, MoBoolean* stiff)
+{
+    MyAutoProblemData* ds = ((MyAutoProblem*)ivp)->m_data;
+
+    if (rho)
+    {
+        *rho = ds->m_probe.m_rho;
+    }
+    if (stiff)
+    {
+        *stiff = ds->m_probe.m_stiff;
+    }
+    return ds->m_choice >= 0 ? s_myAutoCandidates[ds->m_choice].m_name : mwsNullPtr;
+}
+
+/// <summary>
+/// 启用自动调优（须在首次初始化之前调用），调优结果按模型指纹缓存在 cache_path 指定的文本文件中
+/// </summary>
+/// <param name="solver">积分算法对象</param>
+/// <param name="ivp">问题对象</param>
+/// <param name="cache_path">缓存文件路径，为空时关闭调优，按选择规则选算法</param>
+/// <param name="model_key">模型标识（如模型名与版本，可为空）；为空时以回调函数地址区分模型，
+/// 模型库每次加载地址不同时缓存无法命中</param>
+/// <returns>路径过长时返回MWS_IVP_INVALID_INPUT</returns>
+MwsInteger myAutoSetTuning(MwsIVPSolverObj solver, MwsIVPObj ivp, MwsString cache_path, MwsString model_key)
+{
+    MyAutoProblem* spw = (MyAutoProblem*)ivp;
+    MyAutoProblemData* ds = spw->m_data;
+
+    if (cache_path == mwsNullPtr)
+    {
+        ds->m_tune = moFalse;
+        ds->m_cachePath[0] = 0;
+        return MWS_IVP_SUCCESS;
+    }
+    if (strlen(cache_path) >= MY_AUTO_PATH_MAX)
+    {
+        return MWS_IVP_INVALID_INPUT;
+    }
+    strcpy(ds->m_cachePath, cache_path);
+    ds->m_fingerprint = myAutoFingerprint(spw, model_key);
+    ds->m_tune = moTrue;
+
+    return MWS_IVP_SUCCESS;
+}
+
+/// <summary>
+/// 查询已选算法使用的步长控制器参数
+/// </summary>
+/// <param name="solver">积分算法对象</param>
+/// <param name="ivp">问题对象</param>
+/// <param name="ctl">控制器参数</param>
+/// <returns>配置是否取自调优缓存</returns>
+MoBoolean myAutoGetController(MwsIVPSolverObj solver, MwsIVPObj ivp, MyIVPController* ctl)
+{
+    MyAutoProblemData* ds = ((MyAutoProblem*)ivp)->m_data;
+
+    *ctl = ds->m_ctl;
+    return ds->m_cached;
+}
+
+/// <summary>
+/// 销毁问题
+/// </summary>
+/// <param name="solver"></param>
+/// <param name="ivp"></param>
+void myAutoProblemDestroy(MwsIVPSolverObj solver, MwsIVPObj ivp)
+{
+    MyAuto* sw = (MyAuto*)solver;
+    MyAutoProblem* spw = (MyAutoProblem*)ivp;
+
+    if (spw)
+    {
+        if (spw->m_data)
+        {
+            myAutoFreeInner(spw->m_data);
+
+            if (spw->m_data->m_work)
+            {
+                (*sw->m_utils.m_freeDataMemory)(sw->m_userData, spw->m_data->m_work);
+            }
+
+            (*sw->m_utils.m_freeDataMemory)(sw->m_userData, spw->m_data);
+        }
+
+        (*sw->m_utils.m_freeMemory)(sw->m_userData, spw);
+    }
+}
+
+/// <summary>
+/// 销毁积分算法
+/// </summary>
+/// <param name="solver"></param>
+void myAutoDestroy(MwsIVPSolverObj solver)
+{
+    MyAuto* sw = (MyAuto*)solver;
+
+    if (sw)
+    {
+        (*sw->m_utils.m_freeMemory)(sw->m_userData, sw);
+    }
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+
+/***************************************************************************
+//   end of file
+***************************************************************************/
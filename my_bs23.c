@@ -0,0 +1,569 @@
+/***************************************************************************
+///
+/// Copyright (c) 2020, 苏州同元软控信息技术有限公司
+/// All rights reserved.
+///
+/// @file           my_bs23.c
+/// @brief          Bogacki-Shampine 3(2) 变步长积分算法（FSAL），三次Hermite稠密输出
+///
+/// @version        v1.0
+/// @author         田显钊
+/// @date           2020/07/07
+///
+***************************************************************************/
+
+#include "mo_types.h"
+#include "mws_ivp_solver.h"
+#include "my_ivp_common.h"
+#include "my_ivp_trace.h"
+
+#include <memory.h>
+#include <math.h>
+
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+/* 算法对象 */
+typedef struct  
+{
+    MwsIVPUtilFcns	m_utils;
+    void*           m_userData;
+
+} MyBs23;
+
+/* 状态快照（协同仿真回退用），创建问题时预分配 */
+typedef struct
+{
+    MoReal *m_y;            /* preY|curY|preYp|curYp 的副本，长度4n */
+    MoReal m_curTime;
+    MoReal m_preTime;
+    MoReal m_h;
+    MoBoolean m_valid;      /* 是否已保存过快照 */
+} MyBs23Snapshot;
+
+/* 求解问题的数据，用数据内存分配和释放函数 */
+typedef struct  
+{
+    /* m_preY、m_curY、m_preYp、m_curYp 依次位于同一块连续内存中（由m_preY持有） */
+    MoReal *m_preY;         /* 上一步y */
+    MoReal *m_curY;         /* 当前y */
+    MoReal *m_preYp;        /* 上一步y' */
+    MoReal *m_curYp;        /* 当前y' */
+
+    /* m_k2、m_k3、m_yStage 依次位于同一块连续内存中（由m_k2持有） */
+    MoReal *m_k2;
+    MoReal *m_k3;
+    MoReal *m_yStage;       /* 级间y */
+
+    MoReal m_curTime;       /* 当前时间 */
+    MoReal m_preTime;       /* 上一步时间 */
+    MoReal m_initialStep;
+    MoReal m_h;             /* 下一步建议步长，0表示尚未开始积分 */
+    MyIVPController m_ctl;  /* 步长控制器参数，默认 MY_IVP_CONTROLLER_DEFAULT */
+
+    MoBoolean m_ypValid;    /* m_curYp 是否对应 (m_curTime, m_curY) */
+
+    MyBs23Snapshot m_snap;
+} MyBs23ProblemData;
+
+/* 求解问题对象 */
+typedef struct  
+{
+    MoSize          m_nStates;
+
+    MwsIVPOptions	m_opt;
+    MwsIVPCallback  m_callback;
+    void*			m_userData;
+    MY_IVP_TRACE_MEMBER(m_trace)
+
+    MyBs23ProblemData* m_data;
+    MyBs23* m_solverWork;
+
+} MyBs23Problem;
+
+void myBs23ProblemDestroy(MwsIVPSolverObj solver, MwsIVPObj ivp);
+void myBs23Destroy(MwsIVPSolverObj solver);
+MwsInteger myBs23SetController(MwsIVPSolverObj solver, MwsIVPObj ivp, const MyIVPController* ctl);
+
+/// <summary>
+/// 创建算法
+/// </summary>
+/// <param name="util_fcns">工具函数（仿真求解器提供，用户调用）</param>
+/// <param name="user_data">用户数据（求解器内部数据，传递给工具函数util_fcns，自定义算法无需关心其内容）</param>
+/// <returns></returns>
+MwsIVPSolverObj myBs23Create(MwsIVPUtilFcns* util_fcns, void* user_data)
+{
+    MyBs23* sw = (MyBs23*)util_fcns->m_allocMemory(user_data, 1, sizeof(MyBs23));
+
+    if (sw)
+    {
+        memset(sw, 0, sizeof(*sw));
+        sw->m_utils = *util_fcns;
+        sw->m_userData = user_data;
+    }
+
+    return sw;
+}
+
+/// <summary>
+/// 创建问题
+/// </summary>
+/// <param name="solver">积分算法对象</param>
+/// <param name="n">问题规模，即状态变量个数==微分方程阶数</param>
+/// <param name="call_back">回调函数</param>
+/// <param name="opt">求解器选项</param>
+/// <param name="ivp_user_data">用户数据(求解器内部数据，传递给回调函数call_back，算法无需关心)</param>
+/// <returns></returns>
+MwsIVPObj myBs23ProblemCreate(MwsIVPSolverObj solver, MwsSize n, MwsIVPCallback* call_back, MwsIVPOptions* opt, void* ivp_user_data)
+{
+    MyBs23* sw = (MyBs23*)solver;
+    MyBs23Problem* spw = (MyBs23Problem*)sw->m_utils.m_allocMemory(sw->m_userData, 1, sizeof(MyBs23Problem));
+
+    if (spw)
+    {
+        MyBs23ProblemData* ds = (MyBs23ProblemData*)sw->m_utils.m_allocDataMemory(sw->m_userData, 1, sizeof(MyBs23ProblemData));
+
+        if (ds == mwsNullPtr)
+        {
+            sw->m_utils.m_freeMemory(sw->m_userData, spw);
+            return mwsNullPtr;
+        }
+
+        memset(spw, 0, sizeof(*spw));
+        memset(ds, 0, sizeof(*ds));
+
+        spw->m_callback = *call_back;
+        spw->m_userData = ivp_user_data;
+        MY_IVP_TRACE_INTERPOSE(&spw->m_trace, &spw->m_callback, &spw->m_userData);
+        spw->m_opt = *opt;
+        spw->m_nStates = n;
+        spw->m_data = ds;
+        spw->m_solverWork = sw;
+        myBs23SetController(sw, spw, mwsNullPtr);
+
+        if (spw->m_nStates > 0)
+        {
+            ds->m_preY = (MoReal*)sw->m_utils.m_allocDataMemory(sw->m_userData, 4, n * sizeof(MoReal));
+            ds->m_k2 = (MoReal*)sw->m_utils.m_allocDataMemory(sw->m_userData, 3, n * sizeof(MoReal));
+            ds->m_snap.m_y = (MoReal*)sw->m_utils.m_allocDataMemory(sw->m_userData, 4, n * sizeof(MoReal));
+
+            if (!ds->m_preY || !ds->m_k2 || !ds->m_snap.m_y)
+            {
+                myBs23ProblemDestroy(sw, spw);
+                spw = MWnullptr;
+            }
+            else
+            {
+                ds->m_curY = ds->m_preY + n;
+                ds->m_preYp = ds->m_preY + 2 * n;
+                ds->m_curYp = ds->m_preY + 3 * n;
+                ds->m_k3 = ds->m_k2 + n;
+                ds->m_yStage = ds->m_k2 + 2 * n;
+
+                memset(ds->m_preY, 0, 4 * n * sizeof(MoReal));
+                memset(ds->m_k2, 0, 3 * n * sizeof(MoReal));
+            }
+        }
+    }
+
+    return spw;
+}
+
+/// <summary>
+/// 初始化
+/// </summary>
+/// <param name="solver">积分算法对象</param>
+/// <param name="ivp">问题对象</param>
+/// <param name="t0">初始时间</param>
+/// <param name="y0">y的初始值（特定不为空）</param>
+/// <param name="yp0">y’的初始值（DAE）</param>
+/// <param name="is_reinit">是否重新初始化（保留）</param>
+/// <param name="reserve">保留参数，暂不使用</param>
+/// <returns></returns>
+MwsInteger myBs23Init(MwsIVPSolverObj solver, MwsIVPObj ivp, MwsReal t0, const MwsReal* y0,
+    const MwsReal* yp0, MwsBoolean is_reinit, void* reserve)
+{
+    MyBs23Problem* spw = (MyBs23Problem*)ivp;
+    MyBs23ProblemData* ds = spw->m_data;
+    MoSize nState = spw->m_nStates;
+    MoSize index;
+    MoReal oldNorm = 0;
+    MoReal newNorm = 0;
+
+    ds->m_curTime = t0;
+    ds->m_preTime = t0;
+    if (!is_reinit)
+    {
+        /* 首次初始化：清空步长历史，旧快照作废 */
+        ds->m_h = 0;
+        ds->m_snap.m_valid = moFalse;
+    }
+
+    if (nState == 0 || y0 == mwsNullPtr)
+    {
+        ds->m_ypValid = moFalse;
+        return MWS_IVP_SUCCESS;
+    }
+
+    if (is_reinit && ds->m_ypValid)
+    {
+        for (index = 0; index < nState; ++index)
+        {
+            oldNorm += ds->m_curYp[index] * ds->m_curYp[index];
+        }
+    }
+
+    memcpy(ds->m_curY, y0, nState * sizeof(MoReal));
+    memcpy(ds->m_preY, y0, nState * sizeof(MoReal));
+    if (spw->m_callback.m_rshFunction(spw->m_userData, t0, ds->m_curY, ds->m_curYp) != MWS_IVP_SUCCESS)
+    {
+        ds->m_ypValid = moFalse;
+        return MWS_IVP_RHSFN_FAIL;
+    }
+    memcpy(ds->m_preYp, ds->m_curYp, nState * sizeof(MoReal));
+
+    /* 重新初始化：与myRK45Init相同，按y'跳变幅度缩小保留的步长 */
+    if (is_reinit && ds->m_h > 0 && ds->m_ypValid)
+    {
+        for (index = 0; index < nState; ++index)
+        {
+            newNorm += ds->m_curYp[index] * ds->m_curYp[index];
+        }
+        if (newNorm > oldNorm)
+        {
+            MoReal ratio = sqrt(oldNorm / newNorm);
+            ds->m_h *= (ratio < 0.1) ? 0.1 : ratio;
+        }
+    }
+    ds->m_ypValid = moTrue;
+
+    return MWS_IVP_SUCCESS;
+}
+
+/// <summary>
+/// 求解：每次调用前进一个被接受的积分步，误差超限时在内部缩小步长重试
+/// </summary>
+/// 输入：
+/// <param name="solver">积分算法对象</param>
+/// <param name="ivp">问题对象</param>
+/// <param name="step_size">初始积分步长（仅首步使用，<=0时自动选择）</param>
+/// <param name="t">当前时间</param>
+/// <param name="tout">输出结果时间</param>
+/// 输出：
+/// <param name="tret">结果实际达到的时间</param>
+/// <param name="yret">y的结果值（输入为当前y）</param>
+/// <param name="ypret">y’的结果值（可为空）</param>
+/// <param name="reserve">保留参数，暂不使用</param>
+/// <returns></returns>
+MwsInteger myBs23Solve(MwsIVPSolverObj solver, MwsIVPObj ivp, MwsReal step_size, MwsReal t, 
+    MwsReal tout, MwsReal* tret, MwsReal* yret, MwsReal* ypret, void* reserve)
+{
+    MyBs23Problem* spw = (MyBs23Problem*)ivp;
+    MyBs23ProblemData* ds = spw->m_data;
+
+    MoSize n = spw->m_nStates;
+    MoSize index;
+
+    MoReal* preY = ds->m_preY;
+    MoReal* curY = ds->m_curY;
+    MoReal* K1 = ds->m_preYp;
+    MoReal* K2 = ds->m_k2;
+    MoReal* K3 = ds->m_k3;
+    MoReal* K4 = ds->m_curYp;
+    MoReal* yStage = ds->m_yStage;
+
+    MoReal rtol = myIVPRelTol(&spw->m_opt);
+    MoReal atol = myIVPAbsTol(&spw->m_opt);
+    MoReal h = ds->m_h;
+    MoReal errNorm = 0;
+    MoBoolean rejected = moFalse;
+
+    if (spw->m_opt.m_stopTimeDefined && t >= spw->m_opt.m_stopTime)
+    {
+        *tret = t;
+        return MWS_IVP_TSTOP_RETURN;
+    }
+
+    /* 当前状态（上一步的y1即本步的y0），首级沿用上一步的 f(t+h,y1) */
+    memcpy(preY, yret, n * sizeof(MoReal));
+    if (ds->m_ypValid && t == ds->m_curTime)
+    {
+        memcpy(K1, K4, n * sizeof(MoReal));
+    }
+    else if (n > 0 && spw->m_callback.m_rshFunction(spw->m_userData, t, preY, K1) != MWS_IVP_SUCCESS)
+    {
+        return MWS_IVP_RHSFN_FAIL;
+    }
+    ds->m_ypValid = moFalse;        /* K4 即 m_curYp，下面会被试算覆盖 */
+
+    if (h <= 0)
+    {
+        h = step_size;
+        if (h <= 0 && myIVPInitialStep(&spw->m_callback, spw->m_userData, n, t, preY, K1, rtol, atol, 2,
+            myIVPMaxStep(&spw->m_opt), K2, K3, &h) != MWS_IVP_SUCCESS)
+        {
+            return MWS_IVP_RHSFN_FAIL;
+        }
+    }
+
+    for (;;)
+    {
+        MY_IVP_TRACE_BEGIN(attempt)
+
+        h = myIVPClampStep(&spw->m_opt, t, h);
+        if (h < myIVPMinStep(t))
+        {
+            return MWS_IVP_FAIL;    /* 步长过小 */
+        }
+
+        for (index = 0; index < n; ++index)
+        {
+            yStage[index] = preY[index] + h * MY_BS23_A21 * K1[index];
+        }
+        if (spw->m_callback.m_rshFunction(spw->m_userData, t + h / 2, yStage, K2) != MWS_IVP_SUCCESS)
+        {
+            return MWS_IVP_RHSFN_FAIL;
+        }
+        for (index = 0; index < n; ++index)
+        {
+            yStage[index] = preY[index] + h * MY_BS23_A32 * K2[index];
+        }
+        if (spw->m_callback.m_rshFunction(spw->m_userData, t + h * 3 / 4, yStage, K3) != MWS_IVP_SUCCESS)
+        {
+            return MWS_IVP_RHSFN_FAIL;
+        }
+        for (index = 0; index < n; ++index)
+        {
+            curY[index] = preY[index] + h * (MY_BS23_B1 * K1[index] + MY_BS23_B2 * K2[index] + MY_BS23_B3 * K3[index]);
+        }
+        if (spw->m_callback.m_rshFunction(spw->m_userData, t + h, curY, K4) != MWS_IVP_SUCCESS)
+        {
+            return MWS_IVP_RHSFN_FAIL;
+        }
+
+        /* 2阶嵌入误差，借用yStage存放 */
+        for (index = 0; index < n; ++index)
+        {
+            yStage[index] = h * (MY_BS23_E1 * K1[index] + MY_BS23_E2 * K2[index] + MY_BS23_E3 * K3[index]
+                + MY_BS23_E4 * K4[index]);
+        }
+        errNorm = myIVPErrorNorm(n, yStage, preY, curY, rtol, atol);
+
+        if (errNorm <= 1)
+        {
+            MY_IVP_TRACE_END(MY_IVP_TRACE_STEP, attempt);
+            break;
+        }
+        h *= myIVPStepFactorCtl(&ds->m_ctl, errNorm, 2);
+        rejected = moTrue;
+        MY_IVP_TRACE_END(MY_IVP_TRACE_REJECT, attempt);
+    }
+
+    ds->m_preTime = t;
+    ds->m_curTime = t + h;
+    ds->m_initialStep = h;
+    ds->m_ypValid = moTrue;
+
+    /* 刚被拒绝过的步不再放大步长 */
+    if (rejected)
+    {
+        ds->m_h = h * (myIVPStepFactorCtl(&ds->m_ctl, errNorm, 2) < 1 ? myIVPStepFactorCtl(&ds->m_ctl, errNorm, 2) : 1);
+    }
+    else
+    {
+        ds->m_h = h * myIVPStepFactorCtl(&ds->m_ctl, errNorm, 2);
+    }
+
+    memcpy(yret, curY, n * sizeof(MoReal));
+    if (ypret)
+    {
+        memcpy(ypret, K4, n * sizeof(MoReal));
+    }
+    *tret = ds->m_curTime;
+
+    return MWS_IVP_SUCCESS;
+}
+
+/// <summary>
+/// 插值：用步两端的 y 与 y' 做三次Hermite插值，与3阶方法精度一致，不需要额外的右端函数计算
+/// </summary>
+/// 输入：
+/// <param name="solver">积分算法对象</param>
+/// <param name="ivp">问题对象</param>
+/// <param name="tout">输出结果的时间</param>
+/// 输出：
+/// <param name="yret">y的结果值</param>
+/// <param name="reserve"></param>
+/// <returns></returns>
+MwsInteger myBs23Interpolate(MwsIVPSolverObj solver, MwsIVPObj ivp, MwsReal tout, MwsReal* yret, void* reserve)
+{
+    MyBs23Problem* spw = (MyBs23Problem*)ivp;
+    MyBs23ProblemData* ds = spw->m_data;
+    MoReal h = ds->m_curTime - ds->m_preTime;
+
+    if (h == 0)
+    {
+        memcpy(yret, ds->m_curY, spw->m_nStates * sizeof(MoReal));
+        return MWS_IVP_SUCCESS;
+    }
+
+    myIVPHermite(spw->m_nStates, (tout - ds->m_preTime) / h, h, ds->m_preY, ds->m_curY,
+        ds->m_preYp, ds->m_curYp, yret);
+
+    return MWS_IVP_SUCCESS;
+}
+
+/// <summary>
+/// 保存状态快照，只拷贝到预分配的快照区，不分配内存
+/// </summary>
+/// <param name="solver">积分算法对象</param>
+/// <param name="ivp">问题对象</param>
+/// <returns></returns>
+MwsInteger myBs23SaveState(MwsIVPSolverObj solver, MwsIVPObj ivp)
+{
+    MyBs23Problem* spw = (MyBs23Problem*)ivp;
+    MyBs23ProblemData* ds = spw->m_data;
+
+    if (spw->m_nStates > 0)
+    {
+        memcpy(ds->m_snap.m_y, ds->m_preY, 4 * spw->m_nStates * sizeof(MoReal));
+    }
+    ds->m_snap.m_curTime = ds->m_curTime;
+    ds->m_snap.m_preTime = ds->m_preTime;
+    ds->m_snap.m_h = ds->m_h;
+    ds->m_snap.m_valid = moTrue;
+
+    return MWS_IVP_SUCCESS;
+}
+
+/// <summary>
+/// 恢复到最近一次保存的快照，步长历史一并恢复
+/// </summary>
+/// 输入：
+/// <param name="solver">积分算法对象</param>
+/// <param name="ivp">问题对象</param>
+/// 输出：
+/// <param name="tret">快照时刻（可为空）</param>
+/// <param name="yret">快照时刻y的值（可为空）</param>
+/// <param name="ypret">快照时刻y'的值（可为空）</param>
+/// <returns>未保存过快照时返回MWS_IVP_INVALID_INPUT</returns>
+MwsInteger myBs23RestoreState(MwsIVPSolverObj solver, MwsIVPObj ivp, MwsReal* tret, MwsReal* yret, MwsReal* ypret)
+{
+    MyBs23Problem* spw = (MyBs23Problem*)ivp;
+    MyBs23ProblemData* ds = spw->m_data;
+    MoSize nState = spw->m_nStates;
+
+    if (!ds->m_snap.m_valid)
+    {
+        return MWS_IVP_INVALID_INPUT;
+    }
+
+    if (nState > 0)
+    {
+        memcpy(ds->m_preY, ds->m_snap.m_y, 4 * nState * sizeof(MoReal));
+    }
+    ds->m_curTime = ds->m_snap.m_curTime;
+    ds->m_preTime = ds->m_snap.m_preTime;
+    ds->m_h = ds->m_snap.m_h;
+    ds->m_ypValid = moTrue;
+
+    if (tret)
+    {
+        *tret = ds->m_curTime;
+    }
+    if (yret && nState > 0)
+    {
+        memcpy(yret, ds->m_curY, nState * sizeof(MoReal));
+    }
+    if (ypret && nState > 0)
+    {
+        memcpy(ypret, ds->m_curYp, nState * sizeof(MoReal));
+    }
+
+    return MWS_IVP_SUCCESS;
+}
+
+/// <summary>
+/// 设置步长控制器参数（安全因子与单步缩放倍数上下限），不影响已有的步长历史
+/// </summary>
+/// <param name="solver">积分算法对象</param>
+/// <param name="ivp">问题对象</param>
+/// <param name="ctl">控制器参数，为空时恢复默认值</param>
+/// <returns>参数无效时返回MWS_IVP_INVALID_INPUT</returns>
+MwsInteger myBs23SetController(MwsIVPSolverObj solver, MwsIVPObj ivp, const MyIVPController* ctl)
+{
+    static const MyIVPController defaultCtl = MY_IVP_CONTROLLER_DEFAULT;
+    MyBs23Problem* spw = (MyBs23Problem*)ivp;
+
+    if (ctl == mwsNullPtr)
+    {
+        ctl = &defaultCtl;
+    }
+    if (!myIVPControllerValid(ctl))
+    {
+        return MWS_IVP_INVALID_INPUT;
+    }
+    spw->m_data->m_ctl = *ctl;
+
+    return MWS_IVP_SUCCESS;
+}
+
+/// <summary>
+/// 销毁问题
+/// </summary>
+/// <param name="solver"></param>
+/// <param name="ivp"></param>
+void myBs23ProblemDestroy(MwsIVPSolverObj solver, MwsIVPObj ivp)
+{
+    MyBs23* sw = (MyBs23*)solver;
+    MyBs23Problem* spw = (MyBs23Problem*)ivp;
+
+    if (spw)
+    {
+        if (spw->m_data->m_preY)
+        {
+            (*sw->m_utils.m_freeDataMemory)(sw->m_userData, spw->m_data->m_preY);
+        }
+
+        if (spw->m_data->m_k2)
+        {
+            (*sw->m_utils.m_freeDataMemory)(sw->m_userData, spw->m_data->m_k2);
+        }
+
+        if (spw->m_data->m_snap.m_y)
+        {
+            (*sw->m_utils.m_freeDataMemory)(sw->m_userData, spw->m_data->m_snap.m_y);
+        }
+
+        if (spw->m_data)
+        {
+            (*sw->m_utils.m_freeDataMemory)(sw->m_userData, spw->m_data);
+        }
+
+        (*sw->m_utils.m_freeMemory)(sw->m_userData, spw);
+    }
+}
+
+/// <summary>
+/// 销毁积分算法
+/// </summary>
+/// <param name="solver"></param>
+void myBs23Destroy(MwsIVPSolverObj solver)
+{
+    MyBs23* sw = (MyBs23*)solver;
+
+    if (sw)
+    {
+        (*sw->m_utils.m_freeMemory)(sw->m_userData, sw);
+    }
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+
+/***************************************************************************
+//   end of file
+***************************************************************************/
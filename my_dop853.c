@@ -0,0 +1,732 @@
+/***************************************************************************
+///
+/// Copyright (c) 2020, 苏州同元软控信息技术有限公司
+/// All rights reserved.
+///
+/// @file           my_dop853.c
+/// @brief          8阶Dormand-Prince（DOP853）变步长积分算法，带7阶稠密输出
+///
+/// @version        v1.0
+/// @author         田显钊
+/// @date           2020/07/07
+///
+***************************************************************************/
+
+#include "mo_types.h"
+#include "mws_ivp_solver.h"
+#include "my_ivp_common.h"
+#include "my_ivp_trace.h"
+
+#include <memory.h>
+#include <math.h>
+
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+/*
+ * 系数取自 Hairer, Norsett, Wanner, Solving Ordinary Differential Equations I 及其 dop853.f。
+ * 每步12级（含首级FSAL），接受后再算一次 f(t+h,y1) 作为下一步首级；
+ * 稠密输出另需3级，只在第一次插值时补算。
+ */
+/* 节点 c_i（前12级为主方法，第12级为FSAL的 f(t+h,y1)，13~15级仅用于稠密输出） */
+static const MoReal s_dop853C[16] =
+{
+    0.0, 0.526001519587677318785587544488e-01, 0.789002279381515978178381316732e-01, 0.118350341907227396726757197510,
+    0.281649658092772603273242802490, 0.333333333333333333333333333333, 0.25, 0.307692307692307692307692307692,
+    0.651282051282051282051282051282, 0.6, 0.857142857142857142857142857142, 1.0,
+    1.0, 0.1, 0.2, 0.777777777777777777777777777778,
+};
+
+/* 系数矩阵 a_ij，第12行即8阶解的权重 b_j */
+static const MoReal s_dop853A[16][16] =
+{
+    { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 },
+    { 5.26001519587677318785587544488e-2, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 },
+    { 1.97250569845378994544595329183e-2, 5.91751709536136983633785987549e-2, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 },
+    { 2.95875854768068491816892993775e-2, 0, 8.87627564304205475450678981324e-2, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 },
+    { 2.41365134159266685502369798665e-1, 0, -8.84549479328286085344864962717e-1, 9.24834003261792003115737966543e-1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 },
+    { 3.7037037037037037037037037037e-2, 0, 0, 1.70828608729473871279604482173e-1, 1.25467687566822425016691814123e-1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 },
+    { 3.7109375e-2, 0, 0, 1.70252211019544039314978060272e-1, 6.02165389804559606850219397283e-2, -1.7578125e-2, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 },
+    { 3.70920001185047927108779319836e-2, 0, 0, 1.70383925712239993810214054705e-1, 1.07262030446373284651809199168e-1, -1.53194377486244017527936158236e-2, 8.27378916381402288758473766002e-3, 0, 0, 0, 0, 0, 0, 0, 0, 0 },
+    { 6.24110958716075717114429577812e-1, 0, 0, -3.36089262944694129406857109825, -8.68219346841726006818189891453e-1, 2.75920996994467083049415600797e1, 2.01540675504778934086186788979e1, -4.34898841810699588477366255144e1, 0, 0, 0, 0, 0, 0, 0, 0 },
+    { 4.77662536438264365890433908527e-1, 0, 0, -2.48811461997166764192642586468, -5.90290826836842996371446475743e-1, 2.12300514481811942347288949897e1, 1.52792336328824235832596922938e1, -3.32882109689848629194453265587e1, -2.03312017085086261358222928593e-2, 0, 0, 0, 0, 0, 0, 0 },
+    { -9.3714243008598732571704021658e-1, 0, 0, 5.18637242884406370830023853209, 1.09143734899672957818500254654, -8.14978701074692612513997267357, -1.85200656599969598641566180701e1, 2.27394870993505042818970056734e1, 2.49360555267965238987089396762, -3.0467644718982195003823669022, 0, 0, 0, 0, 0, 0 },
+    { 2.27331014751653820792359768449, 0, 0, -1.05344954667372501984066689879e1, -2.00087205822486249909675718444, -1.79589318631187989172765950534e1, 2.79488845294199600508499808837e1, -2.85899827713502369474065508674, -8.87285693353062954433549289258, 1.23605671757943030647266201528e1, 6.43392746015763530355970484046e-1, 0, 0, 0, 0, 0 },
+    { 5.42937341165687622380535766363e-2, 0, 0, 0, 0, 4.45031289275240888144113950566, 1.89151789931450038304281599044, -5.8012039600105847814672114227, 3.1116436695781989440891606237e-1, -1.52160949662516078556178806805e-1, 2.01365400804030348374776537501e-1, 4.47106157277725905176885569043e-2, 0, 0, 0, 0 },
+    { 5.61675022830479523392909219681e-2, 0, 0, 0, 0, 0, 2.53500210216624811088794765333e-1, -2.46239037470802489917441475441e-1, -1.24191423263816360469010140626e-1, 1.5329179827876569731206322685e-1, 8.20105229563468988491666602057e-3, 7.56789766054569976138603589584e-3, -8.298e-3, 0, 0, 0 },
+    { 3.18346481635021405060768473261e-2, 0, 0, 0, 0, 2.83009096723667755288322961402e-2, 5.35419883074385676223797384372e-2, -5.49237485713909884646569340306e-2, 0, 0, -1.08347328697249322858509316994e-4, 3.82571090835658412954920192323e-4, -3.40465008687404560802977114492e-4, 1.41312443674632500278074618366e-1, 0, 0 },
+    { -4.28896301583791923408573538692e-1, 0, 0, 0, 0, -4.69762141536116384314449447206, 7.68342119606259904184240953878, 4.06898981839711007970213554331, 3.56727187455281109270669543021e-1, 0, 0, 0, -1.39902416515901462129418009734e-3, 2.9475147891527723389556272149, -9.15095847217987001081870187138, 0 },
+};
+
+/* 3阶嵌入公式权重 bhh_j，误差 err3 = sum((b_j - bhh_j)*k_j) */
+static const MoReal s_dop853Bhh[12] =
+{
+    0.244094488188976377952755905512, 0, 0, 0, 0, 0, 0, 0, 0.733846688281611857341361741547, 0, 0, 0.220588235294117647058823529412e-1
+};
+
+/* 5阶误差估计权重，err5 = sum(e5_j*k_j) */
+static const MoReal s_dop853E5[12] =
+{
+    0.1312004499419488073250102996e-1, 0, 0, 0, 0, -0.1225156446376204440720569753e+1, -0.4957589496572501915214079952, 0.1664377182454986536961530415e+1, -0.3503288487499736816886487290, 0.3341791187130174790297318841, 0.8192320648511571246570742613e-1, -0.2235530786388629525884427845e-1
+};
+
+/* 7阶稠密输出系数，F[3..6] = h * sum(d_ij*k_j) */
+static const MoReal s_dop853D[4][16] =
+{
+    { -0.84289382761090128651353491142e+1, 0, 0, 0, 0, 0.56671495351937776962531783590, -0.30689499459498916912797304727e+1, 0.23846676565120698287728149680e+1, 0.21170345824450282767155149946e+1, -0.87139158377797299206789907490, 0.22404374302607882758541771650e+1, 0.63157877876946881815570249290, -0.88990336451333310820698117400e-1, 0.18148505520854727256656404962e+2, -0.91946323924783554000451984436e+1, -0.44360363875948939664310572000e+1 },
+    { 0.10427508642579134603413151009e+2, 0, 0, 0, 0, 0.24228349177525818288430175319e+3, 0.16520045171727028198505394887e+3, -0.37454675472269020279518312152e+3, -0.22113666853125306036270938578e+2, 0.77334326684722638389603898808e+1, -0.30674084731089398182061213626e+2, -0.93321305264302278729567221706e+1, 0.15697238121770843886131091075e+2, -0.31139403219565177677282850411e+2, -0.93529243588444783865713862664e+1, 0.35816841486394083752465898540e+2 },
+    { 0.19985053242002433820987653617e+2, 0, 0, 0, 0, -0.38703730874935176555105901742e+3, -0.18917813819516756882830838328e+3, 0.52780815920542364900561016686e+3, -0.11573902539959630126141871134e+2, 0.68812326946963000169666922661e+1, -0.10006050966910838403183860980e+1, 0.77771377980534432092869265740, -0.27782057523535084065932004339e+1, -0.60196695231264120758267380846e+2, 0.84320405506677161018159903784e+2, 0.11992291136182789328035130030e+2 },
+    { -0.25693933462703749003312586129e+2, 0, 0, 0, 0, -0.15418974869023643374053993627e+3, -0.23152937917604549567536039109e+3, 0.35763911791061412378285349910e+3, 0.93405324183624310003907691704e+2, -0.37458323136451633156875139351e+2, 0.10409964950896230045147246184e+3, 0.29840293426660503123344363579e+2, -0.43533456590011143754432175058e+2, 0.96324553959188282948394950600e+2, -0.39177261675615439165231486172e+2, -0.14972683625798562581422125276e+3 },
+};
+
+#define MY_DOP853_STAGES    12      /* 主方法级数 */
+#define MY_DOP853_EXTENDED  16      /* 含稠密输出附加级的总级数 */
+
+/* 算法对象 */
+typedef struct  
+{
+    MwsIVPUtilFcns	m_utils;
+    void*           m_userData;
+
+} MyDop853;
+
+/* 状态快照（协同仿真回退用），创建问题时预分配 */
+typedef struct
+{
+    MoReal *m_y;            /* preY|curY|preYp|curYp 的副本，长度4n */
+    MoReal m_curTime;
+    MoReal m_preTime;
+    MoReal m_h;
+    MoBoolean m_valid;      /* 是否已保存过快照 */
+} MyDop853Snapshot;
+
+/* 求解问题的数据，用数据内存分配和释放函数 */
+typedef struct  
+{
+    /* m_preY、m_curY、m_preYp、m_curYp 依次位于同一块连续内存中（由m_preY持有） */
+    MoReal *m_preY;         /* 上一步y */
+    MoReal *m_curY;         /* 当前y */
+    MoReal *m_preYp;        /* 上一步y' */
+    MoReal *m_curYp;        /* 当前y' */
+
+    /* m_k、m_yStage、m_F 依次位于同一块连续内存中（由m_k持有） */
+    MoReal *m_k;            /* 16个级向量，第s级为 m_k + s*n */
+    MoReal *m_yStage;       /* 级间y */
+    MoReal *m_F;            /* 7个稠密输出系数向量 */
+
+    MoReal m_curTime;       /* 当前时间 */
+    MoReal m_preTime;       /* 上一步时间 */
+    MoReal m_initialStep;
+    MoReal m_h;             /* 下一步建议步长，0表示尚未开始积分 */
+    MyIVPController m_ctl;  /* 步长控制器参数，默认 MY_IVP_CONTROLLER_DEFAULT */
+
+    MoBoolean m_ypValid;    /* m_curYp 是否对应 (m_curTime, m_curY) */
+    MoBoolean m_stagesValid;/* m_k 是否对应最近一步 */
+    MoBoolean m_denseValid; /* m_F 是否已计算 */
+
+    MyDop853Snapshot m_snap;
+} MyDop853ProblemData;
+
+/* 求解问题对象 */
+typedef struct  
+{
+    MoSize          m_nStates;
+
+    MwsIVPOptions	m_opt;
+    MwsIVPCallback  m_callback;
+    void*			m_userData;
+    MY_IVP_TRACE_MEMBER(m_trace)
+
+    MyDop853ProblemData* m_data;
+    MyDop853* m_solverWork;
+
+} MyDop853Problem;
+
+void myDop853ProblemDestroy(MwsIVPSolverObj solver, MwsIVPObj ivp);
+void myDop853Destroy(MwsIVPSolverObj solver);
+MwsInteger myDop853SetController(MwsIVPSolverObj solver, MwsIVPObj ivp, const MyIVPController* ctl);
+
+/// <summary>
+/// 创建算法
+/// </summary>
+/// <param name="util_fcns">工具函数（仿真求解器提供，用户调用）</param>
+/// <param name="user_data">用户数据（求解器内部数据，传递给工具函数util_fcns，自定义算法无需关心其内容）</param>
+/// <returns></returns>
+MwsIVPSolverObj myDop853Create(MwsIVPUtilFcns* util_fcns, void* user_data)
+{
+    MyDop853* sw = (MyDop853*)util_fcns->m_allocMemory(user_data, 1, sizeof(MyDop853));
+
+    if (sw)
+    {
+        memset(sw, 0, sizeof(*sw));
+        sw->m_utils = *util_fcns;
+        sw->m_userData = user_data;
+    }
+
+    return sw;
+}
+
+/// <summary>
+/// 创建问题
+/// </summary>
+/// <param name="solver">积分算法对象</param>
+/// <param name="n">问题规模，即状态变量个数==微分方程阶数</param>
+/// <param name="call_back">回调函数</param>
+/// <param name="opt">求解器选项</param>
+/// <param name="ivp_user_data">用户数据(求解器内部数据，传递给回调函数call_back，算法无需关心)</param>
+/// <returns></returns>
+MwsIVPObj myDop853ProblemCreate(MwsIVPSolverObj solver, MwsSize n, MwsIVPCallback* call_back, MwsIVPOptions* opt, void* ivp_user_data)
+{
+    MyDop853* sw = (MyDop853*)solver;
+    MyDop853Problem* spw = (MyDop853Problem*)sw->m_utils.m_allocMemory(sw->m_userData, 1, sizeof(MyDop853Problem));
+
+    if (spw)
+    {
+        MyDop853ProblemData* ds = (MyDop853ProblemData*)sw->m_utils.m_allocDataMemory(sw->m_userData, 1, sizeof(MyDop853ProblemData));
+
+        if (ds == mwsNullPtr)
+        {
+            sw->m_utils.m_freeMemory(sw->m_userData, spw);
+            return mwsNullPtr;
+        }
+
+        memset(spw, 0, sizeof(*spw));
+        memset(ds, 0, sizeof(*ds));
+
+        spw->m_callback = *call_back;
+        spw->m_userData = ivp_user_data;
+        MY_IVP_TRACE_INTERPOSE(&spw->m_trace, &spw->m_callback, &spw->m_userData);
+        spw->m_opt = *opt;
+        spw->m_nStates = n;
+        spw->m_data = ds;
+        spw->m_solverWork = sw;
+        myDop853SetController(sw, spw, mwsNullPtr);
+
+        if (spw->m_nStates > 0)
+        {
+            ds->m_preY = (MoReal*)sw->m_utils.m_allocDataMemory(sw->m_userData, 4, n * sizeof(MoReal));
+            ds->m_k = (MoReal*)sw->m_utils.m_allocDataMemory(sw->m_userData, MY_DOP853_EXTENDED + 1 + 7, n * sizeof(MoReal));
+            ds->m_snap.m_y = (MoReal*)sw->m_utils.m_allocDataMemory(sw->m_userData, 4, n * sizeof(MoReal));
+
+            if (!ds->m_preY || !ds->m_k || !ds->m_snap.m_y)
+            {
+                myDop853ProblemDestroy(sw, spw);
+                spw = MWnullptr;
+            }
+            else
+            {
+                ds->m_curY = ds->m_preY + n;
+                ds->m_preYp = ds->m_preY + 2 * n;
+                ds->m_curYp = ds->m_preY + 3 * n;
+                ds->m_yStage = ds->m_k + MY_DOP853_EXTENDED * n;
+                ds->m_F = ds->m_yStage + n;
+
+                memset(ds->m_preY, 0, 4 * n * sizeof(MoReal));
+                memset(ds->m_k, 0, (MY_DOP853_EXTENDED + 1 + 7) * n * sizeof(MoReal));
+            }
+        }
+    }
+
+    return spw;
+}
+
+/// <summary>
+/// 初始化
+/// </summary>
+/// <param name="solver">积分算法对象</param>
+/// <param name="ivp">问题对象</param>
+/// <param name="t0">初始时间</param>
+/// <param name="y0">y的初始值（特定不为空）</param>
+/// <param name="yp0">y’的初始值（DAE）</param>
+/// <param name="is_reinit">是否重新初始化（保留）</param>
+/// <param name="reserve">保留参数，暂不使用</param>
+/// <returns></returns>
+MwsInteger myDop853Init(MwsIVPSolverObj solver, MwsIVPObj ivp, MwsReal t0, const MwsReal* y0,
+    const MwsReal* yp0, MwsBoolean is_reinit, void* reserve)
+{
+    MyDop853Problem* spw = (MyDop853Problem*)ivp;
+    MyDop853ProblemData* ds = spw->m_data;
+    MoSize nState = spw->m_nStates;
+    MoSize index;
+    MoReal oldNorm = 0;
+    MoReal newNorm = 0;
+
+    ds->m_curTime = t0;
+    ds->m_preTime = t0;
+    ds->m_stagesValid = moFalse;
+    ds->m_denseValid = moFalse;
+    if (!is_reinit)
+    {
+        /* 首次初始化：清空步长历史，旧快照作废 */
+        ds->m_h = 0;
+        ds->m_snap.m_valid = moFalse;
+    }
+
+    if (nState == 0 || y0 == mwsNullPtr)
+    {
+        ds->m_ypValid = moFalse;
+        return MWS_IVP_SUCCESS;
+    }
+
+    if (is_reinit && ds->m_ypValid)
+    {
+        for (index = 0; index < nState; ++index)
+        {
+            oldNorm += ds->m_curYp[index] * ds->m_curYp[index];
+        }
+    }
+
+    memcpy(ds->m_curY, y0, nState * sizeof(MoReal));
+    memcpy(ds->m_preY, y0, nState * sizeof(MoReal));
+    if (spw->m_callback.m_rshFunction(spw->m_userData, t0, ds->m_curY, ds->m_curYp) != MWS_IVP_SUCCESS)
+    {
+        ds->m_ypValid = moFalse;
+        return MWS_IVP_RHSFN_FAIL;
+    }
+    memcpy(ds->m_preYp, ds->m_curYp, nState * sizeof(MoReal));
+
+    /* 重新初始化：与myRK45Init相同，按y'跳变幅度缩小保留的步长 */
+    if (is_reinit && ds->m_h > 0 && ds->m_ypValid)
+    {
+        for (index = 0; index < nState; ++index)
+        {
+            newNorm += ds->m_curYp[index] * ds->m_curYp[index];
+        }
+        if (newNorm > oldNorm)
+        {
+            MoReal ratio = sqrt(oldNorm / newNorm);
+            ds->m_h *= (ratio < 0.1) ? 0.1 : ratio;
+        }
+    }
+    ds->m_ypValid = moTrue;
+
+    return MWS_IVP_SUCCESS;
+}
+
+/* 计算第s级的级间y：yStage = y + h*sum(a_sj*k_j) */
+static void myDop853StageY(MoSize n, MoInteger s, MoReal h, const MoReal* y, const MoReal* k, MoReal* yStage)
+{
+    MoSize index;
+    MoInteger j;
+
+    for (index = 0; index < n; ++index)
+    {
+        MoReal sum = 0;
+        for (j = 0; j < s; ++j)
+        {
+            sum += s_dop853A[s][j] * k[j * n + index];
+        }
+        yStage[index] = y[index] + h * sum;
+    }
+}
+
+/// <summary>
+/// 求解：每次调用前进一个被接受的积分步，误差超限时在内部缩小步长重试
+/// </summary>
+/// 输入：
+/// <param name="solver">积分算法对象</param>
+/// <param name="ivp">问题对象</param>
+/// <param name="step_size">初始积分步长（仅首步使用，<=0时自动选择）</param>
+/// <param name="t">当前时间</param>
+/// <param name="tout">输出结果时间</param>
+/// 输出：
+/// <param name="tret">结果实际达到的时间</param>
+/// <param name="yret">y的结果值（输入为当前y）</param>
+/// <param name="ypret">y’的结果值（可为空）</param>
+/// <param name="reserve">保留参数，暂不使用</param>
+/// <returns></returns>
+MwsInteger myDop853Solve(MwsIVPSolverObj solver, MwsIVPObj ivp, MwsReal step_size, MwsReal t, 
+    MwsReal tout, MwsReal* tret, MwsReal* yret, MwsReal* ypret, void* reserve)
+{
+    MyDop853Problem* spw = (MyDop853Problem*)ivp;
+    MyDop853ProblemData* ds = spw->m_data;
+
+    MoSize n = spw->m_nStates;
+    MoSize index;
+    MoInteger s, j;
+
+    MoReal* preY = ds->m_preY;
+    MoReal* curY = ds->m_curY;
+    MoReal* preYp = ds->m_preYp;
+    MoReal* curYp = ds->m_curYp;
+    MoReal* K = ds->m_k;
+    MoReal* yStage = ds->m_yStage;
+
+    MoReal rtol = myIVPRelTol(&spw->m_opt);
+    MoReal atol = myIVPAbsTol(&spw->m_opt);
+    MoReal h = ds->m_h;
+    MoReal errNorm = 0;
+    MoBoolean rejected = moFalse;
+
+    if (spw->m_opt.m_stopTimeDefined && t >= spw->m_opt.m_stopTime)
+    {
+        *tret = t;
+        return MWS_IVP_TSTOP_RETURN;
+    }
+
+    /* 当前状态（上一步的y1即本步的y0） */
+    memcpy(preY, yret, n * sizeof(MoReal));
+    if (ds->m_ypValid && t == ds->m_curTime)
+    {
+        memcpy(preYp, curYp, n * sizeof(MoReal));
+    }
+    else if (n > 0 && spw->m_callback.m_rshFunction(spw->m_userData, t, preY, preYp) != MWS_IVP_SUCCESS)
+    {
+        return MWS_IVP_RHSFN_FAIL;
+    }
+
+    if (h <= 0)
+    {
+        h = step_size;
+        if (h <= 0 && myIVPInitialStep(&spw->m_callback, spw->m_userData, n, t, preY, preYp, rtol, atol, 7,
+            myIVPMaxStep(&spw->m_opt), K + n, K + 2 * n, &h) != MWS_IVP_SUCCESS)
+        {
+            return MWS_IVP_RHSFN_FAIL;
+        }
+    }
+
+    memcpy(K, preYp, n * sizeof(MoReal));
+    for (;;)
+    {
+        MoReal err3 = 0;
+        MoReal err5 = 0;
+        MY_IVP_TRACE_BEGIN(attempt)
+
+        h = myIVPClampStep(&spw->m_opt, t, h);
+        if (h < myIVPMinStep(t))
+        {
+            return MWS_IVP_FAIL;    /* 步长过小 */
+        }
+
+        for (s = 1; s < MY_DOP853_STAGES; ++s)
+        {
+            myDop853StageY(n, s, h, preY, K, yStage);
+            if (spw->m_callback.m_rshFunction(spw->m_userData, t + s_dop853C[s] * h, yStage, K + s * n) != MWS_IVP_SUCCESS)
+            {
+                return MWS_IVP_RHSFN_FAIL;
+            }
+        }
+        myDop853StageY(n, MY_DOP853_STAGES, h, preY, K, curY);
+
+        /* 误差估计：5阶与3阶嵌入误差组合（Hairer的dop853误差范数） */
+        for (index = 0; index < n; ++index)
+        {
+            MoReal e3 = 0, e5 = 0, sc;
+            MoReal a = fabs(preY[index]);
+            MoReal b = fabs(curY[index]);
+
+            for (j = 0; j < MY_DOP853_STAGES; ++j)
+            {
+                MoReal kj = K[j * n + index];
+                e3 += (s_dop853A[MY_DOP853_STAGES][j] - s_dop853Bhh[j]) * kj;
+                e5 += s_dop853E5[j] * kj;
+            }
+            sc = atol + rtol * (a > b ? a : b);
+            err3 += (e3 / sc) * (e3 / sc);
+            err5 += (e5 / sc) * (e5 / sc);
+        }
+        if (err5 > 0 || err3 > 0)
+        {
+            errNorm = h * err5 / sqrt((err5 + 0.01 * err3) * n);
+        }
+        else
+        {
+            errNorm = 0;
+        }
+
+        if (errNorm <= 1)
+        {
+            MY_IVP_TRACE_END(MY_IVP_TRACE_STEP, attempt);
+            break;
+        }
+        h *= myIVPStepFactorCtl(&ds->m_ctl, errNorm, 7);
+        rejected = moTrue;
+        MY_IVP_TRACE_END(MY_IVP_TRACE_REJECT, attempt);
+    }
+
+    /* 接受：f(t+h,y1) 即下一步首级（FSAL），同时作为稠密输出的第12级 */
+    if (n > 0 && spw->m_callback.m_rshFunction(spw->m_userData, t + h, curY, curYp) != MWS_IVP_SUCCESS)
+    {
+        return MWS_IVP_RHSFN_FAIL;
+    }
+    memcpy(K + MY_DOP853_STAGES * n, curYp, n * sizeof(MoReal));
+
+    ds->m_preTime = t;
+    ds->m_curTime = t + h;
+    ds->m_initialStep = h;
+    ds->m_ypValid = moTrue;
+    ds->m_stagesValid = moTrue;
+    ds->m_denseValid = moFalse;
+
+    /* 刚被拒绝过的步不再放大步长 */
+    if (rejected)
+    {
+        ds->m_h = h * (myIVPStepFactorCtl(&ds->m_ctl, errNorm, 7) < 1 ? myIVPStepFactorCtl(&ds->m_ctl, errNorm, 7) : 1);
+    }
+    else
+    {
+        ds->m_h = h * myIVPStepFactorCtl(&ds->m_ctl, errNorm, 7);
+    }
+
+    memcpy(yret, curY, n * sizeof(MoReal));
+    if (ypret)
+    {
+        memcpy(ypret, curYp, n * sizeof(MoReal));
+    }
+    *tret = ds->m_curTime;
+
+    return MWS_IVP_SUCCESS;
+}
+
+/* 补算3个附加级并生成7阶稠密输出系数 F0..F6 */
+static MwsInteger myDop853Dense(MyDop853Problem* spw)
+{
+    MyDop853ProblemData* ds = spw->m_data;
+    MoSize n = spw->m_nStates;
+    MoSize index;
+    MoInteger s, j;
+    MoReal h = ds->m_curTime - ds->m_preTime;
+    MoReal* K = ds->m_k;
+    MoReal* F = ds->m_F;
+
+    for (s = MY_DOP853_STAGES + 1; s < MY_DOP853_EXTENDED; ++s)
+    {
+        myDop853StageY(n, s, h, ds->m_preY, K, ds->m_yStage);
+        if (spw->m_callback.m_rshFunction(spw->m_userData, ds->m_preTime + s_dop853C[s] * h, ds->m_yStage, K + s * n) != MWS_IVP_SUCCESS)
+        {
+            return MWS_IVP_RHSFN_FAIL;
+        }
+    }
+
+    for (index = 0; index < n; ++index)
+    {
+        MoReal dy = ds->m_curY[index] - ds->m_preY[index];
+
+        F[index] = dy;
+        F[n + index] = h * ds->m_preYp[index] - dy;
+        F[2 * n + index] = 2 * dy - h * (ds->m_curYp[index] + ds->m_preYp[index]);
+        for (s = 0; s < 4; ++s)
+        {
+            MoReal sum = 0;
+            for (j = 0; j < MY_DOP853_EXTENDED; ++j)
+            {
+                sum += s_dop853D[s][j] * K[j * n + index];
+            }
+            F[(3 + s) * n + index] = h * sum;
+        }
+    }
+
+    ds->m_denseValid = moTrue;
+    return MWS_IVP_SUCCESS;
+}
+
+/// <summary>
+/// 插值：7阶稠密输出，首次调用时补算3级；快照恢复后级向量失效，退化为三次Hermite插值
+/// </summary>
+/// 输入：
+/// <param name="solver">积分算法对象</param>
+/// <param name="ivp">问题对象</param>
+/// <param name="tout">输出结果的时间</param>
+/// 输出：
+/// <param name="yret">y的结果值</param>
+/// <param name="reserve"></param>
+/// <returns></returns>
+MwsInteger myDop853Interpolate(MwsIVPSolverObj solver, MwsIVPObj ivp, MwsReal tout, MwsReal* yret, void* reserve)
+{
+    MyDop853Problem* spw = (MyDop853Problem*)ivp;
+    MyDop853ProblemData* ds = spw->m_data;
+    MoSize n = spw->m_nStates;
+    MoSize index;
+    MoReal h = ds->m_curTime - ds->m_preTime;
+    MoReal x;
+
+    if (h == 0)
+    {
+        memcpy(yret, ds->m_curY, n * sizeof(MoReal));
+        return MWS_IVP_SUCCESS;
+    }
+    x = (tout - ds->m_preTime) / h;
+
+    if (!ds->m_stagesValid)
+    {
+        myIVPHermite(n, x, h, ds->m_preY, ds->m_curY, ds->m_preYp, ds->m_curYp, yret);
+        return MWS_IVP_SUCCESS;
+    }
+    if (!ds->m_denseValid && myDop853Dense(spw) != MWS_IVP_SUCCESS)
+    {
+        return MWS_IVP_RHSFN_FAIL;
+    }
+
+    for (index = 0; index < n; ++index)
+    {
+        const MoReal* F = ds->m_F + index;
+        /* y = y0 + x*(F0 + (1-x)*(F1 + x*(F2 + (1-x)*(F3 + x*(F4 + (1-x)*(F5 + x*F6)))))) */
+        MoReal y = F[6 * n] * x;
+        y = (y + F[5 * n]) * (1 - x);
+        y = (y + F[4 * n]) * x;
+        y = (y + F[3 * n]) * (1 - x);
+        y = (y + F[2 * n]) * x;
+        y = (y + F[n]) * (1 - x);
+        y = (y + F[0]) * x;
+        yret[index] = ds->m_preY[index] + y;
+    }
+
+    return MWS_IVP_SUCCESS;
+}
+
+/// <summary>
+/// 保存状态快照，只拷贝到预分配的快照区，不分配内存
+/// </summary>
+/// <param name="solver">积分算法对象</param>
+/// <param name="ivp">问题对象</param>
+/// <returns></returns>
+MwsInteger myDop853SaveState(MwsIVPSolverObj solver, MwsIVPObj ivp)
+{
+    MyDop853Problem* spw = (MyDop853Problem*)ivp;
+    MyDop853ProblemData* ds = spw->m_data;
+
+    if (spw->m_nStates > 0)
+    {
+        memcpy(ds->m_snap.m_y, ds->m_preY, 4 * spw->m_nStates * sizeof(MoReal));
+    }
+    ds->m_snap.m_curTime = ds->m_curTime;
+    ds->m_snap.m_preTime = ds->m_preTime;
+    ds->m_snap.m_h = ds->m_h;
+    ds->m_snap.m_valid = moTrue;
+
+    return MWS_IVP_SUCCESS;
+}
+
+/// <summary>
+/// 恢复到最近一次保存的快照，步长历史一并恢复
+/// </summary>
+/// 输入：
+/// <param name="solver">积分算法对象</param>
+/// <param name="ivp">问题对象</param>
+/// 输出：
+/// <param name="tret">快照时刻（可为空）</param>
+/// <param name="yret">快照时刻y的值（可为空）</param>
+/// <param name="ypret">快照时刻y'的值（可为空）</param>
+/// <returns>未保存过快照时返回MWS_IVP_INVALID_INPUT</returns>
+MwsInteger myDop853RestoreState(MwsIVPSolverObj solver, MwsIVPObj ivp, MwsReal* tret, MwsReal* yret, MwsReal* ypret)
+{
+    MyDop853Problem* spw = (MyDop853Problem*)ivp;
+    MyDop853ProblemData* ds = spw->m_data;
+    MoSize nState = spw->m_nStates;
+
+    if (!ds->m_snap.m_valid)
+    {
+        return MWS_IVP_INVALID_INPUT;
+    }
+
+    if (nState > 0)
+    {
+        memcpy(ds->m_preY, ds->m_snap.m_y, 4 * nState * sizeof(MoReal));
+    }
+    ds->m_curTime = ds->m_snap.m_curTime;
+    ds->m_preTime = ds->m_snap.m_preTime;
+    ds->m_h = ds->m_snap.m_h;
+    ds->m_ypValid = moTrue;
+    ds->m_stagesValid = moFalse;
+    ds->m_denseValid = moFalse;
+
+    if (tret)
+    {
+        *tret = ds->m_curTime;
+    }
+    if (yret && nState > 0)
+    {
+        memcpy(yret, ds->m_curY, nState * sizeof(MoReal));
+    }
+    if (ypret && nState > 0)
+    {
+        memcpy(ypret, ds->m_curYp, nState * sizeof(MoReal));
+    }
+
+    return MWS_IVP_SUCCESS;
+}
+
+/// <summary>
+/// 设置步长控制器参数（安全因子与单步缩放倍数上下限），不影响已有的步长历史
+/// </summary>
+/// <param name="solver">积分算法对象</param>
+/// <param name="ivp">问题对象</param>
+/// <param name="ctl">控制器参数，为空时恢复默认值</param>
+/// <returns>参数无效时返回MWS_IVP_INVALID_INPUT</returns>
+MwsInteger myDop853SetController(MwsIVPSolverObj solver, MwsIVPObj ivp, const MyIVPController* ctl)
+{
+    static const MyIVPController defaultCtl = MY_IVP_CONTROLLER_DEFAULT;
+    MyDop853Problem* spw = (MyDop853Problem*)ivp;
+
+    if (ctl == mwsNullPtr)
+    {
+        ctl = &defaultCtl;
+    }
+    if (!myIVPControllerValid(ctl))
+    {
+        return MWS_IVP_INVALID_INPUT;
+    }
+    spw->m_data->m_ctl = *ctl;
+
+    return MWS_IVP_SUCCESS;
+}
+
+/// <summary>
+/// 销毁问题
+/// </summary>
+/// <param name="solver"></param>
+/// <param name="ivp"></param>
+void myDop853ProblemDestroy(MwsIVPSolverObj solver, MwsIVPObj ivp)
+{
+    MyDop853* sw = (MyDop853*)solver;
+    MyDop853Problem* spw = (MyDop853Problem*)ivp;
+
+    if (spw)
+    {
+        if (spw->m_data->m_preY)
+        {
+            (*sw->m_utils.m_freeDataMemory)(sw->m_userData, spw->m_data->m_preY);
+        }
+
+        if (spw->m_data->m_k)
+        {
+            (*sw->m_utils.m_freeDataMemory)(sw->m_userData, spw->m_data->m_k);
+        }
+
+        if (spw->m_data->m_snap.m_y)
+        {
+            (*sw->m_utils.m_freeDataMemory)(sw->m_userData, spw->m_data->m_snap.m_y);
+        }
+
+        if (spw->m_data)
+        {
+            (*sw->m_utils.m_freeDataMemory)(sw->m_userData, spw->m_data);
+        }
+
+        (*sw->m_utils.m_freeMemory)(sw->m_userData, spw);
+    }
+}
+
+/// <summary>
+/// 销毁积分算法
+/// </summary>
+/// <param name="solver"></param>
+void myDop853Destroy(MwsIVPSolverObj solver)
+{
+    MyDop853* sw = (MyDop853*)solver;
+
+    if (sw)
+    {
+        (*sw->m_utils.m_freeMemory)(sw->m_userData, sw);
+    }
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+
+/***************************************************************************
+//   end of file
+***************************************************************************/
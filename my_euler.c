@@ -1,300 +1,1115 @@
-/***************************************************************************
-///
-/// Copyright (c) 2020, ͬԪϢ޹˾
-/// All rights reserved.
-///
-/// @file           my_euler.c
-/// @brief          ʽŷ㷨ʾ
-///
-/// @version        v1.0
-/// @author         
-/// @date           2020/07/07
-///
-***************************************************************************/
-
-#include "mo_types.h"
-#include "mws_ivp_solver.h"
-
-#include <memory.h>
-
-#ifdef __cplusplus
-extern "C"{
-#endif
-
-/* 㷨 */
-typedef struct  
-{
-    MwsIVPUtilFcns	m_utils;
-    void*           m_userData;
-
-} MyEuler;
-
-/* ݣڴͷź */
-typedef struct  
-{
-    MoReal *m_preY;
-    MoReal *m_curY;  
-    MoReal *m_preYp;
-
-    MoReal m_curTime;
-    MoReal m_initialStep;
-} MyEulerProblemData;
-
-/*  */
-typedef struct  
-{
-    MoSize          m_nStates;
-
-    MwsIVPOptions	m_opt;
-    MwsIVPCallback  m_callback;
-    void*			m_userData;
-
-    MyEulerProblemData* m_data;
-    MyEuler* m_solverWork;
-
-} MyEulerProblem;
-
-void myEulerProblemDestroy(MwsIVPSolverObj solver, MwsIVPObj ivp);
-void myEulerDestroy(MwsIVPSolverObj solver);
-
-/// <summary>
-/// 㷨
-/// </summary>
-/// <param name="util_fcns">ߺṩûã</param>
-/// <param name="user_data">ûݣڲݣݸߺutil_fcnsԶ㷨ݣ</param>
-/// <returns></returns>
-MwsIVPSolverObj myEulerCreate(MwsIVPUtilFcns* util_fcns, void* user_data)
-{
-    MyEuler* sw = (MyEuler*)util_fcns->m_allocMemory(user_data, 1, sizeof(MyEuler));
-
-    if (sw)
-    {
-        memset(sw, 0, sizeof(*sw));
-        sw->m_utils = *util_fcns;
-        sw->m_userData = user_data;
-    }
-
-    return sw;
-}
-
-/// <summary>
-/// 
-/// </summary>
-/// <param name="solver">㷨</param>
-/// <param name="n">ģ״̬==΢ַ̽</param>
-/// <param name="call_back">ص</param>
-/// <param name="opt">ѡ</param>
-/// <param name="ivp_user_data">û(ڲݣݸصcall_back㷨)</param>
-/// <returns></returns>
-MwsIVPObj myEulerProblemCreate(MwsIVPSolverObj solver, MwsSize n, MwsIVPCallback* call_back, MwsIVPOptions* opt, void* ivp_user_data)
-{
-    MyEuler* sw = (MyEuler*)solver;
-    MyEulerProblem* spw = (MyEulerProblem*)sw->m_utils.m_allocMemory(sw->m_userData, 1, sizeof(MyEulerProblem));
-
-    if (spw)
-    {
-        MyEulerProblemData* ds = (MyEulerProblemData*)sw->m_utils.m_allocDataMemory(sw->m_userData, 1, sizeof(MyEulerProblemData));
-
-        if (ds == mwsNullPtr)
-        {
-            sw->m_utils.m_freeMemory(sw->m_userData, spw);
-            return mwsNullPtr;
-        }
-
-        memset(spw, 0, sizeof(*spw));
-        memset(ds, 0, sizeof(*ds));
-
-        spw->m_callback = *call_back;
-        spw->m_userData = ivp_user_data;
-        spw->m_nStates = n;
-        spw->m_data = ds;
-        spw->m_solverWork = sw;
-
-        spw->m_data->m_curTime = 0;
-        spw->m_data->m_initialStep = 0.002;
-
-        if (spw->m_nStates > 0)
-        {
-            spw->m_data->m_preY = (MoReal *)sw->m_utils.m_allocDataMemory(sw->m_userData, 1, n*sizeof(MoReal));  //(MoReal *)ǿת
-            spw->m_data->m_curY = (MoReal *)sw->m_utils.m_allocDataMemory(sw->m_userData, 1, n*sizeof(MoReal));
-            spw->m_data->m_preYp = (MoReal*)sw->m_utils.m_allocDataMemory(sw->m_userData, 1, n * sizeof(MoReal));
-
-            if (!spw->m_data->m_preY || !spw->m_data->m_curY)
-            {
-                myEulerProblemDestroy(sw, spw);
-                spw = MWnullptr;
-            }
-            else
-            {
-                MoSize index;
-                for (index=0; index<n; ++index)
-                {
-                    spw->m_data->m_preY[index] = 0;
-                    spw->m_data->m_curY[index] = 0;
-                    spw->m_data->m_preYp[index] = 0;
-                }
-            }
-        }
-    }
-
-    return spw;   //أ(Զ㷨ڲݣ)Ϊӿںĵڶ±ߵivp
-}
-
-/// <summary>
-/// ʼ
-/// </summary>
-/// <param name="solver">㷨</param>
-/// <param name="ivp"></param>
-/// <param name="t0">ʼʱ</param>
-/// <param name="y0">yĳʼֵضΪգ</param>
-/// <param name="yp0">yĳʼֵDAE</param>
-/// <param name="is_reinit">Ƿ³ʼ</param>
-/// <param name="reserve">ݲʹ</param>
-/// <returns></returns>
-MwsInteger myEulerInit(MwsIVPSolverObj solver, MwsIVPObj ivp, MwsReal t0, const MwsReal* y0, 
-    const MwsReal* yp0, MwsBoolean is_reinit, void* reserve)
-{
-    /* nothing to do */
-    return MWS_IVP_SUCCESS;  //״̬ȡMwsIVPStatusֵ
-}
-
-/// <summary>
-/// 
-/// </summary>
-/// 룺
-/// <param name="solver">㷨</param>
-/// <param name="ivp"></param>
-/// <param name="step_size">ʼֲ</param>
-/// <param name="t">ǰʱ</param>
-/// <param name="tout">ʱ</param>
-/// 
-/// <param name="tret">ʵʴﵽʱ</param>
-/// <param name="yret">yĽֵ</param>
-/// <param name="ypret">yĽֵDAE</param>
-/// <param name="reserve">ݲʹ</param>
-/// <returns></returns>
-MwsInteger myEulerSolve(MwsIVPSolverObj solver, MwsIVPObj ivp, MwsReal step_size, MwsReal t, 
-    MwsReal tout, MwsReal* tret, MwsReal* yret, MwsReal* ypret, void* reserve)
-{
-    MyEuler* sw = (MyEuler*)solver;
-    MyEulerProblem* spw = (MyEulerProblem*)ivp;
-
-    MoSize index = 0;
-    MoSize nState = spw->m_nStates;
-
-    spw->m_data->m_curTime = t;
-    spw->m_data->m_initialStep = step_size;
-
-    MoReal* preY = spw->m_data->m_preY;                 //ϸy
-    MoReal* curY = spw->m_data->m_curY;                 //ǰy
-    MoReal* preYp = spw->m_data->m_preYp;               //ϸy'
-   
-    for (index = 0; index<nState; ++index)              
-    {
-        preY[index] = yret[index];
-        preYp[index] = ypret[index];
-
-        MoReal* k1 = preYp[index];
-        MoReal* k2 = spw->m_callback.m_rshFunction(spw->m_userData, spw->m_data->m_curTime + spw->m_data->m_initialStep, 
-                                                    yret[index] + spw->m_data->m_initialStep * k1, ypret[index]);
-                                                                //k2=f(xn+h,yn+h*k1)
-        yret[index] += spw->m_data->m_initialStep / 2 * (k1 + k2);      //ιʽ
-        
-        curY[index] = yret[index];
-    }
-    
-
-    /* µǰʱ */
-    *tret += spw->m_data->m_initialStep;                //ʱһ˵˴ÿһڵĴⲿж㷨ѭ
-
-    return MWS_IVP_SUCCESS;  //״̬ȡMwsIVPStatusֵ
-}
-
-/// <summary>
-/// ɲֵynߣ
-/// </summary>
-/// 룺
-/// <param name="solver">㷨</param>
-/// <param name="ivp"></param>
-/// <param name="tout">ʱ</param>
-/// 
-/// <param name="yret">yĽֵ</param>
-/// <param name="reserve"></param>
-/// <returns></returns>
-MwsInteger myEulerInterpolate(MwsIVPSolverObj solver, MwsIVPObj ivp, MwsReal tout, MwsReal* yret, void* reserve)
-{
-    /* Բֵ */
-    MyEuler* sw = (MyEuler*)solver;
-    MyEulerProblem* spw = (MyEulerProblem*)ivp;
-
-    MoSize nStates = spw->m_nStates;
-    MoSize index;
-
-    for (index=0; index<nStates; ++index)
-    {
-        /* Բֵ: 
-                    f(x2)-f(x1)
-            L(x) = ------------ * (x - x1) + f(x1)
-                       x2-x1 
-        */
-        yret[index] = (spw->m_data->m_curY[index] - spw->m_data->m_preY[index]) * (
-            tout - spw->m_data->m_curTime + spw->m_data->m_initialStep) / spw->m_data->m_initialStep + spw->m_data->m_preY[index]; 
-    }
-
-    return MWS_IVP_SUCCESS;
-}
-
-/// <summary>
-/// 
-/// </summary>
-/// <param name="solver"></param>
-/// <param name="ivp"></param>
-void myEulerProblemDestroy(MwsIVPSolverObj solver, MwsIVPObj ivp)
-{
-    MyEuler* sw = (MyEuler*)solver;
-    MyEulerProblem* spw = (MyEulerProblem*)ivp;
-
-    if (spw)
-    {
-        if (spw->m_data->m_preY)
-        {
-            (*sw->m_utils.m_freeDataMemory)(sw->m_userData, spw->m_data->m_preY);
-        }
-
-        if (spw->m_data->m_curY)
-        {
-            (*sw->m_utils.m_freeDataMemory)(sw->m_userData, spw->m_data->m_curY);
-        }
-
-        if (spw->m_data)
-        {
-            (*sw->m_utils.m_freeDataMemory)(sw->m_userData, spw->m_data);
-        }
-
-        (*sw->m_utils.m_freeMemory)(sw->m_userData, spw);
-    }
-}
-
-/// <summary>
-/// ٻ㷨
-/// </summary>
-/// <param name="solver"></param>
-void myEulerDestroy(MwsIVPSolverObj solver)
-{
-    MyEuler* sw = (MyEuler*)solver;
-
-    if (sw)
-    {
-        (*sw->m_utils.m_freeMemory)(sw->m_userData, sw);
-    }
-}
-
-#ifdef __cplusplus
-}
-#endif
-
-
-/***************************************************************************
-//   end of file
-***************************************************************************/
-
+/***************************************************************************
+///
+/// Copyright (c) 2020, 苏州同元软控信息技术有限公司
+/// All rights reserved.
+///
+/// @file           my_euler.c
+/// @brief          实时定步长积分算法：显式欧拉、Heun（默认）、经典RK4可选，单步耗时统计与帧预算检查，
+///                 右端函数失败时细分重试；另支持单精度模式、状态快照回退与对象池复用
+///
+/// @version        v1.0
+/// @author         田显钊
+/// @date           2020/07/07
+///
+***************************************************************************/
+
+/* -std=c99/c11 等严格模式下 <time.h> 不声明 clock_gettime，须在包含任何系统头文件前打开POSIX接口 */
+#if !defined(_WIN32) && defined(__STRICT_ANSI__) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 199309L
+#endif
+
+#include "mo_types.h"
+#include "mws_ivp_solver.h"
+#include "my_ivp_trace.h"
+#include "my_rk_engine.h"
+
+#include <memory.h>
+#include <stdio.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+/* 实时定步长积分方法 */
+typedef enum
+{
+    MY_EULER_EXPLICIT = 0,  /* 显式欧拉，每步1次右端函数 */
+    MY_EULER_HEUN,          /* Heun（改进欧拉/梯形预估校正），每步2次右端函数，默认 */
+    MY_EULER_RK4,           /* 经典4阶龙格库塔，每步4次右端函数 */
+} MyEulerMethod;
+
+/* MyEulerMethod 对应的引擎Butcher表，单精度模式用 */
+static const MoInteger s_myEulerRKMethod[] = { MY_RK_EULER1, MY_RK_HEUN2, MY_RK_CLASSIC4 };
+#define MY_EULER_MAX_STAGES 4
+
+/* 单步耗时直方图：<16ns 每纳秒一格，之后每个2的幂区间再分8格（相对误差<12.5%），上限约2^40ns */
+#define MY_EULER_HIST_BINS  (16 + 37 * 8)
+
+/* 单步耗时统计（单位：秒），供查询用 */
+typedef struct
+{
+    MoSize m_steps;         /* 统计的步数 */
+    MoSize m_overruns;      /* 超过帧预算的步数 */
+    MoReal m_min;
+    MoReal m_max;
+    MoReal m_mean;
+    MoReal m_p99;           /* 99%分位数（直方图上界） */
+} MyEulerTimingStats;
+
+/* 实时运行参数与耗时记录，步进路径上只做整数累加，不分配内存、不写日志 */
+typedef struct
+{
+    MyEulerMethod m_method;
+    unsigned long long m_budgetNs;      /* 帧预算，0表示不检查 */
+    unsigned long long m_steps;
+    unsigned long long m_overruns;
+    unsigned long long m_minNs;
+    unsigned long long m_maxNs;
+    unsigned long long m_sumNs;
+    unsigned long long m_hist[MY_EULER_HIST_BINS];
+} MyEulerTiming;
+
+#define MY_EULER_POOL_SIZE  8   /* 算法对象缓存的已销毁问题对象数上限 */
+
+/* 右端函数失败时把整步细分重做：默认重试次数与每次重试的子步长缩小倍数（子步数乘以其倒数） */
+#define MY_EULER_RHS_RETRIES    3
+#define MY_EULER_RHS_SHRINK     0.25
+
+struct MyEulerProblem;
+
+/* 算法对象 */
+typedef struct  
+{
+    MwsIVPUtilFcns	m_utils;
+    void*           m_userData;
+
+    /* 已销毁问题对象池：连同工作区保留，按状态数复用，参数扫描反复创建销毁问题时不再分配内存 */
+    struct MyEulerProblem* m_pool[MY_EULER_POOL_SIZE];
+    MoInteger m_poolCount;
+
+} MyEuler;
+
+/* 状态快照（协同仿真回退用），创建问题时预分配 */
+typedef struct
+{
+    MoReal *m_y;            /* preY|curY|preYp 的副本，长度3n */
+    MoReal m_curTime;
+    MoReal m_initialStep;
+    MoBoolean m_valid;      /* 是否已保存过快照 */
+} MyEulerSnapshot;
+
+/* 求解问题的数据，用数据内存分配和释放函数 */
+typedef struct  
+{
+    /* m_preY、m_curY、m_preYp 依次位于同一块连续内存中（由m_preY持有） */
+    MoReal *m_preY;
+    MoReal *m_curY;  
+    MoReal *m_preYp;
+
+    /* m_k2、m_k3、m_k4、m_yStage、m_yRetry 依次位于同一块连续内存中（由m_k2持有），创建问题时一次分配 */
+    MoReal *m_k2;
+    MoReal *m_k3;
+    MoReal *m_k4;
+    MoReal *m_yStage;
+    MoReal *m_yRetry;       /* 重试用的步起点 y|y'，长度2n */
+
+    /* 右端函数失败的重试策略（myEulerSetRhsRetry）与累计重试次数 */
+    MoInteger m_retryMax;
+    MoReal m_retryShrink;
+    MoSize m_retries;
+
+    MoReal m_curTime;
+    MoReal m_initialStep;
+
+    /* 单精度模式（myEulerSetSinglePrecision）：float区依次为 y|y1|comp|comp1|引擎工作区，
+       长度(MY_EULER_MAX_STAGES+5)*n，由m_yF持有；插值历史、快照与返回值仍为双精度 */
+    float* m_yF;
+    float* m_y1F;
+    float* m_compF;         /* 补偿求和的舍入误差 */
+    float* m_comp1F;
+    float* m_workF;         /* 前n为第1级 f(t,y) */
+    MoReal* m_shim;         /* 右端函数的双精度转换区，长度2n */
+    MyRKRhsF32 m_rhsF32;
+    MoBoolean m_f32;
+    MoBoolean m_compensated;
+    MoBoolean m_f32Valid;   /* m_yF、m_compF 是否对应 m_curTime 的状态 */
+
+    MyEulerSnapshot m_snap;
+    MyEulerTiming m_timing;
+} MyEulerProblemData;
+
+/* 求解问题对象 */
+typedef struct MyEulerProblem
+{
+    MoSize          m_nStates;
+
+    MwsIVPOptions	m_opt;
+    MwsIVPCallback  m_callback;
+    void*			m_userData;
+    MY_IVP_TRACE_MEMBER(m_trace)
+
+    MyEulerProblemData* m_data;
+    MyEuler* m_solverWork;
+
+} MyEulerProblem;
+
+void myEulerProblemDestroy(MwsIVPSolverObj solver, MwsIVPObj ivp);
+void myEulerDestroy(MwsIVPSolverObj solver);
+
+/* 释放问题对象及其全部工作区 */
+static void myEulerProblemFree(MyEuler* sw, MyEulerProblem* spw)
+{
+    MyEulerProblemData* ds = spw->m_data;
+
+    if (ds)
+    {
+        if (ds->m_preY)     /* m_curY、m_preYp 与之同一块内存 */
+        {
+            (*sw->m_utils.m_freeDataMemory)(sw->m_userData, ds->m_preY);
+        }
+
+        if (ds->m_snap.m_y)
+        {
+            (*sw->m_utils.m_freeDataMemory)(sw->m_userData, ds->m_snap.m_y);
+        }
+
+        if (ds->m_k2)       /* m_k3、m_k4、m_yStage、m_yRetry 与之同一块内存 */
+        {
+            (*sw->m_utils.m_freeDataMemory)(sw->m_userData, ds->m_k2);
+        }
+
+        if (ds->m_yF)       /* 单精度模式的各向量与之同一块内存 */
+        {
+            (*sw->m_utils.m_freeDataMemory)(sw->m_userData, ds->m_yF);
+        }
+
+        if (ds->m_shim)
+        {
+            (*sw->m_utils.m_freeDataMemory)(sw->m_userData, ds->m_shim);
+        }
+
+        (*sw->m_utils.m_freeDataMemory)(sw->m_userData, ds);
+    }
+
+    (*sw->m_utils.m_freeMemory)(sw->m_userData, spw);
+}
+
+/* 从对象池取出状态数为n的问题对象，并把除工作区外的数据恢复为新建时的值；没有时返回空 */
+static MyEulerProblem* myEulerPoolTake(MyEuler* sw, MoSize n)
+{
+    MyEulerProblem* spw;
+    MyEulerProblemData* ds;
+    MyEulerProblemData kept;
+    MoInteger index;
+
+    for (index = 0; index < sw->m_poolCount; ++index)
+    {
+        if (sw->m_pool[index]->m_nStates == n)
+        {
+            break;
+        }
+    }
+    if (index == sw->m_poolCount)
+    {
+        return mwsNullPtr;
+    }
+    spw = sw->m_pool[index];
+    sw->m_pool[index] = sw->m_pool[--sw->m_poolCount];
+
+    ds = spw->m_data;
+    kept = *ds;
+    memset(ds, 0, sizeof(*ds));
+    ds->m_preY = kept.m_preY;
+    ds->m_curY = kept.m_curY;
+    ds->m_preYp = kept.m_preYp;
+    ds->m_k2 = kept.m_k2;
+    ds->m_k3 = kept.m_k3;
+    ds->m_k4 = kept.m_k4;
+    ds->m_yStage = kept.m_yStage;
+    ds->m_yRetry = kept.m_yRetry;
+    ds->m_yF = kept.m_yF;
+    ds->m_y1F = kept.m_y1F;
+    ds->m_compF = kept.m_compF;
+    ds->m_comp1F = kept.m_comp1F;
+    ds->m_workF = kept.m_workF;
+    ds->m_shim = kept.m_shim;
+    ds->m_snap.m_y = kept.m_snap.m_y;
+    if (n > 0)
+    {
+        memset(ds->m_preY, 0, 3 * n * sizeof(MoReal));
+    }
+
+    return spw;
+}
+
+/// <summary>
+/// 创建算法
+/// </summary>
+/// <param name="util_fcns">工具函数（由求解器提供，用户调用）</param>
+/// <param name="user_data">用户数据（求解器内部数据，传递给工具函数util_fcns，自定义算法无需关心其内容）</param>
+/// <returns></returns>
+MwsIVPSolverObj myEulerCreate(MwsIVPUtilFcns* util_fcns, void* user_data)
+{
+    MyEuler* sw = (MyEuler*)util_fcns->m_allocMemory(user_data, 1, sizeof(MyEuler));
+
+    if (sw)
+    {
+        memset(sw, 0, sizeof(*sw));
+        sw->m_utils = *util_fcns;
+        sw->m_userData = user_data;
+    }
+
+    return sw;
+}
+
+/// <summary>
+/// 创建问题：对象池中有同规模的问题对象时直接复用，不分配内存
+/// </summary>
+/// <param name="solver">积分算法对象</param>
+/// <param name="n">问题规模，即状态变量数量==微分方程阶数</param>
+/// <param name="call_back">回调函数</param>
+/// <param name="opt">积分器选项</param>
+/// <param name="ivp_user_data">用户数据(求解器内部数据，传递给回调函数call_back，算法不需关心)</param>
+/// <returns></returns>
+MwsIVPObj myEulerProblemCreate(MwsIVPSolverObj solver, MwsSize n, MwsIVPCallback* call_back, MwsIVPOptions* opt, void* ivp_user_data)
+{
+    MyEuler* sw = (MyEuler*)solver;
+    MyEulerProblem* spw = myEulerPoolTake(sw, n);
+
+    if (spw)
+    {
+        spw->m_callback = *call_back;
+        spw->m_userData = ivp_user_data;
+        MY_IVP_TRACE_INTERPOSE(&spw->m_trace, &spw->m_callback, &spw->m_userData);
+        spw->m_data->m_initialStep = 0.002;
+        spw->m_data->m_timing.m_method = MY_EULER_HEUN;
+        spw->m_data->m_retryMax = MY_EULER_RHS_RETRIES;
+        spw->m_data->m_retryShrink = MY_EULER_RHS_SHRINK;
+        return spw;
+    }
+
+    spw = (MyEulerProblem*)sw->m_utils.m_allocMemory(sw->m_userData, 1, sizeof(MyEulerProblem));
+    if (spw)
+    {
+        MyEulerProblemData* ds = (MyEulerProblemData*)sw->m_utils.m_allocDataMemory(sw->m_userData, 1, sizeof(MyEulerProblemData));
+
+        if (ds == mwsNullPtr)
+        {
+            sw->m_utils.m_freeMemory(sw->m_userData, spw);
+            return mwsNullPtr;
+        }
+
+        memset(spw, 0, sizeof(*spw));
+        memset(ds, 0, sizeof(*ds));
+
+        spw->m_callback = *call_back;
+        spw->m_userData = ivp_user_data;
+        MY_IVP_TRACE_INTERPOSE(&spw->m_trace, &spw->m_callback, &spw->m_userData);
+        spw->m_nStates = n;
+        spw->m_data = ds;
+        spw->m_solverWork = sw;
+
+        spw->m_data->m_curTime = 0;
+        spw->m_data->m_initialStep = 0.002;
+        spw->m_data->m_timing.m_method = MY_EULER_HEUN;
+        spw->m_data->m_retryMax = MY_EULER_RHS_RETRIES;
+        spw->m_data->m_retryShrink = MY_EULER_RHS_SHRINK;
+
+        if (spw->m_nStates > 0)
+        {
+            spw->m_data->m_preY = (MoReal *)sw->m_utils.m_allocDataMemory(sw->m_userData, 3, n*sizeof(MoReal));  //(MoReal *)强制转换
+            spw->m_data->m_snap.m_y = (MoReal *)sw->m_utils.m_allocDataMemory(sw->m_userData, 3, n*sizeof(MoReal));
+            spw->m_data->m_k2 = (MoReal *)sw->m_utils.m_allocDataMemory(sw->m_userData, 6, n*sizeof(MoReal));
+            if (spw->m_data->m_preY)
+            {
+                spw->m_data->m_curY = spw->m_data->m_preY + n;
+                spw->m_data->m_preYp = spw->m_data->m_preY + 2*n;
+            }
+            if (spw->m_data->m_k2)
+            {
+                spw->m_data->m_k3 = spw->m_data->m_k2 + n;
+                spw->m_data->m_k4 = spw->m_data->m_k2 + 2*n;
+                spw->m_data->m_yStage = spw->m_data->m_k2 + 3*n;
+                spw->m_data->m_yRetry = spw->m_data->m_k2 + 4*n;
+            }
+
+            if (!spw->m_data->m_preY || !spw->m_data->m_snap.m_y || !spw->m_data->m_k2)
+            {
+                myEulerProblemFree(sw, spw);
+                spw = MWnullptr;
+            }
+            else
+            {
+                MoSize index;
+                for (index=0; index<n; ++index)
+                {
+                    spw->m_data->m_preY[index] = 0;
+                    spw->m_data->m_curY[index] = 0;
+                    spw->m_data->m_preYp[index] = 0;
+                }
+            }
+        }
+    }
+
+    return spw;   //返回：问题对象(自定义算法内部数据，求解器不关心其内容)，作为其它接口函数的第二个参数，即下边的ivp
+}
+
+/* 单调时钟，单位纳秒 */
+static unsigned long long myEulerNowNs(void)
+{
+#ifdef _WIN32
+    static LARGE_INTEGER freq;
+    LARGE_INTEGER cnt;
+    if (freq.QuadPart == 0)
+    {
+        QueryPerformanceFrequency(&freq);
+    }
+    QueryPerformanceCounter(&cnt);
+    return (unsigned long long)((double)cnt.QuadPart * 1e9 / (double)freq.QuadPart);
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long)ts.tv_sec * 1000000000ULL + (unsigned long long)ts.tv_nsec;
+#endif
+}
+
+/* 耗时(ns) -> 直方图格号 */
+static MoSize myEulerHistBin(unsigned long long ns)
+{
+    MoSize msb = 4;
+    MoSize bin;
+
+    if (ns < 16)
+    {
+        return (MoSize)ns;
+    }
+    while (msb < 63 && (ns >> (msb + 1)) != 0)
+    {
+        ++msb;
+    }
+    bin = 16 + (msb - 4) * 8 + (MoSize)((ns >> (msb - 3)) & 7);
+    return bin < MY_EULER_HIST_BINS ? bin : MY_EULER_HIST_BINS - 1;
+}
+
+/* 直方图格号 -> 该格上界(ns) */
+static unsigned long long myEulerHistUpper(MoSize bin)
+{
+    MoSize msb, sub;
+
+    if (bin < 16)
+    {
+        return bin + 1;
+    }
+    msb = 4 + (bin - 16) / 8;
+    sub = (bin - 16) % 8;
+    return (unsigned long long)(9 + sub) << (msb - 3);
+}
+
+static void myEulerResetTiming(MyEulerProblemData* ds)
+{
+    MyEulerMethod method = ds->m_timing.m_method;
+    unsigned long long budget = ds->m_timing.m_budgetNs;
+
+    memset(&ds->m_timing, 0, sizeof(ds->m_timing));
+    ds->m_timing.m_method = method;
+    ds->m_timing.m_budgetNs = budget;
+}
+
+/* 记录一步耗时，超出帧预算时返回moTrue */
+static MoBoolean myEulerRecordStep(MyEulerTiming* tm, unsigned long long ns)
+{
+    if (tm->m_steps == 0 || ns < tm->m_minNs)
+    {
+        tm->m_minNs = ns;
+    }
+    if (ns > tm->m_maxNs)
+    {
+        tm->m_maxNs = ns;
+    }
+    tm->m_sumNs += ns;
+    ++tm->m_steps;
+    ++tm->m_hist[myEulerHistBin(ns)];
+
+    if (tm->m_budgetNs > 0 && ns > tm->m_budgetNs)
+    {
+        ++tm->m_overruns;
+        return moTrue;
+    }
+    return moFalse;
+}
+
+/// <summary>
+/// 设置实时定步长模式：积分方法与帧预算。应在初始化前调用，步进时不再检查参数
+/// </summary>
+/// <param name="solver">积分算法对象</param>
+/// <param name="ivp">问题对象</param>
+/// <param name="method">积分方法，取MyEulerMethod的值</param>
+/// <param name="frame_budget">单步允许耗时（秒），超出时求解返回MWS_IVP_WARNING；<=0表示不检查</param>
+/// <returns></returns>
+MwsInteger myEulerSetRealTime(MwsIVPSolverObj solver, MwsIVPObj ivp, MoInteger method, MoReal frame_budget)
+{
+    MyEulerProblem* spw = (MyEulerProblem*)ivp;
+
+    if (method < MY_EULER_EXPLICIT || method > MY_EULER_RK4)
+    {
+        return MWS_IVP_INVALID_INPUT;
+    }
+    spw->m_data->m_timing.m_method = (MyEulerMethod)method;
+    spw->m_data->m_timing.m_budgetNs = frame_budget > 0 ? (unsigned long long)(frame_budget * 1e9) : 0;
+
+    return MWS_IVP_SUCCESS;
+}
+
+/// <summary>
+/// 右端函数失败的重试策略：某一级返回MWS_IVP_RHSFN_FAIL时（如试算状态超出查表范围），从步起点把整步细分为子步重做，
+/// 每次重试子步长乘以shrink，至多max_retries次；子步之和仍为step_size，定步长的时间网格不变。
+/// 步起点处的右端函数失败不重试。max_retries为0时恢复为立即返回错误
+/// </summary>
+/// <param name="solver">积分算法对象</param>
+/// <param name="ivp">问题对象</param>
+/// <param name="max_retries">每步最多重试次数</param>
+/// <param name="shrink">每次重试的子步长缩小倍数，(0,1)</param>
+/// <returns></returns>
+MwsInteger myEulerSetRhsRetry(MwsIVPSolverObj solver, MwsIVPObj ivp, MoInteger max_retries, MoReal shrink)
+{
+    MyEulerProblem* spw = (MyEulerProblem*)ivp;
+
+    if (max_retries < 0 || !(shrink > 0 && shrink < 1))
+    {
+        return MWS_IVP_INVALID_INPUT;
+    }
+    spw->m_data->m_retryMax = max_retries;
+    spw->m_data->m_retryShrink = shrink;
+
+    return MWS_IVP_SUCCESS;
+}
+
+/// <summary>
+/// 创建问题以来因右端函数失败而细分重做的累计次数
+/// </summary>
+/// <param name="solver">积分算法对象</param>
+/// <param name="ivp">问题对象</param>
+/// <returns></returns>
+MoSize myEulerGetRhsRetries(MwsIVPSolverObj solver, MwsIVPObj ivp)
+{
+    return ((MyEulerProblem*)ivp)->m_data->m_retries;
+}
+
+/// <summary>
+/// 查询单步耗时统计（最小、最大、平均、99%分位数、超预算次数）
+/// </summary>
+/// <param name="solver">积分算法对象</param>
+/// <param name="ivp">问题对象</param>
+/// <param name="stats">统计结果</param>
+/// <returns></returns>
+MwsInteger myEulerGetTiming(MwsIVPSolverObj solver, MwsIVPObj ivp, MyEulerTimingStats* stats)
+{
+    MyEulerProblem* spw = (MyEulerProblem*)ivp;
+    const MyEulerTiming* tm = &spw->m_data->m_timing;
+    unsigned long long target, count = 0;
+    MoSize bin;
+
+    memset(stats, 0, sizeof(*stats));
+    if (tm->m_steps == 0)
+    {
+        return MWS_IVP_SUCCESS;
+    }
+
+    stats->m_steps = (MoSize)tm->m_steps;
+    stats->m_overruns = (MoSize)tm->m_overruns;
+    stats->m_min = tm->m_minNs * 1e-9;
+    stats->m_max = tm->m_maxNs * 1e-9;
+    stats->m_mean = (double)tm->m_sumNs / tm->m_steps * 1e-9;
+
+    target = (tm->m_steps * 99 + 99) / 100;
+    for (bin = 0; bin < MY_EULER_HIST_BINS; ++bin)
+    {
+        count += tm->m_hist[bin];
+        if (count >= target)
+        {
+            unsigned long long upper = myEulerHistUpper(bin);
+            stats->m_p99 = (upper < tm->m_maxNs ? upper : tm->m_maxNs) * 1e-9;
+            break;
+        }
+    }
+
+    return MWS_IVP_SUCCESS;
+}
+
+/// <summary>
+/// 单精度模式：状态与各级以float存储和计算，时间仍为double，用于硬件在环与大批量集合仿真。
+/// 与 myEulerSetRealTime 一样应在初始化前调用
+/// </summary>
+/// <param name="solver">积分算法对象</param>
+/// <param name="ivp">问题对象</param>
+/// <param name="enable">是否启用单精度</param>
+/// <param name="compensated">状态更新是否采用Kahan补偿求和（小步长长时间运行时减小舍入误差的累积）</param>
+/// <param name="native_rhs">单精度右端函数（可为空，为空时经双精度转换调用原回调）</param>
+/// <returns></returns>
+MwsInteger myEulerSetSinglePrecision(MwsIVPSolverObj solver, MwsIVPObj ivp, MoBoolean enable,
+    MoBoolean compensated, MyRKRhsF32Ptr native_rhs)
+{
+    MyEuler* sw = (MyEuler*)solver;
+    MyEulerProblem* spw = (MyEulerProblem*)ivp;
+    MyEulerProblemData* ds = spw->m_data;
+    MoSize n = spw->m_nStates;
+
+    if (enable && n > 0 && ds->m_yF == mwsNullPtr)
+    {
+        ds->m_yF = (float*)sw->m_utils.m_allocDataMemory(sw->m_userData, MY_EULER_MAX_STAGES + 5, n*sizeof(float));
+        ds->m_shim = (MoReal*)sw->m_utils.m_allocDataMemory(sw->m_userData, 2, n*sizeof(MoReal));
+        if (!ds->m_yF || !ds->m_shim)
+        {
+            if (ds->m_yF)
+            {
+                sw->m_utils.m_freeDataMemory(sw->m_userData, ds->m_yF);
+                ds->m_yF = mwsNullPtr;
+            }
+            if (ds->m_shim)
+            {
+                sw->m_utils.m_freeDataMemory(sw->m_userData, ds->m_shim);
+                ds->m_shim = mwsNullPtr;
+            }
+            return MWS_IVP_MEM_FAIL;
+        }
+        ds->m_y1F = ds->m_yF + n;
+        ds->m_compF = ds->m_yF + 2*n;
+        ds->m_comp1F = ds->m_yF + 3*n;
+        ds->m_workF = ds->m_yF + 4*n;
+    }
+
+    ds->m_rhsF32.m_native = native_rhs;
+    ds->m_rhsF32.m_callback = &spw->m_callback;
+    ds->m_rhsF32.m_userData = native_rhs ? MY_IVP_TRACE_USER_DATA(&spw->m_callback, spw->m_userData)
+        : spw->m_userData;
+    ds->m_rhsF32.m_shim = ds->m_shim;
+    ds->m_f32 = enable;
+    ds->m_compensated = compensated;
+    ds->m_f32Valid = moFalse;
+
+    return MWS_IVP_SUCCESS;
+}
+
+/// <summary>
+/// 初始化
+/// </summary>
+/// <param name="solver">积分算法对象</param>
+/// <param name="ivp">问题对象</param>
+/// <param name="t0">起始时间</param>
+/// <param name="y0">y的初始值（必定不为空）</param>
+/// <param name="yp0">y’的初始值（DAE）</param>
+/// <param name="is_reinit">是否重新初始化（重启）</param>
+/// <param name="reserve">保留参数，暂不使用</param>
+/// <returns></returns>
+MwsInteger myEulerInit(MwsIVPSolverObj solver, MwsIVPObj ivp, MwsReal t0, const MwsReal* y0, 
+    const MwsReal* yp0, MwsBoolean is_reinit, void* reserve)
+{
+    MyEulerProblem* spw = (MyEulerProblem*)ivp;
+    MyEulerProblemData* ds = spw->m_data;
+    MoSize nState = spw->m_nStates;
+
+    ds->m_curTime = t0;
+    ds->m_f32Valid = moFalse;
+    if (!is_reinit)
+    {
+        ds->m_snap.m_valid = moFalse;   /* 首次初始化时旧快照作废；重新初始化时保留，仍可回退 */
+        myEulerResetTiming(ds);
+    }
+
+    /* 预热：在初始化时写一遍所有工作向量，避免实时步进时首次访问触发缺页 */
+    if (nState > 0)
+    {
+        memset(ds->m_k2, 0, 6*nState*sizeof(MoReal));
+        if (!is_reinit)     /* 重新初始化时快照仍有效，不能清零 */
+        {
+            memset(ds->m_snap.m_y, 0, 3*nState*sizeof(MoReal));
+        }
+        if (ds->m_yF)
+        {
+            memset(ds->m_yF, 0, (MY_EULER_MAX_STAGES + 5)*nState*sizeof(float));
+            memset(ds->m_shim, 0, 2*nState*sizeof(MoReal));
+        }
+    }
+
+    if (nState == 0 || y0 == mwsNullPtr)
+    {
+        return MWS_IVP_SUCCESS;
+    }
+
+    /* 新状态直接写入已有缓冲区，不重新分配；定步长算法无步长历史需要处理 */
+    memcpy(ds->m_curY, y0, nState*sizeof(MoReal));
+    memcpy(ds->m_preY, y0, nState*sizeof(MoReal));
+
+    if (spw->m_callback.m_rshFunction(spw->m_userData, t0, ds->m_curY, ds->m_preYp) != MWS_IVP_SUCCESS)
+    {
+        return MWS_IVP_RHSFN_FAIL;
+    }
+
+    return MWS_IVP_SUCCESS;  //返回状态，取MwsIVPStatus的值
+}
+
+/* 单精度步进：状态与各级为float，时间为double；连续步进时沿用上一步的float状态与补偿量。
+   起点处的右端函数失败时置*start_fail */
+static MwsInteger myEulerStepF32(MyEulerProblem* spw, MoReal h, MoReal t, MwsReal* yret, MwsReal* ypret,
+    MoBoolean* start_fail)
+{
+    MyEulerProblemData* ds = spw->m_data;
+    MoSize nState = spw->m_nStates;
+    MoSize index;
+    MwsInteger status;
+
+    /* 重新初始化、回退或外部改过y时从yret重新载入 */
+    for (index = 0; index < nState && ds->m_f32Valid; ++index)
+    {
+        if (yret[index] != (MoReal)ds->m_yF[index])
+        {
+            ds->m_f32Valid = moFalse;
+        }
+    }
+    if (!ds->m_f32Valid || t != ds->m_curTime)
+    {
+        for (index = 0; index < nState; ++index)
+        {
+            ds->m_yF[index] = (float)yret[index];
+        }
+        memset(ds->m_compF, 0, nState*sizeof(float));
+    }
+    ds->m_f32Valid = moFalse;
+
+    if (myRKRhsF32Eval(&ds->m_rhsF32, nState, t, ds->m_yF, ds->m_workF) != MWS_IVP_SUCCESS)
+    {
+        *start_fail = moTrue;
+        return MWS_IVP_RHSFN_FAIL;
+    }
+    status = myRKEngineStepF32(s_myEulerRKMethod[ds->m_timing.m_method], &ds->m_rhsF32, nState, t, h,
+        ds->m_yF, ds->m_workF, ds->m_y1F, mwsNullPtr, ds->m_compensated ? ds->m_compF : mwsNullPtr,
+        ds->m_comp1F, ds->m_workF);
+    if (status != MWS_IVP_SUCCESS)
+    {
+        return status;
+    }
+
+    for (index = 0; index < nState; ++index)
+    {
+        ds->m_preY[index] = ds->m_yF[index];
+        ds->m_curY[index] = ds->m_y1F[index];
+        ds->m_preYp[index] = ds->m_workF[index];
+    }
+    memcpy(ds->m_yF, ds->m_y1F, nState*sizeof(float));
+    if (ds->m_compensated)
+    {
+        memcpy(ds->m_compF, ds->m_comp1F, nState*sizeof(float));
+    }
+    ds->m_f32Valid = moTrue;
+
+    memcpy(yret, ds->m_curY, nState*sizeof(MoReal));
+    if (ypret)
+    {
+        memcpy(ypret, ds->m_preYp, nState*sizeof(MoReal));
+    }
+
+    return MWS_IVP_SUCCESS;
+}
+
+/* 双精度步进：各级按整向量计算，起点处的右端函数失败时置*start_fail */
+static MwsInteger myEulerStepF64(MyEulerProblem* spw, MoReal h, MoReal t, MwsReal* yret, MwsReal* ypret,
+    MoBoolean* start_fail)
+{
+    MyEulerProblemData* ds = spw->m_data;
+    MoSize index = 0;
+    MoSize nState = spw->m_nStates;
+    MwsIVPRshFcnPtr f = spw->m_callback.m_rshFunction;
+    void* ud = spw->m_userData;
+
+    MoReal* preY = ds->m_preY;                  //上个y
+    MoReal* curY = ds->m_curY;                  //当前y
+    MoReal* k1 = ds->m_preYp;                   //上个y'
+    MoReal* k2 = ds->m_k2;
+    MoReal* k3 = ds->m_k3;
+    MoReal* k4 = ds->m_k4;
+    MoReal* yStage = ds->m_yStage;
+
+    /* 整向量计算各级，每步右端函数调用次数固定：欧拉1次、Heun 2次、RK4 4次 */
+    memcpy(preY, yret, nState*sizeof(MoReal));
+    if (f(ud, t, preY, k1) != MWS_IVP_SUCCESS)
+    {
+        *start_fail = moTrue;
+        return MWS_IVP_RHSFN_FAIL;
+    }
+
+    switch (ds->m_timing.m_method)
+    {
+    case MY_EULER_EXPLICIT:
+        for (index = 0; index < nState; ++index)
+        {
+            curY[index] = preY[index] + h*k1[index];
+        }
+        break;
+
+    case MY_EULER_RK4:
+        for (index = 0; index < nState; ++index)
+        {
+            yStage[index] = preY[index] + h/2*k1[index];
+        }
+        if (f(ud, t + h/2, yStage, k2) != MWS_IVP_SUCCESS)
+        {
+            return MWS_IVP_RHSFN_FAIL;
+        }
+        for (index = 0; index < nState; ++index)
+        {
+            yStage[index] = preY[index] + h/2*k2[index];
+        }
+        if (f(ud, t + h/2, yStage, k3) != MWS_IVP_SUCCESS)
+        {
+            return MWS_IVP_RHSFN_FAIL;
+        }
+        for (index = 0; index < nState; ++index)
+        {
+            yStage[index] = preY[index] + h*k3[index];
+        }
+        if (f(ud, t + h, yStage, k4) != MWS_IVP_SUCCESS)
+        {
+            return MWS_IVP_RHSFN_FAIL;
+        }
+        for (index = 0; index < nState; ++index)
+        {
+            curY[index] = preY[index] + h/6*(k1[index] + 2*k2[index] + 2*k3[index] + k4[index]);
+        }
+        break;
+
+    default:    /* MY_EULER_HEUN */
+        for (index = 0; index < nState; ++index)
+        {
+            yStage[index] = preY[index] + h*k1[index];
+        }
+        if (f(ud, t + h, yStage, k2) != MWS_IVP_SUCCESS)       //k2=f(xn+h,yn+h*k1)
+        {
+            return MWS_IVP_RHSFN_FAIL;
+        }
+        for (index = 0; index < nState; ++index)
+        {
+            curY[index] = preY[index] + h/2*(k1[index] + k2[index]);      //梯形公式
+        }
+        break;
+    }
+
+    memcpy(yret, curY, nState*sizeof(MoReal));
+    if (ypret)
+    {
+        memcpy(ypret, k1, nState*sizeof(MoReal));
+    }
+
+    return MWS_IVP_SUCCESS;
+}
+
+/// <summary>
+/// 求解
+/// </summary>
+/// 输入：
+/// <param name="solver">积分算法对象</param>
+/// <param name="ivp">问题对象</param>
+/// <param name="step_size">步长（定步长，或初始化积分步长）</param>
+/// <param name="t">当前时间</param>
+/// <param name="tout">期望输出时间</param>
+/// 输出：
+/// <param name="tret">求解实际达到的时间</param>
+/// <param name="yret">y的结果值</param>
+/// <param name="ypret">y’的结果值（DAE）</param>
+/// <param name="reserve">保留参数，暂不使用</param>
+/// <returns></returns>
+MwsInteger myEulerSolve(MwsIVPSolverObj solver, MwsIVPObj ivp, MwsReal step_size, MwsReal t, 
+    MwsReal tout, MwsReal* tret, MwsReal* yret, MwsReal* ypret, void* reserve)
+{
+    MyEulerProblem* spw = (MyEulerProblem*)ivp;
+    MyEulerProblemData* ds = spw->m_data;
+    unsigned long long start = myEulerNowNs();
+
+    MoReal h = step_size;
+    MoSize nState = spw->m_nStates;
+    MoReal lastTime = ds->m_curTime;
+    MoBoolean startFail = moFalse;
+    MoSize parts = 1;
+    MoSize part;
+    MoInteger retries = 0;
+    MwsInteger status = MWS_IVP_SUCCESS;
+    MY_IVP_TRACE_BEGIN(attempt)
+
+    status = ds->m_f32 ? myEulerStepF32(spw, h, t, yret, ypret, &startFail)
+        : myEulerStepF64(spw, h, t, yret, ypret, &startFail);
+
+    /* 某一级右端函数失败：从步起点细分为parts个子步重做，子步数每次乘以1/shrink，仍恰好到达t+h */
+    while (status == MWS_IVP_RHSFN_FAIL && !startFail && retries < ds->m_retryMax)
+    {
+        MoReal hs;
+
+        ++retries;
+        ++ds->m_retries;
+        if (retries == 1)
+        {
+            memcpy(ds->m_yRetry, yret, nState*sizeof(MoReal));     /* 失败的步不改yret */
+        }
+        parts = (MoSize)(parts / ds->m_retryShrink + 0.5);
+        hs = h / parts;
+        memcpy(yret, ds->m_yRetry, nState*sizeof(MoReal));
+        ds->m_curTime = lastTime;
+
+        for (part = 0; part < parts; ++part)
+        {
+            status = ds->m_f32 ? myEulerStepF32(spw, hs, t + part*hs, yret, mwsNullPtr, &startFail)
+                : myEulerStepF64(spw, hs, t + part*hs, yret, mwsNullPtr, &startFail);
+            if (status != MWS_IVP_SUCCESS)
+            {
+                break;
+            }
+            if (part == 0)
+            {
+                memcpy(ds->m_yRetry + nState, ds->m_preYp, nState*sizeof(MoReal));
+            }
+            ds->m_curTime = t + (part + 1)*hs;   /* 单精度模式据此沿用上一子步的float状态 */
+        }
+        startFail = moFalse;    /* 子步起点不是原步起点，失败时仍可继续细分 */
+    }
+    if (status != MWS_IVP_SUCCESS)
+    {
+        if (retries > 0)
+        {
+            memcpy(yret, ds->m_yRetry, nState*sizeof(MoReal));
+            ds->m_curTime = lastTime;
+        }
+        return status;
+    }
+
+    /* 细分重做后插值区间仍为整步：起点与起点导数取回保存值 */
+    if (retries > 0)
+    {
+        memcpy(ds->m_preY, ds->m_yRetry, nState*sizeof(MoReal));
+        memcpy(ds->m_preYp, ds->m_yRetry + nState, nState*sizeof(MoReal));
+        if (ypret)
+        {
+            memcpy(ypret, ds->m_preYp, nState*sizeof(MoReal));
+        }
+    }
+
+    /* 更新当前积分时间 */
+    ds->m_curTime = t + h;
+    ds->m_initialStep = h;
+    *tret = ds->m_curTime;                      //积分时间增加一步，外部有对算法的循环调用
+    MY_IVP_TRACE_END(MY_IVP_TRACE_STEP, attempt);
+
+    if (myEulerRecordStep(&ds->m_timing, myEulerNowNs() - start))
+    {
+        status = MWS_IVP_WARNING;               /* 超出帧预算 */
+    }
+
+    return status;  //返回状态，取MwsIVPStatus的值
+}
+
+/// <summary>
+/// 生成插值函数（过yn点的曲线）
+/// </summary>
+/// 输入：
+/// <param name="solver">积分算法对象</param>
+/// <param name="ivp">问题对象</param>
+/// <param name="tout">期望的输出时间</param>
+/// 输出：
+/// <param name="yret">y的结果值</param>
+/// <param name="reserve"></param>
+/// <returns></returns>
+MwsInteger myEulerInterpolate(MwsIVPSolverObj solver, MwsIVPObj ivp, MwsReal tout, MwsReal* yret, void* reserve)
+{
+    /* 线性插值 */
+    MyEuler* sw = (MyEuler*)solver;
+    MyEulerProblem* spw = (MyEulerProblem*)ivp;
+
+    MoSize nStates = spw->m_nStates;
+    MoSize index;
+
+    for (index=0; index<nStates; ++index)
+    {
+        /* 线性插值: 
+                    f(x2)-f(x1)
+            L(x) = ------------ * (x - x1) + f(x1)
+                       x2-x1 
+        */
+        yret[index] = (spw->m_data->m_curY[index] - spw->m_data->m_preY[index]) * (
+            tout - spw->m_data->m_curTime + spw->m_data->m_initialStep) / spw->m_data->m_initialStep + spw->m_data->m_preY[index]; 
+    }
+
+    return MWS_IVP_SUCCESS;
+}
+
+/// <summary>
+/// 批量插值：一次求m个输出时刻的线性插值，结果按行存储，与逐个调用 myEulerInterpolate 在舍入误差内一致
+/// </summary>
+/// 输入：
+/// <param name="solver">积分算法对象</param>
+/// <param name="ivp">问题对象</param>
+/// <param name="m">输出时刻个数</param>
+/// <param name="tout">输出时刻，长度m</param>
+/// 输出：
+/// <param name="yret">结果矩阵，m*n按行存储，第j行为tout[j]时刻的y</param>
+/// <returns></returns>
+MwsInteger myEulerInterpolateBatch(MwsIVPSolverObj solver, MwsIVPObj ivp, MoSize m, const MwsReal* tout,
+    MwsReal* yret)
+{
+    MyEulerProblem* spw = (MyEulerProblem*)ivp;
+    MyEulerProblemData* ds = spw->m_data;
+    MoSize nStates = spw->m_nStates;
+    const MoReal* preY = ds->m_preY;
+    const MoReal* curY = ds->m_curY;
+    MoSize index, j;
+
+    if (m > 0 && (!tout || !yret))
+    {
+        return MWS_IVP_INVALID_INPUT;
+    }
+
+    for (j = 0; j < m; ++j)
+    {
+        /* 时刻在外层，状态在内层：每行只有一个比例系数，内层循环连续访问 */
+        MoReal* row = yret + j * nStates;
+        MoReal theta = (tout[j] - ds->m_curTime + ds->m_initialStep) / ds->m_initialStep;
+
+        for (index = 0; index < nStates; ++index)
+        {
+            row[index] = (curY[index] - preY[index]) * theta + preY[index];
+        }
+    }
+
+    return MWS_IVP_SUCCESS;
+}
+
+/// <summary>
+/// 保存状态快照（协同仿真主算法回退用），只拷贝到预分配的快照区，不分配内存
+/// </summary>
+/// <param name="solver">积分算法对象</param>
+/// <param name="ivp">问题对象</param>
+/// <returns></returns>
+MwsInteger myEulerSaveState(MwsIVPSolverObj solver, MwsIVPObj ivp)
+{
+    MyEulerProblem* spw = (MyEulerProblem*)ivp;
+    MyEulerProblemData* ds = spw->m_data;
+
+    if (spw->m_nStates > 0)
+    {
+        memcpy(ds->m_snap.m_y, ds->m_preY, 3*spw->m_nStates*sizeof(MoReal));
+    }
+    ds->m_snap.m_curTime = ds->m_curTime;
+    ds->m_snap.m_initialStep = ds->m_initialStep;
+    ds->m_snap.m_valid = moTrue;
+
+    return MWS_IVP_SUCCESS;
+}
+
+/// <summary>
+/// 恢复到最近一次保存的快照
+/// </summary>
+/// 输入：
+/// <param name="solver">积分算法对象</param>
+/// <param name="ivp">问题对象</param>
+/// 输出：
+/// <param name="tret">快照时刻（可为空）</param>
+/// <param name="yret">快照时刻y的值（可为空）</param>
+/// <param name="ypret">快照时刻y'的值（可为空）</param>
+/// <returns>未保存过快照时返回MWS_IVP_INVALID_INPUT</returns>
+MwsInteger myEulerRestoreState(MwsIVPSolverObj solver, MwsIVPObj ivp, MwsReal* tret, MwsReal* yret, MwsReal* ypret)
+{
+    MyEulerProblem* spw = (MyEulerProblem*)ivp;
+    MyEulerProblemData* ds = spw->m_data;
+    MoSize nState = spw->m_nStates;
+
+    if (!ds->m_snap.m_valid)
+    {
+        return MWS_IVP_INVALID_INPUT;
+    }
+
+    if (nState > 0)
+    {
+        memcpy(ds->m_preY, ds->m_snap.m_y, 3*nState*sizeof(MoReal));
+    }
+    ds->m_curTime = ds->m_snap.m_curTime;
+    ds->m_initialStep = ds->m_snap.m_initialStep;
+    ds->m_f32Valid = moFalse;
+
+    if (tret)
+    {
+        *tret = ds->m_curTime;
+    }
+    if (yret && nState > 0)
+    {
+        memcpy(yret, ds->m_curY, nState*sizeof(MoReal));
+    }
+    if (ypret && nState > 0)
+    {
+        memcpy(ypret, ds->m_preYp, nState*sizeof(MoReal));
+    }
+
+    return MWS_IVP_SUCCESS;
+}
+
+/// <summary>
+/// 销毁问题：对象池未满时连同工作区放回池中，供下次创建同规模的问题复用
+/// </summary>
+/// <param name="solver"></param>
+/// <param name="ivp"></param>
+void myEulerProblemDestroy(MwsIVPSolverObj solver, MwsIVPObj ivp)
+{
+    MyEuler* sw = (MyEuler*)solver;
+    MyEulerProblem* spw = (MyEulerProblem*)ivp;
+
+    if (spw)
+    {
+        /* 超预算汇总只在销毁时报告一次，不影响步进路径 */
+        if (spw->m_data->m_timing.m_overruns > 0 && sw->m_utils.m_logger)
+        {
+            char msg[128];
+            sprintf(msg, "%llu of %llu steps exceeded the frame budget, max %.3f us",
+                spw->m_data->m_timing.m_overruns, spw->m_data->m_timing.m_steps,
+                spw->m_data->m_timing.m_maxNs * 1e-3);
+            sw->m_utils.m_logger(sw->m_userData, MWS_IVP_WARNING, "myEulerSolve", msg);
+        }
+
+        if (sw->m_poolCount < MY_EULER_POOL_SIZE)
+        {
+            sw->m_pool[sw->m_poolCount++] = spw;
+        }
+        else
+        {
+            myEulerProblemFree(sw, spw);
+        }
+    }
+}
+
+/// <summary>
+/// 销毁积分算法
+/// </summary>
+/// <param name="solver"></param>
+void myEulerDestroy(MwsIVPSolverObj solver)
+{
+    MyEuler* sw = (MyEuler*)solver;
+
+    if (sw)
+    {
+        while (sw->m_poolCount > 0)
+        {
+            myEulerProblemFree(sw, sw->m_pool[--sw->m_poolCount]);
+        }
+        (*sw->m_utils.m_freeMemory)(sw->m_userData, sw);
+    }
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+
+/***************************************************************************
+//   end of file
+***************************************************************************/
+
@@ -0,0 +1,1279 @@
+/***************************************************************************
+///
+/// Copyright (c) 2020, 苏州同元软控信息技术有限公司
+/// All rights reserved.
+///
+/// @file           my_exprb.c
+/// @brief          指数Rosenbrock变步长积分算法（exprb32、exprb43），适合半线性刚性问题：
+///                 φ函数与向量的乘积用Krylov子空间（Arnoldi）计算，只需Jacobian与向量的乘积，不解线性方程组
+///
+/// @version        v1.0
+/// @author         田显钊
+/// @date           2020/07/07
+///
+***************************************************************************/
+
+#include "mo_types.h"
+#include "mws_ivp_solver.h"
+#include "my_ivp_common.h"
+#include "my_ivp_trace.h"
+
+#include <memory.h>
+#include <math.h>
+
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+/*
+ * 每步在 (t,u) 处取 J = df/dy，并用差商取 v = df/dt，把 f 写成 f(t+s,y) = F + J(y-u) + s*v + g(t+s,y)，
+ * 线性部分用 φ 函数精确积分，非线性余项 g 显式处理（Hochbruck-Ostermann）。记 D_i = g(t+c_i*h, U_i)：
+ *  exprb32：U2 = u + h*φ1(hJ)F + h^2*φ2(hJ)v（指数Rosenbrock-Euler，2阶），
+ *           u1 = U2 + 2h*φ3(hJ)D2（3阶），误差估计 2h*φ3(hJ)D2；
+ *  exprb43：U2 = u + (h/2)*φ1(hJ/2)F + (h/2)^2*φ2(hJ/2)v，
+ *           U3 = u + h*φ1(hJ)(F + D2) + h^2*φ2(hJ)v，
+ *           u1 = u + h*φ1(hJ)F + h^2*φ2(hJ)v + h*φ3(hJ)(16D2 - 2D3) + h*φ4(hJ)(-48D2 + 12D3)（4阶），
+ *           误差估计 h*φ4(hJ)(-48D2 + 12D3)。
+ * 同一步内的各 φ_k 组合 Σ τ^k*φ_k(τJ)b_k 由一次Krylov计算得到：它等于增广矩阵
+ *   A~ = [J W; 0 K]（W = [b_p ... b_1]，K为p阶上移位矩阵）的 exp(τA~) 作用于 [0; e_p] 后的前n行，
+ * 对 τA~ 做Arnoldi得到Hessenberg矩阵H_m，exp(H_m) 用Padé(6,6)加缩放平方计算；按 |h_{m+1,m}*[exp(H_m)]_{m,1}|
+ * 估计截断误差，MY_EXPRB_KRYLOV_MAX 维仍不满足时把 τ 分成若干子步依次推进（Expokit的做法）。
+ * J*x：有 m_jacFunction 且规模不超过 MY_EXPRB_JAC_MAX_N 时取稠密Jacobian（按列存储），否则用右端函数差商。
+ * 线性部分刚性而非线性部分不刚性时，步长只受精度限制；右端函数全部为非线性刚性时不如隐式算法。
+ */
+#define MY_EXPRB_KRYLOV_MAX     30      /* Krylov子空间最大维数 */
+#define MY_EXPRB_PHI_MAX        4       /* φ函数最高阶数，即增广的维数 */
+#define MY_EXPRB_JAC_MAX_N      500     /* 超过此规模不分配稠密Jacobian，改用差商 */
+#define MY_EXPRB_KRYLOV_SAFETY  0.1     /* Krylov误差相对积分容许误差的比例 */
+#define MY_EXPRB_SUBSTEP_MAX    64      /* 单次φ函数计算的子步数上限，超过时拒绝本步 */
+#define MY_EXPRB_KRYLOV_CHECK   6       /* 每隔几维检查一次Krylov误差（exp(H_m) 的代价与 m^3 成正比） */
+
+/* 方法 */
+typedef enum
+{
+    MY_EXPRB_32 = 0,    /* 3(2)阶，每步2次Krylov计算 */
+    MY_EXPRB_43,        /* 4(3)阶，每步4次Krylov计算，默认 */
+    MY_EXPRB_METHOD_COUNT
+} MyExprbMethod;
+
+/* 统计信息 */
+typedef struct
+{
+    MoSize m_steps;         /* 被接受的步数 */
+    MoSize m_rejected;      /* 被拒绝的试算步数（含Krylov子步过多的） */
+    MoSize m_matVecs;       /* J*x 次数（差商时每次1次右端函数） */
+    MoSize m_substeps;      /* Krylov子步数，每次φ函数计算至少1步 */
+    MoSize m_maxDim;        /* 用到的最大Krylov维数 */
+} MyExprbStats;
+
+/* 算法对象 */
+typedef struct
+{
+    MwsIVPUtilFcns	m_utils;
+    void*           m_userData;
+
+} MyExprb;
+
+/* 状态快照（协同仿真回退用），创建问题时预分配 */
+typedef struct
+{
+    MoReal *m_y;            /* preY|curY|preYp|curYp 的副本，长度4n */
+    MoReal m_curTime;
+    MoReal m_preTime;
+    MoReal m_h;
+    MoBoolean m_valid;      /* 是否已保存过快照 */
+} MyExprbSnapshot;
+
+/* 求解问题的数据，用数据内存分配和释放函数 */
+typedef struct
+{
+    /* m_preY、m_curY、m_preYp、m_curYp 依次位于同一块连续内存中（由m_preY持有） */
+    MoReal *m_preY;         /* 上一步y */
+    MoReal *m_curY;         /* 当前y */
+    MoReal *m_preYp;        /* 上一步y'，即本步的F */
+    MoReal *m_curYp;        /* 当前y' */
+
+    /* 以下8个长度为n的向量依次位于同一块连续内存中（由m_dfdt持有） */
+    MoReal *m_dfdt;         /* v = df/dt */
+    MoReal *m_u2;           /* 级值U2，之后借用为 (16D2-2D3)/h^2 */
+    MoReal *m_u3;           /* 级值U3，之后借用为 (-48D2+12D3)/h^3 */
+    MoReal *m_d2;           /* 非线性余项D2 */
+    MoReal *m_d3;           /* 非线性余项D3 */
+    MoReal *m_fTmp;         /* 差商J*x用 */
+    MoReal *m_err;          /* φ函数结果与误差估计 */
+    MoReal *m_yTmp;         /* 差商J*x用 */
+
+    MoReal *m_jac;          /* 稠密Jacobian（按列存储），回调未提供或规模过大时为空 */
+    MoReal *m_basis;        /* Krylov基，(MY_EXPRB_KRYLOV_MAX+1)个长度 n+MY_EXPRB_PHI_MAX 的向量，另加1个当前向量 */
+    MoReal *m_hess;         /* Hessenberg矩阵 (m+1)*m，其后为exp(H)及其工作区 6*m*m（m = MY_EXPRB_KRYLOV_MAX） */
+
+    MoInteger m_method;     /* MyExprbMethod */
+    MoBoolean m_useJac;     /* 是否使用 m_jacFunction */
+    MoReal m_jvTime;        /* J、F对应的时间 */
+
+    MoReal m_curTime;       /* 当前时间 */
+    MoReal m_preTime;       /* 上一步时间 */
+    MoReal m_initialStep;
+    MoReal m_h;             /* 下一步建议步长，0表示尚未开始积分 */
+    MyIVPController m_ctl;  /* 步长控制器参数，默认 MY_IVP_CONTROLLER_DEFAULT */
+
+    MoBoolean m_ypValid;    /* m_curYp 是否对应 (m_curTime, m_curY) */
+
+    MyExprbStats m_stats;
+    MyExprbSnapshot m_snap;
+} MyExprbProblemData;
+
+/* 求解问题对象 */
+typedef struct
+{
+    MoSize          m_nStates;
+
+    MwsIVPOptions	m_opt;
+    MwsIVPCallback  m_callback;
+    void*			m_userData;
+    MY_IVP_TRACE_MEMBER(m_trace)
+
+    MyExprbProblemData* m_data;
+    MyExprb* m_solverWork;
+
+} MyExprbProblem;
+
+void myExprbProblemDestroy(MwsIVPSolverObj solver, MwsIVPObj ivp);
+void myExprbDestroy(MwsIVPSolverObj solver);
+MwsInteger myExprbSetController(MwsIVPSolverObj solver, MwsIVPObj ivp, const MyIVPController* ctl);
+
+/* 稠密矩阵乘积 c = a*b（m阶，按行存储） */
+static void myExprbMatMul(MoInteger m, const MoReal* a, const MoReal* b, MoReal* c)
+{
+    MoInteger i, j, k;
+
+    for (i = 0; i < m; ++i)
+    {
+        MoReal* ci = c + i * m;
+
+        memset(ci, 0, m * sizeof(MoReal));
+        for (k = 0; k < m; ++k)
+        {
+            MoReal aik = a[i * m + k];
+            const MoReal* bk = b + k * m;
+
+            for (j = 0; j < m; ++j)
+            {
+                ci[j] += aik * bk[j];
+            }
+        }
+    }
+}
+
+/* 解 d*x = r（m阶，按行存储，列主元Gauss消去），d被破坏，x写回r */
+static void myExprbLinSolve(MoInteger m, MoReal* d, MoReal* r)
+{
+    MoInteger i, j, k;
+
+    for (k = 0; k < m; ++k)
+    {
+        MoInteger piv = k;
+
+        for (i = k + 1; i < m; ++i)
+        {
+            if (fabs(d[i * m + k]) > fabs(d[piv * m + k]))
+            {
+                piv = i;
+            }
+        }
+        if (piv != k)
+        {
+            for (j = 0; j < m; ++j)
+            {
+                MoReal tmp = d[k * m + j];
+                d[k * m + j] = d[piv * m + j];
+                d[piv * m + j] = tmp;
+                tmp = r[k * m + j];
+                r[k * m + j] = r[piv * m + j];
+                r[piv * m + j] = tmp;
+            }
+        }
+        for (i = k + 1; i < m; ++i)
+        {
+            MoReal l = d[i * m + k] / d[k * m + k];
+
+            for (j = k; j < m; ++j)
+            {
+                d[i * m + j] -= l * d[k * m + j];
+            }
+            for (j = 0; j < m; ++j)
+            {
+                r[i * m + j] -= l * r[k * m + j];
+            }
+        }
+    }
+    for (k = m - 1; k >= 0; --k)
+    {
+        for (j = 0; j < m; ++j)
+        {
+            MoReal sum = r[k * m + j];
+
+            for (i = k + 1; i < m; ++i)
+            {
+                sum -= d[k * m + i] * r[i * m + j];
+            }
+            r[k * m + j] = sum / d[k * m + k];
+        }
+    }
+}
+
+/*
+ * e = exp(scale*H)，H为Hessenberg矩阵的前m阶（按行存储，行距ldh），e按行存储（行距m）。
+ * Padé(6,6)加缩放平方：先缩到无穷范数不超过0.5；Hessenberg矩阵的阶数很小，不利用其结构
+ */
+static void myExprbExpm(MoInteger m, const MoReal* hess, MoInteger ldh, MoReal scale, MoReal* e, MoReal* work)
+{
+    static const MoReal c[7] = { 1.0, 1.0 / 2, 5.0 / 44, 1.0 / 66, 1.0 / 792, 1.0 / 15840, 1.0 / 665280 };
+    MoInteger mm = m * m;
+    MoReal* a = work;
+    MoReal* a2 = work + mm;
+    MoReal* a4 = work + 2 * mm;
+    MoReal* a6 = work + 3 * mm;
+    MoReal* v = work + 4 * mm;
+    MoReal norm = 0;
+    MoInteger i, j, s = 0;
+
+    for (i = 0; i < m; ++i)
+    {
+        MoReal rowSum = 0;
+
+        for (j = 0; j < m; ++j)
+        {
+            rowSum += fabs(hess[i * ldh + j]);
+        }
+        norm = rowSum > norm ? rowSum : norm;
+    }
+    norm *= fabs(scale);
+    while (norm > 0.5 && s < 64)
+    {
+        norm /= 2;
+        ++s;
+    }
+    scale = ldexp(scale, -s);
+    for (i = 0; i < m; ++i)
+    {
+        for (j = 0; j < m; ++j)
+        {
+            a[i * m + j] = scale * hess[i * ldh + j];
+        }
+    }
+
+    myExprbMatMul(m, a, a, a2);
+    myExprbMatMul(m, a2, a2, a4);
+    myExprbMatMul(m, a4, a2, a6);
+
+    /* 偶次部分 v = c0*I + c2*A^2 + c4*A^4 + c6*A^6，奇次部分 u = A*(c1*I + c3*A^2 + c5*A^4) */
+    for (i = 0; i < mm; ++i)
+    {
+        v[i] = c[2] * a2[i] + c[4] * a4[i] + c[6] * a6[i];
+        a6[i] = c[3] * a2[i] + c[5] * a4[i];
+    }
+    for (i = 0; i < m; ++i)
+    {
+        v[i * m + i] += c[0];
+        a6[i * m + i] += c[1];
+    }
+    myExprbMatMul(m, a, a6, e);
+
+    /* (v - u) * exp(A) = v + u */
+    for (i = 0; i < mm; ++i)
+    {
+        MoReal u = e[i];
+        e[i] = v[i] + u;
+        v[i] -= u;
+    }
+    myExprbLinSolve(m, v, e);
+
+    for (; s > 0; --s)
+    {
+        myExprbMatMul(m, e, e, a2);
+        memcpy(e, a2, mm * sizeof(MoReal));
+    }
+}
+
+/* 向量2范数 */
+static MoReal myExprbNorm(MoSize n, const MoReal* x)
+{
+    MoReal sum = 0;
+    MoSize index;
+
+    for (index = 0; index < n; ++index)
+    {
+        sum += x[index] * x[index];
+    }
+    return sqrt(sum);
+}
+
+/* jx = J*x，J取 (m_jvTime, m_preY) 处的值；差商时借用 m_yTmp、m_fTmp */
+static MwsInteger myExprbJv(MyExprbProblem* spw, const MoReal* x, MoReal* jx)
+{
+    MyExprbProblemData* ds = spw->m_data;
+    MoSize n = spw->m_nStates;
+    MoReal normY = 1;
+    MoReal normX = 0;
+    MoReal eps;
+    MoSize index, col;
+
+    if (ds->m_jac && ds->m_useJac)
+    {
+        memset(jx, 0, n * sizeof(MoReal));
+        for (col = 0; col < n; ++col)
+        {
+            const MoReal* jc = ds->m_jac + col * n;
+            MoReal xc = x[col];
+
+            if (xc == 0)
+            {
+                continue;
+            }
+            for (index = 0; index < n; ++index)
+            {
+                jx[index] += jc[index] * xc;
+            }
+        }
+        ++ds->m_stats.m_matVecs;
+        return MWS_IVP_SUCCESS;
+    }
+
+    for (index = 0; index < n; ++index)
+    {
+        normY = fabs(ds->m_preY[index]) > normY ? fabs(ds->m_preY[index]) : normY;
+        normX = fabs(x[index]) > normX ? fabs(x[index]) : normX;
+    }
+    if (normX == 0)
+    {
+        memset(jx, 0, n * sizeof(MoReal));
+        return MWS_IVP_SUCCESS;     /* J*0 = 0 */
+    }
+
+    eps = sqrt(2.2e-16) * normY / normX;
+    for (index = 0; index < n; ++index)
+    {
+        ds->m_yTmp[index] = ds->m_preY[index] + eps * x[index];
+    }
+    if (spw->m_callback.m_rshFunction(spw->m_userData, ds->m_jvTime, ds->m_yTmp, ds->m_fTmp) != MWS_IVP_SUCCESS)
+    {
+        return MWS_IVP_RHSFN_FAIL;
+    }
+    for (index = 0; index < n; ++index)
+    {
+        jx[index] = (ds->m_fTmp[index] - ds->m_preYp[index]) / eps;
+    }
+    ++ds->m_stats.m_matVecs;
+    return MWS_IVP_SUCCESS;
+}
+
+/*
+ * out = Σ_{k=1..p} τ^k * φ_k(τJ) * b[k-1]（b[k-1]为空表示0），见文件开头的增广矩阵。
+ * W的各列先乘以 eta（使其范数为1左右，基向量的两部分量级相当），结果再除以 eta。
+ * 每个子步对当前向量做Arnoldi，按子步长dt（占τ的比例）估计误差，MY_EXPRB_KRYLOV_MAX 维仍不满足时减半dt；
+ * 子步数超过 MY_EXPRB_SUBSTEP_MAX 时 converged 置为假
+ */
+static MwsInteger myExprbPhi(MyExprbProblem* spw, MoReal tau, MoInteger p, const MoReal* const* b, MoReal tol,
+    MoReal* out, MoBoolean* converged)
+{
+    MyExprbProblemData* ds = spw->m_data;
+    MoSize n = spw->m_nStates;
+    MoSize len = n + p;
+    MoSize ld = n + MY_EXPRB_PHI_MAX;
+    const MoInteger mMax = MY_EXPRB_KRYLOV_MAX;
+    MoReal* w = ds->m_basis + (mMax + 1) * ld;
+    MoReal* hess = ds->m_hess;
+    MoReal* e = ds->m_hess + (mMax + 1) * mMax;
+    MoReal* work = e + mMax * mMax;
+    MoReal normB = 0;
+    MoReal eta, s = 0, dt = 1;
+    MoInteger k, substeps = 0;
+    MoInteger check = MY_EXPRB_KRYLOV_CHECK;
+    int expo;
+    MoSize index;
+
+    *converged = moTrue;
+    for (k = 0; k < p; ++k)
+    {
+        if (b[k])
+        {
+            MoReal normK = myExprbNorm(n, b[k]);
+            normB = normK > normB ? normK : normB;
+        }
+    }
+    if (normB == 0)
+    {
+        memset(out, 0, n * sizeof(MoReal));
+        return MWS_IVP_SUCCESS;
+    }
+    frexp(normB, &expo);
+    eta = ldexp(1.0, -expo);
+    tol *= eta;
+
+    memset(w, 0, len * sizeof(MoReal));
+    w[n + p - 1] = 1;
+
+    while (s < 1)
+    {
+        MoReal beta = myExprbNorm(len, w);
+        MoReal hScale = 0;
+        MoReal errEst = 0;
+        MoInteger m = 0;
+        MoInteger j, i;
+        MoBoolean done = moFalse;
+
+        if (beta == 0)
+        {
+            break;      /* exp(τA~)*0 = 0 */
+        }
+        if (++substeps > MY_EXPRB_SUBSTEP_MAX)
+        {
+            *converged = moFalse;
+            return MWS_IVP_SUCCESS;
+        }
+        ++ds->m_stats.m_substeps;
+        dt = dt < 1 - s ? dt : 1 - s;
+
+        for (index = 0; index < len; ++index)
+        {
+            ds->m_basis[index] = w[index] / beta;
+        }
+        memset(hess, 0, (mMax + 1) * mMax * sizeof(MoReal));
+
+        for (j = 0; j < mMax && !done; ++j)
+        {
+            MoReal* vj = ds->m_basis + j * ld;
+            MoReal* vn = ds->m_basis + (j + 1) * ld;
+            MoReal hNext;
+            MoReal colSum = 0;
+
+            /* vn = τ*A~*vj */
+            if (myExprbJv(spw, vj, vn) != MWS_IVP_SUCCESS)
+            {
+                return MWS_IVP_RHSFN_FAIL;
+            }
+            for (k = 0; k < p; ++k)
+            {
+                const MoReal* bk = b[p - 1 - k];
+                MoReal xk = eta * vj[n + k];
+
+                if (bk && xk != 0)
+                {
+                    for (index = 0; index < n; ++index)
+                    {
+                        vn[index] += xk * bk[index];
+                    }
+                }
+                vn[n + k] = k + 1 < p ? vj[n + k + 1] : 0;
+            }
+            for (index = 0; index < len; ++index)
+            {
+                vn[index] *= tau;
+            }
+
+            /* 修正Gram-Schmidt正交化 */
+            for (i = 0; i <= j; ++i)
+            {
+                const MoReal* vi = ds->m_basis + i * ld;
+                MoReal dot = 0;
+
+                for (index = 0; index < len; ++index)
+                {
+                    dot += vi[index] * vn[index];
+                }
+                for (index = 0; index < len; ++index)
+                {
+                    vn[index] -= dot * vi[index];
+                }
+                hess[i * mMax + j] = dot;
+                colSum += fabs(dot);
+            }
+            hNext = myExprbNorm(len, vn);
+            hess[(j + 1) * mMax + j] = hNext;
+            colSum += hNext;
+            hScale = colSum > hScale ? colSum : hScale;
+            m = j + 1;
+
+            if (hNext <= 1e-14 * hScale)
+            {
+                /* 子空间不变：exp(dt*H_m) 给出精确结果，可一次推进到底 */
+                dt = 1 - s;
+                myExprbExpm(m, hess, mMax, dt, e, work);
+                done = moTrue;
+                break;
+            }
+            for (index = 0; index < len; ++index)
+            {
+                vn[index] /= hNext;
+            }
+
+            if (m % check == 0 || m == mMax)
+            {
+                myExprbExpm(m, hess, mMax, dt, e, work);
+                errEst = beta * dt * hNext * fabs(e[(m - 1) * m]);
+                done = (MoBoolean)(errEst <= dt * tol);
+            }
+        }
+
+        /* 达到最大维数仍不满足：按误差约与 dt^(m+1) 成正比预测并减小子步，Krylov基不变 */
+        while (!done && dt > 1e-12)
+        {
+            MoReal factor = 0.9 * pow(dt * tol / errEst, 1.0 / m);
+
+            dt *= factor < 0.1 ? 0.1 : (factor > 0.5 ? 0.5 : factor);
+            myExprbExpm(m, hess, mMax, dt, e, work);
+            errEst = beta * dt * hess[m * mMax + m - 1] * fabs(e[(m - 1) * m]);
+            done = (MoBoolean)(errEst <= dt * tol);
+        }
+        if (!done)
+        {
+            *converged = moFalse;
+            return MWS_IVP_SUCCESS;
+        }
+        if (m == mMax)
+        {
+            check = mMax;   /* 后续子步多半也要用满维数，不再中途检查 */
+        }
+        if ((MoSize)m > ds->m_stats.m_maxDim)
+        {
+            ds->m_stats.m_maxDim = m;
+        }
+
+        /* w = beta*V_m*exp(dt*H_m)*e1 */
+        memset(w, 0, len * sizeof(MoReal));
+        for (i = 0; i < m; ++i)
+        {
+            const MoReal* vi = ds->m_basis + i * ld;
+            MoReal ci = beta * e[i * m];
+
+            for (index = 0; index < len; ++index)
+            {
+                w[index] += ci * vi[index];
+            }
+        }
+        s = dt < 1 - s ? s + dt : 1;    /* 末个子步直接到1，避免舍入多出一个极短的子步 */
+        if (errEst > 0)
+        {
+            /* 下一子步按同样的预测取值，使其在用满维数时恰好满足误差要求 */
+            MoReal factor = 0.9 * pow(dt * tol / errEst, 1.0 / m);
+            dt *= factor < 0.2 ? 0.2 : (factor > 2 ? 2 : factor);
+        }
+        else
+        {
+            dt *= 2;
+        }
+    }
+
+    for (index = 0; index < n; ++index)
+    {
+        out[index] = w[index] / eta;
+    }
+    return MWS_IVP_SUCCESS;
+}
+
+/* d = f(tc, uc) - F - J*(uc - u) - c*v，即非线性余项；借用 m_err 存放 uc - u */
+static MwsInteger myExprbRemainder(MyExprbProblem* spw, MoReal tc, MoReal c, const MoReal* uc, MoReal* jd, MoReal* d)
+{
+    MyExprbProblemData* ds = spw->m_data;
+    MoSize n = spw->m_nStates;
+    MoSize index;
+
+    if (spw->m_callback.m_rshFunction(spw->m_userData, tc, uc, d) != MWS_IVP_SUCCESS)
+    {
+        return MWS_IVP_RHSFN_FAIL;
+    }
+    for (index = 0; index < n; ++index)
+    {
+        ds->m_err[index] = uc[index] - ds->m_preY[index];
+    }
+    if (myExprbJv(spw, ds->m_err, jd) != MWS_IVP_SUCCESS)
+    {
+        return MWS_IVP_RHSFN_FAIL;
+    }
+    for (index = 0; index < n; ++index)
+    {
+        d[index] -= ds->m_preYp[index] + jd[index] + c * ds->m_dfdt[index];
+    }
+    return MWS_IVP_SUCCESS;
+}
+
+/// <summary>
+/// 创建算法
+/// </summary>
+/// <param name="util_fcns">工具函数（仿真求解器提供，用户调用）</param>
+/// <param name="user_data">用户数据（求解器内部数据，传递给工具函数util_fcns，自定义算法无需关心其内容）</param>
+/// <returns></returns>
+MwsIVPSolverObj myExprbCreate(MwsIVPUtilFcns* util_fcns, void* user_data)
+{
+    MyExprb* sw = (MyExprb*)util_fcns->m_allocMemory(user_data, 1, sizeof(MyExprb));
+
+    if (sw)
+    {
+        memset(sw, 0, sizeof(*sw));
+        sw->m_utils = *util_fcns;
+        sw->m_userData = user_data;
+    }
+
+    return sw;
+}
+
+/// <summary>
+/// 创建问题
+/// </summary>
+/// <param name="solver">积分算法对象</param>
+/// <param name="n">问题规模，即状态变量个数==微分方程阶数</param>
+/// <param name="call_back">回调函数</param>
+/// <param name="opt">求解器选项</param>
+/// <param name="ivp_user_data">用户数据(求解器内部数据，传递给回调函数call_back，算法无需关心)</param>
+/// <returns></returns>
+MwsIVPObj myExprbProblemCreate(MwsIVPSolverObj solver, MwsSize n, MwsIVPCallback* call_back, MwsIVPOptions* opt, void* ivp_user_data)
+{
+    MyExprb* sw = (MyExprb*)solver;
+    MyExprbProblem* spw = (MyExprbProblem*)sw->m_utils.m_allocMemory(sw->m_userData, 1, sizeof(MyExprbProblem));
+
+    if (spw)
+    {
+        MyExprbProblemData* ds = (MyExprbProblemData*)sw->m_utils.m_allocDataMemory(sw->m_userData, 1, sizeof(MyExprbProblemData));
+
+        if (ds == mwsNullPtr)
+        {
+            sw->m_utils.m_freeMemory(sw->m_userData, spw);
+            return mwsNullPtr;
+        }
+
+        memset(spw, 0, sizeof(*spw));
+        memset(ds, 0, sizeof(*ds));
+
+        spw->m_callback = *call_back;
+        spw->m_userData = ivp_user_data;
+        MY_IVP_TRACE_INTERPOSE(&spw->m_trace, &spw->m_callback, &spw->m_userData);
+        spw->m_opt = *opt;
+        spw->m_nStates = n;
+        spw->m_data = ds;
+        spw->m_solverWork = sw;
+        ds->m_method = MY_EXPRB_43;
+        ds->m_useJac = moTrue;
+        myExprbSetController(sw, spw, mwsNullPtr);
+
+        if (spw->m_nStates > 0)
+        {
+            MoSize ld = n + MY_EXPRB_PHI_MAX;
+
+            ds->m_preY = (MoReal*)sw->m_utils.m_allocDataMemory(sw->m_userData, 4, n * sizeof(MoReal));
+            ds->m_dfdt = (MoReal*)sw->m_utils.m_allocDataMemory(sw->m_userData, 8, n * sizeof(MoReal));
+            ds->m_basis = (MoReal*)sw->m_utils.m_allocDataMemory(sw->m_userData, MY_EXPRB_KRYLOV_MAX + 2,
+                ld * sizeof(MoReal));
+            ds->m_hess = (MoReal*)sw->m_utils.m_allocDataMemory(sw->m_userData,
+                (MY_EXPRB_KRYLOV_MAX + 1) * MY_EXPRB_KRYLOV_MAX + 6 * MY_EXPRB_KRYLOV_MAX * MY_EXPRB_KRYLOV_MAX,
+                sizeof(MoReal));
+            ds->m_snap.m_y = (MoReal*)sw->m_utils.m_allocDataMemory(sw->m_userData, 4, n * sizeof(MoReal));
+            if (spw->m_callback.m_jacFunction && n <= MY_EXPRB_JAC_MAX_N)
+            {
+                ds->m_jac = (MoReal*)sw->m_utils.m_allocDataMemory(sw->m_userData, n * n, sizeof(MoReal));
+            }
+
+            if (!ds->m_preY || !ds->m_dfdt || !ds->m_basis || !ds->m_hess || !ds->m_snap.m_y
+                || (spw->m_callback.m_jacFunction && n <= MY_EXPRB_JAC_MAX_N && !ds->m_jac))
+            {
+                myExprbProblemDestroy(sw, spw);
+                spw = MWnullptr;
+            }
+            else
+            {
+                ds->m_curY = ds->m_preY + n;
+                ds->m_preYp = ds->m_preY + 2 * n;
+                ds->m_curYp = ds->m_preY + 3 * n;
+                ds->m_u2 = ds->m_dfdt + n;
+                ds->m_u3 = ds->m_dfdt + 2 * n;
+                ds->m_d2 = ds->m_dfdt + 3 * n;
+                ds->m_d3 = ds->m_dfdt + 4 * n;
+                ds->m_fTmp = ds->m_dfdt + 5 * n;
+                ds->m_err = ds->m_dfdt + 6 * n;
+                ds->m_yTmp = ds->m_dfdt + 7 * n;
+
+                memset(ds->m_preY, 0, 4 * n * sizeof(MoReal));
+                memset(ds->m_dfdt, 0, 8 * n * sizeof(MoReal));
+            }
+        }
+    }
+
+    return spw;
+}
+
+/// <summary>
+/// 初始化
+/// </summary>
+/// <param name="solver">积分算法对象</param>
+/// <param name="ivp">问题对象</param>
+/// <param name="t0">初始时间</param>
+/// <param name="y0">y的初始值（特定不为空）</param>
+/// <param name="yp0">y’的初始值（DAE）</param>
+/// <param name="is_reinit">是否重新初始化（保留）</param>
+/// <param name="reserve">保留参数，暂不使用</param>
+/// <returns></returns>
+MwsInteger myExprbInit(MwsIVPSolverObj solver, MwsIVPObj ivp, MwsReal t0, const MwsReal* y0,
+    const MwsReal* yp0, MwsBoolean is_reinit, void* reserve)
+{
+    MyExprbProblem* spw = (MyExprbProblem*)ivp;
+    MyExprbProblemData* ds = spw->m_data;
+    MoSize nState = spw->m_nStates;
+    MoSize index;
+    MoReal oldNorm = 0;
+    MoReal newNorm = 0;
+
+    ds->m_curTime = t0;
+    ds->m_preTime = t0;
+    if (!is_reinit)
+    {
+        /* 首次初始化：清空步长历史与统计，旧快照作废 */
+        ds->m_h = 0;
+        ds->m_snap.m_valid = moFalse;
+        memset(&ds->m_stats, 0, sizeof(ds->m_stats));
+    }
+
+    if (nState == 0 || y0 == mwsNullPtr)
+    {
+        ds->m_ypValid = moFalse;
+        return MWS_IVP_SUCCESS;
+    }
+
+    if (is_reinit && ds->m_ypValid)
+    {
+        for (index = 0; index < nState; ++index)
+        {
+            oldNorm += ds->m_curYp[index] * ds->m_curYp[index];
+        }
+    }
+
+    memcpy(ds->m_curY, y0, nState * sizeof(MoReal));
+    memcpy(ds->m_preY, y0, nState * sizeof(MoReal));
+    if (spw->m_callback.m_rshFunction(spw->m_userData, t0, ds->m_curY, ds->m_curYp) != MWS_IVP_SUCCESS)
+    {
+        ds->m_ypValid = moFalse;
+        return MWS_IVP_RHSFN_FAIL;
+    }
+    memcpy(ds->m_preYp, ds->m_curYp, nState * sizeof(MoReal));
+
+    /* 重新初始化：与myRK45Init相同，按y'跳变幅度缩小保留的步长 */
+    if (is_reinit && ds->m_h > 0 && ds->m_ypValid)
+    {
+        for (index = 0; index < nState; ++index)
+        {
+            newNorm += ds->m_curYp[index] * ds->m_curYp[index];
+        }
+        if (newNorm > oldNorm)
+        {
+            MoReal ratio = sqrt(oldNorm / newNorm);
+            ds->m_h *= (ratio < 0.1) ? 0.1 : ratio;
+        }
+    }
+    ds->m_ypValid = moTrue;
+
+    return MWS_IVP_SUCCESS;
+}
+
+/// <summary>
+/// 求解：每次调用前进一个被接受的积分步，误差超限或Krylov子步过多时在内部缩小步长重试。
+/// J与df/dt每步在起点计算一次，被拒绝的试算步沿用
+/// </summary>
+/// 输入：
+/// <param name="solver">积分算法对象</param>
+/// <param name="ivp">问题对象</param>
+/// <param name="step_size">初始积分步长（仅首步使用，<=0时自动选择）</param>
+/// <param name="t">当前时间</param>
+/// <param name="tout">输出结果时间</param>
+/// 输出：
+/// <param name="tret">结果实际达到的时间</param>
+/// <param name="yret">y的结果值（输入为当前y）</param>
+/// <param name="ypret">y’的结果值（可为空）</param>
+/// <param name="reserve">保留参数，暂不使用</param>
+/// <returns></returns>
+MwsInteger myExprbSolve(MwsIVPSolverObj solver, MwsIVPObj ivp, MwsReal step_size, MwsReal t,
+    MwsReal tout, MwsReal* tret, MwsReal* yret, MwsReal* ypret, void* reserve)
+{
+    MyExprbProblem* spw = (MyExprbProblem*)ivp;
+    MyExprbProblemData* ds = spw->m_data;
+
+    MoSize n = spw->m_nStates;
+    MoSize index;
+
+    MoReal* preY = ds->m_preY;
+    MoReal* curY = ds->m_curY;
+    MoReal* F = ds->m_preYp;
+    MoReal* v = ds->m_dfdt;
+    MoReal* U2 = ds->m_u2;
+    MoReal* U3 = ds->m_u3;
+    MoReal* D2 = ds->m_d2;
+    MoReal* D3 = ds->m_d3;
+    MoReal* err = ds->m_err;
+
+    MoInteger errOrder = ds->m_method == MY_EXPRB_32 ? 2 : 3;
+    MoReal rtol = myIVPRelTol(&spw->m_opt);
+    MoReal atol = myIVPAbsTol(&spw->m_opt);
+    MoReal krylovTol;
+    MoReal h = ds->m_h;
+    MoReal dt;
+    MoReal errNorm = 0;
+    MoBoolean rejected = moFalse;
+
+    if (spw->m_opt.m_stopTimeDefined && t >= spw->m_opt.m_stopTime)
+    {
+        *tret = t;
+        return MWS_IVP_TSTOP_RETURN;
+    }
+
+    /* 当前状态（上一步的y1即本步的y0），F沿用上一步的 f(t+h,y1) */
+    memcpy(preY, yret, n * sizeof(MoReal));
+    if (ds->m_ypValid && t == ds->m_curTime)
+    {
+        memcpy(F, ds->m_curYp, n * sizeof(MoReal));
+    }
+    else if (n > 0 && spw->m_callback.m_rshFunction(spw->m_userData, t, preY, F) != MWS_IVP_SUCCESS)
+    {
+        return MWS_IVP_RHSFN_FAIL;
+    }
+    ds->m_ypValid = moFalse;
+
+    if (h <= 0)
+    {
+        h = step_size;
+        if (h <= 0 && myIVPInitialStep(&spw->m_callback, spw->m_userData, n, t, preY, F, rtol, atol, errOrder,
+            myIVPMaxStep(&spw->m_opt), U2, U3, &h) != MWS_IVP_SUCCESS)
+        {
+            return MWS_IVP_RHSFN_FAIL;
+        }
+    }
+
+    /* 起点的J与 v = (f(t+dt,u) - F)/dt */
+    ds->m_jvTime = t;
+    if (ds->m_jac && ds->m_useJac
+        && spw->m_callback.m_jacFunction(spw->m_userData, t, preY, mwsNullPtr, 0, ds->m_jac) != MWS_IVP_SUCCESS)
+    {
+        return MWS_IVP_RHSFN_FAIL;
+    }
+    dt = sqrt(2.2e-16) * (fabs(t) > 1 ? fabs(t) : 1);
+    if (n > 0 && spw->m_callback.m_rshFunction(spw->m_userData, t + dt, preY, v) != MWS_IVP_SUCCESS)
+    {
+        return MWS_IVP_RHSFN_FAIL;
+    }
+    for (index = 0; index < n; ++index)
+    {
+        v[index] = (v[index] - F[index]) / dt;
+    }
+
+    /* Krylov误差（2范数）取积分误差范数的 MY_EXPRB_KRYLOV_SAFETY 倍 */
+    krylovTol = MY_EXPRB_KRYLOV_SAFETY * (atol * sqrt((MoReal)n) + rtol * myExprbNorm(n, preY));
+
+    for (;;)
+    {
+        MoBoolean converged = moTrue;
+        MY_IVP_TRACE_BEGIN(attempt)
+
+        h = myIVPClampStep(&spw->m_opt, t, h);
+        if (h < myIVPMinStep(t))
+        {
+            return MWS_IVP_FAIL;    /* 步长过小 */
+        }
+
+        if (ds->m_method == MY_EXPRB_32)
+        {
+            const MoReal* b[3];
+
+            /* U2 = u + h*φ1*F + h^2*φ2*v */
+            b[0] = F;
+            b[1] = v;
+            if (myExprbPhi(spw, h, 2, b, krylovTol, U2, &converged) != MWS_IVP_SUCCESS)
+            {
+                return MWS_IVP_RHSFN_FAIL;
+            }
+            if (converged)
+            {
+                for (index = 0; index < n; ++index)
+                {
+                    U2[index] += preY[index];
+                }
+                if (myExprbRemainder(spw, t + h, h, U2, U3, D2) != MWS_IVP_SUCCESS)
+                {
+                    return MWS_IVP_RHSFN_FAIL;
+                }
+
+                /* 误差 = 2h*φ3*D2 = h^3*φ3*(2D2/h^2)，u1 = U2 + 误差 */
+                for (index = 0; index < n; ++index)
+                {
+                    U3[index] = 2 * D2[index] / (h * h);
+                }
+                b[0] = mwsNullPtr;
+                b[1] = mwsNullPtr;
+                b[2] = U3;
+                if (myExprbPhi(spw, h, 3, b, krylovTol, err, &converged) != MWS_IVP_SUCCESS)
+                {
+                    return MWS_IVP_RHSFN_FAIL;
+                }
+                for (index = 0; index < n; ++index)
+                {
+                    curY[index] = U2[index] + err[index];
+                }
+            }
+        }
+        else
+        {
+            const MoReal* b[4];
+
+            /* U2 = u + (h/2)*φ1(hJ/2)*F + (h/2)^2*φ2(hJ/2)*v */
+            b[0] = F;
+            b[1] = v;
+            if (myExprbPhi(spw, h / 2, 2, b, krylovTol, U2, &converged) != MWS_IVP_SUCCESS)
+            {
+                return MWS_IVP_RHSFN_FAIL;
+            }
+            if (converged)
+            {
+                for (index = 0; index < n; ++index)
+                {
+                    U2[index] += preY[index];
+                }
+                if (myExprbRemainder(spw, t + h / 2, h / 2, U2, U3, D2) != MWS_IVP_SUCCESS)
+                {
+                    return MWS_IVP_RHSFN_FAIL;
+                }
+
+                /* U3 = u + h*φ1*(F + D2) + h^2*φ2*v */
+                for (index = 0; index < n; ++index)
+                {
+                    U3[index] = F[index] + D2[index];
+                }
+                b[0] = U3;
+                if (myExprbPhi(spw, h, 2, b, krylovTol, err, &converged) != MWS_IVP_SUCCESS)
+                {
+                    return MWS_IVP_RHSFN_FAIL;
+                }
+            }
+            if (converged)
+            {
+                for (index = 0; index < n; ++index)
+                {
+                    U3[index] = preY[index] + err[index];
+                }
+                if (myExprbRemainder(spw, t + h, h, U3, U2, D3) != MWS_IVP_SUCCESS)
+                {
+                    return MWS_IVP_RHSFN_FAIL;
+                }
+
+                /* h*φ3*(16D2 - 2D3) + h*φ4*(-48D2 + 12D3)，换成 h^k*φ_k*b_k 的形式 */
+                for (index = 0; index < n; ++index)
+                {
+                    U2[index] = (16 * D2[index] - 2 * D3[index]) / (h * h);
+                    U3[index] = (-48 * D2[index] + 12 * D3[index]) / (h * h * h);
+                }
+                b[0] = F;
+                b[1] = v;
+                b[2] = U2;
+                b[3] = U3;
+                if (myExprbPhi(spw, h, 4, b, krylovTol, err, &converged) != MWS_IVP_SUCCESS)
+                {
+                    return MWS_IVP_RHSFN_FAIL;
+                }
+            }
+            if (converged)
+            {
+                for (index = 0; index < n; ++index)
+                {
+                    curY[index] = preY[index] + err[index];
+                }
+
+                /* 误差 = h*φ4*(-48D2 + 12D3) */
+                b[0] = mwsNullPtr;
+                b[1] = mwsNullPtr;
+                b[2] = mwsNullPtr;
+                if (myExprbPhi(spw, h, 4, b, krylovTol, err, &converged) != MWS_IVP_SUCCESS)
+                {
+                    return MWS_IVP_RHSFN_FAIL;
+                }
+            }
+        }
+
+        if (converged)
+        {
+            errNorm = myIVPErrorNorm(n, err, preY, curY, rtol, atol);
+            if (errNorm <= 1)
+            {
+                MY_IVP_TRACE_END(MY_IVP_TRACE_STEP, attempt);
+                break;
+            }
+            h *= myIVPStepFactorCtl(&ds->m_ctl, errNorm, errOrder);
+        }
+        else
+        {
+            h /= 2;     /* Krylov子步过多 */
+        }
+        rejected = moTrue;
+        ++ds->m_stats.m_rejected;
+        MY_IVP_TRACE_END(MY_IVP_TRACE_REJECT, attempt);
+    }
+
+    if (n > 0 && spw->m_callback.m_rshFunction(spw->m_userData, t + h, curY, ds->m_curYp) != MWS_IVP_SUCCESS)
+    {
+        return MWS_IVP_RHSFN_FAIL;
+    }
+
+    ds->m_preTime = t;
+    ds->m_curTime = t + h;
+    ds->m_initialStep = h;
+    ds->m_ypValid = moTrue;
+    ++ds->m_stats.m_steps;
+
+    /* 刚被拒绝过的步不再放大步长 */
+    if (rejected)
+    {
+        ds->m_h = h * (myIVPStepFactorCtl(&ds->m_ctl, errNorm, errOrder) < 1 ? myIVPStepFactorCtl(&ds->m_ctl, errNorm, errOrder) : 1);
+    }
+    else
+    {
+        ds->m_h = h * myIVPStepFactorCtl(&ds->m_ctl, errNorm, errOrder);
+    }
+
+    memcpy(yret, curY, n * sizeof(MoReal));
+    if (ypret)
+    {
+        memcpy(ypret, ds->m_curYp, n * sizeof(MoReal));
+    }
+    *tret = ds->m_curTime;
+
+    return MWS_IVP_SUCCESS;
+}
+
+/// <summary>
+/// 插值：用步两端的 y 与 y' 做三次Hermite插值，不需要额外的右端函数计算
+/// </summary>
+/// 输入：
+/// <param name="solver">积分算法对象</param>
+/// <param name="ivp">问题对象</param>
+/// <param name="tout">输出结果的时间</param>
+/// 输出：
+/// <param name="yret">y的结果值</param>
+/// <param name="reserve"></param>
+/// <returns></returns>
+MwsInteger myExprbInterpolate(MwsIVPSolverObj solver, MwsIVPObj ivp, MwsReal tout, MwsReal* yret, void* reserve)
+{
+    MyExprbProblem* spw = (MyExprbProblem*)ivp;
+    MyExprbProblemData* ds = spw->m_data;
+    MoReal h = ds->m_curTime - ds->m_preTime;
+
+    if (h == 0)
+    {
+        memcpy(yret, ds->m_curY, spw->m_nStates * sizeof(MoReal));
+        return MWS_IVP_SUCCESS;
+    }
+
+    myIVPHermite(spw->m_nStates, (tout - ds->m_preTime) / h, h, ds->m_preY, ds->m_curY,
+        ds->m_preYp, ds->m_curYp, yret);
+
+    return MWS_IVP_SUCCESS;
+}
+
+/// <summary>
+/// 保存状态快照，只拷贝到预分配的快照区，不分配内存
+/// </summary>
+/// <param name="solver">积分算法对象</param>
+/// <param name="ivp">问题对象</param>
+/// <returns></returns>
+MwsInteger myExprbSaveState(MwsIVPSolverObj solver, MwsIVPObj ivp)
+{
+    MyExprbProblem* spw = (MyExprbProblem*)ivp;
+    MyExprbProblemData* ds = spw->m_data;
+
+    if (spw->m_nStates > 0)
+    {
+        memcpy(ds->m_snap.m_y, ds->m_preY, 4 * spw->m_nStates * sizeof(MoReal));
+    }
+    ds->m_snap.m_curTime = ds->m_curTime;
+    ds->m_snap.m_preTime = ds->m_preTime;
+    ds->m_snap.m_h = ds->m_h;
+    ds->m_snap.m_valid = moTrue;
+
+    return MWS_IVP_SUCCESS;
+}
+
+/// <summary>
+/// 恢复到最近一次保存的快照，步长历史一并恢复
+/// </summary>
+/// 输入：
+/// <param name="solver">积分算法对象</param>
+/// <param name="ivp">问题对象</param>
+/// 输出：
+/// <param name="tret">快照时刻（可为空）</param>
+/// <param name="yret">快照时刻y的值（可为空）</param>
+/// <param name="ypret">快照时刻y'的值（可为空）</param>
+/// <returns>未保存过快照时返回MWS_IVP_INVALID_INPUT</returns>
+MwsInteger myExprbRestoreState(MwsIVPSolverObj solver, MwsIVPObj ivp, MwsReal* tret, MwsReal* yret, MwsReal* ypret)
+{
+    MyExprbProblem* spw = (MyExprbProblem*)ivp;
+    MyExprbProblemData* ds = spw->m_data;
+    MoSize nState = spw->m_nStates;
+
+    if (!ds->m_snap.m_valid)
+    {
+        return MWS_IVP_INVALID_INPUT;
+    }
+
+    if (nState > 0)
+    {
+        memcpy(ds->m_preY, ds->m_snap.m_y, 4 * nState * sizeof(MoReal));
+    }
+    ds->m_curTime = ds->m_snap.m_curTime;
+    ds->m_preTime = ds->m_snap.m_preTime;
+    ds->m_h = ds->m_snap.m_h;
+    ds->m_ypValid = moTrue;
+
+    if (tret)
+    {
+        *tret = ds->m_curTime;
+    }
+    if (yret && nState > 0)
+    {
+        memcpy(yret, ds->m_curY, nState * sizeof(MoReal));
+    }
+    if (ypret && nState > 0)
+    {
+        memcpy(ypret, ds->m_curYp, nState * sizeof(MoReal));
+    }
+
+    return MWS_IVP_SUCCESS;
+}
+
+/// <summary>
+/// 设置步长控制器参数（安全因子与单步缩放倍数上下限），不影响已有的步长历史
+/// </summary>
+/// <param name="solver">积分算法对象</param>
+/// <param name="ivp">问题对象</param>
+/// <param name="ctl">控制器参数，为空时恢复默认值</param>
+/// <returns>参数无效时返回MWS_IVP_INVALID_INPUT</returns>
+MwsInteger myExprbSetController(MwsIVPSolverObj solver, MwsIVPObj ivp, const MyIVPController* ctl)
+{
+    static const MyIVPController defaultCtl = MY_IVP_CONTROLLER_DEFAULT;
+    MyExprbProblem* spw = (MyExprbProblem*)ivp;
+
+    if (ctl == mwsNullPtr)
+    {
+        ctl = &defaultCtl;
+    }
+    if (!myIVPControllerValid(ctl))
+    {
+        return MWS_IVP_INVALID_INPUT;
+    }
+    spw->m_data->m_ctl = *ctl;
+
+    return MWS_IVP_SUCCESS;
+}
+
+/// <summary>
+/// 选择方法，并设置J*x是否使用解析Jacobian；应在初始化前调用
+/// </summary>
+/// <param name="solver">积分算法对象</param>
+/// <param name="ivp">问题对象</param>
+/// <param name="method">方法，取MyExprbMethod的值</param>
+/// <param name="use_jac">是否用 m_jacFunction（稠密，按列存储）计算J*x；为假、回调未提供Jacobian
+/// 或规模超过 MY_EXPRB_JAC_MAX_N 时用右端函数差商（Jacobian稀疏、规模较大时差商往往更快）</param>
+/// <returns>参数无效时返回MWS_IVP_INVALID_INPUT</returns>
+MwsInteger myExprbSetMethod(MwsIVPSolverObj solver, MwsIVPObj ivp, MoInteger method, MoBoolean use_jac)
+{
+    MyExprbProblemData* ds = ((MyExprbProblem*)ivp)->m_data;
+
+    if (method < 0 || method >= MY_EXPRB_METHOD_COUNT)
+    {
+        return MWS_IVP_INVALID_INPUT;
+    }
+    ds->m_method = method;
+    ds->m_useJac = use_jac;
+    ds->m_h = 0;
+
+    return MWS_IVP_SUCCESS;
+}
+
+/// <summary>
+/// 查询统计信息（步数、拒绝次数、J*x次数、Krylov子步数与最大维数），首次初始化时清零
+/// </summary>
+/// <param name="solver">积分算法对象</param>
+/// <param name="ivp">问题对象</param>
+/// <param name="stats">统计结果</param>
+/// <returns></returns>
+MwsInteger myExprbGetStats(MwsIVPSolverObj solver, MwsIVPObj ivp, MyExprbStats* stats)
+{
+    *stats = ((MyExprbProblem*)ivp)->m_data->m_stats;
+    return MWS_IVP_SUCCESS;
+}
+
+/// <summary>
+/// 销毁问题
+/// </summary>
+/// <param name="solver"></param>
+/// <param name="ivp"></param>
+void myExprbProblemDestroy(MwsIVPSolverObj solver, MwsIVPObj ivp)
+{
+    MyExprb* sw = (MyExprb*)solver;
+    MyExprbProblem* spw = (MyExprbProblem*)ivp;
+
+    if (spw)
+    {
+        if (spw->m_data->m_preY)
+        {
+            (*sw->m_utils.m_freeDataMemory)(sw->m_userData, spw->m_data->m_preY);
+        }
+
+        if (spw->m_data->m_dfdt)
+        {
+            (*sw->m_utils.m_freeDataMemory)(sw->m_userData, spw->m_data->m_dfdt);
+        }
+
+        if (spw->m_data->m_jac)
+        {
+            (*sw->m_utils.m_freeDataMemory)(sw->m_userData, spw->m_data->m_jac);
+        }
+
+        if (spw->m_data->m_basis)
+        {
+            (*sw->m_utils.m_freeDataMemory)(sw->m_userData, spw->m_data->m_basis);
+        }
+
+        if (spw->m_data->m_hess)
+        {
+            (*sw->m_utils.m_freeDataMemory)(sw->m_userData, spw->m_data->m_hess);
+        }
+
+        if (spw->m_data->m_snap.m_y)
+        {
+            (*sw->m_utils.m_freeDataMemory)(sw->m_userData, spw->m_data->m_snap.m_y);
+        }
+
+        if (spw->m_data)
+        {
+            (*sw->m_utils.m_freeDataMemory)(sw->m_userData, spw->m_data);
+        }
+
+        (*sw->m_utils.m_freeMemory)(sw->m_userData, spw);
+    }
+}
+
+/// <summary>
+/// 销毁积分算法
+/// </summary>
+/// <param name="solver"></param>
+void myExprbDestroy(MwsIVPSolverObj solver)
+{
+    MyExprb* sw = (MyExprb*)solver;
+
+    if (sw)
+    {
+        (*sw->m_utils.m_freeMemory)(sw->m_userData, sw);
+    }
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+
+/***************************************************************************
+//   end of file
+***************************************************************************/
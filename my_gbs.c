@@ -0,0 +1,657 @@
+/***************************************************************************
+///
+/// Copyright (c) 2020, 苏州同元软控信息技术有限公司
+/// All rights reserved.
+///
+/// @file           my_gbs.c
+/// @brief          Gragg-Bulirsch-Stoer外推积分算法（变阶变步长），各子步序列可并行计算
+///
+/// @version        v1.0
+/// @author         田显钊
+/// @date           2020/07/07
+///
+***************************************************************************/
+
+#include "mo_types.h"
+#include "mws_ivp_solver.h"
+#include "my_ivp_common.h"
+#include "my_ivp_trace.h"
+
+#include <memory.h>
+#include <math.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+/*
+ * 算法（Hairer, Norsett, Wanner, Solving ODE I, II.9）：
+ *  步长H内用子步数 n_j = 2(j+1) 的Gragg修正中点法得到 T_{j,0}（j=0..k），
+ *  其误差按h^2展开，Aitken-Neville外推：
+ *    T_{j,l} = T_{j,l-1} + (T_{j,l-1} - T_{j-1,l-1}) / ((n_j/n_{j-l})^2 - 1)
+ *  T_{k,k} 为2k+2阶，||T_{k,k} - T_{k,k-1}|| 作为误差估计。
+ *  步中点处的偶数下标值 z_{n_j/2}（j为奇数）同样按h^2展开，外推后与两端的 y、y' 一起做五次Hermite稠密输出。
+ *  各 T_{j,0} 互不依赖，开启多线程时（myGbsSetThreads）并行计算，关键路径为最长的 n_k 次右端函数计算。
+ *  阶数按单位步长的工作量 A_k/H_k 最小来选择。
+ */
+#define MY_GBS_MAX_K        9       /* 最高外推列号，对应最高20阶 */
+#define MY_GBS_SAFETY       0.94
+#define MY_GBS_SAFETY2      0.65    /* 误差目标，使外推后的误差有余量 */
+
+/* 算法对象 */
+typedef struct
+{
+    MwsIVPUtilFcns	m_utils;
+    void*           m_userData;
+
+} MyGbs;
+
+/* 求解问题的数据，用数据内存分配和释放函数 */
+typedef struct
+{
+    /* m_preY、m_curY、m_preYp、m_curYp、m_yMid、m_ypMid、m_yAlt 依次位于同一块连续内存中（由m_preY持有） */
+    MoReal *m_preY;         /* 上一步y */
+    MoReal *m_curY;         /* 当前y */
+    MoReal *m_preYp;        /* 上一步y' */
+    MoReal *m_curYp;        /* 当前y' */
+    MoReal *m_yMid;         /* 步中点y（外推值） */
+    MoReal *m_ypMid;        /* 步中点y' */
+    MoReal *m_yAlt;         /* 低一阶的外推结果 T_{k-1,k-1} */
+
+    /* 每个子步序列独占的工作区：T_{j,0}、z_{n_j/2}、z_{m-1}、z_m、f，各长度n，共 5n*(MY_GBS_MAX_K+1)（由m_seq持有） */
+    MoReal *m_seq;
+
+    MoReal m_curTime;       /* 当前时间 */
+    MoReal m_preTime;       /* 上一步时间 */
+    MoReal m_h;             /* 下一步建议步长，0表示尚未开始积分 */
+    MoInteger m_k;          /* 当前外推列号 */
+    MoInteger m_threads;    /* 并行线程数，<=1时串行 */
+
+    MoBoolean m_ypValid;    /* m_curYp 是否对应 (m_curTime, m_curY) */
+} MyGbsProblemData;
+
+/* 求解问题对象 */
+typedef struct
+{
+    MoSize          m_nStates;
+
+    MwsIVPOptions	m_opt;
+    MwsIVPCallback  m_callback;
+    void*			m_userData;
+    MY_IVP_TRACE_MEMBER(m_trace)
+
+    MyGbsProblemData* m_data;
+    MyGbs* m_solverWork;
+
+} MyGbsProblem;
+
+void myGbsProblemDestroy(MwsIVPSolverObj solver, MwsIVPObj ivp);
+void myGbsDestroy(MwsIVPSolverObj solver);
+
+/* 第j个序列的子步数 */
+static MoInteger myGbsSubSteps(MoInteger j)
+{
+    return 2 * (j + 1);
+}
+
+/*
+ * 外推到第k列所需的时间（以右端函数计算次数计）
+ * 串行为各序列之和；threads个线程时取 max(最长序列, 总量/threads)
+ */
+static MoReal myGbsCost(MoInteger k, MoInteger threads)
+{
+    MoReal total = 1;
+    MoInteger j;
+
+    for (j = 0; j <= k; ++j)
+    {
+        total += myGbsSubSteps(j) - 1;
+    }
+    if (threads > 1)
+    {
+        MoReal share = total / (threads < k + 1 ? threads : k + 1);
+        return share > myGbsSubSteps(k) ? share : myGbsSubSteps(k);
+    }
+    return total;
+}
+
+/*
+ * Gragg修正中点法：z_0 = y0，z_1 = z_0 + h*f0，z_{m+1} = z_{m-1} + 2h*f(z_m)，结果 T = z_nSub
+ * @param[in] work  长度5n的工作区，依次为T、步中点值z_{nSub/2}、z_{m-1}、z_m 与 f
+ */
+static MwsInteger myGbsMidpoint(const MwsIVPCallback* cb, void* user_data, MoSize n, MoReal t, MoReal H,
+    const MoReal* y0, const MoReal* f0, MoInteger nSub, MoReal* work)
+{
+    MoReal* T = work;
+    MoReal* zMid = work + n;
+    MoReal* zPrev = work + 2 * n;
+    MoReal* zCur = work + 3 * n;
+    MoReal* f = work + 4 * n;
+    MoReal* tmp;
+    MoReal h = H / nSub;
+    MoSize index;
+    MoInteger m;
+
+    for (index = 0; index < n; ++index)
+    {
+        zPrev[index] = y0[index];
+        zCur[index] = y0[index] + h * f0[index];
+    }
+    for (m = 1; m < nSub; ++m)
+    {
+        if (cb->m_rshFunction(user_data, t + m * h, zCur, f) != MWS_IVP_SUCCESS)
+        {
+            return MWS_IVP_RHSFN_FAIL;
+        }
+        for (index = 0; index < n; ++index)
+        {
+            zPrev[index] += 2 * h * f[index];
+        }
+        tmp = zPrev;
+        zPrev = zCur;
+        zCur = tmp;
+        if (m + 1 == nSub / 2)
+        {
+            memcpy(zMid, zCur, n * sizeof(MoReal));
+        }
+    }
+    memcpy(T, zCur, n * sizeof(MoReal));
+
+    return MWS_IVP_SUCCESS;
+}
+
+/// <summary>
+/// 创建算法
+/// </summary>
+/// <param name="util_fcns">工具函数（由求解器提供，用户调用）</param>
+/// <param name="user_data">用户数据（求解器内部数据，传递给工具函数util_fcns，自定义算法无需关心其内容）</param>
+/// <returns></returns>
+MwsIVPSolverObj myGbsCreate(MwsIVPUtilFcns* util_fcns, void* user_data)
+{
+    MyGbs* sw = (MyGbs*)util_fcns->m_allocMemory(user_data, 1, sizeof(MyGbs));
+
+    if (sw)
+    {
+        memset(sw, 0, sizeof(*sw));
+        sw->m_utils = *util_fcns;
+        sw->m_userData = user_data;
+    }
+
+    return sw;
+}
+
+/// <summary>
+/// 创建问题
+/// </summary>
+/// <param name="solver">积分算法对象</param>
+/// <param name="n">问题规模，即状态变量个数==微分方程阶数</param>
+/// <param name="call_back">回调函数</param>
+/// <param name="opt">求解器选项</param>
+/// <param name="ivp_user_data">用户数据(求解器内部数据，传递给回调函数call_back，算法无需关心)</param>
+/// <returns></returns>
+MwsIVPObj myGbsProblemCreate(MwsIVPSolverObj solver, MwsSize n, MwsIVPCallback* call_back, MwsIVPOptions* opt, void* ivp_user_data)
+{
+    MyGbs* sw = (MyGbs*)solver;
+    MyGbsProblem* spw = (MyGbsProblem*)sw->m_utils.m_allocMemory(sw->m_userData, 1, sizeof(MyGbsProblem));
+
+    if (spw)
+    {
+        MyGbsProblemData* ds = (MyGbsProblemData*)sw->m_utils.m_allocDataMemory(sw->m_userData, 1, sizeof(MyGbsProblemData));
+
+        if (ds == mwsNullPtr)
+        {
+            sw->m_utils.m_freeMemory(sw->m_userData, spw);
+            return mwsNullPtr;
+        }
+
+        memset(spw, 0, sizeof(*spw));
+        memset(ds, 0, sizeof(*ds));
+
+        spw->m_callback = *call_back;
+        spw->m_userData = ivp_user_data;
+        MY_IVP_TRACE_INTERPOSE(&spw->m_trace, &spw->m_callback, &spw->m_userData);
+        spw->m_opt = *opt;
+        spw->m_nStates = n;
+        spw->m_data = ds;
+        spw->m_solverWork = sw;
+
+        ds->m_k = 3;
+        ds->m_threads = 1;
+
+        if (spw->m_nStates > 0)
+        {
+            ds->m_preY = (MoReal*)sw->m_utils.m_allocDataMemory(sw->m_userData, 7, n * sizeof(MoReal));
+            ds->m_seq = (MoReal*)sw->m_utils.m_allocDataMemory(sw->m_userData, 5 * (MY_GBS_MAX_K + 1), n * sizeof(MoReal));
+
+            if (!ds->m_preY || !ds->m_seq)
+            {
+                myGbsProblemDestroy(sw, spw);
+                spw = MWnullptr;
+            }
+            else
+            {
+                ds->m_curY = ds->m_preY + n;
+                ds->m_preYp = ds->m_preY + 2 * n;
+                ds->m_curYp = ds->m_preY + 3 * n;
+                ds->m_yMid = ds->m_preY + 4 * n;
+                ds->m_ypMid = ds->m_preY + 5 * n;
+                ds->m_yAlt = ds->m_preY + 6 * n;
+
+                memset(ds->m_preY, 0, 7 * n * sizeof(MoReal));
+                memset(ds->m_seq, 0, 5 * (MY_GBS_MAX_K + 1) * n * sizeof(MoReal));
+            }
+        }
+    }
+
+    return spw;
+}
+
+/// <summary>
+/// 设置并行线程数（需以OpenMP编译，否则始终串行）
+/// 并行时模型回调必须可重入，见 my_ivp_common.h 中的并行求值约定
+/// </summary>
+/// <param name="solver">积分算法对象</param>
+/// <param name="ivp">问题对象</param>
+/// <param name="threads">线程数，<=1为串行，默认1</param>
+/// <returns></returns>
+MwsInteger myGbsSetThreads(MwsIVPSolverObj solver, MwsIVPObj ivp, MoInteger threads)
+{
+    MyGbsProblem* spw = (MyGbsProblem*)ivp;
+
+    spw->m_data->m_threads = threads > 1 ? threads : 1;
+
+    return MWS_IVP_SUCCESS;
+}
+
+/// <summary>
+/// 初始化
+/// </summary>
+/// <param name="solver">积分算法对象</param>
+/// <param name="ivp">问题对象</param>
+/// <param name="t0">初始时间</param>
+/// <param name="y0">y的初始值（特定不为空）</param>
+/// <param name="yp0">y’的初始值（DAE）</param>
+/// <param name="is_reinit">是否重新初始化（保留）：保留步长与阶数</param>
+/// <param name="reserve">保留参数，暂不使用</param>
+/// <returns></returns>
+MwsInteger myGbsInit(MwsIVPSolverObj solver, MwsIVPObj ivp, MwsReal t0, const MwsReal* y0,
+    const MwsReal* yp0, MwsBoolean is_reinit, void* reserve)
+{
+    MyGbsProblem* spw = (MyGbsProblem*)ivp;
+    MyGbsProblemData* ds = spw->m_data;
+    MoSize nState = spw->m_nStates;
+
+    ds->m_curTime = t0;
+    ds->m_preTime = t0;
+    if (!is_reinit)
+    {
+        ds->m_h = 0;
+        ds->m_k = 3;
+    }
+
+    if (nState == 0 || y0 == mwsNullPtr)
+    {
+        ds->m_ypValid = moFalse;
+        return MWS_IVP_SUCCESS;
+    }
+
+    memcpy(ds->m_curY, y0, nState * sizeof(MoReal));
+    memcpy(ds->m_preY, y0, nState * sizeof(MoReal));
+    if (spw->m_callback.m_rshFunction(spw->m_userData, t0, ds->m_curY, ds->m_curYp) != MWS_IVP_SUCCESS)
+    {
+        ds->m_ypValid = moFalse;
+        return MWS_IVP_RHSFN_FAIL;
+    }
+    memcpy(ds->m_preYp, ds->m_curYp, nState * sizeof(MoReal));
+    ds->m_ypValid = moTrue;
+
+    return MWS_IVP_SUCCESS;
+}
+
+/// <summary>
+/// 求解：每次调用前进一个被接受的外推步，误差超限时在内部缩小步长重试
+/// </summary>
+/// 输入：
+/// <param name="solver">积分算法对象</param>
+/// <param name="ivp">问题对象</param>
+/// <param name="step_size">初始积分步长（仅首步使用，<=0时自动选择）</param>
+/// <param name="t">当前时间</param>
+/// <param name="tout">输出结果时间</param>
+/// 输出：
+/// <param name="tret">结果实际达到的时间</param>
+/// <param name="yret">y的结果值（输入为当前y）</param>
+/// <param name="ypret">y’的结果值（可为空）</param>
+/// <param name="reserve">保留参数，暂不使用</param>
+/// <returns></returns>
+MwsInteger myGbsSolve(MwsIVPSolverObj solver, MwsIVPObj ivp, MwsReal step_size, MwsReal t,
+    MwsReal tout, MwsReal* tret, MwsReal* yret, MwsReal* ypret, void* reserve)
+{
+    MyGbsProblem* spw = (MyGbsProblem*)ivp;
+    MyGbsProblemData* ds = spw->m_data;
+
+    MoSize n = spw->m_nStates;
+    MoSize index;
+    MoInteger j, l, k;
+
+    MoReal* preY = ds->m_preY;
+    MoReal* curY = ds->m_curY;
+    MoReal* f0 = ds->m_preYp;
+
+    MoReal rtol = myIVPRelTol(&spw->m_opt);
+    MoReal atol = myIVPAbsTol(&spw->m_opt);
+    MoReal H = ds->m_h;
+    MoReal errK, errKm1, hK, hKm1;
+    MoBoolean rejected = moFalse;
+    MwsInteger status[MY_GBS_MAX_K + 1];
+
+    if (spw->m_opt.m_stopTimeDefined && t >= spw->m_opt.m_stopTime)
+    {
+        *tret = t;
+        return MWS_IVP_TSTOP_RETURN;
+    }
+
+    memcpy(preY, yret, n * sizeof(MoReal));
+    if (ds->m_ypValid && t == ds->m_curTime)
+    {
+        memcpy(f0, ds->m_curYp, n * sizeof(MoReal));
+    }
+    else if (n > 0 && spw->m_callback.m_rshFunction(spw->m_userData, t, preY, f0) != MWS_IVP_SUCCESS)
+    {
+        return MWS_IVP_RHSFN_FAIL;
+    }
+    ds->m_ypValid = moFalse;
+
+    if (H <= 0)
+    {
+        H = step_size;
+        if (H <= 0 && myIVPInitialStep(&spw->m_callback, spw->m_userData, n, t, preY, f0, rtol, atol, 2 * ds->m_k + 1,
+            myIVPMaxStep(&spw->m_opt), ds->m_seq, ds->m_seq + n, &H) != MWS_IVP_SUCCESS)
+        {
+            return MWS_IVP_RHSFN_FAIL;
+        }
+    }
+
+    for (;;)
+    {
+        MY_IVP_TRACE_BEGIN(attempt)
+
+        k = ds->m_k;
+        H = myIVPClampStep(&spw->m_opt, t, H);
+        if (H < myIVPMinStep(t))
+        {
+            return MWS_IVP_FAIL;    /* 步长过小 */
+        }
+
+        /* 各子步序列相互独立，从最长的开始分配以平衡负载 */
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 1) num_threads(ds->m_threads) if (ds->m_threads > 1)
+#endif
+        for (j = k; j >= 0; --j)
+        {
+            status[j] = myGbsMidpoint(&spw->m_callback, spw->m_userData, n, t, H, preY, f0, myGbsSubSteps(j),
+                ds->m_seq + 5 * j * n);
+        }
+        for (j = 0; j <= k; ++j)
+        {
+            if (status[j] != MWS_IVP_SUCCESS)
+            {
+                return status[j];
+            }
+        }
+
+        /* 逐分量做Aitken-Neville外推，同时累计k列与k-1列的误差，并外推步中点值 */
+        errK = 0;
+        errKm1 = 0;
+        for (index = 0; index < n; ++index)
+        {
+            MoReal prev[MY_GBS_MAX_K + 1];
+            MoReal cur[MY_GBS_MAX_K + 1];
+            MoReal sc, e;
+            MoInteger nMid = 0;
+
+            for (j = 1; j <= k; j += 2)
+            {
+                cur[0] = ds->m_seq[(5 * j + 1) * n + index];
+                for (l = 1; l <= nMid; ++l)
+                {
+                    MoReal r = (MoReal)myGbsSubSteps(j) / myGbsSubSteps(j - 2 * l);
+                    cur[l] = cur[l - 1] + (cur[l - 1] - prev[l - 1]) / (r * r - 1);
+                }
+                memcpy(prev, cur, (nMid + 1) * sizeof(MoReal));
+                ++nMid;
+            }
+            ds->m_yMid[index] = nMid > 0 ? prev[nMid - 1] : preY[index];
+
+            for (j = 0; j <= k; ++j)
+            {
+                cur[0] = ds->m_seq[5 * j * n + index];
+                for (l = 1; l <= j; ++l)
+                {
+                    MoReal r = (MoReal)myGbsSubSteps(j) / myGbsSubSteps(j - l);
+                    cur[l] = cur[l - 1] + (cur[l - 1] - prev[l - 1]) / (r * r - 1);
+                }
+                if (j == k - 1)
+                {
+                    ds->m_yAlt[index] = cur[j];
+                    if (j > 0)
+                    {
+                        sc = atol + rtol * (fabs(preY[index]) > fabs(cur[j]) ? fabs(preY[index]) : fabs(cur[j]));
+                        e = (cur[j] - cur[j - 1]) / sc;
+                        errKm1 += e * e;
+                    }
+                }
+                memcpy(prev, cur, (j + 1) * sizeof(MoReal));
+            }
+            curY[index] = cur[k];
+            sc = atol + rtol * (fabs(preY[index]) > fabs(cur[k]) ? fabs(preY[index]) : fabs(cur[k]));
+            e = (cur[k] - cur[k - 1]) / sc;
+            errK += e * e;
+        }
+        errK = n > 0 ? sqrt(errK / n) : 0;
+        errKm1 = n > 0 ? sqrt(errKm1 / n) : 0;
+        if (!(errK <= HUGE_VAL))
+        {
+            errK = HUGE_VAL;    /* nan按失败处理 */
+        }
+        if (!(errKm1 <= HUGE_VAL))
+        {
+            errKm1 = HUGE_VAL;
+        }
+
+        /* 各列的最优步长：误差估计对应 2l 阶公式 */
+        hK = H * (errK > 0 ? MY_GBS_SAFETY * pow(MY_GBS_SAFETY2 / errK, 1.0 / (2 * k + 1)) : MY_IVP_MAX_FACTOR);
+        hKm1 = k > 1 ? H * (errKm1 > 0 ? MY_GBS_SAFETY * pow(MY_GBS_SAFETY2 / errKm1, 1.0 / (2 * k - 1)) : MY_IVP_MAX_FACTOR) : 0;
+        if (hK > H * MY_IVP_MAX_FACTOR)
+        {
+            hK = H * MY_IVP_MAX_FACTOR;
+        }
+        if (hKm1 > H * MY_IVP_MAX_FACTOR)
+        {
+            hKm1 = H * MY_IVP_MAX_FACTOR;
+        }
+
+        if (errK <= 1)
+        {
+            /* 按单位步长工作量选下一步的阶数 */
+            MoReal wK = myGbsCost(k, ds->m_threads) / hK;
+            MoReal wKm1 = k > 1 ? myGbsCost(k - 1, ds->m_threads) / hKm1 : HUGE_VAL;
+
+            if (k > 1 && wKm1 < 0.8 * wK)
+            {
+                ds->m_k = k - 1;
+                ds->m_h = hKm1;
+            }
+            else if (k < MY_GBS_MAX_K && !rejected && wK < 0.9 * wKm1)
+            {
+                ds->m_k = k + 1;
+                ds->m_h = hK * myGbsCost(k + 1, ds->m_threads) / myGbsCost(k, ds->m_threads);
+            }
+            else
+            {
+                ds->m_h = hK;
+            }
+            MY_IVP_TRACE_END(MY_IVP_TRACE_STEP, attempt);
+            break;
+        }
+        if (k > 1 && errKm1 <= 1)
+        {
+            /* 低一阶的外推结果已满足精度：直接接受，并降阶 */
+            memcpy(curY, ds->m_yAlt, n * sizeof(MoReal));
+            ds->m_k = k - 1;
+            ds->m_h = hKm1;
+            MY_IVP_TRACE_END(MY_IVP_TRACE_STEP, attempt);
+            break;
+        }
+
+        rejected = moTrue;
+        H = (k > 1 && hKm1 > hK) ? hKm1 : hK;
+        if (k > 1 && hKm1 > hK)
+        {
+            ds->m_k = k - 1;
+        }
+        MY_IVP_TRACE_END(MY_IVP_TRACE_REJECT, attempt);
+    }
+
+    if (rejected && ds->m_h > H)
+    {
+        ds->m_h = H;    /* 刚被拒绝过的步不再放大步长 */
+    }
+    if (ds->m_k < 2)
+    {
+        ds->m_k = 2;
+    }
+
+    /* 步末导数：稠密输出与下一步的首个右端函数值共用；步中点导数只用于稠密输出 */
+    if (n > 0 && (spw->m_callback.m_rshFunction(spw->m_userData, t + H, curY, ds->m_curYp) != MWS_IVP_SUCCESS
+        || spw->m_callback.m_rshFunction(spw->m_userData, t + H / 2, ds->m_yMid, ds->m_ypMid) != MWS_IVP_SUCCESS))
+    {
+        return MWS_IVP_RHSFN_FAIL;
+    }
+
+    ds->m_preTime = t;
+    ds->m_curTime = t + H;
+    ds->m_ypValid = moTrue;
+
+    memcpy(yret, curY, n * sizeof(MoReal));
+    if (ypret)
+    {
+        memcpy(ypret, ds->m_curYp, n * sizeof(MoReal));
+    }
+    *tret = ds->m_curTime;
+
+    return MWS_IVP_SUCCESS;
+}
+
+/// <summary>
+/// 插值：用步两端及中点的 y 与 y' 做五次Hermite插值（节点 theta = 0, 1/2, 1 各取值与导数）
+/// </summary>
+/// 输入：
+/// <param name="solver">积分算法对象</param>
+/// <param name="ivp">问题对象</param>
+/// <param name="tout">输出结果的时间</param>
+/// 输出：
+/// <param name="yret">y的结果值</param>
+/// <param name="reserve"></param>
+/// <returns></returns>
+MwsInteger myGbsInterpolate(MwsIVPSolverObj solver, MwsIVPObj ivp, MwsReal tout, MwsReal* yret, void* reserve)
+{
+    MyGbsProblem* spw = (MyGbsProblem*)ivp;
+    MyGbsProblemData* ds = spw->m_data;
+    MoReal h = ds->m_curTime - ds->m_preTime;
+    MoReal theta;
+    MoSize index;
+
+    if (h == 0)
+    {
+        memcpy(yret, ds->m_curY, spw->m_nStates * sizeof(MoReal));
+        return MWS_IVP_SUCCESS;
+    }
+
+    theta = (tout - ds->m_preTime) / h;
+    for (index = 0; index < spw->m_nStates; ++index)
+    {
+        /* 重节点 0,0,1/2,1/2,1,1 上的Newton差商，重节点处一阶差商取 h*y' */
+        MoReal y0 = ds->m_preY[index];
+        MoReal ym = ds->m_yMid[index];
+        MoReal y1 = ds->m_curY[index];
+        MoReal d01 = h * ds->m_preYp[index];
+        MoReal d12 = 2 * (ym - y0);
+        MoReal d23 = h * ds->m_ypMid[index];
+        MoReal d34 = 2 * (y1 - ym);
+        MoReal d45 = h * ds->m_curYp[index];
+        MoReal d012 = 2 * (d12 - d01);
+        MoReal d123 = 2 * (d23 - d12);
+        MoReal d234 = 2 * (d34 - d23);
+        MoReal d345 = 2 * (d45 - d34);
+        MoReal d0123 = 2 * (d123 - d012);
+        MoReal d1234 = d234 - d123;
+        MoReal d2345 = 2 * (d345 - d234);
+        MoReal d01234 = d1234 - d0123;
+        MoReal d12345 = d2345 - d1234;
+        MoReal d012345 = d12345 - d01234;
+        MoReal s = theta - 0.5;
+        MoReal u = theta - 1;
+
+        yret[index] = y0 + theta * (d01 + theta * (d012 + s * (d0123 + s * (d01234 + u * d012345))));
+    }
+
+    return MWS_IVP_SUCCESS;
+}
+
+/// <summary>
+/// 销毁问题
+/// </summary>
+/// <param name="solver"></param>
+/// <param name="ivp"></param>
+void myGbsProblemDestroy(MwsIVPSolverObj solver, MwsIVPObj ivp)
+{
+    MyGbs* sw = (MyGbs*)solver;
+    MyGbsProblem* spw = (MyGbsProblem*)ivp;
+
+    if (spw)
+    {
+        if (spw->m_data->m_preY)
+        {
+            (*sw->m_utils.m_freeDataMemory)(sw->m_userData, spw->m_data->m_preY);
+        }
+
+        if (spw->m_data->m_seq)
+        {
+            (*sw->m_utils.m_freeDataMemory)(sw->m_userData, spw->m_data->m_seq);
+        }
+
+        if (spw->m_data)
+        {
+            (*sw->m_utils.m_freeDataMemory)(sw->m_userData, spw->m_data);
+        }
+
+        (*sw->m_utils.m_freeMemory)(sw->m_userData, spw);
+    }
+}
+
+/// <summary>
+/// 销毁积分算法
+/// </summary>
+/// <param name="solver"></param>
+void myGbsDestroy(MwsIVPSolverObj solver)
+{
+    MyGbs* sw = (MyGbs*)solver;
+
+    if (sw)
+    {
+        (*sw->m_utils.m_freeMemory)(sw->m_userData, sw);
+    }
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+
+/***************************************************************************
+//   end of file
+***************************************************************************/
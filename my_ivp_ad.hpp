@@ -0,0 +1,369 @@
+/***************************************************************************
+///
+/// Copyright (c) 2020, 苏州同元软控信息技术有限公司
+/// All rights reserved.
+///
+/// @file           my_ivp_ad.hpp
+/// @brief          前向自动微分（仅头文件，C++17）：对偶数按多方向播种、按稀疏结构着色，
+///                 由模板化的模型函数对象求出精确的Jacobian，并生成 MwsIVPJacFcnPtr 形式的回调
+///
+/// @version        v1.0
+/// @author         田显钊
+/// @date           2020/07/07
+///
+***************************************************************************/
+
+#ifndef MY_IVP_AD_HPP
+#define MY_IVP_AD_HPP
+
+#include "mo_types.h"
+#include "mws_ivp_solver.h"
+
+#include <cmath>
+#include <vector>
+
+namespace myrk
+{
+
+/*
+ * 模型约定：与 my_rk_functor.hpp 相同，只是状态的标量类型是模板参数
+ *   template <class S>
+ *   MwsInteger operator()(MoReal t, const S* y, S* yp) const;
+ * S 为 MoReal 时即普通的右端函数，为 Dual<K> 时同时求出K个方向导数。
+ * 模型中的数学函数须不加限定地调用（先 using std::sin; 再写 sin(y[0])），以便按参数类型找到下面的重载。
+ */
+
+/* 对偶数：值v与K个方向导数d */
+template <int K>
+struct Dual
+{
+    MoReal v;
+    MoReal d[K];
+
+    Dual() : v(0), d{} {}
+    Dual(MoReal x) : v(x), d{} {}
+
+    Dual& operator+=(const Dual& b) { return *this = *this + b; }
+    Dual& operator-=(const Dual& b) { return *this = *this - b; }
+    Dual& operator*=(const Dual& b) { return *this = *this * b; }
+    Dual& operator/=(const Dual& b) { return *this = *this / b; }
+};
+
+/* 按链式法则构造结果：值为fv，各方向导数为 df * a.d */
+template <int K>
+inline Dual<K> chain(const Dual<K>& a, MoReal fv, MoReal df)
+{
+    Dual<K> r(fv);
+    for (int k = 0; k < K; ++k)
+    {
+        r.d[k] = df * a.d[k];
+    }
+    return r;
+}
+
+template <int K>
+inline Dual<K> operator+(const Dual<K>& a, const Dual<K>& b)
+{
+    Dual<K> r(a.v + b.v);
+    for (int k = 0; k < K; ++k)
+    {
+        r.d[k] = a.d[k] + b.d[k];
+    }
+    return r;
+}
+
+template <int K>
+inline Dual<K> operator-(const Dual<K>& a, const Dual<K>& b)
+{
+    Dual<K> r(a.v - b.v);
+    for (int k = 0; k < K; ++k)
+    {
+        r.d[k] = a.d[k] - b.d[k];
+    }
+    return r;
+}
+
+template <int K>
+inline Dual<K> operator*(const Dual<K>& a, const Dual<K>& b)
+{
+    Dual<K> r(a.v * b.v);
+    for (int k = 0; k < K; ++k)
+    {
+        r.d[k] = a.d[k] * b.v + a.v * b.d[k];
+    }
+    return r;
+}
+
+template <int K>
+inline Dual<K> operator/(const Dual<K>& a, const Dual<K>& b)
+{
+    Dual<K> r(a.v / b.v);
+    for (int k = 0; k < K; ++k)
+    {
+        r.d[k] = (a.d[k] - r.v * b.d[k]) / b.v;
+    }
+    return r;
+}
+
+template <int K>
+inline Dual<K> operator-(const Dual<K>& a)
+{
+    return chain(a, -a.v, -1);
+}
+
+template <int K>
+inline Dual<K> operator+(const Dual<K>& a)
+{
+    return a;
+}
+
+/* 与常数的运算：常数的导数为0 */
+template <int K> inline Dual<K> operator+(const Dual<K>& a, MoReal b) { return chain(a, a.v + b, 1); }
+template <int K> inline Dual<K> operator+(MoReal a, const Dual<K>& b) { return chain(b, a + b.v, 1); }
+template <int K> inline Dual<K> operator-(const Dual<K>& a, MoReal b) { return chain(a, a.v - b, 1); }
+template <int K> inline Dual<K> operator-(MoReal a, const Dual<K>& b) { return chain(b, a - b.v, -1); }
+template <int K> inline Dual<K> operator*(const Dual<K>& a, MoReal b) { return chain(a, a.v * b, b); }
+template <int K> inline Dual<K> operator*(MoReal a, const Dual<K>& b) { return chain(b, a * b.v, a); }
+template <int K> inline Dual<K> operator/(const Dual<K>& a, MoReal b) { return chain(a, a.v / b, 1 / b); }
+template <int K> inline Dual<K> operator/(MoReal a, const Dual<K>& b) { return chain(b, a / b.v, -a / (b.v * b.v)); }
+
+/* 比较只看值，分段模型的分支与普通求值一致 */
+template <int K> inline bool operator<(const Dual<K>& a, const Dual<K>& b) { return a.v < b.v; }
+template <int K> inline bool operator>(const Dual<K>& a, const Dual<K>& b) { return a.v > b.v; }
+template <int K> inline bool operator<=(const Dual<K>& a, const Dual<K>& b) { return a.v <= b.v; }
+template <int K> inline bool operator>=(const Dual<K>& a, const Dual<K>& b) { return a.v >= b.v; }
+template <int K> inline bool operator<(const Dual<K>& a, MoReal b) { return a.v < b; }
+template <int K> inline bool operator>(const Dual<K>& a, MoReal b) { return a.v > b; }
+template <int K> inline bool operator<=(const Dual<K>& a, MoReal b) { return a.v <= b; }
+template <int K> inline bool operator>=(const Dual<K>& a, MoReal b) { return a.v >= b; }
+template <int K> inline bool operator<(MoReal a, const Dual<K>& b) { return a < b.v; }
+template <int K> inline bool operator>(MoReal a, const Dual<K>& b) { return a > b.v; }
+
+/* 初等函数 */
+template <int K> inline Dual<K> sin(const Dual<K>& a) { return chain(a, std::sin(a.v), std::cos(a.v)); }
+template <int K> inline Dual<K> cos(const Dual<K>& a) { return chain(a, std::cos(a.v), -std::sin(a.v)); }
+template <int K> inline Dual<K> tan(const Dual<K>& a)
+{
+    MoReal tv = std::tan(a.v);
+    return chain(a, tv, 1 + tv * tv);
+}
+template <int K> inline Dual<K> exp(const Dual<K>& a)
+{
+    MoReal ev = std::exp(a.v);
+    return chain(a, ev, ev);
+}
+template <int K> inline Dual<K> log(const Dual<K>& a) { return chain(a, std::log(a.v), 1 / a.v); }
+template <int K> inline Dual<K> sqrt(const Dual<K>& a)
+{
+    MoReal sv = std::sqrt(a.v);
+    return chain(a, sv, 0.5 / sv);
+}
+template <int K> inline Dual<K> pow(const Dual<K>& a, MoReal b)
+{
+    return chain(a, std::pow(a.v, b), b * std::pow(a.v, b - 1));
+}
+template <int K> inline Dual<K> pow(const Dual<K>& a, const Dual<K>& b)
+{
+    return exp(b * log(a));
+}
+template <int K> inline Dual<K> fabs(const Dual<K>& a) { return a.v < 0 ? -a : a; }
+template <int K> inline Dual<K> abs(const Dual<K>& a) { return fabs(a); }
+template <int K> inline Dual<K> tanh(const Dual<K>& a)
+{
+    MoReal tv = std::tanh(a.v);
+    return chain(a, tv, 1 - tv * tv);
+}
+template <int K> inline Dual<K> sinh(const Dual<K>& a) { return chain(a, std::sinh(a.v), std::cosh(a.v)); }
+template <int K> inline Dual<K> cosh(const Dual<K>& a) { return chain(a, std::cosh(a.v), std::sinh(a.v)); }
+template <int K> inline Dual<K> atan(const Dual<K>& a) { return chain(a, std::atan(a.v), 1 / (1 + a.v * a.v)); }
+
+/*
+ * Jacobian求值器：J = df/dy，按列存储（pd[col*n+row]，与 myRK45 等使用 m_jacFunction 的约定一致）。
+ * 给出稀疏结构时对列贪心着色，互不共享非零行的列同色，同色的列一次播种求出；
+ * 每遍对偶数求值播种K种颜色，共 ceil(颜色数/K) 遍，每遍代价约为普通右端函数的 1+K 倍
+ */
+template <class F, int K = 8>
+class AdJacobian
+{
+public:
+    static_assert(K > 0, "at least one direction per sweep");
+
+    /* pattern：稀疏结构，n*n按列存储，非零表示该元素可能非零（可为空，为空时按稠密处理，颜色数为n） */
+    AdJacobian(const F& f, MoSize n, const unsigned char* pattern)
+        : m_f(&f), m_n(n), m_colors(0), m_color(n), m_y(n), m_yp(n)
+    {
+        if (pattern)
+        {
+            m_pattern.assign(pattern, pattern + n * n);
+        }
+        color();
+    }
+
+    /* 求 t, y 处的Jacobian，写入pd（n*n按列存储，结构外的元素置0） */
+    MwsInteger evaluate(MoReal t, const MoReal* y, MoReal* pd)
+    {
+        MoSize row, col;
+
+        for (MoInteger base = 0; base < m_colors; base += K)
+        {
+            for (row = 0; row < m_n; ++row)
+            {
+                m_y[row] = Dual<K>(y[row]);
+                if (m_color[row] >= base && m_color[row] < base + K)
+                {
+                    m_y[row].d[m_color[row] - base] = 1;
+                }
+            }
+            if ((*m_f)(t, m_y.data(), m_yp.data()) != MWS_IVP_SUCCESS)
+            {
+                return MWS_IVP_RHSFN_FAIL;
+            }
+            for (col = 0; col < m_n; ++col)
+            {
+                MoInteger c = m_color[col];
+                if (c < base || c >= base + K)
+                {
+                    continue;
+                }
+                for (row = 0; row < m_n; ++row)
+                {
+                    pd[col * m_n + row] = (m_pattern.empty() || m_pattern[col * m_n + row])
+                        ? m_yp[row].d[c - base] : 0;
+                }
+            }
+        }
+        return MWS_IVP_SUCCESS;
+    }
+
+    /* 颜色数（即一次Jacobian求值等价的方向数） */
+    MoInteger colors() const
+    {
+        return m_colors;
+    }
+
+    /* 一次Jacobian求值的对偶数求值遍数 */
+    MoInteger sweeps() const
+    {
+        return (m_colors + K - 1) / K;
+    }
+
+private:
+    /* 按列序贪心着色：列j取与之共享非零行的已着色列都未用过的最小颜色；按行索引各行的非零列，代价为各行非零数的平方和 */
+    void color()
+    {
+        std::vector<std::vector<MoSize> > rowCols(m_n);
+        std::vector<MoInteger> mark(m_n, -1);      /* mark[c] == j：颜色c已被与列j冲突的列占用 */
+        MoSize row, col;
+
+        if (m_pattern.empty())
+        {
+            for (col = 0; col < m_n; ++col)
+            {
+                m_color[col] = (MoInteger)col;
+            }
+            m_colors = (MoInteger)m_n;
+            return;
+        }
+        for (col = 0; col < m_n; ++col)
+        {
+            for (row = 0; row < m_n; ++row)
+            {
+                if (m_pattern[col * m_n + row])
+                {
+                    rowCols[row].push_back(col);
+                }
+            }
+        }
+        for (col = 0; col < m_n; ++col)
+        {
+            MoInteger c = 0;
+            for (row = 0; row < m_n; ++row)
+            {
+                if (!m_pattern[col * m_n + row])
+                {
+                    continue;
+                }
+                for (MoSize other : rowCols[row])
+                {
+                    if (other >= col)
+                    {
+                        break;
+                    }
+                    mark[m_color[other]] = (MoInteger)col;
+                }
+            }
+            while (mark[c] == (MoInteger)col)
+            {
+                ++c;
+            }
+            m_color[col] = c;
+            if (c + 1 > m_colors)
+            {
+                m_colors = c + 1;
+            }
+        }
+    }
+
+    const F* m_f;
+    MoSize m_n;
+    MoInteger m_colors;
+    std::vector<MoInteger> m_color;         /* 各列的颜色 */
+    std::vector<unsigned char> m_pattern;
+    std::vector<Dual<K> > m_y;
+    std::vector<Dual<K> > m_yp;
+};
+
+/*
+ * 模型与其AD Jacobian打包：callback() 给出 m_rshFunction 与 m_jacFunction 都已填好的 MwsIVPCallback，
+ * user_data 须为本对象的地址。Jacobian与cj无关（ODE），即 df/dy
+ */
+template <class F, int K = 8>
+class AdModel
+{
+public:
+    AdModel(const F& f, MoSize n, const unsigned char* pattern)
+        : m_f(f), m_jac(m_f, n, pattern)
+    {
+    }
+
+    AdModel(const AdModel&) = delete;
+    AdModel& operator=(const AdModel&) = delete;
+
+    static MwsInteger rhs(void* user_data, MwsReal t, const MwsReal* y, MwsReal* yp)
+    {
+        return static_cast<AdModel*>(user_data)->m_f(t, y, yp);
+    }
+
+    static MwsInteger jac(void* user_data, MwsReal t, const MwsReal* y, const MwsReal* yp, MwsReal cj, MwsReal* pd)
+    {
+        return static_cast<AdModel*>(user_data)->m_jac.evaluate(t, y, pd);
+    }
+
+    MwsIVPCallback callback() const
+    {
+        MwsIVPCallback cb = { &rhs, mwsNullPtr, &jac, mwsNullPtr };
+        return cb;
+    }
+
+    const F& functor() const
+    {
+        return m_f;
+    }
+
+    const AdJacobian<F, K>& jacobian() const
+    {
+        return m_jac;
+    }
+
+private:
+    F m_f;
+    AdJacobian<F, K> m_jac;
+};
+
+} /* namespace myrk */
+
+#endif /* !MY_IVP_AD_HPP */
+
+/***************************************************************************
+//   end of file
+***************************************************************************/
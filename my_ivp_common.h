@@ -0,0 +1,367 @@
+/***************************************************************************
+///
+/// Copyright (c) 2020, 苏州同元软控信息技术有限公司
+/// All rights reserved.
+///
+/// @file           my_ivp_common.h
+/// @brief          自定义积分算法公用的误差范数、初始步长与插值函数
+///
+/// @version        v1.0
+/// @author         田显钊
+/// @date           2020/07/07
+///
+***************************************************************************/
+
+#ifndef MY_IVP_COMMON_H
+#define MY_IVP_COMMON_H
+
+#include "mo_types.h"
+#include "mws_ivp_solver.h"
+
+#include <math.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MY_IVP_DEFAULT_TOL  1e-6    /* 未定义容许误差时使用的默认相对/绝对误差 */
+#define MY_IVP_SAFETY       0.9     /* 步长控制安全因子 */
+#define MY_IVP_MIN_FACTOR   0.2     /* 单步最大缩小倍数 */
+#define MY_IVP_MAX_FACTOR   10.0    /* 单步最大放大倍数 */
+#define MY_IVP_RHS_RETRIES  8       /* 试算步中右端函数失败后缩小步长重试的默认次数 */
+#define MY_IVP_RHS_SHRINK   0.25    /* 每次重试的步长缩小倍数 */
+
+/*
+ * Butcher表（Bogacki, Shampine, A 3(2) pair of Runge-Kutta formulas, 1989）：
+ *   0   |
+ *   1/2 | 1/2
+ *   3/4 | 0    3/4
+ *   1   | 2/9  1/3  4/9
+ *  -----+---------------------
+ *   y1  | 2/9  1/3  4/9  0
+ *   y1^ | 7/24 1/4  1/3  1/8
+ * 第4级 f(t+h,y1) 同时是下一步的第1级（FSAL），每步只需3次新的右端函数计算。
+ * myBS23 与 myMultirate 的宏步/微步共用。
+ */
+#define MY_BS23_A21     (1.0 / 2.0)
+#define MY_BS23_A32     (3.0 / 4.0)
+#define MY_BS23_B1      (2.0 / 9.0)
+#define MY_BS23_B2      (1.0 / 3.0)
+#define MY_BS23_B3      (4.0 / 9.0)
+#define MY_BS23_E1      (-5.0 / 72.0)   /* b - b^ */
+#define MY_BS23_E2      (1.0 / 12.0)
+#define MY_BS23_E3      (1.0 / 9.0)
+#define MY_BS23_E4      (-1.0 / 8.0)
+
+/* 相对容许误差 */
+static inline MoReal myIVPRelTol(const MwsIVPOptions* opt)
+{
+    if (opt->m_toleranceDefined && opt->m_relativeTolerance)
+    {
+        return opt->m_relativeTolerance[0];
+    }
+    return MY_IVP_DEFAULT_TOL;
+}
+
+/* 绝对容许误差 */
+static inline MoReal myIVPAbsTol(const MwsIVPOptions* opt)
+{
+    if (opt->m_toleranceDefined && opt->m_absoluteTolerance)
+    {
+        return opt->m_absoluteTolerance[0];
+    }
+    return MY_IVP_DEFAULT_TOL;
+}
+
+/* 最大步长，未定义时不限制 */
+static inline MoReal myIVPMaxStep(const MwsIVPOptions* opt)
+{
+    if (opt->m_maxStepSizeDefined && opt->m_maxStepSize > 0)
+    {
+        return opt->m_maxStepSize;
+    }
+    return HUGE_VAL;
+}
+
+/* 按终止时间截断步长，保证 t+h 不越过 m_stopTime */
+static inline MoReal myIVPClampStep(const MwsIVPOptions* opt, MoReal t, MoReal h)
+{
+    if (h > myIVPMaxStep(opt))
+    {
+        h = myIVPMaxStep(opt);
+    }
+    if (opt->m_stopTimeDefined && t + h > opt->m_stopTime)
+    {
+        h = opt->m_stopTime - t;
+    }
+    return h;
+}
+
+/* 最小步长：低于它时认为步长过小，积分失败 */
+static inline MoReal myIVPMinStep(MoReal t)
+{
+    return 10 * fabs(nextafter(t, HUGE_VAL) - t);
+}
+
+/*
+ * 加权均方根误差范数
+ *  ||err|| = sqrt( 1/n * sum( (err_i / (atol + rtol*max(|y0_i|,|y1_i|)))^2 ) )
+ */
+static inline MoReal myIVPErrorNorm(MoSize n, const MoReal* err, const MoReal* y0, const MoReal* y1,
+    MoReal rtol, MoReal atol)
+{
+    MoReal sum = 0;
+    MoSize index;
+
+    if (n == 0)
+    {
+        return 0;
+    }
+    for (index = 0; index < n; ++index)
+    {
+        MoReal a = fabs(y0[index]);
+        MoReal b = fabs(y1[index]);
+        MoReal e = err[index] / (atol + rtol * (a > b ? a : b));
+        sum += e * e;
+    }
+    return sqrt(sum / n);
+}
+
+/*
+ * 步长控制器参数，默认取上面三个宏；myRK45、myBS23、myDOP853 可通过各自的 SetController 修改，
+ * myAuto 的自动调优在若干组取值中搜索
+ */
+typedef struct
+{
+    MoReal m_safety;        /* 安全因子，(0,1] */
+    MoReal m_minFactor;     /* 单步最大缩小倍数，(0,1) */
+    MoReal m_maxFactor;     /* 单步最大放大倍数，>1 */
+} MyIVPController;
+
+#define MY_IVP_CONTROLLER_DEFAULT   { MY_IVP_SAFETY, MY_IVP_MIN_FACTOR, MY_IVP_MAX_FACTOR }
+
+/* 控制器参数是否有效 */
+static inline MoBoolean myIVPControllerValid(const MyIVPController* ctl)
+{
+    return ctl->m_safety > 0 && ctl->m_safety <= 1 && ctl->m_minFactor > 0 && ctl->m_minFactor < 1
+        && ctl->m_maxFactor > 1 && ctl->m_maxFactor <= HUGE_VAL;
+}
+
+/*
+ * 根据误差范数计算新步长倍数，限制在[ctl->m_minFactor, ctl->m_maxFactor]之间
+ * order为误差估计的阶数
+ */
+static inline MoReal myIVPStepFactorCtl(const MyIVPController* ctl, MoReal errNorm, MoInteger order)
+{
+    MoReal factor;
+
+    if (errNorm == 0)
+    {
+        return ctl->m_maxFactor;
+    }
+    if (!(errNorm <= HUGE_VAL))
+    {
+        return ctl->m_minFactor;    /* nan：状态已发散，按最大倍数缩步直至步长过小而失败 */
+    }
+    factor = ctl->m_safety * pow(errNorm, -1.0 / (order + 1));
+    if (factor < ctl->m_minFactor)
+    {
+        factor = ctl->m_minFactor;
+    }
+    if (factor > ctl->m_maxFactor)
+    {
+        factor = ctl->m_maxFactor;
+    }
+    return factor;
+}
+
+/* 按默认控制器参数计算新步长倍数 */
+static inline MoReal myIVPStepFactor(MoReal errNorm, MoInteger order)
+{
+    static const MyIVPController ctl = MY_IVP_CONTROLLER_DEFAULT;
+
+    return myIVPStepFactorCtl(&ctl, errNorm, order);
+}
+
+/*
+ * 自动选择初始步长（Hairer, Norsett, Wanner, Solving ODE I, II.4）
+ * @param[in] ytmp,ftmp  长度为n的临时向量
+ * @param[out] h         初始步长
+ * @return 状态，取MwsIVPStatus的值
+ */
+static inline MwsInteger myIVPInitialStep(const MwsIVPCallback* cb, void* user_data, MoSize n, MoReal t0,
+    const MoReal* y0, const MoReal* f0, MoReal rtol, MoReal atol, MoInteger order, MoReal hmax,
+    MoReal* ytmp, MoReal* ftmp, MoReal* h)
+{
+    MoReal d0 = 0, d1 = 0, d2 = 0, h0, h1, dmax;
+    MoSize index;
+
+    if (n == 0)
+    {
+        *h = hmax < 1e-6 ? hmax : 1e-6;
+        return MWS_IVP_SUCCESS;
+    }
+
+    for (index = 0; index < n; ++index)
+    {
+        MoReal sc = atol + rtol * fabs(y0[index]);
+        d0 += (y0[index] / sc) * (y0[index] / sc);
+        d1 += (f0[index] / sc) * (f0[index] / sc);
+    }
+    d0 = sqrt(d0 / n);
+    d1 = sqrt(d1 / n);
+
+    h0 = (d0 < 1e-5 || d1 < 1e-5) ? 1e-6 : 0.01 * d0 / d1;
+    if (h0 > hmax)
+    {
+        h0 = hmax;
+    }
+
+    for (index = 0; index < n; ++index)
+    {
+        ytmp[index] = y0[index] + h0 * f0[index];
+    }
+    if (cb->m_rshFunction(user_data, t0 + h0, ytmp, ftmp) != MWS_IVP_SUCCESS)
+    {
+        return MWS_IVP_RHSFN_FAIL;
+    }
+    for (index = 0; index < n; ++index)
+    {
+        MoReal sc = atol + rtol * fabs(y0[index]);
+        d2 += ((ftmp[index] - f0[index]) / sc) * ((ftmp[index] - f0[index]) / sc);
+    }
+    d2 = sqrt(d2 / n) / h0;
+
+    dmax = d1 > d2 ? d1 : d2;
+    if (dmax <= 1e-15)
+    {
+        h1 = (h0 * 1e-3 > 1e-6) ? h0 * 1e-3 : 1e-6;
+    }
+    else
+    {
+        h1 = pow(0.01 / dmax, 1.0 / (order + 1));
+    }
+
+    *h = (100 * h0 < h1) ? 100 * h0 : h1;
+    if (*h > hmax)
+    {
+        *h = hmax;
+    }
+    return MWS_IVP_SUCCESS;
+}
+
+/*
+ * 右端函数对第j个参数的偏导 dfdp = df/dp_j (t,y)，长度n；灵敏度分析使用，不提供时按参数扰动差商计算
+ * @return 状态，取MwsIVPStatus的值
+ */
+typedef MwsInteger (*MyIVPParamJacPtr)(void* user_data, MoReal t, const MoReal* y, MoInteger j, MoReal* dfdp);
+
+/*
+ * 参数的向量-Jacobian积：grad += (df/dp)^T * w，grad长度为参数个数；伴随灵敏度使用，
+ * 一次调用即得全部参数的贡献，反向过程的代价因此与参数个数无关
+ * @return 状态，取MwsIVPStatus的值
+ */
+typedef MwsInteger (*MyIVPParamVjpPtr)(void* user_data, MoReal t, const MoReal* y, const MoReal* w, MoReal* grad);
+
+/*
+ * 并行求值约定（myGBS、myPIRK 等 SetThreads 大于1时）：
+ *  同一问题的 m_rshFunction 会被多个线程以相同的 user_data 同时调用，
+ *  模型回调必须可重入——只读 t、y 与模型参数，结果只写入传入的 yp，不修改 user_data 所指的共享状态
+ *  （如缓存、计数器、外部求解器句柄）。不满足时请保持默认的串行（线程数1）。
+ *  未以OpenMP编译时始终串行，结果与并行时逐位一致。
+ */
+
+/*
+ * 批量计算 count 组右端函数：f_i = f(t[i], y_i)，y_i、f_i 分别为 y、f 中第i段长度n的向量
+ * threads>1 且以OpenMP编译时并行计算，要求见上面的并行求值约定
+ * @return 状态，取MwsIVPStatus的值；任一组失败即返回 MWS_IVP_RHSFN_FAIL
+ */
+static inline MwsInteger myIVPRhsBatch(const MwsIVPCallback* cb, void* user_data, MoSize n, MoInteger count,
+    const MoReal* t, const MoReal* y, MoReal* f, MoInteger threads)
+{
+    MoInteger i;
+    MoInteger nFail = 0;
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static, 1) num_threads(threads) if (threads > 1) reduction(+:nFail)
+#else
+    (void)threads;
+#endif
+    for (i = 0; i < count; ++i)
+    {
+        if (cb->m_rshFunction(user_data, t[i], y + i * n, f + i * n) != MWS_IVP_SUCCESS)
+        {
+            ++nFail;
+        }
+    }
+
+    return nFail > 0 ? MWS_IVP_RHSFN_FAIL : MWS_IVP_SUCCESS;
+}
+
+/*
+ * 三次Hermite插值，theta=(t-t0)/h
+ *  y(theta) = (1-theta)*y0 + theta*y1 + theta*(theta-1)*((1-2*theta)*(y1-y0) + (theta-1)*h*f0 + theta*h*f1)
+ */
+static inline void myIVPHermite(MoSize n, MoReal theta, MoReal h, const MoReal* y0, const MoReal* y1,
+    const MoReal* f0, const MoReal* f1, MoReal* yret)
+{
+    MoSize index;
+
+    for (index = 0; index < n; ++index)
+    {
+        MoReal dy = y1[index] - y0[index];
+        yret[index] = (1 - theta) * y0[index] + theta * y1[index]
+            + theta * (theta - 1) * ((1 - 2 * theta) * dy + (theta - 1) * h * f0[index] + theta * h * f1[index]);
+    }
+}
+
+/* 批量插值时每块的状态数，块内的多项式系数放在栈上 */
+#define MY_IVP_BATCH_BLOCK 64
+
+/*
+ * 批量三次Hermite插值：m个时刻 tout[j]（theta=(tout[j]-t0)/h），结果按行存入 yret（m*n，第j行对应tout[j]）。
+ * 状态按块先展开成theta的三次多项式系数，再对各时刻用Horner求值，内层循环连续访问，便于编译器向量化
+ */
+static inline void myIVPHermiteBatch(MoSize n, MoSize m, const MoReal* tout, MoReal t0, MoReal h, const MoReal* y0,
+    const MoReal* y1, const MoReal* f0, const MoReal* f1, MoReal* yret)
+{
+    MoReal c1[MY_IVP_BATCH_BLOCK];
+    MoReal c2[MY_IVP_BATCH_BLOCK];
+    MoReal c3[MY_IVP_BATCH_BLOCK];
+    MoSize base, index, j;
+
+    for (base = 0; base < n; base += MY_IVP_BATCH_BLOCK)
+    {
+        MoSize len = n - base < MY_IVP_BATCH_BLOCK ? n - base : MY_IVP_BATCH_BLOCK;
+        const MoReal* c0 = y0 + base;
+
+        for (index = 0; index < len; ++index)
+        {
+            MoReal dy = y1[base + index] - y0[base + index];
+            MoReal a = h * f0[base + index];
+            MoReal b = h * f1[base + index];
+            c1[index] = a;
+            c2[index] = 3 * dy - 2 * a - b;
+            c3[index] = a + b - 2 * dy;
+        }
+        for (j = 0; j < m; ++j)
+        {
+            MoReal theta = (tout[j] - t0) / h;
+            MoReal* row = yret + j * n + base;
+            for (index = 0; index < len; ++index)
+            {
+                row[index] = c0[index] + theta * (c1[index] + theta * (c2[index] + theta * c3[index]));
+            }
+        }
+    }
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* !MY_IVP_COMMON_H */
+
+/***************************************************************************
+//   end of file
+***************************************************************************/
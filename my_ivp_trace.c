@@ -0,0 +1,415 @@
+/***************************************************************************
+///
+/// Copyright (c) 2020, 苏州同元软控信息技术有限公司
+/// All rights reserved.
+///
+/// @file           my_ivp_trace.c
+/// @brief          积分算法耗时跟踪的实现，只在定义 MY_IVP_TRACE 时编译
+///
+/// @version        v1.0
+/// @author         田显钊
+/// @date           2020/07/07
+///
+***************************************************************************/
+
+/* -std=c99/c11 等严格模式下 <time.h> 不声明 clock_gettime，须在包含任何系统头文件前打开POSIX接口 */
+#if !defined(_WIN32) && defined(__STRICT_ANSI__) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 199309L
+#endif
+
+#include "my_ivp_trace.h"
+
+#ifdef MY_IVP_TRACE
+
+#include <memory.h>
+#include <stdio.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <intrin.h>
+#else
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#endif
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define MY_IVP_TRACE_TSC    /* 时间戳取TSC，约十个周期；现代x86的TSC频率恒定 */
+#endif
+
+/* 耗时直方图：<16个计数每计数一格，之后每个2的幂区间再分8格（与 my_euler.c 的单步耗时直方图相同） */
+#define MY_IVP_TRACE_HIST_BINS  (16 + 60 * 8)
+
+/* Chrome跟踪事件，24字节 */
+typedef struct
+{
+    MyIVPTraceTicks m_start;
+    MyIVPTraceTicks m_end;
+    MoInteger m_kind;
+    MoInteger m_thread;
+} MyIVPTraceEvent;
+
+/* 进程内唯一的跟踪状态；各计数用OpenMP原子操作累加，并行的右端函数可同时记录 */
+typedef struct
+{
+    MoBoolean m_active;
+    MyIVPTraceTicks m_ticks0;           /* 开始跟踪时的时间戳与单调时钟，换算TSC频率用 */
+    unsigned long long m_ns0;
+    MyIVPTraceEvent* m_events;
+    MoSize m_eventCap;
+    MoSize m_eventNext;                 /* 下一个事件的位置，可超过m_eventCap（超出部分为丢弃数） */
+    unsigned long long m_count[MY_IVP_TRACE_KINDS];
+    unsigned long long m_sum[MY_IVP_TRACE_KINDS];
+    unsigned long long m_hist[MY_IVP_TRACE_KINDS][MY_IVP_TRACE_HIST_BINS];
+} MyIVPTrace;
+
+static MyIVPTrace s_myIVPTrace;
+
+/* 本线程正在计时的转接层数：回调被再包一层时（如myAuto的调用计数）只计最外层，不重复计时 */
+static MoInteger s_myIVPTraceDepth;
+#ifdef _OPENMP
+#pragma omp threadprivate(s_myIVPTraceDepth)
+#endif
+
+static const char* const s_myIVPTraceName[MY_IVP_TRACE_KINDS] =
+{
+    "rhs", "jac", "stepFinished", "step", "reject"
+};
+
+/* 单调时钟，单位纳秒 */
+static unsigned long long myIVPTraceClockNs(void)
+{
+#ifdef _WIN32
+    static LARGE_INTEGER freq;
+    LARGE_INTEGER cnt;
+    if (freq.QuadPart == 0)
+    {
+        QueryPerformanceFrequency(&freq);
+    }
+    QueryPerformanceCounter(&cnt);
+    return (unsigned long long)((double)cnt.QuadPart * 1e9 / (double)freq.QuadPart);
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long)ts.tv_sec * 1000000000ULL + (unsigned long long)ts.tv_nsec;
+#endif
+}
+
+static MyIVPTraceTicks myIVPTraceNow(void)
+{
+#ifdef MY_IVP_TRACE_TSC
+    return (MyIVPTraceTicks)__rdtsc();
+#else
+    return (MyIVPTraceTicks)myIVPTraceClockNs();
+#endif
+}
+
+/* 每个时间戳计数的秒数：TSC按开始跟踪以来的单调时钟标定 */
+static MoReal myIVPTraceSecondsPerTick(void)
+{
+#ifdef MY_IVP_TRACE_TSC
+    MyIVPTraceTicks ticks = myIVPTraceNow() - s_myIVPTrace.m_ticks0;
+    unsigned long long ns = myIVPTraceClockNs() - s_myIVPTrace.m_ns0;
+
+    return ticks > 0 && ns > 0 ? (MoReal)ns * 1e-9 / (MoReal)ticks : 1e-9;
+#else
+    return 1e-9;
+#endif
+}
+
+/* 耗时(计数) -> 直方图格号 */
+static MoSize myIVPTraceHistBin(MyIVPTraceTicks ticks)
+{
+    MoSize msb = 4;
+    MoSize bin;
+
+    if (ticks < 16)
+    {
+        return (MoSize)ticks;
+    }
+    while (msb < 63 && (ticks >> (msb + 1)) != 0)
+    {
+        ++msb;
+    }
+    bin = 16 + (msb - 4) * 8 + (MoSize)((ticks >> (msb - 3)) & 7);
+    return bin < MY_IVP_TRACE_HIST_BINS ? bin : MY_IVP_TRACE_HIST_BINS - 1;
+}
+
+/* 直方图格号 -> 该格下界(计数)，bin+1的下界即本格上界 */
+static MyIVPTraceTicks myIVPTraceHistLower(MoSize bin)
+{
+    MoSize msb, sub;
+
+    if (bin <= 16)
+    {
+        return bin;
+    }
+    msb = 4 + (bin - 16) / 8;
+    sub = (bin - 16) % 8;
+    return (MyIVPTraceTicks)(8 + sub) << (msb - 3);
+}
+
+static void myIVPTraceRecord(MoInteger kind, MyIVPTraceTicks start, MyIVPTraceTicks end)
+{
+    MyIVPTrace* tr = &s_myIVPTrace;
+    MyIVPTraceTicks ticks = end > start ? end - start : 0;
+    MoSize bin = myIVPTraceHistBin(ticks);
+    MoSize slot;
+
+#ifdef _OPENMP
+#pragma omp atomic
+#endif
+    tr->m_count[kind] += 1;
+#ifdef _OPENMP
+#pragma omp atomic
+#endif
+    tr->m_sum[kind] += ticks;
+#ifdef _OPENMP
+#pragma omp atomic
+#endif
+    tr->m_hist[kind][bin] += 1;
+
+    if (tr->m_eventCap == 0)
+    {
+        return;
+    }
+#ifdef _OPENMP
+#pragma omp atomic capture
+#endif
+    slot = tr->m_eventNext++;
+    if (slot < tr->m_eventCap)
+    {
+        MyIVPTraceEvent* ev = tr->m_events + slot;
+        ev->m_start = start;
+        ev->m_end = end;
+        ev->m_kind = kind;
+#ifdef _OPENMP
+        ev->m_thread = omp_get_thread_num();
+#else
+        ev->m_thread = 0;
+#endif
+    }
+}
+
+/* 未跟踪时返回0，不读时间戳 */
+MyIVPTraceTicks myIVPTraceBegin(void)
+{
+    return s_myIVPTrace.m_active ? myIVPTraceNow() : 0;
+}
+
+void myIVPTraceEnd(MoInteger kind, MyIVPTraceTicks start)
+{
+    if (s_myIVPTrace.m_active && start != 0)
+    {
+        myIVPTraceRecord(kind, start, myIVPTraceNow());
+    }
+}
+
+/* 转接函数：计时后调用平台的原回调；未跟踪或已在外层计时时直接调用 */
+static MwsInteger myIVPTraceRhs(void* user_data, MwsReal t, const MwsReal* y, MwsReal* yp)
+{
+    MyIVPTraceCallback* tc = (MyIVPTraceCallback*)user_data;
+    MyIVPTraceTicks start;
+    MwsInteger status;
+
+    if (s_myIVPTraceDepth > 0 || !s_myIVPTrace.m_active)
+    {
+        return tc->m_inner.m_rshFunction(tc->m_userData, t, y, yp);
+    }
+    ++s_myIVPTraceDepth;
+    start = myIVPTraceNow();
+    status = tc->m_inner.m_rshFunction(tc->m_userData, t, y, yp);
+    myIVPTraceRecord(MY_IVP_TRACE_RHS, start, myIVPTraceNow());
+    --s_myIVPTraceDepth;
+    return status;
+}
+
+static MwsInteger myIVPTraceJac(void* user_data, MwsReal t, const MwsReal* y, const MwsReal* yp, MwsReal cj,
+    MwsReal* pd)
+{
+    MyIVPTraceCallback* tc = (MyIVPTraceCallback*)user_data;
+    MyIVPTraceTicks start;
+    MwsInteger status;
+
+    if (s_myIVPTraceDepth > 0 || !s_myIVPTrace.m_active)
+    {
+        return tc->m_inner.m_jacFunction(tc->m_userData, t, y, yp, cj, pd);
+    }
+    ++s_myIVPTraceDepth;
+    start = myIVPTraceNow();
+    status = tc->m_inner.m_jacFunction(tc->m_userData, t, y, yp, cj, pd);
+    myIVPTraceRecord(MY_IVP_TRACE_JAC, start, myIVPTraceNow());
+    --s_myIVPTraceDepth;
+    return status;
+}
+
+static MwsInteger myIVPTraceStepFinished(void* user_data, MwsReal t, const MwsReal* y)
+{
+    MyIVPTraceCallback* tc = (MyIVPTraceCallback*)user_data;
+    MyIVPTraceTicks start;
+    MwsInteger status;
+
+    if (s_myIVPTraceDepth > 0 || !s_myIVPTrace.m_active)
+    {
+        return tc->m_inner.m_stepFinished(tc->m_userData, t, y);
+    }
+    ++s_myIVPTraceDepth;
+    start = myIVPTraceNow();
+    status = tc->m_inner.m_stepFinished(tc->m_userData, t, y);
+    myIVPTraceRecord(MY_IVP_TRACE_STEP_FINISHED, start, myIVPTraceNow());
+    --s_myIVPTraceDepth;
+    return status;
+}
+
+/*
+ * 把问题对象的回调换成转接函数，空的回调保持为空。
+ * 组合算法（myAuto、myParareal）把已转接的回调交给内部算法时不再重复转接，每次调用只计一次
+ */
+void myIVPTraceInterpose(MyIVPTraceCallback* tc, MwsIVPCallback* cb, void** user_data)
+{
+    if (cb->m_rshFunction == &myIVPTraceRhs || cb->m_jacFunction == &myIVPTraceJac
+        || cb->m_stepFinished == &myIVPTraceStepFinished)
+    {
+        return;
+    }
+    tc->m_inner = *cb;
+    tc->m_userData = *user_data;
+    if (cb->m_rshFunction)
+    {
+        cb->m_rshFunction = &myIVPTraceRhs;
+    }
+    if (cb->m_jacFunction)
+    {
+        cb->m_jacFunction = &myIVPTraceJac;
+    }
+    if (cb->m_stepFinished)
+    {
+        cb->m_stepFinished = &myIVPTraceStepFinished;
+    }
+    *user_data = tc;
+}
+
+void* myIVPTraceUserData(const MwsIVPCallback* cb, void* user_data)
+{
+    return cb->m_rshFunction == &myIVPTraceRhs ? ((MyIVPTraceCallback*)user_data)->m_userData : user_data;
+}
+
+const MwsIVPCallback* myIVPTraceInner(const MwsIVPCallback* cb, void* user_data)
+{
+    return cb->m_rshFunction == &myIVPTraceRhs ? &((MyIVPTraceCallback*)user_data)->m_inner : cb;
+}
+
+MwsInteger myIVPTraceStart(void* buffer, MoSize bytes)
+{
+    MyIVPTrace* tr = &s_myIVPTrace;
+
+    tr->m_active = moFalse;
+    memset(tr, 0, sizeof(*tr));
+    tr->m_events = (MyIVPTraceEvent*)buffer;
+    tr->m_eventCap = buffer ? bytes / sizeof(MyIVPTraceEvent) : 0;
+    tr->m_ns0 = myIVPTraceClockNs();
+    tr->m_ticks0 = myIVPTraceNow();
+    tr->m_active = moTrue;
+
+    return MWS_IVP_SUCCESS;
+}
+
+void myIVPTraceStop(void)
+{
+    s_myIVPTrace.m_active = moFalse;
+}
+
+MwsInteger myIVPTraceGetStats(MoInteger kind, MyIVPTraceStats* stats)
+{
+    MyIVPTrace* tr = &s_myIVPTrace;
+    MoReal spt = myIVPTraceSecondsPerTick();
+    unsigned long long seen = 0;
+    MoSize bin;
+
+    if (kind < 0 || kind >= MY_IVP_TRACE_KINDS || !stats)
+    {
+        return MWS_IVP_INVALID_INPUT;
+    }
+    memset(stats, 0, sizeof(*stats));
+    stats->m_count = (MoSize)tr->m_count[kind];
+    if (stats->m_count == 0)
+    {
+        return MWS_IVP_SUCCESS;
+    }
+    stats->m_total = (MoReal)tr->m_sum[kind] * spt;
+    stats->m_mean = stats->m_total / (MoReal)stats->m_count;
+
+    for (bin = 0; bin < MY_IVP_TRACE_HIST_BINS; ++bin)
+    {
+        unsigned long long c = tr->m_hist[kind][bin];
+
+        if (c == 0)
+        {
+            continue;
+        }
+        if (seen == 0)
+        {
+            stats->m_min = (MoReal)myIVPTraceHistLower(bin) * spt;
+        }
+        if (seen < (tr->m_count[kind] + 1) / 2 && seen + c >= (tr->m_count[kind] + 1) / 2)
+        {
+            stats->m_p50 = (MoReal)myIVPTraceHistLower(bin + 1) * spt;
+        }
+        if (seen < (tr->m_count[kind] * 99 + 99) / 100 && seen + c >= (tr->m_count[kind] * 99 + 99) / 100)
+        {
+            stats->m_p99 = (MoReal)myIVPTraceHistLower(bin + 1) * spt;
+        }
+        stats->m_max = (MoReal)myIVPTraceHistLower(bin + 1) * spt;
+        seen += c;
+    }
+
+    return MWS_IVP_SUCCESS;
+}
+
+MwsInteger myIVPTraceWriteChrome(const char* path)
+{
+    MyIVPTrace* tr = &s_myIVPTrace;
+    MoReal usPerTick = myIVPTraceSecondsPerTick() * 1e6;
+    MoSize count = tr->m_eventNext < tr->m_eventCap ? tr->m_eventNext : tr->m_eventCap;
+    MoSize index;
+    FILE* file;
+
+    if (!path || (file = fopen(path, "w")) == mwsNullPtr)
+    {
+        return MWS_IVP_INVALID_INPUT;
+    }
+
+    fprintf(file, "{\"displayTimeUnit\":\"ns\",\"metadata\":{\"dropped\":%llu},\"traceEvents\":[\n",
+        (unsigned long long)(tr->m_eventNext - count));
+    for (index = 0; index < count; ++index)
+    {
+        const MyIVPTraceEvent* ev = tr->m_events + index;
+
+        fprintf(file, "{\"name\":\"%s\",\"cat\":\"ivp\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}%s\n",
+            s_myIVPTraceName[ev->m_kind], (int)ev->m_thread,
+            (MoReal)(long long)(ev->m_start - tr->m_ticks0) * usPerTick,
+            (MoReal)(ev->m_end - ev->m_start) * usPerTick, index + 1 < count ? "," : "");
+    }
+    fprintf(file, "]}\n");
+
+    return fclose(file) == 0 ? MWS_IVP_SUCCESS : MWS_IVP_FAIL;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MY_IVP_TRACE */
+
+/***************************************************************************
+//   end of file
+***************************************************************************/
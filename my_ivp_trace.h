@@ -0,0 +1,126 @@
+/***************************************************************************
+///
+/// Copyright (c) 2020, 苏州同元软控信息技术有限公司
+/// All rights reserved.
+///
+/// @file           my_ivp_trace.h
+/// @brief          积分算法热路径的耗时跟踪：各回调与试算步的对数直方图，可导出Chrome/Perfetto跟踪文件。
+///                 编译时定义 MY_IVP_TRACE 才生效，否则各宏展开为空（实现见 my_ivp_trace.c）
+///
+/// @version        v1.0
+/// @author         田显钊
+/// @date           2020/07/07
+///
+***************************************************************************/
+
+#ifndef MY_IVP_TRACE_H
+#define MY_IVP_TRACE_H
+
+#include "mo_types.h"
+#include "mws_ivp_solver.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef MY_IVP_TRACE
+
+/* 跟踪的事件类型 */
+typedef enum
+{
+    MY_IVP_TRACE_RHS = 0,       /* m_rshFunction 调用 */
+    MY_IVP_TRACE_JAC,           /* m_jacFunction 调用 */
+    MY_IVP_TRACE_STEP_FINISHED, /* m_stepFinished 调用 */
+    MY_IVP_TRACE_STEP,          /* 被接受的试算步（定步长算法为整步） */
+    MY_IVP_TRACE_REJECT,        /* 被拒绝的试算步 */
+    MY_IVP_TRACE_KINDS
+} MyIVPTraceKind;
+
+/* 时间戳计数：x86上为TSC，其它平台为单调时钟纳秒，统计与导出时再换算为秒 */
+typedef unsigned long long MyIVPTraceTicks;
+
+/* 单类事件的耗时统计（单位：秒）；最小、最大与分位数取直方图格的边界，相对误差<12.5% */
+typedef struct
+{
+    MoSize m_count;
+    MoReal m_total;
+    MoReal m_mean;
+    MoReal m_min;
+    MoReal m_max;
+    MoReal m_p50;
+    MoReal m_p99;
+} MyIVPTraceStats;
+
+/* 问题对象的回调转接：跟踪时问题对象保存的回调换成计时的转接函数，用户数据换成本结构 */
+typedef struct
+{
+    MwsIVPCallback m_inner;     /* 平台的原回调 */
+    void* m_userData;           /* 平台的原用户数据 */
+} MyIVPTraceCallback;
+
+MyIVPTraceTicks myIVPTraceBegin(void);
+void myIVPTraceEnd(MoInteger kind, MyIVPTraceTicks start);
+void myIVPTraceInterpose(MyIVPTraceCallback* tc, MwsIVPCallback* cb, void** user_data);
+void* myIVPTraceUserData(const MwsIVPCallback* cb, void* user_data);
+const MwsIVPCallback* myIVPTraceInner(const MwsIVPCallback* cb, void* user_data);
+
+/// <summary>
+/// 开始跟踪并清空以前的记录。buffer用于保存Chrome跟踪事件（每个事件24字节），
+/// 为空时只统计直方图；缓冲区写满后不再保存事件，直方图照常累计
+/// </summary>
+/// <param name="buffer">事件缓冲区，由调用方持有，停止跟踪并导出后才可释放</param>
+/// <param name="bytes">缓冲区字节数</param>
+/// <returns></returns>
+MwsInteger myIVPTraceStart(void* buffer, MoSize bytes);
+
+/* 停止跟踪，已有记录保留，可继续查询与导出 */
+void myIVPTraceStop(void);
+
+/// <summary>
+/// 查询一类事件的耗时统计
+/// </summary>
+/// <param name="kind">事件类型，取MyIVPTraceKind的值</param>
+/// <param name="stats">统计结果</param>
+/// <returns></returns>
+MwsInteger myIVPTraceGetStats(MoInteger kind, MyIVPTraceStats* stats);
+
+/// <summary>
+/// 把保存的事件写成Chrome跟踪JSON（chrome://tracing、ui.perfetto.dev可直接打开），
+/// 各事件为"X"型，线程号为OpenMP线程号；缓冲区溢出丢弃的事件数写在metadata中
+/// </summary>
+/// <param name="path">文件路径</param>
+/// <returns></returns>
+MwsInteger myIVPTraceWriteChrome(const char* path);
+
+/*
+ * 问题结构体中的转接成员、创建问题时的回调替换、取回平台原用户数据（绕过回调直接调用模型时用）、
+ * 取回平台原回调（按函数地址识别模型时用）、计时起止；
+ * 未定义 MY_IVP_TRACE 时均展开为空
+ */
+#define MY_IVP_TRACE_MEMBER(name)               MyIVPTraceCallback name;
+#define MY_IVP_TRACE_INTERPOSE(tc, cb, ud)      myIVPTraceInterpose((tc), (cb), (ud))
+#define MY_IVP_TRACE_USER_DATA(cb, ud)          myIVPTraceUserData((cb), (ud))
+#define MY_IVP_TRACE_CALLBACK(cb, ud)           myIVPTraceInner((cb), (ud))
+#define MY_IVP_TRACE_BEGIN(var)                 MyIVPTraceTicks var = myIVPTraceBegin();
+#define MY_IVP_TRACE_END(kind, var)             myIVPTraceEnd((kind), (var))
+
+#else
+
+#define MY_IVP_TRACE_MEMBER(name)
+#define MY_IVP_TRACE_INTERPOSE(tc, cb, ud)      ((void)0)
+#define MY_IVP_TRACE_USER_DATA(cb, ud)          (ud)
+#define MY_IVP_TRACE_CALLBACK(cb, ud)           (cb)
+#define MY_IVP_TRACE_BEGIN(var)
+#define MY_IVP_TRACE_END(kind, var)             ((void)0)
+
+#endif /* MY_IVP_TRACE */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* !MY_IVP_TRACE_H */
+
+/***************************************************************************
+//   end of file
+***************************************************************************/
@@ -0,0 +1,718 @@
+/***************************************************************************
+///
+/// Copyright (c) 2020, 苏州同元软控信息技术有限公司
+/// All rights reserved.
+///
+/// @file           my_multirate.c
+/// @brief          多速率变步长积分算法：慢变量宏步、快变量微步（慢者优先）
+///
+/// @version        v1.0
+/// @author         田显钊
+/// @date           2020/07/07
+///
+***************************************************************************/
+
+#include "mo_types.h"
+#include "mws_ivp_solver.h"
+#include "my_ivp_common.h"
+#include "my_ivp_trace.h"
+
+#include <memory.h>
+#include <math.h>
+
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+/*
+ * 算法（慢者优先，宏步与微步均用BS23嵌入公式）：
+ *  1. 以宏步长H对全体状态做一步BS23，只用慢变量的误差控制H；
+ *  2. 快变量在[t,t+H]内用自适应微步积分，每一级所需的慢变量取自宏步两端的三次Hermite插值；
+ *  3. 快变量结果替换宏步中的对应分量，再算一次 f(t+H,y) 作为下一宏步的首级。
+ * 划分可由用户给定；未给定时按宏步各分量的误差自动划分：误差>1 的分量转为快变量，
+ * 误差<MY_MR_SLOW_BACK 的快变量转回慢变量；快变量超过一半时退化为单速率BS23。
+ * 右端函数只能整向量计算，若用户提供只算快变量的右端函数（myMultirateSetPartition），
+ * 微步只调用它，这才是省下右端函数计算量的来源。
+ */
+#define MY_MR_SLOW_BACK     0.5     /* 快变量转回慢变量的误差阈值（迟滞） */
+#define MY_MR_MAX_FAST      0.5     /* 快变量占比上限 */
+
+/* 算法对象 */
+typedef struct
+{
+    MwsIVPUtilFcns	m_utils;
+    void*           m_userData;
+
+} MyMultirate;
+
+/* 求解问题的数据，用数据内存分配和释放函数 */
+typedef struct
+{
+    /* 以下10个长度为n的向量依次位于同一块连续内存中（由m_preY持有） */
+    MoReal *m_preY;         /* 上一宏步y */
+    MoReal *m_curY;         /* 当前y */
+    MoReal *m_preYp;        /* 上一宏步y'，即宏步首级 */
+    MoReal *m_curYp;        /* 当前y' */
+    MoReal *m_k2;
+    MoReal *m_k3;
+    MoReal *m_k4;           /* 宏步末端 f(t+H, y宏)，用于慢变量的Hermite插值 */
+    MoReal *m_yStage;       /* 级间y（全向量：慢变量为插值，快变量为微步级值） */
+    MoReal *m_err;          /* 各分量的加权误差 */
+    MoReal *m_yFast;        /* 微步中的快变量 */
+
+    /* 微步的4个级向量，依次位于同一块连续内存中（由m_fk1持有） */
+    MoReal *m_fk1;
+    MoReal *m_fk2;
+    MoReal *m_fk3;
+    MoReal *m_fk4;
+
+    MoBoolean *m_isFast;    /* 各分量是否为快变量 */
+    MoSize *m_fastIdx;      /* 快变量下标表，与 m_slowIdx 同一块内存（由m_fastIdx持有） */
+    MoSize *m_slowIdx;      /* 慢变量下标表 */
+    MoSize m_nFast;
+    MoSize m_nSlow;
+    MoBoolean m_autoPartition;      /* 是否按误差自动划分 */
+    MwsIVPRshFcnPtr m_fastFunction; /* 只计算快变量的右端函数（可为空，为空时用整向量右端函数） */
+
+    MoReal m_curTime;       /* 当前时间 */
+    MoReal m_preTime;       /* 上一宏步时间 */
+    MoReal m_h;             /* 下一宏步建议步长，0表示尚未开始积分 */
+    MoReal m_hMicro;        /* 下一微步建议步长 */
+    MoBoolean m_ypValid;    /* m_curYp 是否对应 (m_curTime, m_curY) */
+} MyMultirateProblemData;
+
+/* 求解问题对象 */
+typedef struct
+{
+    MoSize          m_nStates;
+
+    MwsIVPOptions	m_opt;
+    MwsIVPCallback  m_callback;
+    void*			m_userData;
+    MY_IVP_TRACE_MEMBER(m_trace)
+
+    MyMultirateProblemData* m_data;
+    MyMultirate* m_solverWork;
+
+} MyMultirateProblem;
+
+void myMultirateProblemDestroy(MwsIVPSolverObj solver, MwsIVPObj ivp);
+void myMultirateDestroy(MwsIVPSolverObj solver);
+
+/* 按 m_isFast 重建快/慢下标表 */
+static void myMultirateIndex(MyMultirateProblem* spw)
+{
+    MyMultirateProblemData* ds = spw->m_data;
+    MoSize index;
+
+    ds->m_nFast = 0;
+    ds->m_nSlow = 0;
+    for (index = 0; index < spw->m_nStates; ++index)
+    {
+        if (ds->m_isFast[index])
+        {
+            ds->m_fastIdx[ds->m_nFast++] = index;
+        }
+        else
+        {
+            ds->m_slowIdx[ds->m_nSlow++] = index;
+        }
+    }
+}
+
+/// <summary>
+/// 创建算法
+/// </summary>
+/// <param name="util_fcns">工具函数（由求解器提供，用户调用）</param>
+/// <param name="user_data">用户数据（求解器内部数据，传递给工具函数util_fcns，自定义算法无需关心其内容）</param>
+/// <returns></returns>
+MwsIVPSolverObj myMultirateCreate(MwsIVPUtilFcns* util_fcns, void* user_data)
+{
+    MyMultirate* sw = (MyMultirate*)util_fcns->m_allocMemory(user_data, 1, sizeof(MyMultirate));
+
+    if (sw)
+    {
+        memset(sw, 0, sizeof(*sw));
+        sw->m_utils = *util_fcns;
+        sw->m_userData = user_data;
+    }
+
+    return sw;
+}
+
+/// <summary>
+/// 创建问题，初始为自动划分、全部为慢变量
+/// </summary>
+/// <param name="solver">积分算法对象</param>
+/// <param name="n">问题规模，即状态变量个数==微分方程阶数</param>
+/// <param name="call_back">回调函数</param>
+/// <param name="opt">求解器选项</param>
+/// <param name="ivp_user_data">用户数据(求解器内部数据，传递给回调函数call_back，算法无需关心)</param>
+/// <returns></returns>
+MwsIVPObj myMultirateProblemCreate(MwsIVPSolverObj solver, MwsSize n, MwsIVPCallback* call_back, MwsIVPOptions* opt, void* ivp_user_data)
+{
+    MyMultirate* sw = (MyMultirate*)solver;
+    MyMultirateProblem* spw = (MyMultirateProblem*)sw->m_utils.m_allocMemory(sw->m_userData, 1, sizeof(MyMultirateProblem));
+
+    if (spw)
+    {
+        MyMultirateProblemData* ds = (MyMultirateProblemData*)sw->m_utils.m_allocDataMemory(sw->m_userData, 1, sizeof(MyMultirateProblemData));
+
+        if (ds == mwsNullPtr)
+        {
+            sw->m_utils.m_freeMemory(sw->m_userData, spw);
+            return mwsNullPtr;
+        }
+
+        memset(spw, 0, sizeof(*spw));
+        memset(ds, 0, sizeof(*ds));
+
+        spw->m_callback = *call_back;
+        spw->m_userData = ivp_user_data;
+        MY_IVP_TRACE_INTERPOSE(&spw->m_trace, &spw->m_callback, &spw->m_userData);
+        spw->m_opt = *opt;
+        spw->m_nStates = n;
+        spw->m_data = ds;
+        spw->m_solverWork = sw;
+
+        ds->m_autoPartition = moTrue;
+
+        if (spw->m_nStates > 0)
+        {
+            ds->m_preY = (MoReal*)sw->m_utils.m_allocDataMemory(sw->m_userData, 10, n * sizeof(MoReal));
+            ds->m_fk1 = (MoReal*)sw->m_utils.m_allocDataMemory(sw->m_userData, 4, n * sizeof(MoReal));
+            ds->m_isFast = (MoBoolean*)sw->m_utils.m_allocDataMemory(sw->m_userData, n, sizeof(MoBoolean));
+            ds->m_fastIdx = (MoSize*)sw->m_utils.m_allocDataMemory(sw->m_userData, 2, n * sizeof(MoSize));
+
+            if (!ds->m_preY || !ds->m_fk1 || !ds->m_isFast || !ds->m_fastIdx)
+            {
+                myMultirateProblemDestroy(sw, spw);
+                spw = MWnullptr;
+            }
+            else
+            {
+                ds->m_curY = ds->m_preY + n;
+                ds->m_preYp = ds->m_preY + 2 * n;
+                ds->m_curYp = ds->m_preY + 3 * n;
+                ds->m_k2 = ds->m_preY + 4 * n;
+                ds->m_k3 = ds->m_preY + 5 * n;
+                ds->m_k4 = ds->m_preY + 6 * n;
+                ds->m_yStage = ds->m_preY + 7 * n;
+                ds->m_err = ds->m_preY + 8 * n;
+                ds->m_yFast = ds->m_preY + 9 * n;
+                ds->m_fk2 = ds->m_fk1 + n;
+                ds->m_fk3 = ds->m_fk1 + 2 * n;
+                ds->m_fk4 = ds->m_fk1 + 3 * n;
+                ds->m_slowIdx = ds->m_fastIdx + n;
+
+                memset(ds->m_preY, 0, 10 * n * sizeof(MoReal));
+                memset(ds->m_fk1, 0, 4 * n * sizeof(MoReal));
+                memset(ds->m_isFast, 0, n * sizeof(MoBoolean));
+                myMultirateIndex(spw);
+            }
+        }
+    }
+
+    return spw;
+}
+
+/// <summary>
+/// 设置快/慢变量划分
+/// </summary>
+/// <param name="solver">积分算法对象</param>
+/// <param name="ivp">问题对象</param>
+/// <param name="is_fast">长度为n，各分量是否为快变量；为空时按误差自动划分</param>
+/// <param name="fast_rhs">只计算快变量导数的右端函数（至少写入is_fast为真的分量），可为空；自动划分时不使用</param>
+/// <returns></returns>
+MwsInteger myMultirateSetPartition(MwsIVPSolverObj solver, MwsIVPObj ivp, const MoBoolean* is_fast, MwsIVPRshFcnPtr fast_rhs)
+{
+    MyMultirateProblem* spw = (MyMultirateProblem*)ivp;
+    MyMultirateProblemData* ds = spw->m_data;
+
+    if (spw->m_nStates == 0)
+    {
+        return MWS_IVP_SUCCESS;
+    }
+
+    if (is_fast)
+    {
+        memcpy(ds->m_isFast, is_fast, spw->m_nStates * sizeof(MoBoolean));
+        ds->m_autoPartition = moFalse;
+        ds->m_fastFunction = fast_rhs;
+    }
+    else
+    {
+        memset(ds->m_isFast, 0, spw->m_nStates * sizeof(MoBoolean));
+        ds->m_autoPartition = moTrue;
+        ds->m_fastFunction = mwsNullPtr;
+    }
+    myMultirateIndex(spw);
+
+    return MWS_IVP_SUCCESS;
+}
+
+/// <summary>
+/// 初始化
+/// </summary>
+/// <param name="solver">积分算法对象</param>
+/// <param name="ivp">问题对象</param>
+/// <param name="t0">初始时间</param>
+/// <param name="y0">y的初始值（特定不为空）</param>
+/// <param name="yp0">y’的初始值（DAE）</param>
+/// <param name="is_reinit">是否重新初始化（保留）：保留宏/微步长与划分，只重置插值历史</param>
+/// <param name="reserve">保留参数，暂不使用</param>
+/// <returns></returns>
+MwsInteger myMultirateInit(MwsIVPSolverObj solver, MwsIVPObj ivp, MwsReal t0, const MwsReal* y0,
+    const MwsReal* yp0, MwsBoolean is_reinit, void* reserve)
+{
+    MyMultirateProblem* spw = (MyMultirateProblem*)ivp;
+    MyMultirateProblemData* ds = spw->m_data;
+    MoSize nState = spw->m_nStates;
+
+    ds->m_curTime = t0;
+    ds->m_preTime = t0;
+    if (!is_reinit)
+    {
+        ds->m_h = 0;
+        ds->m_hMicro = 0;
+    }
+
+    if (nState == 0 || y0 == mwsNullPtr)
+    {
+        ds->m_ypValid = moFalse;
+        return MWS_IVP_SUCCESS;
+    }
+
+    memcpy(ds->m_curY, y0, nState * sizeof(MoReal));
+    memcpy(ds->m_preY, y0, nState * sizeof(MoReal));
+    if (spw->m_callback.m_rshFunction(spw->m_userData, t0, ds->m_curY, ds->m_curYp) != MWS_IVP_SUCCESS)
+    {
+        ds->m_ypValid = moFalse;
+        return MWS_IVP_RHSFN_FAIL;
+    }
+    memcpy(ds->m_preYp, ds->m_curYp, nState * sizeof(MoReal));
+    ds->m_ypValid = moTrue;
+
+    return MWS_IVP_SUCCESS;
+}
+
+/* 慢变量在 tau 处的值（宏步两端三次Hermite插值）写入 yStage */
+static void myMultirateSlowAt(MyMultirateProblemData* ds, MoReal t, MoReal H, MoReal tau, MoReal* yStage)
+{
+    MoReal theta = (tau - t) / H;
+    MoSize i;
+
+    for (i = 0; i < ds->m_nSlow; ++i)
+    {
+        MoSize index = ds->m_slowIdx[i];
+        MoReal dy = ds->m_curY[index] - ds->m_preY[index];
+        yStage[index] = (1 - theta) * ds->m_preY[index] + theta * ds->m_curY[index]
+            + theta * (theta - 1) * ((1 - 2 * theta) * dy + (theta - 1) * H * ds->m_preYp[index] + theta * H * ds->m_k4[index]);
+    }
+}
+
+/* 快变量在 tau 处的导数，只保证 fk 中快变量分量有效 */
+static MwsInteger myMultirateFastRhs(MyMultirateProblem* spw, MoReal tau, const MoReal* y, MoReal* fk)
+{
+    MwsInteger status;
+
+    if (spw->m_data->m_fastFunction)     /* 跟踪包装只接管整向量右端函数，快变量函数须取回原用户数据 */
+    {
+        status = spw->m_data->m_fastFunction(MY_IVP_TRACE_USER_DATA(&spw->m_callback, spw->m_userData), tau, y, fk);
+    }
+    else
+    {
+        status = spw->m_callback.m_rshFunction(spw->m_userData, tau, y, fk);
+    }
+    return status == MWS_IVP_SUCCESS ? MWS_IVP_SUCCESS : MWS_IVP_RHSFN_FAIL;
+}
+
+/* 快变量在宏步[t,t+H]内的自适应微步积分，结果写回 m_curY 的快变量分量 */
+static MwsInteger myMultirateMicro(MyMultirateProblem* spw, MoReal t, MoReal H, MoReal rtol, MoReal atol)
+{
+    MyMultirateProblemData* ds = spw->m_data;
+    MoReal* yS = ds->m_yStage;
+    MoReal* yF = ds->m_yFast;
+    MoReal* fk1 = ds->m_fk1;
+    MoReal* fk2 = ds->m_fk2;
+    MoReal* fk3 = ds->m_fk3;
+    MoReal* fk4 = ds->m_fk4;
+    MoReal tEnd = t + H;
+    MoReal tau = t;
+    MoReal h = ds->m_hMicro > 0 ? ds->m_hMicro : H / 4;
+    MoSize i;
+
+    for (i = 0; i < ds->m_nFast; ++i)
+    {
+        MoSize index = ds->m_fastIdx[i];
+        yF[index] = ds->m_preY[index];
+        fk1[index] = ds->m_preYp[index];
+    }
+
+    while (tau < tEnd)
+    {
+        MoReal errSum = 0, errNorm, factor;
+        MoBoolean last = moFalse;
+
+        if (h >= tEnd - tau)
+        {
+            h = tEnd - tau;
+            last = moTrue;
+        }
+        if (h < myIVPMinStep(tau))
+        {
+            return MWS_IVP_FAIL;
+        }
+
+        myMultirateSlowAt(ds, t, H, tau + h * MY_BS23_A21, yS);
+        for (i = 0; i < ds->m_nFast; ++i)
+        {
+            MoSize index = ds->m_fastIdx[i];
+            yS[index] = yF[index] + h * MY_BS23_A21 * fk1[index];
+        }
+        if (myMultirateFastRhs(spw, tau + h * MY_BS23_A21, yS, fk2) != MWS_IVP_SUCCESS)
+        {
+            return MWS_IVP_RHSFN_FAIL;
+        }
+
+        myMultirateSlowAt(ds, t, H, tau + h * MY_BS23_A32, yS);
+        for (i = 0; i < ds->m_nFast; ++i)
+        {
+            MoSize index = ds->m_fastIdx[i];
+            yS[index] = yF[index] + h * MY_BS23_A32 * fk2[index];
+        }
+        if (myMultirateFastRhs(spw, tau + h * MY_BS23_A32, yS, fk3) != MWS_IVP_SUCCESS)
+        {
+            return MWS_IVP_RHSFN_FAIL;
+        }
+
+        myMultirateSlowAt(ds, t, H, tau + h, yS);
+        for (i = 0; i < ds->m_nFast; ++i)
+        {
+            MoSize index = ds->m_fastIdx[i];
+            yS[index] = yF[index] + h * (MY_BS23_B1 * fk1[index] + MY_BS23_B2 * fk2[index] + MY_BS23_B3 * fk3[index]);
+        }
+        if (myMultirateFastRhs(spw, tau + h, yS, fk4) != MWS_IVP_SUCCESS)
+        {
+            return MWS_IVP_RHSFN_FAIL;
+        }
+
+        for (i = 0; i < ds->m_nFast; ++i)
+        {
+            MoSize index = ds->m_fastIdx[i];
+            MoReal e = h * (MY_BS23_E1 * fk1[index] + MY_BS23_E2 * fk2[index] + MY_BS23_E3 * fk3[index]
+                + MY_BS23_E4 * fk4[index]);
+            MoReal a = fabs(yF[index]);
+            MoReal b = fabs(yS[index]);
+            e /= atol + rtol * (a > b ? a : b);
+            errSum += e * e;
+        }
+        errNorm = sqrt(errSum / ds->m_nFast);
+        factor = myIVPStepFactor(errNorm, 2);
+
+        if (errNorm <= 1)
+        {
+            for (i = 0; i < ds->m_nFast; ++i)
+            {
+                MoSize index = ds->m_fastIdx[i];
+                yF[index] = yS[index];
+                fk1[index] = fk4[index];
+            }
+            tau = last ? tEnd : tau + h;
+            /* 末步被截断时不以截断后的步长作为下一宏步的微步建议 */
+            if (!last)
+            {
+                ds->m_hMicro = h * factor;
+            }
+        }
+        h *= factor;
+    }
+
+    for (i = 0; i < ds->m_nFast; ++i)
+    {
+        MoSize index = ds->m_fastIdx[i];
+        ds->m_curY[index] = yF[index];
+    }
+    return MWS_IVP_SUCCESS;
+}
+
+/// <summary>
+/// 求解：每次调用前进一个被接受的宏步，快变量在宏步内用微步积分
+/// </summary>
+/// 输入：
+/// <param name="solver">积分算法对象</param>
+/// <param name="ivp">问题对象</param>
+/// <param name="step_size">初始宏步长（仅首步使用，<=0时自动选择）</param>
+/// <param name="t">当前时间</param>
+/// <param name="tout">输出结果时间</param>
+/// 输出：
+/// <param name="tret">结果实际达到的时间</param>
+/// <param name="yret">y的结果值（输入为当前y）</param>
+/// <param name="ypret">y’的结果值（可为空）</param>
+/// <param name="reserve">保留参数，暂不使用</param>
+/// <returns></returns>
+MwsInteger myMultirateSolve(MwsIVPSolverObj solver, MwsIVPObj ivp, MwsReal step_size, MwsReal t,
+    MwsReal tout, MwsReal* tret, MwsReal* yret, MwsReal* ypret, void* reserve)
+{
+    MyMultirateProblem* spw = (MyMultirateProblem*)ivp;
+    MyMultirateProblemData* ds = spw->m_data;
+
+    MoSize n = spw->m_nStates;
+    MoSize index, i;
+    MwsInteger status;
+
+    MoReal* preY = ds->m_preY;
+    MoReal* curY = ds->m_curY;
+    MoReal* K1 = ds->m_preYp;
+    MoReal* K2 = ds->m_k2;
+    MoReal* K3 = ds->m_k3;
+    MoReal* K4 = ds->m_k4;
+    MoReal* yStage = ds->m_yStage;
+    MoReal* err = ds->m_err;
+
+    MoReal rtol = myIVPRelTol(&spw->m_opt);
+    MoReal atol = myIVPAbsTol(&spw->m_opt);
+    MoReal H = ds->m_h;
+    MoReal errNorm = 0;
+    MoBoolean rejected = moFalse;
+
+    if (spw->m_opt.m_stopTimeDefined && t >= spw->m_opt.m_stopTime)
+    {
+        *tret = t;
+        return MWS_IVP_TSTOP_RETURN;
+    }
+
+    memcpy(preY, yret, n * sizeof(MoReal));
+    if (ds->m_ypValid && t == ds->m_curTime)
+    {
+        memcpy(K1, ds->m_curYp, n * sizeof(MoReal));
+    }
+    else if (n > 0 && spw->m_callback.m_rshFunction(spw->m_userData, t, preY, K1) != MWS_IVP_SUCCESS)
+    {
+        return MWS_IVP_RHSFN_FAIL;
+    }
+    ds->m_ypValid = moFalse;
+
+    if (H <= 0)
+    {
+        H = step_size;
+        if (H <= 0 && myIVPInitialStep(&spw->m_callback, spw->m_userData, n, t, preY, K1, rtol, atol, 2,
+            myIVPMaxStep(&spw->m_opt), K2, K3, &H) != MWS_IVP_SUCCESS)
+        {
+            return MWS_IVP_RHSFN_FAIL;
+        }
+    }
+
+    /* 宏步：全体状态做一步BS23，只用慢变量误差控制H */
+    for (;;)
+    {
+        MoReal errSum = 0;
+        MY_IVP_TRACE_BEGIN(attempt)
+
+        H = myIVPClampStep(&spw->m_opt, t, H);
+        if (H < myIVPMinStep(t))
+        {
+            return MWS_IVP_FAIL;
+        }
+
+        for (index = 0; index < n; ++index)
+        {
+            yStage[index] = preY[index] + H * MY_BS23_A21 * K1[index];
+        }
+        if (spw->m_callback.m_rshFunction(spw->m_userData, t + H / 2, yStage, K2) != MWS_IVP_SUCCESS)
+        {
+            return MWS_IVP_RHSFN_FAIL;
+        }
+        for (index = 0; index < n; ++index)
+        {
+            yStage[index] = preY[index] + H * MY_BS23_A32 * K2[index];
+        }
+        if (spw->m_callback.m_rshFunction(spw->m_userData, t + H * 3 / 4, yStage, K3) != MWS_IVP_SUCCESS)
+        {
+            return MWS_IVP_RHSFN_FAIL;
+        }
+        for (index = 0; index < n; ++index)
+        {
+            curY[index] = preY[index] + H * (MY_BS23_B1 * K1[index] + MY_BS23_B2 * K2[index] + MY_BS23_B3 * K3[index]);
+        }
+        if (spw->m_callback.m_rshFunction(spw->m_userData, t + H, curY, K4) != MWS_IVP_SUCCESS)
+        {
+            return MWS_IVP_RHSFN_FAIL;
+        }
+
+        for (index = 0; index < n; ++index)
+        {
+            MoReal e = H * (MY_BS23_E1 * K1[index] + MY_BS23_E2 * K2[index] + MY_BS23_E3 * K3[index] + MY_BS23_E4 * K4[index]);
+            MoReal a = fabs(preY[index]);
+            MoReal b = fabs(curY[index]);
+            err[index] = fabs(e) / (atol + rtol * (a > b ? a : b));
+        }
+
+        /* 自动划分：误差超限的分量转为快变量，足够小的快变量转回慢变量 */
+        if (ds->m_autoPartition)
+        {
+            MoSize nFast = 0;
+            for (index = 0; index < n; ++index)
+            {
+                if (err[index] > 1)
+                {
+                    ds->m_isFast[index] = moTrue;
+                }
+                else if (err[index] < MY_MR_SLOW_BACK)
+                {
+                    ds->m_isFast[index] = moFalse;
+                }
+                nFast += ds->m_isFast[index] ? 1 : 0;
+            }
+            if (nFast > MY_MR_MAX_FAST * n)
+            {
+                memset(ds->m_isFast, 0, n * sizeof(MoBoolean));     /* 快变量过多，多速率无益 */
+            }
+            myMultirateIndex(spw);
+        }
+
+        for (i = 0; i < ds->m_nSlow; ++i)
+        {
+            errSum += err[ds->m_slowIdx[i]] * err[ds->m_slowIdx[i]];
+        }
+        errNorm = ds->m_nSlow > 0 ? sqrt(errSum / ds->m_nSlow) : 0;
+
+        if (errNorm <= 1)
+        {
+            MY_IVP_TRACE_END(MY_IVP_TRACE_STEP, attempt);
+            break;
+        }
+        H *= myIVPStepFactor(errNorm, 2);
+        rejected = moTrue;
+        MY_IVP_TRACE_END(MY_IVP_TRACE_REJECT, attempt);
+    }
+
+    /* 微步：快变量 */
+    if (ds->m_nFast > 0)
+    {
+        status = myMultirateMicro(spw, t, H, rtol, atol);
+        if (status != MWS_IVP_SUCCESS)
+        {
+            return status;
+        }
+    }
+
+    if (n > 0 && spw->m_callback.m_rshFunction(spw->m_userData, t + H, curY, ds->m_curYp) != MWS_IVP_SUCCESS)
+    {
+        return MWS_IVP_RHSFN_FAIL;
+    }
+
+    ds->m_preTime = t;
+    ds->m_curTime = t + H;
+    ds->m_ypValid = moTrue;
+    if (rejected)
+    {
+        ds->m_h = H * (myIVPStepFactor(errNorm, 2) < 1 ? myIVPStepFactor(errNorm, 2) : 1);
+    }
+    else
+    {
+        ds->m_h = H * myIVPStepFactor(errNorm, 2);
+    }
+
+    memcpy(yret, curY, n * sizeof(MoReal));
+    if (ypret)
+    {
+        memcpy(ypret, ds->m_curYp, n * sizeof(MoReal));
+    }
+    *tret = ds->m_curTime;
+
+    return MWS_IVP_SUCCESS;
+}
+
+/// <summary>
+/// 插值：宏步两端三次Hermite插值（快变量在宏步内的细节不保留，需要时应减小最大步长）
+/// </summary>
+/// 输入：
+/// <param name="solver">积分算法对象</param>
+/// <param name="ivp">问题对象</param>
+/// <param name="tout">输出结果的时间</param>
+/// 输出：
+/// <param name="yret">y的结果值</param>
+/// <param name="reserve"></param>
+/// <returns></returns>
+MwsInteger myMultirateInterpolate(MwsIVPSolverObj solver, MwsIVPObj ivp, MwsReal tout, MwsReal* yret, void* reserve)
+{
+    MyMultirateProblem* spw = (MyMultirateProblem*)ivp;
+    MyMultirateProblemData* ds = spw->m_data;
+    MoReal h = ds->m_curTime - ds->m_preTime;
+
+    if (h == 0)
+    {
+        memcpy(yret, ds->m_curY, spw->m_nStates * sizeof(MoReal));
+        return MWS_IVP_SUCCESS;
+    }
+
+    myIVPHermite(spw->m_nStates, (tout - ds->m_preTime) / h, h, ds->m_preY, ds->m_curY,
+        ds->m_preYp, ds->m_curYp, yret);
+
+    return MWS_IVP_SUCCESS;
+}
+
+/// <summary>
+/// 销毁问题
+/// </summary>
+/// <param name="solver"></param>
+/// <param name="ivp"></param>
+void myMultirateProblemDestroy(MwsIVPSolverObj solver, MwsIVPObj ivp)
+{
+    MyMultirate* sw = (MyMultirate*)solver;
+    MyMultirateProblem* spw = (MyMultirateProblem*)ivp;
+
+    if (spw)
+    {
+        if (spw->m_data->m_preY)
+        {
+            (*sw->m_utils.m_freeDataMemory)(sw->m_userData, spw->m_data->m_preY);
+        }
+
+        if (spw->m_data->m_fk1)
+        {
+            (*sw->m_utils.m_freeDataMemory)(sw->m_userData, spw->m_data->m_fk1);
+        }
+
+        if (spw->m_data->m_isFast)
+        {
+            (*sw->m_utils.m_freeDataMemory)(sw->m_userData, spw->m_data->m_isFast);
+        }
+
+        if (spw->m_data->m_fastIdx)
+        {
+            (*sw->m_utils.m_freeDataMemory)(sw->m_userData, spw->m_data->m_fastIdx);
+        }
+
+        if (spw->m_data)
+        {
+            (*sw->m_utils.m_freeDataMemory)(sw->m_userData, spw->m_data);
+        }
+
+        (*sw->m_utils.m_freeMemory)(sw->m_userData, spw);
+    }
+}
+
+/// <summary>
+/// 销毁积分算法
+/// </summary>
+/// <param name="solver"></param>
+void myMultirateDestroy(MwsIVPSolverObj solver)
+{
+    MyMultirate* sw = (MyMultirate*)solver;
+
+    if (sw)
+    {
+        (*sw->m_utils.m_freeMemory)(sw->m_userData, sw);
+    }
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+
+/***************************************************************************
+//   end of file
+***************************************************************************/
@@ -0,0 +1,797 @@
+/***************************************************************************
+///
+/// Copyright (c) 2020, 苏州同元软控信息技术有限公司
+/// All rights reserved.
+///
+/// @file           my_parareal.c
+/// @brief          Parareal时间并行驱动：粗传播器myEuler串行，细传播器myRK45各时间片并行
+///
+/// @version        v1.0
+/// @author         田显钊
+/// @date           2020/07/07
+///
+***************************************************************************/
+
+#include "mo_types.h"
+#include "mws_ivp_solver.h"
+#include "my_ivp_common.h"
+#include "my_ivp_trace.h"
+
+#include <memory.h>
+#include <math.h>
+
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+/*
+ * 算法（Lions, Maday, Turinici, 2001）：
+ *  [t0, m_stopTime] 等分为N个时间片 T_0 < T_1 < ... < T_N，G为粗传播器，F为细传播器，
+ *    U_0 = y0，U_{n+1}^0 = G(U_n^0)
+ *    U_{n+1}^{k+1} = G(U_n^{k+1}) + F(U_n^k) - G(U_n^k)
+ *  每次迭代中各片的 F(U_n^k) 互不依赖，并行计算；G 的修正扫描是串行的，因此要求G远比F便宜。
+ *  第k次迭代后前k个片已与串行细解一致，只需从第k片开始计算；
+ *  相邻两次迭代的 U 在容许误差内不再变化即收敛，最多迭代N次（此时等价于串行细解）。
+ *  并行时模型回调必须可重入，见 my_ivp_common.h 中的并行求值约定。
+ *
+ * 与平台接口的对应：首次求解时对整个区间做Parareal，之后每次Solve返回下一个时间片的端点；
+ * 片内插值从该片起点用细传播器串行重算（单调的输出时刻只重算一遍）。
+ */
+#define MY_PARAREAL_DEFAULT_SLICES  8
+#define MY_PARAREAL_COARSE_STEPS    4   /* 每片的粗传播步数 */
+
+/* 默认传播器来自 my_euler.c 与 my_RK45.c，本文件须在二者之后包含 */
+
+/* 传播器：一套积分算法接口及其算法对象 */
+typedef struct
+{
+    MwsIVPSolverFcns m_fcns;
+    MwsIVPSolverObj m_solver;
+} MyPararealPropagator;
+
+/* 算法对象 */
+typedef struct
+{
+    MwsIVPUtilFcns	m_utils;
+    void*           m_userData;
+
+} MyParareal;
+
+/* 求解问题的数据，用数据内存分配和释放函数 */
+typedef struct
+{
+    MyPararealPropagator m_coarse;
+    MyPararealPropagator m_fine;
+    MwsIVPObj m_coarseIvp;      /* 粗传播器问题对象，各片共用（串行） */
+    MwsIVPObj* m_fineIvp;       /* 每片一个细传播器问题对象（终止时间为片末），长度N */
+    MwsIVPObj m_denseIvp;       /* 片内插值用的细传播器问题对象 */
+
+    /* m_U、m_G、m_F、m_work 依次位于同一块连续内存中（由m_U持有） */
+    MoReal *m_U;                /* 片端点的解 U_0..U_N，(N+1)*n */
+    MoReal *m_G;                /* 上次迭代的 G(U_n)，N*n */
+    MoReal *m_F;                /* 本次迭代的 F(U_n)，N*n */
+    MoReal *m_work;             /* 2n：新的G值与差值 */
+
+    MoInteger m_nSlices;
+    MoInteger m_maxIters;       /* <=0 时取 N */
+    MoInteger m_coarseSteps;
+    MoInteger m_threads;        /* 并行线程数，<=1时串行 */
+    MoInteger m_iters;          /* 最近一次Parareal的迭代次数 */
+
+    MoReal m_t0;
+    MoReal m_dT;                /* 片长 */
+    MoInteger m_slice;          /* 下一次Solve返回的片号 */
+    MoBoolean m_ready;          /* m_U 是否对应当前的初值 */
+
+    MoInteger m_denseSlice;     /* m_denseIvp 当前所在的片，-1表示无效 */
+    MoReal m_denseTime;         /* m_denseIvp 已积分到的时间 */
+    MoReal m_denseLast;         /* m_denseIvp 最近一步的起点 */
+} MyPararealProblemData;
+
+/* 求解问题对象 */
+typedef struct
+{
+    MoSize          m_nStates;
+
+    MwsIVPOptions	m_opt;
+    MwsIVPCallback  m_callback;
+    void*			m_userData;
+    MY_IVP_TRACE_MEMBER(m_trace)
+
+    MyPararealProblemData* m_data;
+    MyParareal* m_solverWork;
+
+} MyPararealProblem;
+
+void myPararealProblemDestroy(MwsIVPSolverObj solver, MwsIVPObj ivp);
+void myPararealDestroy(MwsIVPSolverObj solver);
+
+/* 释放各片的细传播器问题对象 */
+static void myPararealFreeSlices(MyParareal* sw, MyPararealProblemData* ds)
+{
+    MoInteger i;
+
+    if (ds->m_fineIvp)
+    {
+        for (i = 0; i < ds->m_nSlices; ++i)
+        {
+            if (ds->m_fineIvp[i])
+            {
+                ds->m_fine.m_fcns.m_destroyPBPtr(ds->m_fine.m_solver, ds->m_fineIvp[i]);
+            }
+        }
+        sw->m_utils.m_freeDataMemory(sw->m_userData, ds->m_fineIvp);
+        ds->m_fineIvp = mwsNullPtr;
+    }
+    if (ds->m_U)
+    {
+        sw->m_utils.m_freeDataMemory(sw->m_userData, ds->m_U);
+        ds->m_U = mwsNullPtr;
+    }
+}
+
+/* 按片数分配端点解与各片的细传播器问题对象表（问题对象在每次Parareal开始时按片末时间创建） */
+static MwsInteger myPararealAllocSlices(MyParareal* sw, MyPararealProblem* spw, MoInteger slices)
+{
+    MyPararealProblemData* ds = spw->m_data;
+    MoSize n = spw->m_nStates;
+    MoSize nVec = (MoSize)(3 * slices + 3);
+
+    myPararealFreeSlices(sw, ds);
+    ds->m_nSlices = slices;
+    ds->m_ready = moFalse;
+
+    ds->m_fineIvp = (MwsIVPObj*)sw->m_utils.m_allocDataMemory(sw->m_userData, slices, sizeof(MwsIVPObj));
+    if (!ds->m_fineIvp)
+    {
+        return MWS_IVP_MEM_FAIL;
+    }
+    memset(ds->m_fineIvp, 0, slices * sizeof(MwsIVPObj));
+
+    if (n > 0)
+    {
+        ds->m_U = (MoReal*)sw->m_utils.m_allocDataMemory(sw->m_userData, nVec, n * sizeof(MoReal));
+        if (!ds->m_U)
+        {
+            return MWS_IVP_MEM_FAIL;
+        }
+        memset(ds->m_U, 0, nVec * n * sizeof(MoReal));
+        ds->m_G = ds->m_U + (slices + 1) * n;
+        ds->m_F = ds->m_G + slices * n;
+        ds->m_work = ds->m_F + slices * n;
+    }
+
+    return MWS_IVP_SUCCESS;
+}
+
+/* 创建传播器的算法对象与问题对象（粗传播器一个，插值用细传播器一个） */
+static MwsInteger myPararealCreatePropagators(MyParareal* sw, MyPararealProblem* spw)
+{
+    MyPararealProblemData* ds = spw->m_data;
+
+    ds->m_coarse.m_solver = ds->m_coarse.m_fcns.m_createPtr(&sw->m_utils, sw->m_userData);
+    ds->m_fine.m_solver = ds->m_fine.m_fcns.m_createPtr(&sw->m_utils, sw->m_userData);
+    if (!ds->m_coarse.m_solver || !ds->m_fine.m_solver)
+    {
+        return MWS_IVP_MEM_FAIL;
+    }
+    ds->m_coarseIvp = ds->m_coarse.m_fcns.m_createPBPtr(ds->m_coarse.m_solver, spw->m_nStates, &spw->m_callback,
+        &spw->m_opt, spw->m_userData);
+    ds->m_denseIvp = ds->m_fine.m_fcns.m_createPBPtr(ds->m_fine.m_solver, spw->m_nStates, &spw->m_callback,
+        &spw->m_opt, spw->m_userData);
+    if (!ds->m_coarseIvp || !ds->m_denseIvp)
+    {
+        return MWS_IVP_MEM_FAIL;
+    }
+    ds->m_denseSlice = -1;
+
+    return MWS_IVP_SUCCESS;
+}
+
+/* 释放传播器（含各片的细传播器问题对象） */
+static void myPararealFreePropagators(MyParareal* sw, MyPararealProblemData* ds)
+{
+    MoInteger i;
+
+    if (ds->m_fineIvp)
+    {
+        for (i = 0; i < ds->m_nSlices; ++i)
+        {
+            if (ds->m_fineIvp[i])
+            {
+                ds->m_fine.m_fcns.m_destroyPBPtr(ds->m_fine.m_solver, ds->m_fineIvp[i]);
+                ds->m_fineIvp[i] = mwsNullPtr;
+            }
+        }
+    }
+    if (ds->m_coarseIvp)
+    {
+        ds->m_coarse.m_fcns.m_destroyPBPtr(ds->m_coarse.m_solver, ds->m_coarseIvp);
+        ds->m_coarseIvp = mwsNullPtr;
+    }
+    if (ds->m_denseIvp)
+    {
+        ds->m_fine.m_fcns.m_destroyPBPtr(ds->m_fine.m_solver, ds->m_denseIvp);
+        ds->m_denseIvp = mwsNullPtr;
+    }
+    if (ds->m_coarse.m_solver)
+    {
+        ds->m_coarse.m_fcns.m_destroyPtr(ds->m_coarse.m_solver);
+        ds->m_coarse.m_solver = mwsNullPtr;
+    }
+    if (ds->m_fine.m_solver)
+    {
+        ds->m_fine.m_fcns.m_destroyPtr(ds->m_fine.m_solver);
+        ds->m_fine.m_solver = mwsNullPtr;
+    }
+    ds->m_ready = moFalse;
+}
+
+/* 粗传播：从片n起点的 yin 以 m_coarseSteps 个定步长步积分到片末，结果写入 yout（yin 与 yout 可相同） */
+static MwsInteger myPararealCoarse(MyPararealProblem* spw, MoInteger n, const MoReal* yin, MoReal* yout)
+{
+    MyPararealProblemData* ds = spw->m_data;
+    MoReal t = ds->m_t0 + n * ds->m_dT;
+    MoReal h = ds->m_dT / ds->m_coarseSteps;
+    MoReal tret = t;
+    MwsInteger status;
+    MoInteger i;
+
+    status = ds->m_coarse.m_fcns.m_initPtr(ds->m_coarse.m_solver, ds->m_coarseIvp, t, yin, mwsNullPtr, moFalse, mwsNullPtr);
+    if (status != MWS_IVP_SUCCESS)
+    {
+        return status;
+    }
+    if (yout != yin)
+    {
+        memcpy(yout, yin, spw->m_nStates * sizeof(MoReal));
+    }
+    for (i = 0; i < ds->m_coarseSteps; ++i)
+    {
+        status = ds->m_coarse.m_fcns.m_solvePtr(ds->m_coarse.m_solver, ds->m_coarseIvp, h, t, t + h, &tret, yout,
+            mwsNullPtr, mwsNullPtr);
+        if (status != MWS_IVP_SUCCESS && status != MWS_IVP_WARNING)
+        {
+            return status;
+        }
+        t = tret;
+    }
+
+    return MWS_IVP_SUCCESS;
+}
+
+/* 细传播：用 ivp 从 (t, y) 积分到 tEnd，y 输入初值、输出终值 */
+static MwsInteger myPararealFine(MyPararealProblemData* ds, MwsIVPObj ivp, MoReal t, MoReal tEnd, MoReal* y)
+{
+    MoReal tret = t;
+    MwsInteger status;
+
+    status = ds->m_fine.m_fcns.m_initPtr(ds->m_fine.m_solver, ivp, t, y, mwsNullPtr, moFalse, mwsNullPtr);
+    while (status == MWS_IVP_SUCCESS && t < tEnd)
+    {
+        status = ds->m_fine.m_fcns.m_solvePtr(ds->m_fine.m_solver, ivp, 0, t, tEnd, &tret, y, mwsNullPtr, mwsNullPtr);
+        if (status == MWS_IVP_TSTOP_RETURN || status == MWS_IVP_WARNING)
+        {
+            status = MWS_IVP_SUCCESS;
+        }
+        if (status != MWS_IVP_SUCCESS || tret <= t)
+        {
+            return status != MWS_IVP_SUCCESS ? status : MWS_IVP_FAIL;
+        }
+        if (tret > tEnd)
+        {
+            /* 传播器未按终止时间截断步长：插值回片末 */
+            return ds->m_fine.m_fcns.m_interpolatePtr(ds->m_fine.m_solver, ivp, tEnd, y, mwsNullPtr);
+        }
+        t = tret;
+    }
+
+    return status;
+}
+
+/* 对 [t0, m_stopTime] 做Parareal，结果存于 m_U */
+static MwsInteger myPararealRun(MyParareal* sw, MyPararealProblem* spw, MoReal t0, const MoReal* y0)
+{
+    MyPararealProblemData* ds = spw->m_data;
+    MoSize n = spw->m_nStates;
+    MoSize index;
+    MoInteger N = ds->m_nSlices;
+    MoInteger maxIters = (ds->m_maxIters > 0 && ds->m_maxIters < N) ? ds->m_maxIters : N;
+    MoInteger i, k;
+    MoReal rtol = myIVPRelTol(&spw->m_opt);
+    MoReal atol = myIVPAbsTol(&spw->m_opt);
+    MoReal* Gnew = ds->m_work;
+    MoReal* diff = ds->m_work + n;
+    MwsInteger status = MWS_IVP_SUCCESS;
+
+    ds->m_ready = moFalse;
+    ds->m_t0 = t0;
+    ds->m_dT = (spw->m_opt.m_stopTime - t0) / N;
+    ds->m_slice = 0;
+    ds->m_iters = 0;
+    ds->m_denseSlice = -1;
+
+    /* 各片的细传播器以片末为终止时间 */
+    for (i = 0; i < N; ++i)
+    {
+        MwsIVPOptions opt = spw->m_opt;
+
+        if (ds->m_fineIvp[i])
+        {
+            ds->m_fine.m_fcns.m_destroyPBPtr(ds->m_fine.m_solver, ds->m_fineIvp[i]);
+        }
+        opt.m_stopTimeDefined = moTrue;
+        opt.m_stopTime = (i == N - 1) ? spw->m_opt.m_stopTime : t0 + (i + 1) * ds->m_dT;
+        ds->m_fineIvp[i] = ds->m_fine.m_fcns.m_createPBPtr(ds->m_fine.m_solver, n, &spw->m_callback, &opt, spw->m_userData);
+        if (!ds->m_fineIvp[i])
+        {
+            return MWS_IVP_MEM_FAIL;
+        }
+    }
+
+    if (n == 0)
+    {
+        ds->m_ready = moTrue;
+        return MWS_IVP_SUCCESS;
+    }
+
+    /* 第0次迭代：粗传播串行扫描 */
+    memcpy(ds->m_U, y0, n * sizeof(MoReal));
+    for (i = 0; i < N; ++i)
+    {
+        status = myPararealCoarse(spw, i, ds->m_U + i * n, ds->m_G + i * n);
+        if (status != MWS_IVP_SUCCESS)
+        {
+            return status;
+        }
+        memcpy(ds->m_U + (i + 1) * n, ds->m_G + i * n, n * sizeof(MoReal));
+    }
+
+    for (k = 0; k < maxIters; ++k)
+    {
+        MoReal maxErr = 0;
+        MoInteger nFail = 0;
+
+        /*
+         * 细传播：未收敛的各片并行
+         * 只有起点精确的第k片失败才是真正的失败；其余片的起点可能因粗传播不准而不合理，
+         * 失败时置为无穷大，使本次迭代不收敛，待其成为第k片时再计算
+         */
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 1) num_threads(ds->m_threads) if (ds->m_threads > 1) reduction(+:nFail)
+#endif
+        for (i = k; i < N; ++i)
+        {
+            /* 起点含inf/nan（粗传播已发散）时不做细传播，按失败处理 */
+            memcpy(ds->m_F + i * n, ds->m_U + i * n, n * sizeof(MoReal));
+            if (!(myIVPErrorNorm(n, ds->m_F + i * n, ds->m_F + i * n, ds->m_F + i * n, 0, 1) <= HUGE_VAL)
+                || myPararealFine(ds, ds->m_fineIvp[i], t0 + i * ds->m_dT,
+                (i == N - 1) ? spw->m_opt.m_stopTime : t0 + (i + 1) * ds->m_dT, ds->m_F + i * n) != MWS_IVP_SUCCESS)
+            {
+                if (i == k)
+                {
+                    ++nFail;
+                }
+                else
+                {
+                    for (index = 0; index < n; ++index)
+                    {
+                        ds->m_F[i * n + index] = HUGE_VAL;
+                    }
+                }
+            }
+        }
+        if (nFail > 0)
+        {
+            return MWS_IVP_FAIL;
+        }
+
+        /*
+         * 串行修正：U_{n+1} = G(U_n) + F(U_n^old) - G(U_n^old)
+         * 第k片的起点已精确，直接取 U_{k+1} = F(U_k)，粗传播发散（inf/nan）时也能保证每次迭代至少前进一片
+         */
+        for (i = k; i < N; ++i)
+        {
+            MoReal* Unext = ds->m_U + (i + 1) * n;
+            MoReal err;
+
+            if (i == k)
+            {
+                memcpy(Gnew, ds->m_F + i * n, n * sizeof(MoReal));
+                memcpy(ds->m_G + i * n, Gnew, n * sizeof(MoReal));
+            }
+            else
+            {
+                status = myPararealCoarse(spw, i, ds->m_U + i * n, Gnew);
+                if (status != MWS_IVP_SUCCESS)
+                {
+                    return status;
+                }
+            }
+            for (index = 0; index < n; ++index)
+            {
+                MoReal u = Gnew[index] + ds->m_F[i * n + index] - ds->m_G[i * n + index];
+                diff[index] = u - Unext[index];
+                Unext[index] = u;
+            }
+            memcpy(ds->m_G + i * n, Gnew, n * sizeof(MoReal));
+
+            err = myIVPErrorNorm(n, diff, Unext, Unext, rtol, atol);
+            if (!(err <= maxErr))
+            {
+                maxErr = err;   /* nan 视为未收敛 */
+            }
+        }
+
+        ds->m_iters = k + 1;
+        if (maxErr <= 1)
+        {
+            break;
+        }
+    }
+
+    ds->m_ready = moTrue;
+
+    return MWS_IVP_SUCCESS;
+}
+
+/// <summary>
+/// 创建算法
+/// </summary>
+/// <param name="util_fcns">工具函数（由求解器提供，用户调用）</param>
+/// <param name="user_data">用户数据（求解器内部数据，传递给工具函数util_fcns，自定义算法无需关心其内容）</param>
+/// <returns></returns>
+MwsIVPSolverObj myPararealCreate(MwsIVPUtilFcns* util_fcns, void* user_data)
+{
+    MyParareal* sw = (MyParareal*)util_fcns->m_allocMemory(user_data, 1, sizeof(MyParareal));
+
+    if (sw)
+    {
+        memset(sw, 0, sizeof(*sw));
+        sw->m_utils = *util_fcns;
+        sw->m_userData = user_data;
+    }
+
+    return sw;
+}
+
+/// <summary>
+/// 创建问题：默认粗传播器为myEuler（Heun），细传播器为myRK45
+/// </summary>
+/// <param name="solver">积分算法对象</param>
+/// <param name="n">问题规模，即状态变量个数==微分方程阶数</param>
+/// <param name="call_back">回调函数</param>
+/// <param name="opt">求解器选项（必须定义终止时间）</param>
+/// <param name="ivp_user_data">用户数据(求解器内部数据，传递给回调函数call_back，算法无需关心)</param>
+/// <returns></returns>
+MwsIVPObj myPararealProblemCreate(MwsIVPSolverObj solver, MwsSize n, MwsIVPCallback* call_back, MwsIVPOptions* opt, void* ivp_user_data)
+{
+    MyParareal* sw = (MyParareal*)solver;
+    MyPararealProblem* spw = (MyPararealProblem*)sw->m_utils.m_allocMemory(sw->m_userData, 1, sizeof(MyPararealProblem));
+
+    if (spw)
+    {
+        MyPararealProblemData* ds = (MyPararealProblemData*)sw->m_utils.m_allocDataMemory(sw->m_userData, 1, sizeof(MyPararealProblemData));
+
+        if (ds == mwsNullPtr)
+        {
+            sw->m_utils.m_freeMemory(sw->m_userData, spw);
+            return mwsNullPtr;
+        }
+
+        memset(spw, 0, sizeof(*spw));
+        memset(ds, 0, sizeof(*ds));
+
+        spw->m_callback = *call_back;
+        spw->m_userData = ivp_user_data;
+        MY_IVP_TRACE_INTERPOSE(&spw->m_trace, &spw->m_callback, &spw->m_userData);
+        spw->m_opt = *opt;
+        spw->m_nStates = n;
+        spw->m_data = ds;
+        spw->m_solverWork = sw;
+
+        ds->m_coarse.m_fcns.m_createPtr = &myEulerCreate;
+        ds->m_coarse.m_fcns.m_createPBPtr = &myEulerProblemCreate;
+        ds->m_coarse.m_fcns.m_initPtr = &myEulerInit;
+        ds->m_coarse.m_fcns.m_solvePtr = &myEulerSolve;
+        ds->m_coarse.m_fcns.m_interpolatePtr = &myEulerInterpolate;
+        ds->m_coarse.m_fcns.m_destroyPBPtr = &myEulerProblemDestroy;
+        ds->m_coarse.m_fcns.m_destroyPtr = &myEulerDestroy;
+
+        ds->m_fine.m_fcns.m_createPtr = &myRK45Create;
+        ds->m_fine.m_fcns.m_createPBPtr = &myRK45ProblemCreate;
+        ds->m_fine.m_fcns.m_initPtr = &myRK45Init;
+        ds->m_fine.m_fcns.m_solvePtr = &myRK45Solve;
+        ds->m_fine.m_fcns.m_interpolatePtr = &myRK45Interpolate;
+        ds->m_fine.m_fcns.m_destroyPBPtr = &myRK45ProblemDestroy;
+        ds->m_fine.m_fcns.m_destroyPtr = &myRK45Destroy;
+
+        ds->m_coarseSteps = MY_PARAREAL_COARSE_STEPS;
+        ds->m_threads = 1;
+
+        if (myPararealCreatePropagators(sw, spw) != MWS_IVP_SUCCESS
+            || myPararealAllocSlices(sw, spw, MY_PARAREAL_DEFAULT_SLICES) != MWS_IVP_SUCCESS)
+        {
+            myPararealProblemDestroy(sw, spw);
+            spw = MWnullptr;
+        }
+    }
+
+    return spw;
+}
+
+/// <summary>
+/// 设置时间片划分与并行度，下次求解时生效
+/// 并行时模型回调必须可重入，见 my_ivp_common.h 中的并行求值约定
+/// </summary>
+/// <param name="solver">积分算法对象</param>
+/// <param name="ivp">问题对象</param>
+/// <param name="slices">时间片数N（默认8）</param>
+/// <param name="max_iters">最大迭代次数，<=0 时为N</param>
+/// <param name="coarse_steps">每片的粗传播步数（默认4）</param>
+/// <param name="threads">细传播的并行线程数，<=1为串行（默认1），一般取片数</param>
+/// <returns></returns>
+MwsInteger myPararealSetSlices(MwsIVPSolverObj solver, MwsIVPObj ivp, MoInteger slices, MoInteger max_iters,
+    MoInteger coarse_steps, MoInteger threads)
+{
+    MyParareal* sw = (MyParareal*)solver;
+    MyPararealProblem* spw = (MyPararealProblem*)ivp;
+    MyPararealProblemData* ds = spw->m_data;
+
+    if (slices < 1 || coarse_steps < 1)
+    {
+        return MWS_IVP_INVALID_INPUT;
+    }
+
+    ds->m_maxIters = max_iters;
+    ds->m_coarseSteps = coarse_steps;
+    ds->m_threads = threads > 1 ? threads : 1;
+    ds->m_ready = moFalse;
+    if (slices != ds->m_nSlices)
+    {
+        return myPararealAllocSlices(sw, spw, slices);
+    }
+
+    return MWS_IVP_SUCCESS;
+}
+
+/// <summary>
+/// 替换粗/细传播器（如以myBS23、myDOP853作细传播器），下次求解时生效
+/// </summary>
+/// <param name="solver">积分算法对象</param>
+/// <param name="ivp">问题对象</param>
+/// <param name="coarse">粗传播器接口，为空时保持不变；以 step_size 定步长调用</param>
+/// <param name="fine">细传播器接口，为空时保持不变；须遵守终止时间</param>
+/// <returns></returns>
+MwsInteger myPararealSetPropagators(MwsIVPSolverObj solver, MwsIVPObj ivp, const MwsIVPSolverFcns* coarse,
+    const MwsIVPSolverFcns* fine)
+{
+    MyParareal* sw = (MyParareal*)solver;
+    MyPararealProblem* spw = (MyPararealProblem*)ivp;
+    MyPararealProblemData* ds = spw->m_data;
+
+    myPararealFreePropagators(sw, ds);
+    if (coarse)
+    {
+        ds->m_coarse.m_fcns = *coarse;
+    }
+    if (fine)
+    {
+        ds->m_fine.m_fcns = *fine;
+    }
+
+    return myPararealCreatePropagators(sw, spw);
+}
+
+/// <summary>
+/// 最近一次Parareal的迭代次数
+/// </summary>
+/// <param name="solver">积分算法对象</param>
+/// <param name="ivp">问题对象</param>
+/// <returns></returns>
+MoInteger myPararealGetIterations(MwsIVPSolverObj solver, MwsIVPObj ivp)
+{
+    MyPararealProblem* spw = (MyPararealProblem*)ivp;
+
+    return spw->m_data->m_iters;
+}
+
+/// <summary>
+/// 初始化：只记录需要重新计算，Parareal在首次求解时进行
+/// </summary>
+/// <param name="solver">积分算法对象</param>
+/// <param name="ivp">问题对象</param>
+/// <param name="t0">初始时间</param>
+/// <param name="y0">y的初始值（特定不为空）</param>
+/// <param name="yp0">y’的初始值（DAE）</param>
+/// <param name="is_reinit">是否重新初始化（保留）</param>
+/// <param name="reserve">保留参数，暂不使用</param>
+/// <returns></returns>
+MwsInteger myPararealInit(MwsIVPSolverObj solver, MwsIVPObj ivp, MwsReal t0, const MwsReal* y0,
+    const MwsReal* yp0, MwsBoolean is_reinit, void* reserve)
+{
+    MyPararealProblem* spw = (MyPararealProblem*)ivp;
+
+    spw->m_data->m_ready = moFalse;
+    spw->m_data->m_t0 = t0;
+
+    if (!spw->m_opt.m_stopTimeDefined || spw->m_opt.m_stopTime <= t0)
+    {
+        return MWS_IVP_INVALID_INPUT;   /* 时间并行需要确定的积分区间 */
+    }
+
+    return MWS_IVP_SUCCESS;
+}
+
+/// <summary>
+/// 求解：首次调用（或状态被外部改动后）对 [t, m_stopTime] 做Parareal，每次调用返回下一个时间片端点
+/// </summary>
+/// 输入：
+/// <param name="solver">积分算法对象</param>
+/// <param name="ivp">问题对象</param>
+/// <param name="step_size">未使用（粗传播步长由片长与 coarse_steps 决定）</param>
+/// <param name="t">当前时间</param>
+/// <param name="tout">输出结果时间</param>
+/// 输出：
+/// <param name="tret">结果实际达到的时间</param>
+/// <param name="yret">y的结果值（输入为当前y）</param>
+/// <param name="ypret">y’的结果值（可为空）</param>
+/// <param name="reserve">保留参数，暂不使用</param>
+/// <returns></returns>
+MwsInteger myPararealSolve(MwsIVPSolverObj solver, MwsIVPObj ivp, MwsReal step_size, MwsReal t,
+    MwsReal tout, MwsReal* tret, MwsReal* yret, MwsReal* ypret, void* reserve)
+{
+    MyParareal* sw = (MyParareal*)solver;
+    MyPararealProblem* spw = (MyPararealProblem*)ivp;
+    MyPararealProblemData* ds = spw->m_data;
+    MoSize n = spw->m_nStates;
+    MoReal tSlice;
+
+    if (!spw->m_opt.m_stopTimeDefined)
+    {
+        return MWS_IVP_INVALID_INPUT;
+    }
+    if (t >= spw->m_opt.m_stopTime)
+    {
+        *tret = t;
+        return MWS_IVP_TSTOP_RETURN;
+    }
+
+    /* 外部改动了时间或状态：从当前点重新做Parareal */
+    tSlice = ds->m_t0 + ds->m_slice * ds->m_dT;
+    if (!ds->m_ready || ds->m_slice >= ds->m_nSlices || t != tSlice
+        || (n > 0 && memcmp(yret, ds->m_U + ds->m_slice * n, n * sizeof(MoReal)) != 0))
+    {
+        MwsInteger status = myPararealRun(sw, spw, t, yret);
+        if (status != MWS_IVP_SUCCESS)
+        {
+            ds->m_ready = moFalse;
+            return status;
+        }
+    }
+
+    ++ds->m_slice;
+    *tret = (ds->m_slice == ds->m_nSlices) ? spw->m_opt.m_stopTime : ds->m_t0 + ds->m_slice * ds->m_dT;
+    memcpy(yret, ds->m_U + ds->m_slice * n, n * sizeof(MoReal));
+    if (ypret && n > 0 && spw->m_callback.m_rshFunction(spw->m_userData, *tret, yret, ypret) != MWS_IVP_SUCCESS)
+    {
+        return MWS_IVP_RHSFN_FAIL;
+    }
+
+    return MWS_IVP_SUCCESS;
+}
+
+/// <summary>
+/// 插值：在最近返回的时间片内，从片起点用细传播器串行积分到 tout 后插值；
+/// 输出时刻单调增加时每片只重算一遍
+/// </summary>
+/// 输入：
+/// <param name="solver">积分算法对象</param>
+/// <param name="ivp">问题对象</param>
+/// <param name="tout">输出结果的时间</param>
+/// 输出：
+/// <param name="yret">y的结果值</param>
+/// <param name="reserve"></param>
+/// <returns></returns>
+MwsInteger myPararealInterpolate(MwsIVPSolverObj solver, MwsIVPObj ivp, MwsReal tout, MwsReal* yret, void* reserve)
+{
+    MyPararealProblem* spw = (MyPararealProblem*)ivp;
+    MyPararealProblemData* ds = spw->m_data;
+    MoSize n = spw->m_nStates;
+    MoInteger slice = ds->m_slice > 0 ? ds->m_slice - 1 : 0;
+    MoReal tStart = ds->m_t0 + slice * ds->m_dT;
+    MoReal tret;
+    MwsInteger status = MWS_IVP_SUCCESS;
+
+    if (!ds->m_ready || n == 0)
+    {
+        return ds->m_ready ? MWS_IVP_SUCCESS : MWS_IVP_FAIL;
+    }
+    if (tout <= tStart)
+    {
+        memcpy(yret, ds->m_U + slice * n, n * sizeof(MoReal));
+        return MWS_IVP_SUCCESS;
+    }
+    if (tout >= ds->m_t0 + (slice + 1) * ds->m_dT)
+    {
+        memcpy(yret, ds->m_U + (slice + 1) * n, n * sizeof(MoReal));
+        return MWS_IVP_SUCCESS;
+    }
+
+    /* 插值用问题对象不在本片、或已越过 tout 所在的步：从片起点重新积分 */
+    if (ds->m_denseSlice != slice || tout < ds->m_denseLast)
+    {
+        memcpy(ds->m_work, ds->m_U + slice * n, n * sizeof(MoReal));
+        status = ds->m_fine.m_fcns.m_initPtr(ds->m_fine.m_solver, ds->m_denseIvp, tStart, ds->m_work, mwsNullPtr,
+            moFalse, mwsNullPtr);
+        if (status != MWS_IVP_SUCCESS)
+        {
+            ds->m_denseSlice = -1;
+            return status;
+        }
+        ds->m_denseSlice = slice;
+        ds->m_denseTime = tStart;
+        ds->m_denseLast = tStart;
+    }
+
+    while (ds->m_denseTime < tout)
+    {
+        status = ds->m_fine.m_fcns.m_solvePtr(ds->m_fine.m_solver, ds->m_denseIvp, 0, ds->m_denseTime, tout, &tret,
+            ds->m_work, mwsNullPtr, mwsNullPtr);
+        if ((status != MWS_IVP_SUCCESS && status != MWS_IVP_WARNING) || tret <= ds->m_denseTime)
+        {
+            ds->m_denseSlice = -1;
+            return status != MWS_IVP_SUCCESS ? status : MWS_IVP_FAIL;
+        }
+        ds->m_denseLast = ds->m_denseTime;
+        ds->m_denseTime = tret;
+    }
+
+    return ds->m_fine.m_fcns.m_interpolatePtr(ds->m_fine.m_solver, ds->m_denseIvp, tout, yret, mwsNullPtr);
+}
+
+/// <summary>
+/// 销毁问题
+/// </summary>
+/// <param name="solver"></param>
+/// <param name="ivp"></param>
+void myPararealProblemDestroy(MwsIVPSolverObj solver, MwsIVPObj ivp)
+{
+    MyParareal* sw = (MyParareal*)solver;
+    MyPararealProblem* spw = (MyPararealProblem*)ivp;
+
+    if (spw)
+    {
+        if (spw->m_data)
+        {
+            myPararealFreePropagators(sw, spw->m_data);
+            myPararealFreeSlices(sw, spw->m_data);
+            (*sw->m_utils.m_freeDataMemory)(sw->m_userData, spw->m_data);
+        }
+
+        (*sw->m_utils.m_freeMemory)(sw->m_userData, spw);
+    }
+}
+
+/// <summary>
+/// 销毁积分算法
+/// </summary>
+/// <param name="solver"></param>
+void myPararealDestroy(MwsIVPSolverObj solver)
+{
+    MyParareal* sw = (MyParareal*)solver;
+
+    if (sw)
+    {
+        (*sw->m_utils.m_freeMemory)(sw->m_userData, sw);
+    }
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+
+/***************************************************************************
+//   end of file
+***************************************************************************/
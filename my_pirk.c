@@ -0,0 +1,502 @@
+/***************************************************************************
+///
+/// Copyright (c) 2020, 苏州同元软控信息技术有限公司
+/// All rights reserved.
+///
+/// @file           my_pirk.c
+/// @brief          并行迭代Runge-Kutta积分算法（PIRK，3级Gauss-Legendre，6阶），各级右端函数可并行计算
+///
+/// @version        v1.0
+/// @author         田显钊
+/// @date           2020/07/07
+///
+***************************************************************************/
+
+#include "mo_types.h"
+#include "mws_ivp_solver.h"
+#include "my_ivp_common.h"
+#include "my_ivp_trace.h"
+
+#include <memory.h>
+#include <math.h>
+
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+/*
+ * 算法（van der Houwen, Sommeijer, Iterated Runge-Kutta methods on parallel computers, 1991）：
+ *  对隐式的3级Gauss-Legendre方法（6阶）做不动点迭代，
+ *    K_i^(0) = f(t, y0)
+ *    K_i^(m) = f(t + c_i*h, y0 + h * sum_j a_ij * K_j^(m-1))，i = 1..s，m = 1..M
+ *    y^(m)   = y0 + h * sum_j b_j * K_j^(m)
+ *  每次迭代阶数加1，y^(m) 为 min(6, m+1) 阶；取 M = 5 得6阶，y^(5) - y^(4) 作为5阶误差估计。
+ *  同一次迭代内的s个右端函数计算互不依赖，开启多线程时（myPirkSetThreads）并行计算，
+ *  每步的串行右端函数计算次数为 1 + M = 6，与级数无关。
+ *  不动点迭代只在 h*L 较小时收敛，适用于非刚性问题；迭代不收敛表现为误差估计偏大，由步长控制自动缩步。
+ */
+#define MY_PIRK_STAGES      3
+#define MY_PIRK_ITERS       5
+#define MY_PIRK_ORDER       6
+#define MY_PIRK_SQRT15      3.8729833462074170
+
+static const MoReal s_pirkC[MY_PIRK_STAGES] =
+{
+    0.5 - MY_PIRK_SQRT15 / 10, 0.5, 0.5 + MY_PIRK_SQRT15 / 10
+};
+
+static const MoReal s_pirkA[MY_PIRK_STAGES][MY_PIRK_STAGES] =
+{
+    { 5.0 / 36,                       2.0 / 9 - MY_PIRK_SQRT15 / 15, 5.0 / 36 - MY_PIRK_SQRT15 / 30 },
+    { 5.0 / 36 + MY_PIRK_SQRT15 / 24, 2.0 / 9,                       5.0 / 36 - MY_PIRK_SQRT15 / 24 },
+    { 5.0 / 36 + MY_PIRK_SQRT15 / 30, 2.0 / 9 + MY_PIRK_SQRT15 / 15, 5.0 / 36 }
+};
+
+static const MoReal s_pirkB[MY_PIRK_STAGES] =
+{
+    5.0 / 18, 4.0 / 9, 5.0 / 18
+};
+
+/* 算法对象 */
+typedef struct
+{
+    MwsIVPUtilFcns	m_utils;
+    void*           m_userData;
+
+} MyPirk;
+
+/* 求解问题的数据，用数据内存分配和释放函数 */
+typedef struct
+{
+    /* m_preY、m_curY、m_preYp、m_curYp、m_yLow 依次位于同一块连续内存中（由m_preY持有） */
+    MoReal *m_preY;         /* 上一步y */
+    MoReal *m_curY;         /* 当前y */
+    MoReal *m_preYp;        /* 上一步y' */
+    MoReal *m_curYp;        /* 当前y' */
+    MoReal *m_yLow;         /* 倒数第二次迭代的结果 y^(M-1) */
+
+    /* m_stageY、m_stageK 依次位于同一块连续内存中（由m_stageY持有），各为 s*n，第i级占第i段 */
+    MoReal *m_stageY;
+    MoReal *m_stageK;
+
+    MoReal m_curTime;       /* 当前时间 */
+    MoReal m_preTime;       /* 上一步时间 */
+    MoReal m_h;             /* 下一步建议步长，0表示尚未开始积分 */
+    MoInteger m_threads;    /* 并行线程数，<=1时串行 */
+
+    MoBoolean m_ypValid;    /* m_curYp 是否对应 (m_curTime, m_curY) */
+} MyPirkProblemData;
+
+/* 求解问题对象 */
+typedef struct
+{
+    MoSize          m_nStates;
+
+    MwsIVPOptions	m_opt;
+    MwsIVPCallback  m_callback;
+    void*			m_userData;
+    MY_IVP_TRACE_MEMBER(m_trace)
+
+    MyPirkProblemData* m_data;
+    MyPirk* m_solverWork;
+
+} MyPirkProblem;
+
+void myPirkProblemDestroy(MwsIVPSolverObj solver, MwsIVPObj ivp);
+void myPirkDestroy(MwsIVPSolverObj solver);
+
+/// <summary>
+/// 创建算法
+/// </summary>
+/// <param name="util_fcns">工具函数（由求解器提供，用户调用）</param>
+/// <param name="user_data">用户数据（求解器内部数据，传递给工具函数util_fcns，自定义算法无需关心其内容）</param>
+/// <returns></returns>
+MwsIVPSolverObj myPirkCreate(MwsIVPUtilFcns* util_fcns, void* user_data)
+{
+    MyPirk* sw = (MyPirk*)util_fcns->m_allocMemory(user_data, 1, sizeof(MyPirk));
+
+    if (sw)
+    {
+        memset(sw, 0, sizeof(*sw));
+        sw->m_utils = *util_fcns;
+        sw->m_userData = user_data;
+    }
+
+    return sw;
+}
+
+/// <summary>
+/// 创建问题
+/// </summary>
+/// <param name="solver">积分算法对象</param>
+/// <param name="n">问题规模，即状态变量个数==微分方程阶数</param>
+/// <param name="call_back">回调函数</param>
+/// <param name="opt">求解器选项</param>
+/// <param name="ivp_user_data">用户数据(求解器内部数据，传递给回调函数call_back，算法无需关心)</param>
+/// <returns></returns>
+MwsIVPObj myPirkProblemCreate(MwsIVPSolverObj solver, MwsSize n, MwsIVPCallback* call_back, MwsIVPOptions* opt, void* ivp_user_data)
+{
+    MyPirk* sw = (MyPirk*)solver;
+    MyPirkProblem* spw = (MyPirkProblem*)sw->m_utils.m_allocMemory(sw->m_userData, 1, sizeof(MyPirkProblem));
+
+    if (spw)
+    {
+        MyPirkProblemData* ds = (MyPirkProblemData*)sw->m_utils.m_allocDataMemory(sw->m_userData, 1, sizeof(MyPirkProblemData));
+
+        if (ds == mwsNullPtr)
+        {
+            sw->m_utils.m_freeMemory(sw->m_userData, spw);
+            return mwsNullPtr;
+        }
+
+        memset(spw, 0, sizeof(*spw));
+        memset(ds, 0, sizeof(*ds));
+
+        spw->m_callback = *call_back;
+        spw->m_userData = ivp_user_data;
+        MY_IVP_TRACE_INTERPOSE(&spw->m_trace, &spw->m_callback, &spw->m_userData);
+        spw->m_opt = *opt;
+        spw->m_nStates = n;
+        spw->m_data = ds;
+        spw->m_solverWork = sw;
+
+        ds->m_threads = 1;
+
+        if (spw->m_nStates > 0)
+        {
+            ds->m_preY = (MoReal*)sw->m_utils.m_allocDataMemory(sw->m_userData, 5, n * sizeof(MoReal));
+            ds->m_stageY = (MoReal*)sw->m_utils.m_allocDataMemory(sw->m_userData, 2 * MY_PIRK_STAGES, n * sizeof(MoReal));
+
+            if (!ds->m_preY || !ds->m_stageY)
+            {
+                myPirkProblemDestroy(sw, spw);
+                spw = MWnullptr;
+            }
+            else
+            {
+                ds->m_curY = ds->m_preY + n;
+                ds->m_preYp = ds->m_preY + 2 * n;
+                ds->m_curYp = ds->m_preY + 3 * n;
+                ds->m_yLow = ds->m_preY + 4 * n;
+                ds->m_stageK = ds->m_stageY + MY_PIRK_STAGES * n;
+
+                memset(ds->m_preY, 0, 5 * n * sizeof(MoReal));
+                memset(ds->m_stageY, 0, 2 * MY_PIRK_STAGES * n * sizeof(MoReal));
+            }
+        }
+    }
+
+    return spw;
+}
+
+/// <summary>
+/// 设置并行线程数（需以OpenMP编译，否则始终串行），超过级数的线程不会被使用
+/// 并行时模型回调必须可重入，见 my_ivp_common.h 中的并行求值约定
+/// </summary>
+/// <param name="solver">积分算法对象</param>
+/// <param name="ivp">问题对象</param>
+/// <param name="threads">线程数，<=1为串行，默认1</param>
+/// <returns></returns>
+MwsInteger myPirkSetThreads(MwsIVPSolverObj solver, MwsIVPObj ivp, MoInteger threads)
+{
+    MyPirkProblem* spw = (MyPirkProblem*)ivp;
+
+    spw->m_data->m_threads = threads > MY_PIRK_STAGES ? MY_PIRK_STAGES : (threads > 1 ? threads : 1);
+
+    return MWS_IVP_SUCCESS;
+}
+
+/// <summary>
+/// 初始化
+/// </summary>
+/// <param name="solver">积分算法对象</param>
+/// <param name="ivp">问题对象</param>
+/// <param name="t0">初始时间</param>
+/// <param name="y0">y的初始值（特定不为空）</param>
+/// <param name="yp0">y’的初始值（DAE）</param>
+/// <param name="is_reinit">是否重新初始化（保留）：保留步长</param>
+/// <param name="reserve">保留参数，暂不使用</param>
+/// <returns></returns>
+MwsInteger myPirkInit(MwsIVPSolverObj solver, MwsIVPObj ivp, MwsReal t0, const MwsReal* y0,
+    const MwsReal* yp0, MwsBoolean is_reinit, void* reserve)
+{
+    MyPirkProblem* spw = (MyPirkProblem*)ivp;
+    MyPirkProblemData* ds = spw->m_data;
+    MoSize nState = spw->m_nStates;
+
+    ds->m_curTime = t0;
+    ds->m_preTime = t0;
+    if (!is_reinit)
+    {
+        ds->m_h = 0;
+    }
+
+    if (nState == 0 || y0 == mwsNullPtr)
+    {
+        ds->m_ypValid = moFalse;
+        return MWS_IVP_SUCCESS;
+    }
+
+    memcpy(ds->m_curY, y0, nState * sizeof(MoReal));
+    memcpy(ds->m_preY, y0, nState * sizeof(MoReal));
+    if (spw->m_callback.m_rshFunction(spw->m_userData, t0, ds->m_curY, ds->m_curYp) != MWS_IVP_SUCCESS)
+    {
+        ds->m_ypValid = moFalse;
+        return MWS_IVP_RHSFN_FAIL;
+    }
+    memcpy(ds->m_preYp, ds->m_curYp, nState * sizeof(MoReal));
+    ds->m_ypValid = moTrue;
+
+    return MWS_IVP_SUCCESS;
+}
+
+/// <summary>
+/// 求解：每次调用前进一个被接受的积分步，误差超限时在内部缩小步长重试
+/// </summary>
+/// 输入：
+/// <param name="solver">积分算法对象</param>
+/// <param name="ivp">问题对象</param>
+/// <param name="step_size">初始积分步长（仅首步使用，<=0时自动选择）</param>
+/// <param name="t">当前时间</param>
+/// <param name="tout">输出结果时间</param>
+/// 输出：
+/// <param name="tret">结果实际达到的时间</param>
+/// <param name="yret">y的结果值（输入为当前y）</param>
+/// <param name="ypret">y’的结果值（可为空）</param>
+/// <param name="reserve">保留参数，暂不使用</param>
+/// <returns></returns>
+MwsInteger myPirkSolve(MwsIVPSolverObj solver, MwsIVPObj ivp, MwsReal step_size, MwsReal t,
+    MwsReal tout, MwsReal* tret, MwsReal* yret, MwsReal* ypret, void* reserve)
+{
+    MyPirkProblem* spw = (MyPirkProblem*)ivp;
+    MyPirkProblemData* ds = spw->m_data;
+
+    MoSize n = spw->m_nStates;
+    MoSize index;
+    MoInteger i, j, m;
+
+    MoReal* preY = ds->m_preY;
+    MoReal* curY = ds->m_curY;
+    MoReal* f0 = ds->m_preYp;
+    MoReal* Y = ds->m_stageY;
+    MoReal* K = ds->m_stageK;
+
+    MoReal rtol = myIVPRelTol(&spw->m_opt);
+    MoReal atol = myIVPAbsTol(&spw->m_opt);
+    MoReal h = ds->m_h;
+    MoReal tStage[MY_PIRK_STAGES];
+    MoReal errNorm = 0;
+    MoBoolean rejected = moFalse;
+
+    if (spw->m_opt.m_stopTimeDefined && t >= spw->m_opt.m_stopTime)
+    {
+        *tret = t;
+        return MWS_IVP_TSTOP_RETURN;
+    }
+
+    memcpy(preY, yret, n * sizeof(MoReal));
+    if (ds->m_ypValid && t == ds->m_curTime)
+    {
+        memcpy(f0, ds->m_curYp, n * sizeof(MoReal));
+    }
+    else if (n > 0 && spw->m_callback.m_rshFunction(spw->m_userData, t, preY, f0) != MWS_IVP_SUCCESS)
+    {
+        return MWS_IVP_RHSFN_FAIL;
+    }
+    ds->m_ypValid = moFalse;
+
+    if (h <= 0)
+    {
+        h = step_size;
+        if (h <= 0 && myIVPInitialStep(&spw->m_callback, spw->m_userData, n, t, preY, f0, rtol, atol, MY_PIRK_ORDER - 1,
+            myIVPMaxStep(&spw->m_opt), Y, K, &h) != MWS_IVP_SUCCESS)
+        {
+            return MWS_IVP_RHSFN_FAIL;
+        }
+    }
+
+    for (;;)
+    {
+        MY_IVP_TRACE_BEGIN(attempt)
+
+        h = myIVPClampStep(&spw->m_opt, t, h);
+        if (h < myIVPMinStep(t))
+        {
+            return MWS_IVP_FAIL;    /* 步长过小 */
+        }
+
+        for (i = 0; i < MY_PIRK_STAGES; ++i)
+        {
+            tStage[i] = t + s_pirkC[i] * h;
+            memcpy(K + i * n, f0, n * sizeof(MoReal));
+        }
+
+        for (m = 1; m <= MY_PIRK_ITERS; ++m)
+        {
+            for (i = 0; i < MY_PIRK_STAGES; ++i)
+            {
+                for (index = 0; index < n; ++index)
+                {
+                    MoReal sum = 0;
+                    for (j = 0; j < MY_PIRK_STAGES; ++j)
+                    {
+                        sum += s_pirkA[i][j] * K[j * n + index];
+                    }
+                    Y[i * n + index] = preY[index] + h * sum;
+                }
+            }
+            if (m == MY_PIRK_ITERS)
+            {
+                /* 最后一次迭代前的K给出 y^(M-1) */
+                for (index = 0; index < n; ++index)
+                {
+                    MoReal sum = 0;
+                    for (j = 0; j < MY_PIRK_STAGES; ++j)
+                    {
+                        sum += s_pirkB[j] * K[j * n + index];
+                    }
+                    ds->m_yLow[index] = preY[index] + h * sum;
+                }
+            }
+            if (n > 0 && myIVPRhsBatch(&spw->m_callback, spw->m_userData, n, MY_PIRK_STAGES, tStage, Y, K,
+                ds->m_threads) != MWS_IVP_SUCCESS)
+            {
+                return MWS_IVP_RHSFN_FAIL;
+            }
+        }
+
+        /* y^(M)，误差 y^(M) - y^(M-1) 借用 m_yLow 存放 */
+        for (index = 0; index < n; ++index)
+        {
+            MoReal sum = 0;
+            for (j = 0; j < MY_PIRK_STAGES; ++j)
+            {
+                sum += s_pirkB[j] * K[j * n + index];
+            }
+            curY[index] = preY[index] + h * sum;
+            ds->m_yLow[index] = curY[index] - ds->m_yLow[index];
+        }
+        errNorm = myIVPErrorNorm(n, ds->m_yLow, preY, curY, rtol, atol);
+
+        if (errNorm <= 1)
+        {
+            MY_IVP_TRACE_END(MY_IVP_TRACE_STEP, attempt);
+            break;
+        }
+        h *= myIVPStepFactor(errNorm, MY_PIRK_ORDER - 1);
+        rejected = moTrue;
+        MY_IVP_TRACE_END(MY_IVP_TRACE_REJECT, attempt);
+    }
+
+    /* 步末导数：稠密输出与下一步的 K^(0) 共用 */
+    if (n > 0 && spw->m_callback.m_rshFunction(spw->m_userData, t + h, curY, ds->m_curYp) != MWS_IVP_SUCCESS)
+    {
+        return MWS_IVP_RHSFN_FAIL;
+    }
+
+    ds->m_preTime = t;
+    ds->m_curTime = t + h;
+    ds->m_ypValid = moTrue;
+
+    /* 刚被拒绝过的步不再放大步长 */
+    if (rejected)
+    {
+        ds->m_h = h * (myIVPStepFactor(errNorm, MY_PIRK_ORDER - 1) < 1 ? myIVPStepFactor(errNorm, MY_PIRK_ORDER - 1) : 1);
+    }
+    else
+    {
+        ds->m_h = h * myIVPStepFactor(errNorm, MY_PIRK_ORDER - 1);
+    }
+
+    memcpy(yret, curY, n * sizeof(MoReal));
+    if (ypret)
+    {
+        memcpy(ypret, ds->m_curYp, n * sizeof(MoReal));
+    }
+    *tret = ds->m_curTime;
+
+    return MWS_IVP_SUCCESS;
+}
+
+/// <summary>
+/// 插值：用步两端的 y 与 y' 做三次Hermite插值
+/// </summary>
+/// 输入：
+/// <param name="solver">积分算法对象</param>
+/// <param name="ivp">问题对象</param>
+/// <param name="tout">输出结果的时间</param>
+/// 输出：
+/// <param name="yret">y的结果值</param>
+/// <param name="reserve"></param>
+/// <returns></returns>
+MwsInteger myPirkInterpolate(MwsIVPSolverObj solver, MwsIVPObj ivp, MwsReal tout, MwsReal* yret, void* reserve)
+{
+    MyPirkProblem* spw = (MyPirkProblem*)ivp;
+    MyPirkProblemData* ds = spw->m_data;
+    MoReal h = ds->m_curTime - ds->m_preTime;
+
+    if (h == 0)
+    {
+        memcpy(yret, ds->m_curY, spw->m_nStates * sizeof(MoReal));
+        return MWS_IVP_SUCCESS;
+    }
+
+    myIVPHermite(spw->m_nStates, (tout - ds->m_preTime) / h, h, ds->m_preY, ds->m_curY,
+        ds->m_preYp, ds->m_curYp, yret);
+
+    return MWS_IVP_SUCCESS;
+}
+
+/// <summary>
+/// 销毁问题
+/// </summary>
+/// <param name="solver"></param>
+/// <param name="ivp"></param>
+void myPirkProblemDestroy(MwsIVPSolverObj solver, MwsIVPObj ivp)
+{
+    MyPirk* sw = (MyPirk*)solver;
+    MyPirkProblem* spw = (MyPirkProblem*)ivp;
+
+    if (spw)
+    {
+        if (spw->m_data->m_preY)
+        {
+            (*sw->m_utils.m_freeDataMemory)(sw->m_userData, spw->m_data->m_preY);
+        }
+
+        if (spw->m_data->m_stageY)
+        {
+            (*sw->m_utils.m_freeDataMemory)(sw->m_userData, spw->m_data->m_stageY);
+        }
+
+        if (spw->m_data)
+        {
+            (*sw->m_utils.m_freeDataMemory)(sw->m_userData, spw->m_data);
+        }
+
+        (*sw->m_utils.m_freeMemory)(sw->m_userData, spw);
+    }
+}
+
+/// <summary>
+/// 销毁积分算法
+/// </summary>
+/// <param name="solver"></param>
+void myPirkDestroy(MwsIVPSolverObj solver)
+{
+    MyPirk* sw = (MyPirk*)solver;
+
+    if (sw)
+    {
+        (*sw->m_utils.m_freeMemory)(sw->m_userData, sw);
+    }
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+
+/***************************************************************************
+//   end of file
+***************************************************************************/
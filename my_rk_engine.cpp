@@ -0,0 +1,128 @@
+/***************************************************************************
+///
+/// Copyright (c) 2020, 苏州同元软控信息技术有限公司
+/// All rights reserved.
+///
+/// @file           my_rk_engine.cpp
+/// @brief          显式Runge-Kutta引擎的C接口：按方法编号分派到编译期展开的单步函数
+///
+/// @version        v1.0
+/// @author         田显钊
+/// @date           2020/07/07
+///
+***************************************************************************/
+
+#include "my_rk_engine.h"
+#include "my_rk_engine.hpp"
+
+namespace
+{
+
+typedef MwsInteger (*MyRKStepPtr)(const myrk::RhsF64& rhs, MoSize n, MoReal t, MoReal h, const MoReal* y0,
+    const MoReal* f0, MoReal* y1, MoReal* err, const MoReal* comp0, MoReal* comp1, MoReal* work);
+typedef MwsInteger (*MyRKSensStepPtr)(MyRKSensRhsPtr rhs, void* data, MoSize n, MoSize ns, MoReal t, MoReal h,
+    const MoReal* y0, const MoReal* k, const MoReal* s0, const MoReal* ks0, MoReal* s1, MoReal* swork);
+typedef MwsInteger (*MyRKAdjStepPtr)(MyRKAdjRhsPtr rhs, void* data, MoSize n, MoReal t, MoReal h, const MoReal* y0,
+    const MoReal* k, const MoReal* lambda1, MoReal* lambda0, MoReal* work);
+typedef MwsInteger (*MyRKStepF32Ptr)(const myrk::RhsF32& rhs, MoSize n, MoReal t, MoReal h, const float* y0,
+    const float* f0, float* y1, float* err, const float* comp0, float* comp1, float* work);
+
+/* 方法表的一行：双精度、单精度单步函数、灵敏度与伴随单步函数及方法信息均由Butcher表生成 */
+struct MyRKEntry
+{
+    MyRKStepPtr     m_step;
+    MyRKStepF32Ptr  m_stepF32;
+    MyRKSensStepPtr m_sensStep;
+    MyRKAdjStepPtr  m_adjStep;
+    MyRKEngineInfo  m_info;
+};
+
+template <class T>
+constexpr MyRKEntry myRKEntry(const char* name)
+{
+    static_assert(T::kStages <= MY_RK_MAX_STAGES, "MY_RK_MAX_STAGES is too small");
+    static_assert(myrk::checkTableau<T>(), "inconsistent Butcher tableau");
+    return MyRKEntry{ &myrk::step<T, MoReal, myrk::RhsF64>, &myrk::step<T, float, myrk::RhsF32>, &myrk::sensStep<T>, &myrk::adjointStep<T>, { name, T::kStages, T::kOrder, T::kErrOrder, T::kFsal ? moTrue : moFalse } };
+}
+
+/* 顺序与 MyRKMethod 一致 */
+const MyRKEntry s_methods[] = {
+    myRKEntry<myrk::Fehlberg45>("Fehlberg45"),
+    myRKEntry<myrk::DormandPrince54>("DormandPrince54"),
+    myRKEntry<myrk::CashKarp54>("CashKarp54"),
+    myRKEntry<myrk::BogackiShampine32>("BogackiShampine32"),
+    myRKEntry<myrk::Euler1>("Euler1"),
+    myRKEntry<myrk::Heun2>("Heun2"),
+    myRKEntry<myrk::Classic4>("Classic4"),
+};
+
+static_assert(sizeof(s_methods) / sizeof(s_methods[0]) == MY_RK_METHOD_COUNT, "method table does not match MyRKMethod");
+
+} /* namespace */
+
+extern "C" {
+
+const MyRKEngineInfo* myRKEngineGetInfo(MoInteger method)
+{
+    if (method < 0 || method >= MY_RK_METHOD_COUNT)
+    {
+        return mwsNullPtr;
+    }
+    return &s_methods[method].m_info;
+}
+
+MwsInteger myRKEngineStep(MoInteger method, const MwsIVPCallback* cb, void* user_data, MoSize n,
+    MoReal t, MoReal h, const MoReal* y0, const MoReal* f0, MoReal* y1, MoReal* err, MoReal* work)
+{
+    myrk::RhsF64 rhs = { cb, user_data };
+
+    if (method < 0 || method >= MY_RK_METHOD_COUNT)
+    {
+        return MWS_IVP_INVALID_INPUT;
+    }
+    return s_methods[method].m_step(rhs, n, t, h, y0, f0, y1, err, mwsNullPtr, mwsNullPtr, work);
+}
+
+MwsInteger myRKEngineSensStep(MoInteger method, MyRKSensRhsPtr rhs, void* sens_data, MoSize n, MoSize ns,
+    MoReal t, MoReal h, const MoReal* y0, const MoReal* k, const MoReal* s0, const MoReal* ks0, MoReal* s1,
+    MoReal* swork)
+{
+    if (method < 0 || method >= MY_RK_METHOD_COUNT)
+    {
+        return MWS_IVP_INVALID_INPUT;
+    }
+    return s_methods[method].m_sensStep(rhs, sens_data, n, ns, t, h, y0, k, s0, ks0, s1, swork);
+}
+
+MwsInteger myRKEngineAdjointStep(MoInteger method, MyRKAdjRhsPtr rhs, void* adj_data, MoSize n, MoReal t, MoReal h,
+    const MoReal* y0, const MoReal* k, const MoReal* lambda1, MoReal* lambda0, MoReal* work)
+{
+    if (method < 0 || method >= MY_RK_METHOD_COUNT || lambda0 == lambda1)
+    {
+        return MWS_IVP_INVALID_INPUT;
+    }
+    return s_methods[method].m_adjStep(rhs, adj_data, n, t, h, y0, k, lambda1, lambda0, work);
+}
+
+MwsInteger myRKEngineStepF32(MoInteger method, const MyRKRhsF32* rhs, MoSize n, MoReal t, MoReal h,
+    const float* y0, const float* f0, float* y1, float* err, const float* comp0, float* comp1, float* work)
+{
+    myrk::RhsF32 f = { rhs };
+
+    if (method < 0 || method >= MY_RK_METHOD_COUNT)
+    {
+        return MWS_IVP_INVALID_INPUT;
+    }
+    return s_methods[method].m_stepF32(f, n, t, h, y0, f0, y1, err, comp0, comp1, work);
+}
+
+MwsInteger myRKRhsF32Eval(const MyRKRhsF32* rhs, MoSize n, MoReal t, const float* y, float* yp)
+{
+    return myrk::evalF32(rhs, n, t, y, yp);
+}
+
+} /* extern "C" */
+
+/***************************************************************************
+//   end of file
+***************************************************************************/
@@ -0,0 +1,191 @@
+/***************************************************************************
+///
+/// Copyright (c) 2020, 苏州同元软控信息技术有限公司
+/// All rights reserved.
+///
+/// @file           my_rk_engine.h
+/// @brief          显式Runge-Kutta通用单步引擎的C接口（实现见 my_rk_engine.cpp，须一并编译进插件）
+///
+/// @version        v1.0
+/// @author         田显钊
+/// @date           2020/07/07
+///
+***************************************************************************/
+
+#ifndef MY_RK_ENGINE_H
+#define MY_RK_ENGINE_H
+
+#include "mo_types.h"
+#include "mws_ivp_solver.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * 引擎内置的嵌入式方法，Butcher表见 my_rk_engine.hpp
+ * 新增方法：在 my_rk_engine.hpp 中写一张表，在此处加一个枚举值，在 my_rk_engine.cpp 的方法表中加一行
+ */
+typedef enum
+{
+    MY_RK_FEHLBERG45 = 0,       /* Fehlberg 4(5)，推进5阶解（局部外推） */
+    MY_RK_DORMAND_PRINCE54,     /* Dormand-Prince 5(4)，FSAL */
+    MY_RK_CASH_KARP54,          /* Cash-Karp 5(4) */
+    MY_RK_BOGACKI_SHAMPINE32,   /* Bogacki-Shampine 3(2)，FSAL */
+    MY_RK_EULER1,               /* 显式欧拉，定步长（无误差估计，m_errOrder为0） */
+    MY_RK_HEUN2,                /* Heun，定步长 */
+    MY_RK_CLASSIC4,             /* 经典4阶龙格库塔，定步长 */
+    MY_RK_METHOD_COUNT
+} MyRKMethod;
+
+#define MY_RK_MAX_STAGES    7   /* 内置方法的最大级数，用于预分配工作区 */
+
+/* 方法信息 */
+typedef struct
+{
+    const char* m_name;
+    MoInteger   m_stages;       /* 级数s */
+    MoInteger   m_order;        /* 推进解的阶数 */
+    MoInteger   m_errOrder;     /* 嵌入解的阶数，步长控制用；0表示定步长方法 */
+    MoBoolean   m_fsal;         /* 最后一级即 f(t+h,y1)，可作为下一步的第1级 */
+} MyRKEngineInfo;
+
+/* 单精度右端函数，时间仍为双精度；user_data 与 MwsIVPCallback 的相同 */
+typedef MwsInteger (*MyRKRhsF32Ptr)(void* user_data, MoReal t, const float* y, float* yp);
+
+/*
+ * 单精度模式下右端函数的调用方式：
+ *  m_native 非空时直接调用；否则把y转换为双精度写入 m_shim（长度2n，前n为y、后n为y'），
+ *  调用 m_callback->m_rshFunction 后再把y'转换回单精度
+ */
+typedef struct
+{
+    MyRKRhsF32Ptr           m_native;
+    const MwsIVPCallback*   m_callback;
+    void*                   m_userData;
+    MoReal*                 m_shim;
+} MyRKRhsF32;
+
+/*
+ * 灵敏度方程的右端函数：ks = J(t,y)*s + df/dp，s、ks 为按参数分段的矩阵（第j段长度n，共ns=n*np个元素）
+ * f 为 f(t,y)，即状态的同一级，供差商使用；sens_data 由调用方透传
+ */
+typedef MwsInteger (*MyRKSensRhsPtr)(void* sens_data, MoReal t, const MoReal* y, const MoReal* f, const MoReal* s,
+    MoReal* ks);
+
+/*
+ * 伴随方程的级函数：nu = J(t,y)^T * kappa，同时由调用方累加参数梯度 (df/dp)^T * kappa
+ * f 为 f(t,y)，即正向的同一级；adj_data 由调用方透传
+ */
+typedef MwsInteger (*MyRKAdjRhsPtr)(void* adj_data, MoReal t, const MoReal* y, const MoReal* f, const MoReal* kappa,
+    MoReal* nu);
+
+/// <summary>
+/// 查询方法信息
+/// </summary>
+/// <param name="method">MyRKMethod的值</param>
+/// <returns>方法不存在时返回空</returns>
+const MyRKEngineInfo* myRKEngineGetInfo(MoInteger method);
+
+/// <summary>
+/// 试算一步：y1 = y0 + h*sum(b_i*k_i)，err = h*sum(e_i*k_i)，e = b - b^
+/// </summary>
+/// 输入：
+/// <param name="method">MyRKMethod的值</param>
+/// <param name="cb">回调函数</param>
+/// <param name="user_data">传递给回调函数的用户数据</param>
+/// <param name="n">状态变量数量</param>
+/// <param name="t">步起点时间</param>
+/// <param name="h">步长</param>
+/// <param name="y0">步起点的y</param>
+/// <param name="f0">f(t,y0)，即第1级</param>
+/// 输出：
+/// <param name="y1">推进解</param>
+/// <param name="err">局部误差估计（可为空）</param>
+/// <param name="work">工作区，长度(s+1)*n；返回后前s段依次为各级 k_i，FSAL方法的第s段即 f(t+h,y1)</param>
+/// <returns>状态，取MwsIVPStatus的值</returns>
+MwsInteger myRKEngineStep(MoInteger method, const MwsIVPCallback* cb, void* user_data, MoSize n,
+    MoReal t, MoReal h, const MoReal* y0, const MoReal* f0, MoReal* y1, MoReal* err, MoReal* work);
+
+/// <summary>
+/// 灵敏度随已接受的状态步推进一步（交错法）：第i级 Y_i、S_i 由同一张Butcher表组合，
+/// ks_i = rhs(t+c_i*h, Y_i, k_i, S_i)，s1 = s0 + h*sum(b_i*ks_i)；状态各级 k_i 直接复用，不再计算右端函数
+/// </summary>
+/// 输入：
+/// <param name="method">MyRKMethod的值，与状态步相同</param>
+/// <param name="rhs">灵敏度方程的右端函数</param>
+/// <param name="sens_data">传递给rhs的数据</param>
+/// <param name="n">状态变量数量</param>
+/// <param name="ns">灵敏度元素数量 n*np</param>
+/// <param name="t">步起点时间</param>
+/// <param name="h">步长</param>
+/// <param name="y0">步起点的y</param>
+/// <param name="k">状态步返回后工作区的前s段，即各级 k_i</param>
+/// <param name="s0">步起点的灵敏度</param>
+/// <param name="ks0">rhs(t, y0, k_0, s0)，即第1级</param>
+/// 输出：
+/// <param name="s1">步终点的灵敏度</param>
+/// <param name="swork">工作区，长度(s+1)*ns+n；返回后前s段依次为各级 ks_i，FSAL方法的第s段即终点的灵敏度导数</param>
+/// <returns>状态，取MwsIVPStatus的值</returns>
+MwsInteger myRKEngineSensStep(MoInteger method, MyRKSensRhsPtr rhs, void* sens_data, MoSize n, MoSize ns,
+    MoReal t, MoReal h, const MoReal* y0, const MoReal* k, const MoReal* s0, const MoReal* ks0, MoReal* s1,
+    MoReal* swork);
+
+/// <summary>
+/// 离散伴随反推一步：已知 lambda1 = dL/dy1，求 lambda0 = dL/dy0。
+/// 按 i = s-1..0：kappa_i = h*(b_i*lambda1 + sum(j>i, a_ji*nu_j))，nu_i = rhs(t+c_i*h, Y_i, k_i, kappa_i)，
+/// lambda0 = lambda1 + sum(nu_i)；Y_i 由 y0 与 k 重建，不再调用右端函数
+/// </summary>
+/// 输入：
+/// <param name="method">MyRKMethod的值，与正向步相同</param>
+/// <param name="rhs">伴随级函数</param>
+/// <param name="adj_data">传递给rhs的数据</param>
+/// <param name="n">状态变量数量</param>
+/// <param name="t">步起点时间</param>
+/// <param name="h">步长</param>
+/// <param name="y0">步起点的y</param>
+/// <param name="k">以同一步长重算正向步后工作区的前s段，即各级 k_i</param>
+/// <param name="lambda1">步终点的伴随变量</param>
+/// 输出：
+/// <param name="lambda0">步起点的伴随变量（不能与lambda1相同）</param>
+/// <param name="work">工作区，长度(s+2)*n</param>
+/// <returns>状态，取MwsIVPStatus的值</returns>
+MwsInteger myRKEngineAdjointStep(MoInteger method, MyRKAdjRhsPtr rhs, void* adj_data, MoSize n, MoReal t, MoReal h,
+    const MoReal* y0, const MoReal* k, const MoReal* lambda1, MoReal* lambda0, MoReal* work);
+
+/// <summary>
+/// 单精度试算一步：状态、各级与误差为float，时间与步长为double
+/// </summary>
+/// 输入：
+/// <param name="method">MyRKMethod的值</param>
+/// <param name="rhs">单精度右端函数</param>
+/// <param name="n">状态变量数量</param>
+/// <param name="t">步起点时间</param>
+/// <param name="h">步长</param>
+/// <param name="y0">步起点的y</param>
+/// <param name="f0">f(t,y0)，即第1级</param>
+/// <param name="comp0">补偿求和的舍入误差（可为空，为空时不补偿）</param>
+/// 输出：
+/// <param name="y1">推进解</param>
+/// <param name="err">局部误差估计（可为空）</param>
+/// <param name="comp1">本步的舍入误差，步被接受后由调用方替换comp0（comp0为空时不使用）</param>
+/// <param name="work">工作区，长度(s+1)*n，内容同 myRKEngineStep</param>
+/// <returns>状态，取MwsIVPStatus的值</returns>
+MwsInteger myRKEngineStepF32(MoInteger method, const MyRKRhsF32* rhs, MoSize n, MoReal t, MoReal h,
+    const float* y0, const float* f0, float* y1, float* err, const float* comp0, float* comp1, float* work);
+
+/// <summary>
+/// 按 MyRKRhsF32 的约定计算一次单精度右端函数
+/// </summary>
+/// <returns>状态，取MwsIVPStatus的值</returns>
+MwsInteger myRKRhsF32Eval(const MyRKRhsF32* rhs, MoSize n, MoReal t, const float* y, float* yp);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* !MY_RK_ENGINE_H */
+
+/***************************************************************************
+//   end of file
+***************************************************************************/
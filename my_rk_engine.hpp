@@ -0,0 +1,506 @@
+/***************************************************************************
+///
+/// Copyright (c) 2020, 苏州同元软控信息技术有限公司
+/// All rights reserved.
+///
+/// @file           my_rk_engine.hpp
+/// @brief          显式Runge-Kutta引擎：Butcher表与编译期展开的级循环（C++17）
+///
+/// @version        v1.0
+/// @author         田显钊
+/// @date           2020/07/07
+///
+***************************************************************************/
+
+#ifndef MY_RK_ENGINE_HPP
+#define MY_RK_ENGINE_HPP
+
+#include "mo_types.h"
+#include "mws_ivp_solver.h"
+#include "my_rk_engine.h"
+
+#include <cstring>
+#include <utility>
+
+namespace myrk
+{
+
+/*
+ * Butcher表约定：
+ *  kStages、kOrder、kErrOrder、kFsal 与 MyRKEngineInfo 对应；
+ *  c[i]、a[i][j]（j<i，其余为0）、b[i] 为推进解系数，e[i] = b[i] - b^[i] 为误差系数。
+ * 系数一律写成浮点字面量之比（如 25.0 / 216），避免整数除法；
+ * checkTableau 在编译期检查 sum(a[i]) == c[i]、sum(b) == 1、sum(e) == 0。
+ */
+
+/* Fehlberg 4(5)（Hairer, Norsett, Wanner, Solving ODE I, II.5, 表5.1），推进5阶解 */
+struct Fehlberg45
+{
+    static constexpr int kStages = 6;
+    static constexpr int kOrder = 5;
+    static constexpr int kErrOrder = 4;
+    static constexpr bool kFsal = false;
+
+    static constexpr double c[kStages] = { 0, 1.0 / 4, 3.0 / 8, 12.0 / 13, 1, 1.0 / 2 };
+    static constexpr double a[kStages][kStages] = {
+        { 0 },
+        { 1.0 / 4 },
+        { 3.0 / 32, 9.0 / 32 },
+        { 1932.0 / 2197, -7200.0 / 2197, 7296.0 / 2197 },
+        { 439.0 / 216, -8, 3680.0 / 513, -845.0 / 4104 },
+        { -8.0 / 27, 2, -3544.0 / 2565, 1859.0 / 4104, -11.0 / 40 } };
+    static constexpr double b[kStages] = { 16.0 / 135, 0, 6656.0 / 12825, 28561.0 / 56430, -9.0 / 50, 2.0 / 55 };
+    static constexpr double e[kStages] = { 1.0 / 360, 0, -128.0 / 4275, -2197.0 / 75240, 1.0 / 50, 2.0 / 55 };
+};
+
+/* Dormand-Prince 5(4)（Dormand, Prince, 1980），第7级与推进解同点，FSAL */
+struct DormandPrince54
+{
+    static constexpr int kStages = 7;
+    static constexpr int kOrder = 5;
+    static constexpr int kErrOrder = 4;
+    static constexpr bool kFsal = true;
+
+    static constexpr double c[kStages] = { 0, 1.0 / 5, 3.0 / 10, 4.0 / 5, 8.0 / 9, 1, 1 };
+    static constexpr double a[kStages][kStages] = {
+        { 0 },
+        { 1.0 / 5 },
+        { 3.0 / 40, 9.0 / 40 },
+        { 44.0 / 45, -56.0 / 15, 32.0 / 9 },
+        { 19372.0 / 6561, -25360.0 / 2187, 64448.0 / 6561, -212.0 / 729 },
+        { 9017.0 / 3168, -355.0 / 33, 46732.0 / 5247, 49.0 / 176, -5103.0 / 18656 },
+        { 35.0 / 384, 0, 500.0 / 1113, 125.0 / 192, -2187.0 / 6784, 11.0 / 84 } };
+    static constexpr double b[kStages] = { 35.0 / 384, 0, 500.0 / 1113, 125.0 / 192, -2187.0 / 6784, 11.0 / 84, 0 };
+    static constexpr double e[kStages] = { 71.0 / 57600, 0, -71.0 / 16695, 71.0 / 1920, -17253.0 / 339200,
+        22.0 / 525, -1.0 / 40 };
+};
+
+/* Cash-Karp 5(4)（Cash, Karp, 1990），推进5阶解 */
+struct CashKarp54
+{
+    static constexpr int kStages = 6;
+    static constexpr int kOrder = 5;
+    static constexpr int kErrOrder = 4;
+    static constexpr bool kFsal = false;
+
+    static constexpr double c[kStages] = { 0, 1.0 / 5, 3.0 / 10, 3.0 / 5, 1, 7.0 / 8 };
+    static constexpr double a[kStages][kStages] = {
+        { 0 },
+        { 1.0 / 5 },
+        { 3.0 / 40, 9.0 / 40 },
+        { 3.0 / 10, -9.0 / 10, 6.0 / 5 },
+        { -11.0 / 54, 5.0 / 2, -70.0 / 27, 35.0 / 27 },
+        { 1631.0 / 55296, 175.0 / 512, 575.0 / 13824, 44275.0 / 110592, 253.0 / 4096 } };
+    static constexpr double b[kStages] = { 37.0 / 378, 0, 250.0 / 621, 125.0 / 594, 0, 512.0 / 1771 };
+    static constexpr double e[kStages] = { 37.0 / 378 - 2825.0 / 27648, 0, 250.0 / 621 - 18575.0 / 48384,
+        125.0 / 594 - 13525.0 / 55296, -277.0 / 14336, 512.0 / 1771 - 1.0 / 4 };
+};
+
+/* Bogacki-Shampine 3(2)，与 my_ivp_common.h 中 MY_BS23_* 为同一张表 */
+struct BogackiShampine32
+{
+    static constexpr int kStages = 4;
+    static constexpr int kOrder = 3;
+    static constexpr int kErrOrder = 2;
+    static constexpr bool kFsal = true;
+
+    static constexpr double c[kStages] = { 0, 1.0 / 2, 3.0 / 4, 1 };
+    static constexpr double a[kStages][kStages] = {
+        { 0 },
+        { 1.0 / 2 },
+        { 0, 3.0 / 4 },
+        { 2.0 / 9, 1.0 / 3, 4.0 / 9 } };
+    static constexpr double b[kStages] = { 2.0 / 9, 1.0 / 3, 4.0 / 9, 0 };
+    static constexpr double e[kStages] = { -5.0 / 72, 1.0 / 12, 1.0 / 9, -1.0 / 8 };
+};
+
+/*
+ * 定步长方法（无嵌入解，e全为0，kErrOrder为0），供 myEuler 的单精度模式使用；
+ * 不能用于变步长的 myRK45
+ */
+struct Euler1
+{
+    static constexpr int kStages = 1;
+    static constexpr int kOrder = 1;
+    static constexpr int kErrOrder = 0;
+    static constexpr bool kFsal = false;
+
+    static constexpr double c[kStages] = { 0 };
+    static constexpr double a[kStages][kStages] = { { 0 } };
+    static constexpr double b[kStages] = { 1 };
+    static constexpr double e[kStages] = { 0 };
+};
+
+struct Heun2
+{
+    static constexpr int kStages = 2;
+    static constexpr int kOrder = 2;
+    static constexpr int kErrOrder = 0;
+    static constexpr bool kFsal = false;
+
+    static constexpr double c[kStages] = { 0, 1 };
+    static constexpr double a[kStages][kStages] = { { 0 }, { 1 } };
+    static constexpr double b[kStages] = { 1.0 / 2, 1.0 / 2 };
+    static constexpr double e[kStages] = { 0, 0 };
+};
+
+struct Classic4
+{
+    static constexpr int kStages = 4;
+    static constexpr int kOrder = 4;
+    static constexpr int kErrOrder = 0;
+    static constexpr bool kFsal = false;
+
+    static constexpr double c[kStages] = { 0, 1.0 / 2, 1.0 / 2, 1 };
+    static constexpr double a[kStages][kStages] = {
+        { 0 },
+        { 1.0 / 2 },
+        { 0, 1.0 / 2 },
+        { 0, 0, 1 } };
+    static constexpr double b[kStages] = { 1.0 / 6, 1.0 / 3, 1.0 / 3, 1.0 / 6 };
+    static constexpr double e[kStages] = { 0, 0, 0, 0 };
+};
+
+/* 系数行：A行取 a[I][0..I-1]，B行取 b，E行取 e */
+template <class T, int I>
+struct RowA
+{
+    static constexpr int kLen = I;
+    static constexpr double at(int j) { return T::a[I][j]; }
+};
+
+template <class T>
+struct RowB
+{
+    static constexpr int kLen = T::kStages;
+    static constexpr double at(int j) { return T::b[j]; }
+};
+
+template <class T>
+struct RowE
+{
+    static constexpr int kLen = T::kStages;
+    static constexpr double at(int j) { return T::e[j]; }
+};
+
+/* 从j起第一个非零系数的下标，没有时返回kLen */
+template <class Row>
+constexpr int nextNonzero(int j)
+{
+    while (j < Row::kLen && Row::at(j) == 0)
+    {
+        ++j;
+    }
+    return j;
+}
+
+/*
+ * sum(Row[j]*k_j)，j从非零系数J起；零系数在编译期剔除，系数作为常量直接嵌入指令。
+ * S为状态的标量类型（double 或 float），系数在编译期转换为S
+ */
+template <class Row, int J, class S>
+inline S dot(const S* k, MoSize n, MoSize index)
+{
+    constexpr int next = nextNonzero<Row>(J + 1);
+    constexpr S coef = static_cast<S>(Row::at(J));
+    if constexpr (next >= Row::kLen)
+    {
+        return coef * k[J * n + index];
+    }
+    else
+    {
+        return coef * k[J * n + index] + dot<Row, next>(k, n, index);
+    }
+}
+
+/* out = y0 + h*sum(Row[j]*k_j)；系数全为零时 out = y0 */
+template <class Row, class S>
+inline void combine(MoSize n, S h, const S* y0, const S* k, S* out)
+{
+    constexpr int first = nextNonzero<Row>(0);
+    MoSize index;
+
+    if constexpr (first >= Row::kLen)
+    {
+        if (out != y0)
+        {
+            std::memcpy(out, y0, n * sizeof(S));
+        }
+    }
+    else
+    {
+        for (index = 0; index < n; ++index)
+        {
+            out[index] = y0[index] + h * dot<Row, first>(k, n, index);
+        }
+    }
+}
+
+/* 双精度右端函数：直接调用回调 */
+struct RhsF64
+{
+    const MwsIVPCallback* m_callback;
+    void* m_userData;
+
+    bool operator()(MoSize, MoReal t, const MoReal* y, MoReal* f) const
+    {
+        return m_callback->m_rshFunction(m_userData, t, y, f) == MWS_IVP_SUCCESS;
+    }
+};
+
+/* 单精度右端函数：原生float回调，或经双精度转换区调用原回调 */
+inline MwsInteger evalF32(const MyRKRhsF32* rhs, MoSize n, MoReal t, const float* y, float* f)
+{
+    MoReal* yd = rhs->m_shim;
+    MoReal* fd = rhs->m_shim + n;
+    MoSize index;
+
+    if (rhs->m_native)
+    {
+        return rhs->m_native(rhs->m_userData, t, y, f);
+    }
+    for (index = 0; index < n; ++index)
+    {
+        yd[index] = y[index];
+    }
+    if (rhs->m_callback->m_rshFunction(rhs->m_userData, t, yd, fd) != MWS_IVP_SUCCESS)
+    {
+        return MWS_IVP_RHSFN_FAIL;
+    }
+    for (index = 0; index < n; ++index)
+    {
+        f[index] = static_cast<float>(fd[index]);
+    }
+    return MWS_IVP_SUCCESS;
+}
+
+struct RhsF32
+{
+    const MyRKRhsF32* m_rhs;
+
+    bool operator()(MoSize n, MoReal t, const float* y, float* f) const
+    {
+        return evalF32(m_rhs, n, t, y, f) == MWS_IVP_SUCCESS;
+    }
+};
+
+/* 第I级（I>=1）：ytmp = y0 + h*sum(a[I][j]*k_j)，k_I = f(t + c[I]*h, ytmp)；级时间始终为双精度 */
+template <class T, int I, class S, class Rhs>
+inline bool stage(const Rhs& rhs, MoSize n, MoReal t, MoReal h, const S* y0, S* k, S* ytmp)
+{
+    if constexpr (I == 0)
+    {
+        return true;            /* 第1级即调用方给出的f0 */
+    }
+    else
+    {
+        combine<RowA<T, I> >(n, static_cast<S>(h), y0, k, ytmp);
+        return rhs(n, t + T::c[I] * h, ytmp, k + I * n);
+    }
+}
+
+/* 各级按顺序展开，&&折叠保证求值顺序并在右端函数失败时立即停止 */
+template <class T, class S, class Rhs, int... I>
+inline bool stages(const Rhs& rhs, MoSize n, MoReal t, MoReal h, const S* y0, S* k, S* ytmp,
+    std::integer_sequence<int, I...>)
+{
+    return (stage<T, I>(rhs, n, t, h, y0, k, ytmp) && ...);
+}
+
+/*
+ * 试算一步，参数含义同 myRKEngineStep / myRKEngineStepF32。
+ * comp0非空时状态更新采用Kahan补偿求和：comp0为上一步留下的舍入误差，新的误差写入comp1，
+ * 由调用方在步被接受后替换comp0（依赖严格的IEEE运算顺序，不能以 -ffast-math、/fp:fast 编译）
+ */
+template <class T, class S, class Rhs>
+MwsInteger step(const Rhs& rhs, MoSize n, MoReal t, MoReal h, const S* y0, const S* f0, S* y1, S* err,
+    const S* comp0, S* comp1, S* work)
+{
+    constexpr int firstB = nextNonzero<RowB<T> >(0);
+    constexpr int firstE = nextNonzero<RowE<T> >(0);
+    const S hs = static_cast<S>(h);
+    S* k = work;
+    S* ytmp = work + T::kStages * n;
+    MoSize index;
+
+    if (k != f0)
+    {
+        std::memcpy(k, f0, n * sizeof(S));
+    }
+    if (!stages<T, S>(rhs, n, t, h, y0, k, ytmp, std::make_integer_sequence<int, T::kStages>()))
+    {
+        return MWS_IVP_RHSFN_FAIL;
+    }
+
+    if (comp0)
+    {
+        for (index = 0; index < n; ++index)
+        {
+            S d = hs * dot<RowB<T>, firstB>(k, n, index) - comp0[index];
+            S sum = y0[index] + d;
+            comp1[index] = (sum - y0[index]) - d;
+            y1[index] = sum;
+        }
+    }
+    else
+    {
+        combine<RowB<T> >(n, hs, y0, k, y1);
+    }
+
+    if (err)
+    {
+        if constexpr (firstE >= T::kStages)
+        {
+            std::memset(err, 0, n * sizeof(S));     /* 定步长方法没有误差估计 */
+        }
+        else
+        {
+            for (index = 0; index < n; ++index)
+            {
+                err[index] = hs * dot<RowE<T>, firstE>(k, n, index);
+            }
+        }
+    }
+    return MWS_IVP_SUCCESS;
+}
+
+/* 灵敏度第I级（I>=1）：Y_I、S_I 分别由状态级k与已算出的灵敏度级ks组合 */
+template <class T, int I>
+inline bool sensStage(MyRKSensRhsPtr rhs, void* data, MoSize n, MoSize ns, MoReal t, MoReal h, const MoReal* y0,
+    const MoReal* k, const MoReal* s0, MoReal* ks, MoReal* stmp, MoReal* ytmp)
+{
+    if constexpr (I == 0)
+    {
+        return true;            /* 第1级即调用方给出的ks0 */
+    }
+    else
+    {
+        combine<RowA<T, I> >(n, h, y0, k, ytmp);
+        combine<RowA<T, I> >(ns, h, s0, ks, stmp);
+        return rhs(data, t + T::c[I] * h, ytmp, k + I * n, stmp, ks + I * ns) == MWS_IVP_SUCCESS;
+    }
+}
+
+template <class T, int... I>
+inline bool sensStages(MyRKSensRhsPtr rhs, void* data, MoSize n, MoSize ns, MoReal t, MoReal h, const MoReal* y0,
+    const MoReal* k, const MoReal* s0, MoReal* ks, MoReal* stmp, MoReal* ytmp, std::integer_sequence<int, I...>)
+{
+    return (sensStage<T, I>(rhs, data, n, ns, t, h, y0, k, s0, ks, stmp, ytmp) && ...);
+}
+
+/* 灵敏度推进一步，参数含义同 myRKEngineSensStep */
+template <class T>
+MwsInteger sensStep(MyRKSensRhsPtr rhs, void* data, MoSize n, MoSize ns, MoReal t, MoReal h, const MoReal* y0,
+    const MoReal* k, const MoReal* s0, const MoReal* ks0, MoReal* s1, MoReal* swork)
+{
+    MoReal* ks = swork;
+    MoReal* stmp = swork + T::kStages * ns;
+    MoReal* ytmp = stmp + ns;
+
+    if (ks != ks0)
+    {
+        std::memcpy(ks, ks0, ns * sizeof(MoReal));
+    }
+    if (!sensStages<T>(rhs, data, n, ns, t, h, y0, k, s0, ks, stmp, ytmp, std::make_integer_sequence<int, T::kStages>()))
+    {
+        return MWS_IVP_RHSFN_FAIL;
+    }
+    combine<RowB<T> >(ns, h, s0, ks, s1);
+    return MWS_IVP_SUCCESS;
+}
+
+/* 离散伴随反推一步，参数含义同 myRKEngineAdjointStep；各级逆序处理，只被零系数连接的级直接跳过 */
+template <class T>
+MwsInteger adjointStep(MyRKAdjRhsPtr rhs, void* data, MoSize n, MoReal t, MoReal h, const MoReal* y0,
+    const MoReal* k, const MoReal* lambda1, MoReal* lambda0, MoReal* work)
+{
+    MoReal* nu = work;
+    MoReal* kappa = work + T::kStages * n;
+    MoReal* ytmp = kappa + n;
+    MoSize index;
+
+    std::memcpy(lambda0, lambda1, n * sizeof(MoReal));
+    for (int i = T::kStages - 1; i >= 0; --i)
+    {
+        bool used = T::b[i] != 0;
+        for (int j = i + 1; j < T::kStages; ++j)
+        {
+            used = used || T::a[j][i] != 0;
+        }
+        if (!used)
+        {
+            std::memset(nu + i * n, 0, n * sizeof(MoReal));
+            continue;           /* 如FSAL方法的末级，不影响y1 */
+        }
+
+        for (index = 0; index < n; ++index)
+        {
+            MoReal sum = T::b[i] * lambda1[index];
+            for (int j = i + 1; j < T::kStages; ++j)
+            {
+                if (T::a[j][i] != 0)
+                {
+                    sum += T::a[j][i] * nu[j * n + index];
+                }
+            }
+            kappa[index] = h * sum;
+
+            sum = 0;
+            for (int j = 0; j < i; ++j)
+            {
+                if (T::a[i][j] != 0)
+                {
+                    sum += T::a[i][j] * k[j * n + index];
+                }
+            }
+            ytmp[index] = y0[index] + h * sum;
+        }
+
+        if (rhs(data, t + T::c[i] * h, ytmp, k + i * n, kappa, nu + i * n) != MWS_IVP_SUCCESS)
+        {
+            return MWS_IVP_RHSFN_FAIL;
+        }
+        for (index = 0; index < n; ++index)
+        {
+            lambda0[index] += nu[i * n + index];
+        }
+    }
+    return MWS_IVP_SUCCESS;
+}
+
+/* 编译期检查Butcher表的一致性（容差覆盖舍入误差，整数除法等抄写错误必然超出） */
+constexpr double absDiff(double x, double y)
+{
+    return x > y ? x - y : y - x;
+}
+
+template <class T>
+constexpr bool checkTableau()
+{
+    double sumB = 0;
+    double sumE = 0;
+
+    for (int i = 0; i < T::kStages; ++i)
+    {
+        double sumA = 0;
+        for (int j = 0; j < i; ++j)
+        {
+            sumA += T::a[i][j];
+        }
+        if (absDiff(sumA, T::c[i]) > 1e-14)
+        {
+            return false;
+        }
+        sumB += T::b[i];
+        sumE += T::e[i];
+    }
+    return absDiff(sumB, 1) <= 1e-14 && absDiff(sumE, 0) <= 1e-14;
+}
+
+} /* namespace myrk */
+
+#endif /* !MY_RK_ENGINE_HPP */
+
+/***************************************************************************
+//   end of file
+***************************************************************************/
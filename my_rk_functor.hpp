@@ -0,0 +1,351 @@
+/***************************************************************************
+///
+/// Copyright (c) 2020, 苏州同元软控信息技术有限公司
+/// All rights reserved.
+///
+/// @file           my_rk_functor.hpp
+/// @brief          编译期右端函数的RK积分器（仅头文件，C++17）：模型与级循环在同一编译单元内展开，
+///                 并生成可经 isimRegisterIVPSolver 注册的 MwsIVPSolverFcns
+///
+/// @version        v1.0
+/// @author         田显钊
+/// @date           2020/07/07
+///
+***************************************************************************/
+
+#ifndef MY_RK_FUNCTOR_HPP
+#define MY_RK_FUNCTOR_HPP
+
+#include "my_rk_engine.hpp"
+#include "my_ivp_common.h"
+
+#include <new>
+#include <type_traits>
+
+namespace myrk
+{
+
+/*
+ * 模型约定（函数对象或lambda的闭包类型）：
+ *   MwsInteger operator()(MoReal t, const MoReal* y, MoReal* yp) const;
+ * 注册为插件时，模型若可由 void* 构造则以问题的 ivp_user_data 构造，否则默认构造。
+ * 状态数N为编译期常量，状态、各级与误差向量都放在积分器对象内，级循环的长度对编译器可见，
+ * 小规模模型（n < 20左右）可完全展开并与模型一起向量化。
+ *
+ * 示例：
+ *   struct Oscillator
+ *   {
+ *       MwsInteger operator()(MoReal t, const MoReal* y, MoReal* yp) const
+ *       {
+ *           yp[0] = y[1];
+ *           yp[1] = -y[0];
+ *           return MWS_IVP_SUCCESS;
+ *       }
+ *   };
+ *   myrk::registerFunctorSolver<myrk::DormandPrince54, Oscillator, 2>(sim_data, "myOscDP54", "MYOSCDP54");
+ */
+
+/* 编译期右端函数：直接调用模型，可被内联 */
+template <class F>
+struct RhsFunctor
+{
+    const F* m_f;
+
+    bool operator()(MoSize, MoReal t, const MoReal* y, MoReal* f) const
+    {
+        return (*m_f)(t, y, f) == MWS_IVP_SUCCESS;
+    }
+};
+
+/* 转成回调形式，只用于初始步长估计等一次性计算 */
+template <class F>
+MwsInteger functorRhs(void* user_data, MwsReal t, const MwsReal* y, MwsReal* yp)
+{
+    return (*static_cast<const F*>(user_data))(t, y, yp);
+}
+
+/* 以问题的用户数据构造模型（可由 void* 构造时），否则默认构造 */
+template <class F>
+F makeFunctor(void* user_data)
+{
+    if constexpr (std::is_constructible<F, void*>::value)
+    {
+        return F(user_data);
+    }
+    else
+    {
+        return F();
+    }
+}
+
+/*
+ * 变步长积分器，步长控制、初始步长、FSAL与插值的约定均与 myRK45 相同（见 my_RK45.c），
+ * 只是右端函数和状态数在编译期确定
+ */
+template <class T, class F, MoSize N>
+class FunctorIntegrator
+{
+public:
+    static_assert(N > 0, "state count must be positive");
+    static_assert(T::kErrOrder > 0, "adaptive stepping needs an embedded error estimate");
+
+    FunctorIntegrator(const F& f, const MwsIVPOptions& opt)
+        : m_f(f), m_opt(opt), m_ctl(MY_IVP_CONTROLLER_DEFAULT), m_curTime(0), m_h(0), m_initialStep(0),
+          m_ypValid(false)
+    {
+    }
+
+    /* 初始化，参数含义同 myRK45Init（不区分重新初始化，步长历史一律清空） */
+    MwsInteger init(MoReal t0, const MoReal* y0)
+    {
+        std::memcpy(m_curY, y0, sizeof(m_curY));
+        std::memcpy(m_preY, y0, sizeof(m_preY));
+        m_curTime = t0;
+        if (m_f(t0, m_curY, m_curYp) != MWS_IVP_SUCCESS)
+        {
+            return MWS_IVP_RHSFN_FAIL;
+        }
+        std::memcpy(m_preYp, m_curYp, sizeof(m_preYp));
+        m_ypValid = true;
+        m_initialStep = 0;
+        m_h = 0;
+        return MWS_IVP_SUCCESS;
+    }
+
+    /* 前进一个被接受的步，参数含义同 myRK45Solve：yret输入时为当前状态 */
+    MwsInteger solve(MoReal step_size, MoReal t, MoReal* tret, MoReal* yret, MoReal* ypret)
+    {
+        const RhsFunctor<F> rhs = { &m_f };
+        MoReal rtol = myIVPRelTol(&m_opt);
+        MoReal atol = myIVPAbsTol(&m_opt);
+        MoReal h = m_h;
+        MoReal errNorm = 0;
+        MoReal factor;
+        bool rejected = false;
+
+        if (m_opt.m_stopTimeDefined && t >= m_opt.m_stopTime)
+        {
+            *tret = t;
+            return MWS_IVP_TSTOP_RETURN;
+        }
+
+        std::memcpy(m_preY, yret, sizeof(m_preY));
+        if (m_ypValid && t == m_curTime)
+        {
+            std::memcpy(m_preYp, m_curYp, sizeof(m_preYp));
+        }
+        else if (m_f(t, m_preY, m_preYp) != MWS_IVP_SUCCESS)
+        {
+            return MWS_IVP_RHSFN_FAIL;
+        }
+        m_ypValid = false;
+
+        if (h <= 0)
+        {
+            MwsIVPCallback cb = { &functorRhs<F>, mwsNullPtr, mwsNullPtr, mwsNullPtr };
+            h = step_size;
+            if (h <= 0 && myIVPInitialStep(&cb, &m_f, N, t, m_preY, m_preYp, rtol, atol, T::kErrOrder,
+                myIVPMaxStep(&m_opt), m_work, m_work + N, &h) != MWS_IVP_SUCCESS)
+            {
+                return MWS_IVP_RHSFN_FAIL;
+            }
+        }
+
+        for (;;)
+        {
+            h = myIVPClampStep(&m_opt, t, h);
+            if (h < myIVPMinStep(t))
+            {
+                return MWS_IVP_FAIL;    /* 步长过小 */
+            }
+            if (step<T, MoReal>(rhs, N, t, h, m_preY, m_preYp, m_curY, m_err, mwsNullPtr, mwsNullPtr, m_work)
+                != MWS_IVP_SUCCESS)
+            {
+                return MWS_IVP_RHSFN_FAIL;
+            }
+            errNorm = myIVPErrorNorm(N, m_err, m_preY, m_curY, rtol, atol);
+            if (errNorm <= 1)
+            {
+                break;
+            }
+            h *= myIVPStepFactorCtl(&m_ctl, errNorm, T::kErrOrder);
+            rejected = true;
+        }
+
+        if constexpr (T::kFsal)
+        {
+            std::memcpy(m_curYp, m_work + (T::kStages - 1) * N, sizeof(m_curYp));
+        }
+        else if (m_f(t + h, m_curY, m_curYp) != MWS_IVP_SUCCESS)
+        {
+            return MWS_IVP_RHSFN_FAIL;
+        }
+
+        m_curTime = t + h;
+        m_initialStep = h;
+        m_ypValid = true;
+
+        factor = myIVPStepFactorCtl(&m_ctl, errNorm, T::kErrOrder);
+        if (rejected && factor > 1)
+        {
+            factor = 1;
+        }
+        m_h = h * factor;
+
+        std::memcpy(yret, m_curY, sizeof(m_curY));
+        if (ypret)
+        {
+            std::memcpy(ypret, m_curYp, sizeof(m_curYp));
+        }
+        *tret = m_curTime;
+        return MWS_IVP_SUCCESS;
+    }
+
+    /* 三次Hermite插值，同 myRK45Interpolate */
+    void interpolate(MoReal tout, MoReal* yret) const
+    {
+        MoReal h = m_initialStep;
+
+        if (h == 0)
+        {
+            std::memcpy(yret, m_curY, sizeof(m_curY));
+            return;
+        }
+        myIVPHermite(N, (tout - m_curTime + h) / h, h, m_preY, m_curY, m_preYp, m_curYp, yret);
+    }
+
+    void setController(const MyIVPController& ctl)
+    {
+        m_ctl = ctl;
+    }
+
+    const F& functor() const
+    {
+        return m_f;
+    }
+
+private:
+    F m_f;
+    MwsIVPOptions m_opt;        /* 容许误差数组仍归平台所有 */
+    MyIVPController m_ctl;
+    MoReal m_curTime;
+    MoReal m_h;                 /* 下一步的建议步长 */
+    MoReal m_initialStep;       /* 最近一步的步长，插值用 */
+    bool m_ypValid;             /* m_curYp 是否对应 (m_curTime, m_curY) */
+    MoReal m_preY[N];
+    MoReal m_curY[N];
+    MoReal m_preYp[N];
+    MoReal m_curYp[N];
+    MoReal m_err[N];
+    MoReal m_work[(T::kStages + 1) * N];
+};
+
+/*
+ * 插件接口：各函数与 MwsIVPSolverFcns 的函数指针类型一致，kFcns 可直接交给 isimRegisterIVPSolver。
+ * 平台传入的回调只用于确认规模，右端函数一律取编译期模型；问题规模与N不一致时创建失败
+ */
+template <class T, class F, MoSize N>
+struct FunctorSolver
+{
+    typedef FunctorIntegrator<T, F, N> Integrator;
+
+    struct Solver
+    {
+        MwsIVPUtilFcns m_utils;
+        void* m_userData;
+    };
+
+    static MwsIVPSolverObj create(MwsIVPUtilFcns* util_fcns, void* user_data)
+    {
+        Solver* sw = static_cast<Solver*>(util_fcns->m_allocMemory(user_data, 1, sizeof(Solver)));
+
+        if (sw)
+        {
+            sw->m_utils = *util_fcns;
+            sw->m_userData = user_data;
+        }
+        return sw;
+    }
+
+    static MwsIVPObj createProblem(MwsIVPSolverObj solver, MwsSize n, MwsIVPCallback* call_back,
+        MwsIVPOptions* opt, void* ivp_user_data)
+    {
+        Solver* sw = static_cast<Solver*>(solver);
+        void* mem;
+
+        if (n != N || !opt)
+        {
+            return mwsNullPtr;
+        }
+        mem = sw->m_utils.m_allocMemory(sw->m_userData, 1, sizeof(Integrator));
+        if (!mem)
+        {
+            return mwsNullPtr;
+        }
+        return new (mem) Integrator(makeFunctor<F>(ivp_user_data), *opt);
+    }
+
+    static MwsInteger init(MwsIVPSolverObj solver, MwsIVPObj ivp, MwsReal t0, const MwsReal* y0,
+        const MwsReal* yp0, MwsBoolean is_reinit, void* reserve)
+    {
+        return static_cast<Integrator*>(ivp)->init(t0, y0);
+    }
+
+    static MwsInteger solve(MwsIVPSolverObj solver, MwsIVPObj ivp, MwsReal step_size, MwsReal t, MwsReal tout,
+        MwsReal* tret, MwsReal* yret, MwsReal* ypret, void* reserve)
+    {
+        return static_cast<Integrator*>(ivp)->solve(step_size, t, tret, yret, ypret);
+    }
+
+    static MwsInteger interpolate(MwsIVPSolverObj solver, MwsIVPObj ivp, MwsReal tout, MwsReal* yret,
+        void* reserve)
+    {
+        static_cast<Integrator*>(ivp)->interpolate(tout, yret);
+        return MWS_IVP_SUCCESS;
+    }
+
+    static void destroyProblem(MwsIVPSolverObj solver, MwsIVPObj ivp)
+    {
+        Solver* sw = static_cast<Solver*>(solver);
+
+        if (ivp)
+        {
+            static_cast<Integrator*>(ivp)->~Integrator();
+            sw->m_utils.m_freeMemory(sw->m_userData, ivp);
+        }
+    }
+
+    static void destroy(MwsIVPSolverObj solver)
+    {
+        Solver* sw = static_cast<Solver*>(solver);
+
+        if (sw)
+        {
+            sw->m_utils.m_freeMemory(sw->m_userData, sw);
+        }
+    }
+
+    static constexpr MwsIVPSolverFcns kFcns = { &create, &createProblem, &init, &solve, &interpolate,
+        &destroyProblem, &destroy };
+};
+
+/* 注册编译期模型的积分算法，与 mws_user_algo.c 中注册表的各行相同，均为变步长ODE算法 */
+template <class T, class F, MoSize N>
+inline MoBoolean registerFunctorSolver(void* sim_data, MwsString name, MwsString desc)
+{
+    MwsIVPSolverProp prop;
+
+    prop.m_name = name;
+    prop.m_desc = desc;
+    prop.m_fixedStep = moFalse;
+    prop.m_ivpType = MWS_IVP_ODE;
+    return isimRegisterIVPSolver(sim_data, &prop, &FunctorSolver<T, F, N>::kFcns);
+}
+
+} /* namespace myrk */
+
+#endif /* !MY_RK_FUNCTOR_HPP */
+
+/***************************************************************************
+//   end of file
+***************************************************************************/
@@ -0,0 +1,445 @@
+/***************************************************************************
+///
+/// Copyright (c) 2020, 苏州同元软控信息技术有限公司
+/// All rights reserved.
+///
+/// @file           my_symplectic.c
+/// @brief          二阶力学系统的辛定步长积分算法：Stormer-Verlet、Yoshida 4阶、Blanes-Moan
+///
+/// @version        v1.0
+/// @author         田显钊
+/// @date           2020/07/07
+///
+***************************************************************************/
+
+#include "mo_types.h"
+#include "mws_ivp_solver.h"
+#include "my_ivp_common.h"
+#include "my_ivp_trace.h"
+
+#include <memory.h>
+#include <math.h>
+
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+/*
+ * 状态排列为 y = [q; v]：前 nPos 个为位置，后 nPos 个为速度，且 dq/dt = v。
+ * 加速度取右端函数输出的后半部分 a = f(t,[q;v])[nPos..2nPos)。
+ * 每个方法都是"踢(kick) v += c*h*a(q)"与"漂移(drift) q += d*h*v"交替的对称组合，
+ * 首尾的踢可合并（FSAL），每步加速度计算次数 = 漂移次数。
+ * 加速度与速度有关（如阻尼）时仍可计算，但不再严格保辛。
+ */
+typedef enum
+{
+    MY_SYMPLECTIC_VERLET = 0,   /* Stormer-Verlet（速度Verlet），2阶，每步1次右端函数 */
+    MY_SYMPLECTIC_YOSHIDA4,     /* Yoshida 4阶三重跳组合，每步3次右端函数 */
+    MY_SYMPLECTIC_BLANES_MOAN,  /* Blanes-Moan SRKN_6^b，4阶，误差常数远小于Yoshida，每步6次右端函数 */
+} MySymplecticMethod;
+
+#define MY_SYMPLECTIC_MAX_DRIFTS    6
+
+/* 组合系数：kick[0..nDrift]，drift[0..nDrift-1] */
+typedef struct
+{
+    MoInteger m_nDrift;
+    MoReal m_kick[MY_SYMPLECTIC_MAX_DRIFTS + 1];
+    MoReal m_drift[MY_SYMPLECTIC_MAX_DRIFTS];
+} MySymplecticScheme;
+
+/* Yoshida (1990)：w1 = 1/(2-2^(1/3))，w0 = -2^(1/3)/(2-2^(1/3)) */
+#define MY_YOSHIDA_W1   1.3512071919596576
+#define MY_YOSHIDA_W0   (-1.7024143839193153)
+
+/* Blanes, Moan (2002), Practical symplectic partitioned Runge-Kutta and Runge-Kutta-Nystrom methods, SRKN_6^b */
+#define MY_BM_A1    0.245298957184271
+#define MY_BM_A2    0.604872665711080
+#define MY_BM_A3    (0.5 - MY_BM_A1 - MY_BM_A2)
+#define MY_BM_B1    0.0829844064174052
+#define MY_BM_B2    0.396309801498368
+#define MY_BM_B3    (-0.0390563049223486)
+#define MY_BM_B4    (1 - 2 * (MY_BM_B1 + MY_BM_B2 + MY_BM_B3))
+
+static const MySymplecticScheme s_symplecticSchemes[3] =
+{
+    { 1, { 0.5, 0.5 }, { 1.0 } },
+    { 3, { MY_YOSHIDA_W1 / 2, (MY_YOSHIDA_W1 + MY_YOSHIDA_W0) / 2, (MY_YOSHIDA_W0 + MY_YOSHIDA_W1) / 2, MY_YOSHIDA_W1 / 2 },
+         { MY_YOSHIDA_W1, MY_YOSHIDA_W0, MY_YOSHIDA_W1 } },
+    { 6, { MY_BM_B1, MY_BM_B2, MY_BM_B3, MY_BM_B4, MY_BM_B3, MY_BM_B2, MY_BM_B1 },
+         { MY_BM_A1, MY_BM_A2, MY_BM_A3, MY_BM_A3, MY_BM_A2, MY_BM_A1 } },
+};
+
+/* 算法对象 */
+typedef struct
+{
+    MwsIVPUtilFcns	m_utils;
+    void*           m_userData;
+
+    MySymplecticMethod m_method;
+
+} MySymplectic;
+
+/* 求解问题的数据，用数据内存分配和释放函数 */
+typedef struct
+{
+    /* m_preY、m_curY、m_preYp、m_curYp 依次位于同一块连续内存中（由m_preY持有） */
+    MoReal *m_preY;         /* 上一步y */
+    MoReal *m_curY;         /* 当前y */
+    MoReal *m_preYp;        /* 上一步y' */
+    MoReal *m_curYp;        /* 当前y'，后半部分即当前加速度 */
+
+    MoSize m_nPos;          /* 位置个数 */
+
+    MoReal m_curTime;
+    MoReal m_initialStep;
+    MoBoolean m_ypValid;    /* m_curYp 是否对应 (m_curTime, m_curY) */
+} MySymplecticProblemData;
+
+/* 求解问题对象 */
+typedef struct
+{
+    MoSize          m_nStates;
+
+    MwsIVPOptions	m_opt;
+    MwsIVPCallback  m_callback;
+    void*			m_userData;
+    MY_IVP_TRACE_MEMBER(m_trace)
+
+    MySymplecticProblemData* m_data;
+    MySymplectic* m_solverWork;
+
+} MySymplecticProblem;
+
+void mySymplecticProblemDestroy(MwsIVPSolverObj solver, MwsIVPObj ivp);
+void mySymplecticDestroy(MwsIVPSolverObj solver);
+
+static MwsIVPSolverObj mySymplecticCreate(MwsIVPUtilFcns* util_fcns, void* user_data, MySymplecticMethod method)
+{
+    MySymplectic* sw = (MySymplectic*)util_fcns->m_allocMemory(user_data, 1, sizeof(MySymplectic));
+
+    if (sw)
+    {
+        memset(sw, 0, sizeof(*sw));
+        sw->m_utils = *util_fcns;
+        sw->m_userData = user_data;
+        sw->m_method = method;
+    }
+
+    return sw;
+}
+
+/// <summary>
+/// 创建算法（Stormer-Verlet）
+/// </summary>
+/// <param name="util_fcns">工具函数（由求解器提供，用户调用）</param>
+/// <param name="user_data">用户数据（求解器内部数据，传递给工具函数util_fcns，自定义算法无需关心其内容）</param>
+/// <returns></returns>
+MwsIVPSolverObj myVerletCreate(MwsIVPUtilFcns* util_fcns, void* user_data)
+{
+    return mySymplecticCreate(util_fcns, user_data, MY_SYMPLECTIC_VERLET);
+}
+
+/// <summary>
+/// 创建算法（Yoshida 4阶）
+/// </summary>
+MwsIVPSolverObj myYoshida4Create(MwsIVPUtilFcns* util_fcns, void* user_data)
+{
+    return mySymplecticCreate(util_fcns, user_data, MY_SYMPLECTIC_YOSHIDA4);
+}
+
+/// <summary>
+/// 创建算法（Blanes-Moan）
+/// </summary>
+MwsIVPSolverObj myBlanesMoanCreate(MwsIVPUtilFcns* util_fcns, void* user_data)
+{
+    return mySymplecticCreate(util_fcns, user_data, MY_SYMPLECTIC_BLANES_MOAN);
+}
+
+/// <summary>
+/// 创建问题，默认前一半状态为位置、后一半为速度
+/// </summary>
+/// <param name="solver">积分算法对象</param>
+/// <param name="n">问题规模，即状态变量个数==微分方程阶数</param>
+/// <param name="call_back">回调函数</param>
+/// <param name="opt">求解器选项</param>
+/// <param name="ivp_user_data">用户数据(求解器内部数据，传递给回调函数call_back，算法无需关心)</param>
+/// <returns></returns>
+MwsIVPObj mySymplecticProblemCreate(MwsIVPSolverObj solver, MwsSize n, MwsIVPCallback* call_back, MwsIVPOptions* opt, void* ivp_user_data)
+{
+    MySymplectic* sw = (MySymplectic*)solver;
+    MySymplecticProblem* spw = (MySymplecticProblem*)sw->m_utils.m_allocMemory(sw->m_userData, 1, sizeof(MySymplecticProblem));
+
+    if (spw)
+    {
+        MySymplecticProblemData* ds = (MySymplecticProblemData*)sw->m_utils.m_allocDataMemory(sw->m_userData, 1, sizeof(MySymplecticProblemData));
+
+        if (ds == mwsNullPtr)
+        {
+            sw->m_utils.m_freeMemory(sw->m_userData, spw);
+            return mwsNullPtr;
+        }
+
+        memset(spw, 0, sizeof(*spw));
+        memset(ds, 0, sizeof(*ds));
+
+        spw->m_callback = *call_back;
+        spw->m_userData = ivp_user_data;
+        MY_IVP_TRACE_INTERPOSE(&spw->m_trace, &spw->m_callback, &spw->m_userData);
+        spw->m_opt = *opt;
+        spw->m_nStates = n;
+        spw->m_data = ds;
+        spw->m_solverWork = sw;
+
+        ds->m_nPos = n / 2;
+
+        if (spw->m_nStates > 0)
+        {
+            ds->m_preY = (MoReal*)sw->m_utils.m_allocDataMemory(sw->m_userData, 4, n * sizeof(MoReal));
+
+            if (!ds->m_preY)
+            {
+                mySymplecticProblemDestroy(sw, spw);
+                spw = MWnullptr;
+            }
+            else
+            {
+                ds->m_curY = ds->m_preY + n;
+                ds->m_preYp = ds->m_preY + 2 * n;
+                ds->m_curYp = ds->m_preY + 3 * n;
+
+                memset(ds->m_preY, 0, 4 * n * sizeof(MoReal));
+            }
+        }
+    }
+
+    return spw;
+}
+
+/// <summary>
+/// 设置状态排列：前 n_pos 个为位置，紧接着 n_pos 个为速度
+/// </summary>
+/// <param name="solver">积分算法对象</param>
+/// <param name="ivp">问题对象</param>
+/// <param name="n_pos">位置个数，须满足 2*n_pos == n</param>
+/// <returns></returns>
+MwsInteger mySymplecticSetLayout(MwsIVPSolverObj solver, MwsIVPObj ivp, MoSize n_pos)
+{
+    MySymplecticProblem* spw = (MySymplecticProblem*)ivp;
+
+    if (2 * n_pos != spw->m_nStates)
+    {
+        return MWS_IVP_INVALID_INPUT;
+    }
+    spw->m_data->m_nPos = n_pos;
+
+    return MWS_IVP_SUCCESS;
+}
+
+/// <summary>
+/// 初始化
+/// </summary>
+/// <param name="solver">积分算法对象</param>
+/// <param name="ivp">问题对象</param>
+/// <param name="t0">初始时间</param>
+/// <param name="y0">y的初始值（特定不为空）</param>
+/// <param name="yp0">y’的初始值（DAE）</param>
+/// <param name="is_reinit">是否重新初始化（保留）</param>
+/// <param name="reserve">保留参数，暂不使用</param>
+/// <returns></returns>
+MwsInteger mySymplecticInit(MwsIVPSolverObj solver, MwsIVPObj ivp, MwsReal t0, const MwsReal* y0,
+    const MwsReal* yp0, MwsBoolean is_reinit, void* reserve)
+{
+    MySymplecticProblem* spw = (MySymplecticProblem*)ivp;
+    MySymplecticProblemData* ds = spw->m_data;
+    MoSize nState = spw->m_nStates;
+
+    ds->m_curTime = t0;
+    ds->m_ypValid = moFalse;
+
+    if (nState == 0 || y0 == mwsNullPtr)
+    {
+        return MWS_IVP_SUCCESS;
+    }
+
+    memcpy(ds->m_curY, y0, nState * sizeof(MoReal));
+    memcpy(ds->m_preY, y0, nState * sizeof(MoReal));
+    if (spw->m_callback.m_rshFunction(spw->m_userData, t0, ds->m_curY, ds->m_curYp) != MWS_IVP_SUCCESS)
+    {
+        return MWS_IVP_RHSFN_FAIL;
+    }
+    memcpy(ds->m_preYp, ds->m_curYp, nState * sizeof(MoReal));
+    ds->m_ypValid = moTrue;
+
+    return MWS_IVP_SUCCESS;
+}
+
+/// <summary>
+/// 求解：定步长，每次调用前进一步
+/// </summary>
+/// 输入：
+/// <param name="solver">积分算法对象</param>
+/// <param name="ivp">问题对象</param>
+/// <param name="step_size">积分步长</param>
+/// <param name="t">当前时间</param>
+/// <param name="tout">输出结果时间</param>
+/// 输出：
+/// <param name="tret">结果实际达到的时间</param>
+/// <param name="yret">y的结果值（输入为当前y）</param>
+/// <param name="ypret">y’的结果值（可为空）</param>
+/// <param name="reserve">保留参数，暂不使用</param>
+/// <returns></returns>
+MwsInteger mySymplecticSolve(MwsIVPSolverObj solver, MwsIVPObj ivp, MwsReal step_size, MwsReal t,
+    MwsReal tout, MwsReal* tret, MwsReal* yret, MwsReal* ypret, void* reserve)
+{
+    MySymplectic* sw = (MySymplectic*)solver;
+    MySymplecticProblem* spw = (MySymplecticProblem*)ivp;
+    MySymplecticProblemData* ds = spw->m_data;
+    const MySymplecticScheme* sc = &s_symplecticSchemes[sw->m_method];
+
+    MoSize n = spw->m_nStates;
+    MoSize nPos = ds->m_nPos;
+    MoSize index;
+    MoInteger stage;
+    MoReal h = step_size;
+    MoReal tau = t;
+
+    MoReal* y = ds->m_curY;
+    MoReal* q = y;
+    MoReal* v = y + nPos;
+    MoReal* a = ds->m_curYp + nPos;
+    MY_IVP_TRACE_BEGIN(attempt)
+
+    if (2 * nPos != n)
+    {
+        return MWS_IVP_INVALID_INPUT;
+    }
+
+    memcpy(ds->m_preY, yret, n * sizeof(MoReal));
+    memcpy(y, yret, n * sizeof(MoReal));
+    if (!(ds->m_ypValid && t == ds->m_curTime)
+        && n > 0 && spw->m_callback.m_rshFunction(spw->m_userData, t, y, ds->m_curYp) != MWS_IVP_SUCCESS)
+    {
+        return MWS_IVP_RHSFN_FAIL;
+    }
+    memcpy(ds->m_preYp, ds->m_curYp, n * sizeof(MoReal));
+    ds->m_ypValid = moFalse;
+
+    for (stage = 0; stage < sc->m_nDrift; ++stage)
+    {
+        /* 踢：v += kick*h*a(q) */
+        for (index = 0; index < nPos; ++index)
+        {
+            v[index] += sc->m_kick[stage] * h * a[index];
+        }
+        /* 漂移：q += drift*h*v */
+        for (index = 0; index < nPos; ++index)
+        {
+            q[index] += sc->m_drift[stage] * h * v[index];
+        }
+        tau += sc->m_drift[stage] * h;
+        if (spw->m_callback.m_rshFunction(spw->m_userData, stage + 1 == sc->m_nDrift ? t + h : tau, y, ds->m_curYp) != MWS_IVP_SUCCESS)
+        {
+            return MWS_IVP_RHSFN_FAIL;
+        }
+    }
+    /* 末尾的踢，其加速度即下一步首个踢的加速度（FSAL） */
+    for (index = 0; index < nPos; ++index)
+    {
+        v[index] += sc->m_kick[sc->m_nDrift] * h * a[index];
+    }
+    /* y'的前半部分（位置导数）即更新后的速度 */
+    memcpy(ds->m_curYp, v, nPos * sizeof(MoReal));
+
+    ds->m_curTime = t + h;
+    ds->m_initialStep = h;
+    ds->m_ypValid = moTrue;
+
+    memcpy(yret, y, n * sizeof(MoReal));
+    if (ypret)
+    {
+        memcpy(ypret, ds->m_curYp, n * sizeof(MoReal));
+    }
+    *tret = ds->m_curTime;
+    MY_IVP_TRACE_END(MY_IVP_TRACE_STEP, attempt);
+
+    return MWS_IVP_SUCCESS;
+}
+
+/// <summary>
+/// 插值：步两端的三次Hermite插值
+/// </summary>
+/// 输入：
+/// <param name="solver">积分算法对象</param>
+/// <param name="ivp">问题对象</param>
+/// <param name="tout">输出结果的时间</param>
+/// 输出：
+/// <param name="yret">y的结果值</param>
+/// <param name="reserve"></param>
+/// <returns></returns>
+MwsInteger mySymplecticInterpolate(MwsIVPSolverObj solver, MwsIVPObj ivp, MwsReal tout, MwsReal* yret, void* reserve)
+{
+    MySymplecticProblem* spw = (MySymplecticProblem*)ivp;
+    MySymplecticProblemData* ds = spw->m_data;
+    MoReal h = ds->m_initialStep;
+
+    if (h == 0)
+    {
+        memcpy(yret, ds->m_curY, spw->m_nStates * sizeof(MoReal));
+        return MWS_IVP_SUCCESS;
+    }
+
+    myIVPHermite(spw->m_nStates, (tout - ds->m_curTime + h) / h, h, ds->m_preY, ds->m_curY,
+        ds->m_preYp, ds->m_curYp, yret);
+
+    return MWS_IVP_SUCCESS;
+}
+
+/// <summary>
+/// 销毁问题
+/// </summary>
+/// <param name="solver"></param>
+/// <param name="ivp"></param>
+void mySymplecticProblemDestroy(MwsIVPSolverObj solver, MwsIVPObj ivp)
+{
+    MySymplectic* sw = (MySymplectic*)solver;
+    MySymplecticProblem* spw = (MySymplecticProblem*)ivp;
+
+    if (spw)
+    {
+        if (spw->m_data->m_preY)
+        {
+            (*sw->m_utils.m_freeDataMemory)(sw->m_userData, spw->m_data->m_preY);
+        }
+
+        if (spw->m_data)
+        {
+            (*sw->m_utils.m_freeDataMemory)(sw->m_userData, spw->m_data);
+        }
+
+        (*sw->m_utils.m_freeMemory)(sw->m_userData, spw);
+    }
+}
+
+/// <summary>
+/// 销毁积分算法
+/// </summary>
+/// <param name="solver"></param>
+void mySymplecticDestroy(MwsIVPSolverObj solver)
+{
+    MySymplectic* sw = (MySymplectic*)solver;
+
+    if (sw)
+    {
+        (*sw->m_utils.m_freeMemory)(sw->m_userData, sw);
+    }
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+
+/***************************************************************************
+//   end of file
+***************************************************************************/
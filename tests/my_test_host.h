@@ -0,0 +1,74 @@
+/***************************************************************************
+///
+/// Copyright (c) 2020, 苏州同元软控信息技术有限公司
+/// All rights reserved.
+///
+/// @file           my_test_host.h
+/// @brief          回归测试用的最小宿主：工具函数、注册接口桩与检查宏。
+///                 各测试整体包含 mws_user_algo.c，编译方法（平台头文件目录为 $MWS_INC）：
+///                 g++ -c -O2 -I$MWS_INC ../my_rk_engine.cpp
+///                 gcc -std=gnu99 -O2 -I$MWS_INC -I.. test_xxx.c my_rk_engine.o -lstdc++ -lm
+///
+/// @version        v1.0
+/// @author         田显钊
+/// @date           2020/07/07
+///
+***************************************************************************/
+
+#ifndef MY_TEST_HOST_H
+#define MY_TEST_HOST_H
+
+#include "mws_user_algo.c"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+static int s_myTestFailed = 0;
+
+/* 检查条件，失败时打印位置并记录，测试继续执行 */
+#define MY_TEST_CHECK(cond) \
+    do \
+    { \
+        if (!(cond)) \
+        { \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            s_myTestFailed = 1; \
+        } \
+    } while (0)
+
+static void* myTestAlloc(void* user_data, MwsSize count, MwsSize size)
+{
+    return calloc(count, size);
+}
+
+static void myTestFree(void* user_data, void* ptr)
+{
+    free(ptr);
+}
+
+static void myTestLogger(void* user_data, MwsInteger status, MwsString where, MwsString msg)
+{
+    printf("[%d] %s: %s\n", (int)status, where, msg);
+}
+
+static MwsIVPUtilFcns s_myTestUtils = { myTestLogger, myTestAlloc, myTestFree, myTestAlloc, myTestFree };
+
+/* 平台注册接口的桩，测试中直接调用各算法函数 */
+MoBoolean isimRegisterIVPSolver(void* sim_data, const MwsIVPSolverProp* prop, const MwsIVPSolverFcns* fcns)
+{
+    return moTrue;
+}
+
+MoBoolean isimUnregisterIVPSolver(void* sim_data, MwsString name)
+{
+    return moTrue;
+}
+
+/* 汇总结果作为进程返回值：0为通过 */
+static int myTestResult(const char* name)
+{
+    printf("%s: %s\n", name, s_myTestFailed ? "FAILED" : "passed");
+    return s_myTestFailed;
+}
+
+#endif /* !MY_TEST_HOST_H */
@@ -0,0 +1,105 @@
+/***************************************************************************
+///
+/// Copyright (c) 2020, 苏州同元软控信息技术有限公司
+/// All rights reserved.
+///
+/// @file           test_rk45_adjoint.c
+/// @brief          回归测试：myRK45 伴随梯度与正向灵敏度一致；反复调用 myRK45AdjointSolve（中间换一个终点权重）
+///                 结果逐位相同，检查点预算很小需要段内重算时也如此
+///
+/// @version        v1.0
+/// @author         田显钊
+/// @date           2020/07/07
+///
+***************************************************************************/
+
+#include "my_test_host.h"
+
+#include <math.h>
+
+#define MY_TEST_END     3.0
+
+static MoReal s_myTestParams[2] = { 0.7, 1.3 };
+
+/* y0' = -p0*y0 + 0.1*sin(y1)，y1' = -p1*y1 + p0*y0^2 */
+static MwsInteger myTestRhs(void* user_data, MwsReal t, const MwsReal* y, MwsReal* yp)
+{
+    const MoReal* p = (const MoReal*)user_data;
+
+    yp[0] = -p[0] * y[0] + 0.1 * sin(y[1]);
+    yp[1] = -p[1] * y[1] + p[0] * y[0] * y[0];
+    return MWS_IVP_SUCCESS;
+}
+
+static MwsInteger myTestDfdp(void* user_data, MoReal t, const MoReal* y, MoInteger j, MoReal* dfdp)
+{
+    dfdp[0] = j == 0 ? -y[0] : 0;
+    dfdp[1] = j == 0 ? y[0] * y[0] : -y[1];
+    return MWS_IVP_SUCCESS;
+}
+
+/* 检查点数为slots时：g = y1(T) 的伴随梯度与正向灵敏度比较，并检查重复调用结果不变 */
+static void myTestAdjoint(MoSize slots)
+{
+    MwsReal rtol = 1e-9, atol = 1e-9;
+    MwsIVPOptions opt = { moTrue, MY_TEST_END, moTrue, &rtol, &atol, moFalse, 0 };
+    MwsIVPCallback cb = { myTestRhs, mwsNullPtr, mwsNullPtr, mwsNullPtr };
+    MwsIVPSolverObj solver = myRK45Create(&s_myTestUtils, mwsNullPtr);
+    MwsIVPObj ivp = myRK45ProblemCreate(solver, 2, &cb, &opt, s_myTestParams);
+    MwsReal y[2] = { 1, 0 };
+    MwsReal t = 0, tret;
+    MoReal sens[4];
+    MoReal lambdaT[2] = { 0, 1 };
+    MoReal lambdaOther[2] = { 1, 0 };
+    MoReal lambda0[2], grad[2], lambda1[2], grad1[2];
+    MoSize recomputed, recomputed1;
+    MwsInteger status = MWS_IVP_SUCCESS;
+    int call;
+
+    MY_TEST_CHECK(myRK45Init(solver, ivp, 0, y, mwsNullPtr, moFalse, mwsNullPtr) == MWS_IVP_SUCCESS);
+    MY_TEST_CHECK(myRK45SetSensitivity(solver, ivp, 2, s_myTestParams, myTestDfdp, moFalse, mwsNullPtr)
+        == MWS_IVP_SUCCESS);
+    MY_TEST_CHECK(myRK45SetAdjoint(solver, ivp, slots * 2 * sizeof(MoReal), 2, s_myTestParams, myTestDfdp, mwsNullPtr)
+        == MWS_IVP_SUCCESS);
+    while (t < MY_TEST_END && status == MWS_IVP_SUCCESS)
+    {
+        status = myRK45Solve(solver, ivp, 0, t, MY_TEST_END, &tret, y, mwsNullPtr, mwsNullPtr);
+        t = tret;
+    }
+    MY_TEST_CHECK(status == MWS_IVP_SUCCESS || status == MWS_IVP_TSTOP_RETURN);
+    MY_TEST_CHECK(myRK45GetSensitivity(solver, ivp, MY_TEST_END, sens) == MWS_IVP_SUCCESS);
+
+    MY_TEST_CHECK(myRK45AdjointSolve(solver, ivp, lambdaT, lambda0, grad, &recomputed) == MWS_IVP_SUCCESS);
+    /* 灵敏度按参数存放，每个参数n个分量 */
+    MY_TEST_CHECK(fabs(grad[0] - sens[1]) < 1e-6 && fabs(grad[1] - sens[3]) < 1e-6);
+
+    for (call = 0; call < 3; ++call)
+    {
+        MoBoolean other = call == 1;
+
+        MY_TEST_CHECK(myRK45AdjointSolve(solver, ivp, other ? lambdaOther : lambdaT, lambda1, grad1, &recomputed1)
+            == MWS_IVP_SUCCESS);
+        if (!other)
+        {
+            MY_TEST_CHECK(memcmp(lambda1, lambda0, sizeof(lambda0)) == 0 && memcmp(grad1, grad, sizeof(grad)) == 0);
+            MY_TEST_CHECK(recomputed1 == recomputed);
+        }
+    }
+    printf("slots %3u: grad %.9f %.9f, recomputed %u\n", (unsigned)slots, grad[0], grad[1], (unsigned)recomputed);
+
+    myRK45ProblemDestroy(solver, ivp);
+    myRK45Destroy(solver);
+}
+
+int main(void)
+{
+    static const MoSize slots[] = { 2, 3, 4, 6, 10, 1000 };
+    MoSize i;
+
+    for (i = 0; i < sizeof(slots) / sizeof(slots[0]); ++i)
+    {
+        myTestAdjoint(slots[i]);
+    }
+
+    return myTestResult("test_rk45_adjoint");
+}
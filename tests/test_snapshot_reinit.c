@@ -0,0 +1,146 @@
+/***************************************************************************
+///
+/// Copyright (c) 2020, 苏州同元软控信息技术有限公司
+/// All rights reserved.
+///
+/// @file           test_snapshot_reinit.c
+/// @brief          回归测试：重新初始化（is_reinit）后快照仍可回退，回退后的状态与时刻与保存时一致，
+///                 继续积分的结果与未重新初始化时逐位相同（myEuler、myRK45）
+///
+/// @version        v1.0
+/// @author         田显钊
+/// @date           2020/07/07
+///
+***************************************************************************/
+
+#include "my_test_host.h"
+
+#define MY_TEST_STEP    0.01
+
+/* 阻尼振子 */
+static MwsInteger myTestRhs(void* user_data, MwsReal t, const MwsReal* y, MwsReal* yp)
+{
+    yp[0] = y[1];
+    yp[1] = -y[0] - 0.1 * y[1];
+    return MWS_IVP_SUCCESS;
+}
+
+/* 定步长推进steps步 */
+static void myTestEulerRun(MwsIVPSolverObj solver, MwsIVPObj ivp, MwsReal* t, MwsReal* y, int steps)
+{
+    int i;
+
+    for (i = 0; i < steps; ++i)
+    {
+        MwsReal tret;
+
+        MY_TEST_CHECK(myEulerSolve(solver, ivp, MY_TEST_STEP, *t, *t + MY_TEST_STEP, &tret, y, mwsNullPtr, mwsNullPtr)
+            == MWS_IVP_SUCCESS);
+        *t = tret;
+    }
+}
+
+/* 变步长推进到tout */
+static void myTestRK45Run(MwsIVPSolverObj solver, MwsIVPObj ivp, MwsReal* t, MwsReal* y, MwsReal tout)
+{
+    MwsInteger status = MWS_IVP_SUCCESS;
+
+    while (*t < tout && status == MWS_IVP_SUCCESS)
+    {
+        MwsReal tret;
+
+        status = myRK45Solve(solver, ivp, 0, *t, tout, &tret, y, mwsNullPtr, mwsNullPtr);
+        *t = tret;
+    }
+    MY_TEST_CHECK(status == MWS_IVP_SUCCESS || status == MWS_IVP_TSTOP_RETURN);
+}
+
+/* reinit为真时在保存快照后重新初始化到别的状态，再回退；为假时直接回退 */
+static void myTestEuler(MoBoolean reinit, MwsReal* tEnd, MwsReal* yEnd)
+{
+    MwsIVPOptions opt = { 0 };
+    MwsIVPCallback cb = { myTestRhs, mwsNullPtr, mwsNullPtr, mwsNullPtr };
+    MwsIVPSolverObj solver = myEulerCreate(&s_myTestUtils, mwsNullPtr);
+    MwsIVPObj ivp = myEulerProblemCreate(solver, 2, &cb, &opt, mwsNullPtr);
+    MwsReal y[2] = { 1, 0 };
+    MwsReal ySaved[2];
+    MwsReal yOther[2] = { -3, 5 };
+    MwsReal t = 0, tSaved, tret;
+
+    MY_TEST_CHECK(myEulerInit(solver, ivp, 0, y, mwsNullPtr, moFalse, mwsNullPtr) == MWS_IVP_SUCCESS);
+    myTestEulerRun(solver, ivp, &t, y, 50);
+    MY_TEST_CHECK(myEulerSaveState(solver, ivp) == MWS_IVP_SUCCESS);
+    tSaved = t;
+    ySaved[0] = y[0];
+    ySaved[1] = y[1];
+
+    myTestEulerRun(solver, ivp, &t, y, 20);
+    if (reinit)
+    {
+        MY_TEST_CHECK(myEulerInit(solver, ivp, t, yOther, mwsNullPtr, moTrue, mwsNullPtr) == MWS_IVP_SUCCESS);
+    }
+    MY_TEST_CHECK(myEulerRestoreState(solver, ivp, &tret, y, mwsNullPtr) == MWS_IVP_SUCCESS);
+    MY_TEST_CHECK(tret == tSaved && y[0] == ySaved[0] && y[1] == ySaved[1]);
+
+    t = tret;
+    myTestEulerRun(solver, ivp, &t, y, 30);
+    *tEnd = t;
+    yEnd[0] = y[0];
+    yEnd[1] = y[1];
+
+    myEulerProblemDestroy(solver, ivp);
+    myEulerDestroy(solver);
+}
+
+static void myTestRK45(MoBoolean reinit, MwsReal* tEnd, MwsReal* yEnd)
+{
+    MwsReal rtol = 1e-8, atol = 1e-8;
+    MwsIVPOptions opt = { moTrue, 2.0, moTrue, &rtol, &atol, moFalse, 0 };
+    MwsIVPCallback cb = { myTestRhs, mwsNullPtr, mwsNullPtr, mwsNullPtr };
+    MwsIVPSolverObj solver = myRK45Create(&s_myTestUtils, mwsNullPtr);
+    MwsIVPObj ivp = myRK45ProblemCreate(solver, 2, &cb, &opt, mwsNullPtr);
+    MwsReal y[2] = { 1, 0 };
+    MwsReal ySaved[2];
+    MwsReal yOther[2] = { -3, 5 };
+    MwsReal t = 0, tSaved, tret;
+
+    MY_TEST_CHECK(myRK45Init(solver, ivp, 0, y, mwsNullPtr, moFalse, mwsNullPtr) == MWS_IVP_SUCCESS);
+    myTestRK45Run(solver, ivp, &t, y, 0.5);
+    MY_TEST_CHECK(myRK45SaveState(solver, ivp) == MWS_IVP_SUCCESS);
+    tSaved = t;
+    ySaved[0] = y[0];
+    ySaved[1] = y[1];
+
+    myTestRK45Run(solver, ivp, &t, y, 1.0);
+    if (reinit)
+    {
+        MY_TEST_CHECK(myRK45Init(solver, ivp, t, yOther, mwsNullPtr, moTrue, mwsNullPtr) == MWS_IVP_SUCCESS);
+    }
+    MY_TEST_CHECK(myRK45RestoreState(solver, ivp, &tret, y, mwsNullPtr) == MWS_IVP_SUCCESS);
+    MY_TEST_CHECK(tret == tSaved && y[0] == ySaved[0] && y[1] == ySaved[1]);
+
+    t = tret;
+    myTestRK45Run(solver, ivp, &t, y, 2.0);
+    *tEnd = t;
+    yEnd[0] = y[0];
+    yEnd[1] = y[1];
+
+    myRK45ProblemDestroy(solver, ivp);
+    myRK45Destroy(solver);
+}
+
+int main(void)
+{
+    MwsReal tRef, tReinit;
+    MwsReal yRef[2], yReinit[2];
+
+    myTestEuler(moFalse, &tRef, yRef);
+    myTestEuler(moTrue, &tReinit, yReinit);
+    MY_TEST_CHECK(tReinit == tRef && yReinit[0] == yRef[0] && yReinit[1] == yRef[1]);
+
+    myTestRK45(moFalse, &tRef, yRef);
+    myTestRK45(moTrue, &tReinit, yReinit);
+    MY_TEST_CHECK(tReinit == tRef && yReinit[0] == yRef[0] && yReinit[1] == yRef[1]);
+
+    return myTestResult("test_snapshot_reinit");
+}